@@ -45,6 +45,7 @@ SOURCES += \
     ui/aboutdialog.cpp \
     ui/enteroneblastquerydialog.cpp \
     blast/blasthit.cpp \
+    blast/blasthitstore.cpp \
     blast/blastqueries.cpp \
     ui/blastsearchdialog.cpp \
     ui/infotextwidget.cpp \
@@ -57,6 +58,9 @@ SOURCES += \
     command_line/image.cpp \
     command_line/commoncommandlinefunctions.cpp \
     ui/mytablewidget.cpp \
+    ui/mytableview.cpp \
+    ui/blasthitstablemodel.cpp \
+    ui/blastqueriestablemodel.cpp \
     blast/buildblastdatabaseworker.cpp \
     ui/colourbutton.cpp \
     blast/blastquery.cpp \
@@ -67,11 +71,11 @@ SOURCES += \
     graph/graphlocation.cpp \
     ui/tablewidgetitemint.cpp \
     ui/tablewidgetitemdouble.cpp \
-    ui/tablewidgetitemshown.cpp \
     program/memory.cpp \
-    ui/querypathspushbutton.cpp \
     ui/querypathsdialog.cpp \
     blast/blastquerypath.cpp \
+    blast/querypathsearch.cpp \
+    blast/graphaligner.cpp \
     tests/bandagetests.cpp \
     ui/blasthitfiltersdialog.cpp \
     program/scinot.cpp \
@@ -79,8 +83,28 @@ SOURCES += \
     ui/changenodedepthdialog.cpp \
     ui/querypathsequencecopybutton.cpp \
     command_line/querypaths.cpp \
+    command_line/querybatch.cpp \
     command_line/info.cpp \
     command_line/reduce.cpp \
+    command_line/contiguity.cpp \
+    command_line/filter.cpp \
+    command_line/shortestpath.cpp \
+    command_line/bubbles.cpp \
+    command_line/clean.cpp \
+    command_line/find.cpp \
+    graph/contiguityengine.cpp \
+    graph/pathenumerator.cpp \
+    graph/nodenameindex.cpp \
+    graph/nodedepthindex.cpp \
+    graph/shortestpathfinder.cpp \
+    graph/superbubblefinder.cpp \
+    graph/graphcleaner.cpp \
+    graph/orderstatistictree.cpp \
+    graph/graphstatistics.cpp \
+    graph/grapheditjournal.cpp \
+    graph/graphcoarsener.cpp \
+    graph/sequenceindex.cpp \
+    graph/translatedindex.cpp \
     ogdf/basic/Graph.cpp \
     ogdf/basic/GraphAttributes.cpp \
     ogdf/energybased/FMMMLayout.cpp \
@@ -116,8 +140,7 @@ SOURCES += \
     ogdf/internal/energybased/QuadTreeNodeNM.cpp \
     ogdf/basic/Constraint.cpp \
     ogdf/internal/energybased/MultilevelGraph.cpp \
-    ui/graphinfodialog.cpp \
-    ui/tablewidgetitemname.cpp
+    ui/graphinfodialog.cpp
 
 HEADERS  += \
     program/settings.h \
@@ -137,6 +160,7 @@ HEADERS  += \
     ui/enteroneblastquerydialog.h \
     blast/blasthitpart.h \
     blast/blasthit.h \
+    blast/blasthitstore.h \
     blast/blastquery.h \
     blast/blastqueries.h \
     blast/blastsearch.h \
@@ -151,6 +175,9 @@ HEADERS  += \
     command_line/image.h \
     command_line/commoncommandlinefunctions.h \
     ui/mytablewidget.h \
+    ui/mytableview.h \
+    ui/blasthitstablemodel.h \
+    ui/blastqueriestablemodel.h \
     blast/buildblastdatabaseworker.h \
     ui/colourbutton.h \
     blast/runblastsearchworker.h \
@@ -159,20 +186,41 @@ HEADERS  += \
     graph/graphlocation.h \
     ui/tablewidgetitemint.h \
     ui/tablewidgetitemdouble.h \
-    ui/tablewidgetitemshown.h \
     program/memory.h \
     graph/querydistance.h \
-    ui/querypathspushbutton.h \
     ui/querypathsdialog.h \
     blast/blastquerypath.h \
+    blast/querypathsearch.h \
+    blast/graphaligner.h \
     ui/blasthitfiltersdialog.h \
     program/scinot.h \
+    program/runjobs.h \
     ui/changenodenamedialog.h \
     ui/changenodedepthdialog.h \
     ui/querypathsequencecopybutton.h \
     command_line/querypaths.h \
+    command_line/querybatch.h \
     command_line/info.h \
     command_line/reduce.h \
+    command_line/contiguity.h \
+    command_line/filter.h \
+    command_line/shortestpath.h \
+    command_line/bubbles.h \
+    command_line/clean.h \
+    command_line/find.h \
+    graph/contiguityengine.h \
+    graph/pathenumerator.h \
+    graph/nodenameindex.h \
+    graph/nodedepthindex.h \
+    graph/shortestpathfinder.h \
+    graph/superbubblefinder.h \
+    graph/graphcleaner.h \
+    graph/orderstatistictree.h \
+    graph/graphstatistics.h \
+    graph/grapheditjournal.h \
+    graph/graphcoarsener.h \
+    graph/sequenceindex.h \
+    graph/translatedindex.h \
     ogdf/basic/Graph.h \
     ogdf/basic/GraphAttributes.h \
     ogdf/energybased/FMMMLayout.h \
@@ -239,8 +287,7 @@ HEADERS  += \
     ogdf/internal/energybased/QuadTreeNodeNM.h \
     ogdf/basic/Constraints.h \
     ogdf/internal/energybased/MultilevelGraph.h \
-    ui/graphinfodialog.h \
-    ui/tablewidgetitemname.h
+    ui/graphinfodialog.h
 
 FORMS    += \
     ui/mainwindow.ui \
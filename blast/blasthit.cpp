@@ -37,44 +37,77 @@ BlastHit::BlastHit(BlastQuery * query, DeBruijnNode * node,
     m_nodeStart(nodeStart), m_nodeEnd(nodeEnd),
     m_eValue(eValue), m_bitScore(bitScore)
 {
-    int nodeLength = m_node->getLength();
-    int queryLength = m_query->getLength();
+}
 
-    m_nodeStartFraction = double(nodeStart - 1) / nodeLength;
-    m_nodeEndFraction = double(nodeEnd) / nodeLength;
-    m_queryStartFraction = double(queryStart - 1) / queryLength;
-    m_queryEndFraction = double(queryEnd) / queryLength;
+BlastHit::BlastHit() :
+    m_query(0), m_node(0),
+    m_percentIdentity(0.0), m_alignmentLength(0),
+    m_numberMismatches(0), m_numberGapOpens(0),
+    m_queryStart(0), m_queryEnd(0),
+    m_nodeStart(0), m_nodeEnd(0),
+    m_bitScore(0.0)
+{
+}
+
+
+double BlastHit::getNodeStartFraction() const
+{
+    return double(m_nodeStart - 1) / m_node->getLength();
+}
+
+double BlastHit::getNodeEndFraction() const
+{
+    return double(m_nodeEnd) / m_node->getLength();
+}
+
+double BlastHit::getQueryStartFraction() const
+{
+    return double(m_queryStart - 1) / m_query->getLength();
+}
+
+double BlastHit::getQueryEndFraction() const
+{
+    return double(m_queryEnd) / m_query->getLength();
 }
 
 std::vector<BlastHitPart> BlastHit::getBlastHitParts(bool reverse, double scaledNodeLength)
 {
     std::vector<BlastHitPart> returnVector;
+    double nodeStartFraction = getNodeStartFraction();
+    double nodeEndFraction = getNodeEndFraction();
 
     //If the colour scheme is Blast rainbow, then this function generates lots
     //of BlastHitParts - each small and with a different colour of the rainbow.
     if (g_settings->nodeColourScheme == BLAST_HITS_RAINBOW_COLOUR)
     {
-        double scaledHitLength = (m_nodeEndFraction - m_nodeStartFraction) * scaledNodeLength;
+        double scaledHitLength = (nodeEndFraction - nodeStartFraction) * scaledNodeLength;
 
-        int partCount = ceil(g_settings->blastRainbowPartsPerQuery * fabs(m_queryStartFraction - m_queryEndFraction));
+        double queryStartFraction = getQueryStartFraction();
+        double queryEndFraction = getQueryEndFraction();
+        int partCount = ceil(g_settings->blastRainbowPartsPerQuery * fabs(queryStartFraction - queryEndFraction));
 
-        //If there are way more parts than the scaled hit length, that means
-        //that a single part will be much less than a pixel in length.  This
-        //isn't desirable, so reduce the partCount in these cases.
-        if (partCount > scaledHitLength * 2.0)
-            partCount = int(scaledHitLength * 2.0);
+        //If there are more parts than the scaled hit length, that means that
+        //a single part would be less than a pixel in length.  Then the hit is
+        //made as one part with a rainbow gradient instead, which looks the
+        //same but is much faster to draw.
+        if (partCount > scaledHitLength)
+        {
+            if (reverse)
+                returnVector.push_back(BlastHitPart(queryStartFraction, queryEndFraction, 1.0 - nodeStartFraction, 1.0 - nodeEndFraction));
+            else
+                returnVector.push_back(BlastHitPart(queryStartFraction, queryEndFraction, nodeStartFraction, nodeEndFraction));
+            return returnVector;
+        }
 
-        double nodeSpacing = (m_nodeEndFraction - m_nodeStartFraction) / partCount;
-        double querySpacing = (m_queryEndFraction - m_queryStartFraction) / partCount;
+        double nodeSpacing = (nodeEndFraction - nodeStartFraction) / partCount;
+        double querySpacing = (queryEndFraction - queryStartFraction) / partCount;
 
-        double nodeFraction = m_nodeStartFraction;
-        double queryFraction = m_queryStartFraction;
+        double nodeFraction = nodeStartFraction;
+        double queryFraction = queryStartFraction;
 
         for (int i = 0; i < partCount; ++i)
         {
-            QColor dotColour;
-            dotColour.setHsvF(queryFraction * 0.9, 1.0, 1.0);  //times 0.9 to keep the colour from getting too close to red, as that could confuse the end with the start
-
+            QColor dotColour = getRainbowColour(queryFraction);
             double nextFraction = nodeFraction + nodeSpacing;
 
             if (reverse)
@@ -92,18 +125,22 @@ std::vector<BlastHitPart> BlastHit::getBlastHitParts(bool reverse, double scaled
     else
     {
         if (reverse)
-            returnVector.push_back(BlastHitPart(m_query->getColour(), 1.0 - m_nodeStartFraction, 1.0 - m_nodeEndFraction));
+            returnVector.push_back(BlastHitPart(m_query->getColour(), 1.0 - nodeStartFraction, 1.0 - nodeEndFraction));
         else
-            returnVector.push_back(BlastHitPart(m_query->getColour(), m_nodeStartFraction, m_nodeEndFraction));
+            returnVector.push_back(BlastHitPart(m_query->getColour(), nodeStartFraction, nodeEndFraction));
     }
 
     return returnVector;
 }
 
 
-bool BlastHit::compareTwoBlastHitPointers(BlastHit * a, BlastHit * b)
+//This function gives the colour of a place in the query for the BLAST
+//rainbow colour scheme.
+QColor BlastHit::getRainbowColour(double queryFraction)
 {
-    return a->m_queryStart < b->m_queryStart;
+    QColor colour;
+    colour.setHsvF(queryFraction * 0.9, 1.0, 1.0);  //times 0.9 to keep the colour from getting too close to red, as that could confuse the end with the start
+    return colour;
 }
 
 
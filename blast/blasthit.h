@@ -29,6 +29,10 @@ class BlastQuery;
 #include "../graph/graphlocation.h"
 #include "../program/scinot.h"
 
+//Hits are kept as columns in a BlastHitStore, which makes one of these from
+//a hit's columns when the whole hit is needed (e.g. to draw it).  The
+//fractions of the node and query which the hit covers are worked out when
+//needed, not stored.
 class BlastHit
 {
 public:
@@ -52,17 +56,14 @@ public:
     SciNot m_eValue;
     double m_bitScore;
 
-    double m_nodeStartFraction;
-    double m_nodeEndFraction;
-    double m_queryStartFraction;
-    double m_queryEndFraction;
-
-    Path m_queryPath;
-
     std::vector<BlastHitPart> getBlastHitParts(bool reverse, double scaledNodeLength);
     bool onForwardStrand() {return m_queryStart < m_queryEnd;}
-    double getNodeCentreFraction() {return (m_nodeStartFraction + m_nodeEndFraction) / 2.0;}
-    static bool compareTwoBlastHitPointers(BlastHit * a, BlastHit * b);
+    double getNodeStartFraction() const;
+    double getNodeEndFraction() const;
+    double getQueryStartFraction() const;
+    double getQueryEndFraction() const;
+    double getNodeCentreFraction() {return (getNodeStartFraction() + getNodeEndFraction()) / 2.0;}
+    static QColor getRainbowColour(double queryFraction);
     double getQueryCoverageFraction();
     GraphLocation getHitStart() const;
     GraphLocation getHitEnd() const;
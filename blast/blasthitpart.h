@@ -21,16 +21,27 @@
 
 #include <QColor>
 
+//A part is either one colour, or (for a rainbow hit whose parts would be
+//smaller than a pixel) a rainbow gradient over the given range of the query,
+//drawn from the part's start to its end.
 class BlastHitPart
 {
 public:
     BlastHitPart() {}
     BlastHitPart(QColor colour, double nodeFractionStart, double nodeFractionEnd) :
-        m_colour(colour), m_nodeFractionStart(nodeFractionStart), m_nodeFractionEnd(nodeFractionEnd) {}
+        m_colour(colour), m_nodeFractionStart(nodeFractionStart), m_nodeFractionEnd(nodeFractionEnd),
+        m_rainbowGradient(false), m_queryFractionStart(0.0), m_queryFractionEnd(0.0) {}
+    BlastHitPart(double queryFractionStart, double queryFractionEnd,
+                 double nodeFractionStart, double nodeFractionEnd) :
+        m_nodeFractionStart(nodeFractionStart), m_nodeFractionEnd(nodeFractionEnd),
+        m_rainbowGradient(true), m_queryFractionStart(queryFractionStart), m_queryFractionEnd(queryFractionEnd) {}
 
     QColor m_colour;
     double m_nodeFractionStart;
     double m_nodeFractionEnd;
+    bool m_rainbowGradient;
+    double m_queryFractionStart;
+    double m_queryFractionEnd;
 };
 
 #endif // BLASTHITPART_H
@@ -0,0 +1,251 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "blasthitstore.h"
+
+#include "blastquery.h"
+#include "../graph/debruijnnode.h"
+#include "../program/settings.h"
+#include "../program/globals.h"
+
+BlastHitStore::BlastHitStore()
+{
+}
+
+
+//This function makes a whole hit from the hit's columns.
+BlastHit BlastHitStore::getHit(int hitId) const
+{
+    return BlastHit(getQuery(hitId), getNode(hitId),
+                    m_percentIdentities[hitId], m_alignmentLengths[hitId],
+                    m_numberMismatches[hitId], m_numberGapOpens[hitId],
+                    m_queryStarts[hitId], m_queryEnds[hitId],
+                    m_nodeStarts[hitId], m_nodeEnds[hitId],
+                    m_eValues[hitId], m_bitScores[hitId]);
+}
+
+
+double BlastHitStore::getQueryCoverageFraction(int hitId) const
+{
+    int queryRegionSize = m_queryEnds[hitId] - m_queryStarts[hitId] + 1;
+    int queryLength = m_queryLengths[m_queryIds[hitId]];
+
+    if (queryLength == 0)
+        return 0.0;
+    else
+        return double(queryRegionSize) / queryLength;
+}
+
+
+//This function checks a hit against the user-defined filters.  It only reads
+//the hit's columns (and the query lengths, which are kept by query ID).
+bool BlastHitStore::hitPassesFilters(int hitId) const
+{
+    if (g_settings->blastAlignmentLengthFilter.on &&
+            m_alignmentLengths[hitId] < g_settings->blastAlignmentLengthFilter)
+        return false;
+    if (g_settings->blastQueryCoverageFilter.on)
+    {
+        double hitCoveragePercentage = 100.0 * getQueryCoverageFraction(hitId);
+        if (hitCoveragePercentage < g_settings->blastQueryCoverageFilter)
+            return false;
+    }
+    if (g_settings->blastIdentityFilter.on &&
+            m_percentIdentities[hitId] < g_settings->blastIdentityFilter)
+        return false;
+    if (g_settings->blastEValueFilter.on &&
+            m_eValues[hitId] > g_settings->blastEValueFilter)
+        return false;
+    if (g_settings->blastBitScoreFilter.on &&
+            m_bitScores[hitId] < g_settings->blastBitScoreFilter)
+        return false;
+    return true;
+}
+
+
+//This function adds the hit's fields to the end of the columns and returns
+//the hit's ID.  The hit goes in the unfiltered order, and in the store's
+//order too if it passes the current filters.
+int BlastHitStore::add(const BlastHit & hit)
+{
+    int hitId = int(m_queryIds.size());
+    m_queryIds.push_back(getQueryIdForAdding(hit.m_query));
+    m_nodeIds.push_back(getNodeIdForAdding(hit.m_node));
+    m_percentIdentities.push_back(hit.m_percentIdentity);
+    m_alignmentLengths.push_back(hit.m_alignmentLength);
+    m_numberMismatches.push_back(hit.m_numberMismatches);
+    m_numberGapOpens.push_back(hit.m_numberGapOpens);
+    m_queryStarts.push_back(hit.m_queryStart);
+    m_queryEnds.push_back(hit.m_queryEnd);
+    m_nodeStarts.push_back(hit.m_nodeStart);
+    m_nodeEnds.push_back(hit.m_nodeEnd);
+    m_eValues.push_back(hit.m_eValue);
+    m_bitScores.push_back(hit.m_bitScore);
+
+    m_unfilteredHits.push_back(hitId);
+    if (hitPassesFilters(hitId))
+        m_hits.push_back(hitId);
+    return hitId;
+}
+
+
+int BlastHitStore::getQueryIdForAdding(BlastQuery * query)
+{
+    QHash<BlastQuery *, int>::const_iterator i = m_queryIdsByPointer.constFind(query);
+    if (i != m_queryIdsByPointer.constEnd())
+        return i.value();
+
+    int queryId = int(m_queries.size());
+    m_queries.push_back(query);
+    m_queryLengths.push_back(query->getLength());
+    m_queryIdsByPointer.insert(query, queryId);
+    return queryId;
+}
+
+int BlastHitStore::getNodeIdForAdding(DeBruijnNode * node)
+{
+    QHash<DeBruijnNode *, int>::const_iterator i = m_nodeIdsByPointer.constFind(node);
+    if (i != m_nodeIdsByPointer.constEnd())
+        return i.value();
+
+    int nodeId = int(m_nodes.size());
+    m_nodes.push_back(node);
+    m_nodeIdsByPointer.insert(node, nodeId);
+    return nodeId;
+}
+
+
+//This function remakes the order of passing hits from all of the hits, in a
+//single pass over their columns.
+void BlastHitStore::applyFilter()
+{
+    m_hits.clear();
+    m_hits.reserve(m_unfilteredHits.size());
+    for (size_t i = 0; i < m_unfilteredHits.size(); ++i)
+    {
+        if (hitPassesFilters(m_unfilteredHits[i]))
+            m_hits.push_back(m_unfilteredHits[i]);
+    }
+}
+
+
+//This function groups the hits of the shown queries by node, and gives each
+//node with hits its span of them (see getNodeHit).  The hits keep their
+//order within each node: by query, then as in each query's hit list.  The
+//nodes' old spans must be cleared before this is called.
+void BlastHitStore::setNodeHits(const std::vector<BlastQuery *> & shownQueries)
+{
+    std::vector<int> nodeHitStarts(m_nodes.size() + 1, 0);
+    for (size_t i = 0; i < shownQueries.size(); ++i)
+    {
+        QList<int> hitIds = shownQueries[i]->getHitIds();
+        for (int j = 0; j < hitIds.size(); ++j)
+            ++nodeHitStarts[m_nodeIds[hitIds[j]] + 1];
+    }
+    for (size_t i = 1; i < nodeHitStarts.size(); ++i)
+        nodeHitStarts[i] += nodeHitStarts[i - 1];
+
+    m_nodeHits.assign(nodeHitStarts.back(), 0);
+    std::vector<int> nextNodeHits(nodeHitStarts.begin(), nodeHitStarts.end() - 1);
+    for (size_t i = 0; i < shownQueries.size(); ++i)
+    {
+        QList<int> hitIds = shownQueries[i]->getHitIds();
+        for (int j = 0; j < hitIds.size(); ++j)
+            m_nodeHits[nextNodeHits[m_nodeIds[hitIds[j]]]++] = hitIds[j];
+    }
+
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        int hitCount = nodeHitStarts[i + 1] - nodeHitStarts[i];
+        if (hitCount > 0)
+            m_nodes[i]->setBlastHits(nodeHitStarts[i], hitCount);
+    }
+}
+
+
+//The queries' IDs aren't used again, so a new query at the same address
+//gets a new ID.  The nodes' spans still refer to the removed hits, so
+//setNodeHits must be called again afterwards.
+void BlastHitStore::removeHitsForQueries(const QSet<BlastQuery *> & queries)
+{
+    std::vector<bool> removedQueries(m_queries.size(), false);
+    for (size_t i = 0; i < m_queries.size(); ++i)
+    {
+        if (m_queries[i] != 0 && queries.contains(m_queries[i]))
+        {
+            removedQueries[i] = true;
+            m_queryIdsByPointer.remove(m_queries[i]);
+            m_queries[i] = 0;
+        }
+    }
+    removeHitsForQueries(removedQueries, &m_hits);
+    removeHitsForQueries(removedQueries, &m_unfilteredHits);
+}
+
+void BlastHitStore::removeHitsForQueries(const std::vector<bool> & removedQueries, std::vector<int> * hits) const
+{
+    std::vector<int> keptHits;
+    keptHits.reserve(hits->size());
+    for (size_t i = 0; i < hits->size(); ++i)
+    {
+        if (!removedQueries[m_queryIds[(*hits)[i]]])
+            keptHits.push_back((*hits)[i]);
+    }
+    hits->swap(keptHits);
+}
+
+
+void BlastHitStore::clear()
+{
+    m_queryIds.clear();
+    m_nodeIds.clear();
+    m_percentIdentities.clear();
+    m_alignmentLengths.clear();
+    m_numberMismatches.clear();
+    m_numberGapOpens.clear();
+    m_queryStarts.clear();
+    m_queryEnds.clear();
+    m_nodeStarts.clear();
+    m_nodeEnds.clear();
+    m_eValues.clear();
+    m_bitScores.clear();
+
+    m_queries.clear();
+    m_queryLengths.clear();
+    m_queryIdsByPointer.clear();
+    m_nodes.clear();
+    m_nodeIdsByPointer.clear();
+
+    m_hits.clear();
+    m_unfilteredHits.clear();
+    m_nodeHits.clear();
+}
+
+
+long long BlastHitStore::getMemoryUsed() const
+{
+    long long memory = (m_queryIds.capacity() + m_nodeIds.capacity() +
+                        m_alignmentLengths.capacity() + m_numberMismatches.capacity() +
+                        m_numberGapOpens.capacity() + m_queryStarts.capacity() +
+                        m_queryEnds.capacity() + m_nodeStarts.capacity() +
+                        m_nodeEnds.capacity()) * sizeof(int);
+    memory += (m_percentIdentities.capacity() + m_bitScores.capacity()) * sizeof(double);
+    memory += m_eValues.capacity() * sizeof(SciNot);
+    memory += (m_hits.capacity() + m_unfilteredHits.capacity() + m_nodeHits.capacity()) * sizeof(int);
+    return memory;
+}
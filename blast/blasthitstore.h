@@ -0,0 +1,119 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BLASTHITSTORE_H
+#define BLASTHITSTORE_H
+
+#include <vector>
+#include <QSet>
+#include <QHash>
+#include "blasthit.h"
+#include "../program/scinot.h"
+
+class BlastQuery;
+class DeBruijnNode;
+
+//This class holds all of the hits from a BLAST search as columns: each field
+//of the hits has its own array, and a hit is an integer ID which indexes all
+//of them.  So a search with millions of hits costs little more than the
+//fields themselves, and passes over all of the hits (filtering, sorting the
+//hits table) read only the columns they need, one after the other in memory.
+//A hit's query and node are kept as integer IDs too.  These index the store's
+//own tables of queries and nodes, made as hits are added, and stay the same
+//until the store is cleared.
+//Queries, query paths and nodes refer to hits by their IDs.  getHit makes a
+//BlastHit from a hit's columns for code which needs the whole hit.
+//Hits which fail the filters are kept too, so the filters can be changed
+//without searching again.  The store's order (size, getHitId) holds only the
+//hits which passed, and the unfiltered order holds them all.  Removing hits
+//only takes them out of these orders; their columns are freed when the store
+//is cleared.
+class BlastHitStore
+{
+public:
+    //CREATORS
+    BlastHitStore();
+
+    //ACCESSORS
+    int size() const {return int(m_hits.size());}
+    bool empty() const {return m_hits.empty();}
+    int getHitId(int index) const {return m_hits[index];}
+    int getUnfilteredCount() const {return int(m_unfilteredHits.size());}
+    int getUnfilteredHitId(int index) const {return m_unfilteredHits[index];}
+    BlastHit getHit(int hitId) const;
+    int getQueryId(int hitId) const {return m_queryIds[hitId];}
+    int getNodeId(int hitId) const {return m_nodeIds[hitId];}
+    BlastQuery * getQuery(int hitId) const {return m_queries[m_queryIds[hitId]];}
+    DeBruijnNode * getNode(int hitId) const {return m_nodes[m_nodeIds[hitId]];}
+    double getPercentIdentity(int hitId) const {return m_percentIdentities[hitId];}
+    int getAlignmentLength(int hitId) const {return m_alignmentLengths[hitId];}
+    int getNumberMismatches(int hitId) const {return m_numberMismatches[hitId];}
+    int getNumberGapOpens(int hitId) const {return m_numberGapOpens[hitId];}
+    int getQueryStart(int hitId) const {return m_queryStarts[hitId];}
+    int getQueryEnd(int hitId) const {return m_queryEnds[hitId];}
+    int getNodeStart(int hitId) const {return m_nodeStarts[hitId];}
+    int getNodeEnd(int hitId) const {return m_nodeEnds[hitId];}
+    SciNot getEValue(int hitId) const {return m_eValues[hitId];}
+    double getBitScore(int hitId) const {return m_bitScores[hitId];}
+    double getQueryCoverageFraction(int hitId) const;
+    bool hitPassesFilters(int hitId) const;
+    int getQueryCount() const {return int(m_queries.size());}
+    BlastQuery * getQueryFromId(int queryId) const {return m_queries[queryId];}
+    int findQueryId(BlastQuery * query) const {return m_queryIdsByPointer.value(query, -1);}
+    int getNodeCount() const {return int(m_nodes.size());}
+    DeBruijnNode * getNodeFromId(int nodeId) const {return m_nodes[nodeId];}
+    BlastHit getNodeHit(int index) const {return getHit(m_nodeHits[index]);}
+    long long getMemoryUsed() const;
+
+    //MODIFERS
+    int add(const BlastHit & hit);
+    void applyFilter();
+    void setNodeHits(const std::vector<BlastQuery *> & shownQueries);
+    void removeHitsForQueries(const QSet<BlastQuery *> & queries);
+    void clear();
+
+private:
+    std::vector<int> m_queryIds;
+    std::vector<int> m_nodeIds;
+    std::vector<double> m_percentIdentities;
+    std::vector<int> m_alignmentLengths;
+    std::vector<int> m_numberMismatches;
+    std::vector<int> m_numberGapOpens;
+    std::vector<int> m_queryStarts;
+    std::vector<int> m_queryEnds;
+    std::vector<int> m_nodeStarts;
+    std::vector<int> m_nodeEnds;
+    std::vector<SciNot> m_eValues;
+    std::vector<double> m_bitScores;
+
+    std::vector<BlastQuery *> m_queries;
+    std::vector<int> m_queryLengths;
+    QHash<BlastQuery *, int> m_queryIdsByPointer;
+    std::vector<DeBruijnNode *> m_nodes;
+    QHash<DeBruijnNode *, int> m_nodeIdsByPointer;
+
+    std::vector<int> m_hits;
+    std::vector<int> m_unfilteredHits;
+    std::vector<int> m_nodeHits;
+
+    int getQueryIdForAdding(BlastQuery * query);
+    int getNodeIdForAdding(DeBruijnNode * node);
+    void removeHitsForQueries(const std::vector<bool> & removedQueries, std::vector<int> * hits) const;
+};
+
+#endif // BLASTHITSTORE_H
@@ -21,7 +21,11 @@
 #include "../program/settings.h"
 #include <QTextStream>
 #include "blastsearch.h"
+#include "../graph/assemblygraph.h"
 #include "../program/memory.h"
+#include "querypathsearch.h"
+#include "../program/runjobs.h"
+#include <QSet>
 
 BlastQueries::BlastQueries() :
     m_tempNuclFile(0), m_tempProtFile(0)
@@ -44,12 +48,7 @@ void BlastQueries::createTempQueryFiles()
 
 BlastQuery * BlastQueries::getQueryFromName(QString queryName)
 {
-    for (size_t i = 0; i < m_queries.size(); ++i)
-    {
-        if (m_queries[i]->getName() == queryName)
-            return m_queries[i];
-    }
-    return 0;
+    return m_queriesByName.value(queryName, 0);
 }
 
 
@@ -63,6 +62,7 @@ void BlastQueries::addQuery(BlastQuery * newQuery)
     newQuery->setColour(m_presetColours[colourIndex]);
 
     m_queries.push_back(newQuery);
+    m_queriesByName.insert(newQuery->getName(), newQuery);
     updateTempFiles();
 }
 
@@ -72,7 +72,9 @@ void BlastQueries::addQuery(BlastQuery * newQuery)
 //wasn't unique.
 QString BlastQueries::renameQuery(BlastQuery * newQuery, QString newName)
 {
+    m_queriesByName.remove(newQuery->getName());
     newQuery->setName(getUniqueName(newName));
+    m_queriesByName.insert(newQuery->getName(), newQuery);
     updateTempFiles();
     return newQuery->getName();
 }
@@ -105,16 +107,29 @@ void BlastQueries::clearAllQueries()
     for (size_t i = 0; i < m_queries.size(); ++i)
         delete m_queries[i];
     m_queries.clear();
+    m_queriesByName.clear();
     deleteTempFiles();
 }
 
 void BlastQueries::clearSomeQueries(std::vector<BlastQuery *> queriesToRemove)
 {
+    QSet<BlastQuery *> removeSet;
     for (size_t i = 0; i < queriesToRemove.size(); ++i)
+        removeSet.insert(queriesToRemove[i]);
+
+    std::vector<BlastQuery *> keptQueries;
+    for (size_t i = 0; i < m_queries.size(); ++i)
     {
-        m_queries.erase(std::remove(m_queries.begin(), m_queries.end(), queriesToRemove[i]), m_queries.end());
-        delete queriesToRemove[i];
+        BlastQuery * query = m_queries[i];
+        if (removeSet.contains(query))
+        {
+            m_queriesByName.remove(query->getName());
+            delete query;
+        }
+        else
+            keptQueries.push_back(query);
     }
+    m_queries.swap(keptQueries);
 
     updateTempFiles();
 }
@@ -240,10 +255,41 @@ bool BlastQueries::isQueryPresent(BlastQuery * query)
 
 //This function looks at each BLAST query and tries to find a path through
 //the graph which covers the maximal amount of the query.
+//If more than one thread is to be used, the path searches for all queries
+//(one for each start/end hit pair) are put into a thread pool together, so
+//the threads stay busy even when a few queries have far more work than the
+//rest.  Once they are all done, each query's paths are filtered and sorted,
+//again in the thread pool.  Each query gathers its search results in the
+//order the searches were made, so the results are the same regardless of the
+//number of threads.
 void BlastQueries::findQueryPaths()
 {
-    for (size_t i = 0; i < m_queries.size(); ++i)
-        m_queries[i]->findQueryPaths();
+    findQueryPaths(m_queries);
+}
+
+void BlastQueries::findQueryPaths(const std::vector<BlastQuery *> & queries)
+{
+    int threads = g_settings->threads;
+    if (threads <= 1)
+    {
+        for (size_t i = 0; i < queries.size(); ++i)
+            queries[i]->findQueryPaths();
+        return;
+    }
+
+    //Making the query paths reads node sequences, and reading a missing one
+    //would load sequences into the graph, so that is done here first.
+    g_assemblyGraph->loadMissingSequencesFromFasta();
+
+    QList< QSharedPointer<QueryPathSearch> > searches;
+    for (size_t i = 0; i < queries.size(); ++i)
+        searches += queries[i]->prepareQueryPathSearches();
+    runJobs(searches, threads);
+
+    QList< QSharedPointer<QueryPathSearchFinisher> > finishers;
+    for (size_t i = 0; i < queries.size(); ++i)
+        finishers.push_back(QSharedPointer<QueryPathSearchFinisher>(new QueryPathSearchFinisher(queries[i])));
+    runJobs(finishers, threads);
 }
 
 
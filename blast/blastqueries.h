@@ -24,6 +24,7 @@
 #include <QFile>
 #include "../program/globals.h"
 #include <QSharedPointer>
+#include <QHash>
 
 //This class manages all BLAST queries. It holds BlastQuery
 //objects itself, and it creates/modifies/deletes the temp
@@ -31,6 +32,8 @@
 //There are two separate temp files, one for nucleotide
 //queries (for blastn) and one for protein queries (for
 //tblasn).
+//The queries are also hashed by name, so finding a query from a name (e.g.
+//for each line of BLAST output) doesn't need a search through all of them.
 
 class BlastQueries
 {
@@ -55,12 +58,14 @@ public:
     int getQueryCount(SequenceType sequenceType);
     bool isQueryPresent(BlastQuery * query);
     void findQueryPaths();
+    void findQueryPaths(const std::vector<BlastQuery *> & queries);
 
     std::vector<QColor> m_presetColours;
 
 private:
     QSharedPointer<QFile> m_tempNuclFile;
     QSharedPointer<QFile> m_tempProtFile;
+    QHash<QString, BlastQuery *> m_queriesByName;
 
     void deleteTempFiles();
     void updateTempFiles();
@@ -17,6 +17,7 @@
 
 
 #include "blastquery.h"
+#include "blastsearch.h"
 #include "../program/settings.h"
 #include "../graph/path.h"
 #include "../graph/debruijnnode.h"
@@ -79,6 +80,14 @@ QString BlastQuery::getTypeString() const
 }
 
 
+//This function makes the query's hit at the given place in its hit list from
+//the search's hit store.
+BlastHit BlastQuery::getHit(int index) const
+{
+    return g_blastSearch->m_allHits.getHit(m_hits[index]);
+}
+
+
 void BlastQuery::clearSearchResults()
 {
     m_searchedFor = false;
@@ -91,10 +100,23 @@ void BlastQuery::clearSearchResults()
 
 //This function tries to find the paths through the graph which cover the query.
 void BlastQuery::findQueryPaths()
+{
+    QList< QSharedPointer<QueryPathSearch> > searches = prepareQueryPathSearches();
+    for (int i = 0; i < searches.size(); ++i)
+        searches[i]->run();
+    finishQueryPathSearches();
+}
+
+
+//This function makes a path search for each pair of possible start and end
+//hits.  The searches are independent of each other, so they can be run in any
+//order (or at the same time) before finishQueryPathSearches is called.
+QList< QSharedPointer<QueryPathSearch> > BlastQuery::prepareQueryPathSearches()
 {
     m_paths = QList<BlastQueryPath>();
+    m_pathSearches.clear();
     if (m_hits.size() > g_settings->maxHitsForQueryPath)
-        return;
+        return m_pathSearches;
 
     int queryLength = m_sequence.length();
     if (m_sequenceType == PROTEIN)
@@ -102,43 +124,42 @@ void BlastQuery::findQueryPaths()
 
     //Find all possible path starts within an acceptable distance from the query
     //start.
-    QList<BlastHit *> possibleStarts;
+    std::vector<BlastHit> possibleStarts;
     double acceptableStartFraction = 1.0 - g_settings->minQueryCoveredByPath;
     for (int i = 0; i < m_hits.size(); ++i)
     {
-        BlastHit * hit = m_hits[i].data();
-        if (hit->m_queryStartFraction <= acceptableStartFraction)
+        BlastHit hit = getHit(i);
+        if (hit.getQueryStartFraction() <= acceptableStartFraction)
             possibleStarts.push_back(hit);
     }
 
     //Find all possible path ends.
-    QList<BlastHit *> possibleEnds;
+    std::vector<BlastHit> possibleEnds;
     double acceptableEndFraction = g_settings->minQueryCoveredByPath;
     for (int i = 0; i < m_hits.size(); ++i)
     {
-        BlastHit * hit = m_hits[i].data();
-        if (hit->m_queryEndFraction >= acceptableEndFraction)
+        BlastHit hit = getHit(i);
+        if (hit.getQueryEndFraction() >= acceptableEndFraction)
             possibleEnds.push_back(hit);
     }
 
-    //For each possible start, find paths to each possible end.
-    QList<Path> possiblePaths;
-    for (int i = 0; i < possibleStarts.size(); ++i)
+    //For each possible start, search for paths to each possible end.
+    for (size_t i = 0; i < possibleStarts.size(); ++i)
     {
-        BlastHit * start = possibleStarts[i];
-        GraphLocation startLocation = start->getHitStart();
+        const BlastHit & start = possibleStarts[i];
+        GraphLocation startLocation = start.getHitStart();
 
-        for (int j = 0; j < possibleEnds.size(); ++j)
+        for (size_t j = 0; j < possibleEnds.size(); ++j)
         {
-            BlastHit * end = possibleEnds[j];
-            GraphLocation endLocation = end->getHitEnd();
+            const BlastHit & end = possibleEnds[j];
+            GraphLocation endLocation = end.getHitEnd();
 
             //Assuming there is a path from the start hit to the end hit,
             //determine the ideal length.  This is the query length minus the
             //parts of the query not covered by the start and end.
             int partialQueryLength = queryLength;
-            int pathStart = start->m_queryStart - 1;
-            int pathEnd = end->m_queryEnd;
+            int pathStart = start.m_queryStart - 1;
+            int pathEnd = end.m_queryEnd;
             if (m_sequenceType == PROTEIN)
             {
                 pathStart *= 3;
@@ -168,14 +189,38 @@ void BlastQuery::findQueryPaths()
             else //neither are on
                 maxLength = std::numeric_limits<int>::max();
 
-            possiblePaths.append(Path::getAllPossiblePaths(startLocation,
-                                                           endLocation,
-                                                           g_settings->maxQueryPathNodes - 1,
-                                                           minLength,
-                                                           maxLength));
+            m_pathSearches.push_back(QSharedPointer<QueryPathSearch>(new QueryPathSearch(startLocation,
+                                                                                         endLocation,
+                                                                                         g_settings->maxQueryPathNodes - 1,
+                                                                                         minLength,
+                                                                                         maxLength)));
         }
     }
 
+    return m_pathSearches;
+}
+
+
+//This function gathers the paths from the finished searches (in the order the
+//searches were made, so the result doesn't depend on the order they ran in)
+//and turns them into the query's paths.
+void BlastQuery::finishQueryPathSearches()
+{
+    QList<Path> possiblePaths;
+    for (int i = 0; i < m_pathSearches.size(); ++i)
+        possiblePaths.append(m_pathSearches[i]->getPaths());
+    m_pathSearches.clear();
+
+    setPathsFromCandidates(possiblePaths);
+}
+
+
+//This function makes the query's paths from candidate paths, which come from
+//either the path searches or the built-in aligner.  Candidates which fail
+//the path settings, or which are sub-paths of others, are left out.
+void BlastQuery::setPathsFromCandidates(QList<Path> possiblePaths)
+{
+    m_paths = QList<BlastQueryPath>();
 
     //Now we use the Path objects to make BlastQueryPath objects.  These contain
     //BLAST-specific information that the Path class doesn't.
@@ -210,22 +255,13 @@ void BlastQuery::findQueryPaths()
 
     //We now want to throw out any paths which are sub-paths of other, larger
     //paths.
+    QList<Path> candidatePaths;
+    for (int i = 0; i < sufficientCoveragePaths.size(); ++i)
+        candidatePaths.push_back(sufficientCoveragePaths[i].getPath());
+    std::vector<bool> subPaths = Path::findPathsWithNodeSubsets(candidatePaths);
     for (int i = 0; i < sufficientCoveragePaths.size(); ++i)
     {
-        bool throwOut = false;
-        for (int j = 0; j < sufficientCoveragePaths.size(); ++j)
-        {
-            //No need to compare a path with itself.
-            if (i == j)
-                continue;
-
-            if (sufficientCoveragePaths[i].getPath().hasNodeSubset(sufficientCoveragePaths[j].getPath()))
-            {
-                throwOut = true;
-                break;
-            }
-        }
-        if (!throwOut)
+        if (!subPaths[i])
             m_paths.push_back(sufficientCoveragePaths[i]);
     }
 
@@ -239,25 +275,20 @@ void BlastQuery::findQueryPaths()
 //If a list of BLAST hits is passed to the function, it only looks in those
 //hits.  If no such list is passed, it looks in all hits for this query.
 // http://stackoverflow.com/questions/5276686/merging-ranges-in-c
-double BlastQuery::fractionCoveredByHits(const QList<BlastHit *> * hitsToCheck) const
+double BlastQuery::fractionCoveredByHits(const QList<int> * hitsToCheck) const
 {
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
     int hitBases = 0;
     int queryLength = getLength();
     if (queryLength == 0)
         return 0.0;
 
     std::vector<std::pair<int, int> > ranges;
-    if (hitsToCheck == 0) {
-        for (int i = 0; i < m_hits.size(); ++i) {
-            BlastHit * hit = m_hits[i].data();
-            ranges.push_back(std::pair<int,int>(hit->m_queryStart - 1, hit->m_queryEnd));
-        }
-    }
-    else {
-        for (int i = 0; i < hitsToCheck->size(); ++i) {
-            BlastHit * hit = (*hitsToCheck)[i];
-            ranges.push_back(std::pair<int,int>(hit->m_queryStart - 1, hit->m_queryEnd));
-        }
+    if (hitsToCheck == 0)
+        hitsToCheck = &m_hits;
+    for (int i = 0; i < hitsToCheck->size(); ++i) {
+        int hitId = (*hitsToCheck)[i];
+        ranges.push_back(std::pair<int,int>(hits.getQueryStart(hitId) - 1, hits.getQueryEnd(hitId)));
     }
 
     if (ranges.size() == 0)
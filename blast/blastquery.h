@@ -27,6 +27,7 @@
 #include <QList>
 #include <QSharedPointer>
 #include "blastquerypath.h"
+#include "querypathsearch.h"
 
 class BlastQuery : public QObject
 {
@@ -43,23 +44,28 @@ public:
     int getLength() const {return m_sequence.length();}
     bool hasHits() const {return m_hits.size() > 0;}
     int hitCount() const {return m_hits.size();}
-    QList< QSharedPointer<BlastHit> > getHits() const {return m_hits;}
+    QList<int> getHitIds() const {return m_hits;}
+    BlastHit getHit(int index) const;
     bool wasSearchedFor() const {return m_searchedFor;}
     QColor getColour() const {return m_colour;}
     SequenceType getSequenceType() const {return m_sequenceType;}
     QList<BlastQueryPath> getPaths() const {return m_paths;}
     int getPathCount() const {return m_paths.size();}
     QString getTypeString() const;
-    double fractionCoveredByHits(const QList<BlastHit *> * hitsToCheck = 0) const;
+    double fractionCoveredByHits(const QList<int> * hitsToCheck = 0) const;
     bool isShown() const {return m_shown;}
     bool isHidden() const {return !m_shown;}
 
     //MODIFIERS
     void setName(QString newName) {m_name = newName;}
-    void addHit(QSharedPointer<BlastHit> newHit) {m_hits.push_back(newHit);}
+    void addHit(int newHitId) {m_hits.push_back(newHitId);}
+    void setHits(QList<int> newHitIds) {m_hits = newHitIds;}
     void clearSearchResults();
     void setAsSearchedFor() {m_searchedFor = true;}
     void findQueryPaths();
+    QList< QSharedPointer<QueryPathSearch> > prepareQueryPathSearches();
+    void finishQueryPathSearches();
+    void setPathsFromCandidates(QList<Path> possiblePaths);
 
 public slots:
     void setColour(QColor newColour) {m_colour = newColour;}
@@ -68,16 +74,17 @@ public slots:
 private:
     QString m_name;
     QString m_sequence;
-    QList< QSharedPointer<BlastHit> > m_hits;
+    QList<int> m_hits;
     bool m_searchedFor;
     QColor m_colour;
     SequenceType m_sequenceType;
     QList<BlastQueryPath> m_paths;
+    QList< QSharedPointer<QueryPathSearch> > m_pathSearches;
     bool m_shown;
 
     void autoSetSequenceType();
     bool positionInAnyHit(int position) const;
-    bool positionInHitList(int position, const QList<BlastHit *> * hitsToCheck) const;
+    bool positionInHitList(int position, const QList<int> * hitsToCheck) const;
 };
 
 #endif // BLASTQUERY_H
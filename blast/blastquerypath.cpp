@@ -19,6 +19,7 @@
 #include "blastquerypath.h"
 
 #include "blastquery.h"
+#include "blastsearch.h"
 #include "../graph/debruijnnode.h"
 #include "../program/globals.h"
 #include "../graph/assemblygraph.h"
@@ -33,41 +34,42 @@ BlastQueryPath::BlastQueryPath(Path path, BlastQuery * query) :
     //query.  It requires that the hits occur in order, i.e. that each hit in
     //the path begins later in the query than the previous hit.
 
-    BlastHit * previousHit = 0;
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
+    int previousHitId = -1;
     QList<DeBruijnNode *> pathNodes = m_path.getNodes();
+    QList<int> queryHits = query->getHitIds();
     for (int i = 0; i < pathNodes.size(); ++i)
     {
         DeBruijnNode * node = pathNodes[i];
 
-        QList<BlastHit *> hitsThisNode;
-        QList< QSharedPointer<BlastHit> > queryHits = query->getHits();
+        QList<int> hitsThisNode;
         for (int j = 0; j < queryHits.size(); ++j)
         {
-            BlastHit * hit = queryHits[j].data();
-            if (hit->m_node->getName() == node->getName())
-                hitsThisNode.push_back(hit);
+            int hitId = queryHits[j];
+            if (hits.getNode(hitId)->getName() == node->getName())
+                hitsThisNode.push_back(hitId);
         }
 
         std::sort(hitsThisNode.begin(), hitsThisNode.end(),
-                  BlastHit::compareTwoBlastHitPointers);
+                  [&hits](int a, int b) {return hits.getQueryStart(a) < hits.getQueryStart(b);});
 
         for (int j = 0; j < hitsThisNode.size(); ++j)
         {
-            BlastHit * hit = hitsThisNode[j];
+            int hitId = hitsThisNode[j];
 
             //First check to make sure the hits are within the path.  This means
             //if we are in the first or last nodes of the path, we need to make
             //sure that our hit is contained within the start/end positions.
-            if ( (i != 0 || hit->m_nodeStart >= m_path.getStartLocation().getPosition()) &&
-                    (i != pathNodes.size()-1 || hit->m_nodeEnd <= m_path.getEndLocation().getPosition()))
+            if ( (i != 0 || hits.getNodeStart(hitId) >= m_path.getStartLocation().getPosition()) &&
+                    (i != pathNodes.size()-1 || hits.getNodeEnd(hitId) <= m_path.getEndLocation().getPosition()))
             {
                 //Now make sure that the hit follows the previous hit in the
                 //query.
-                if (previousHit == 0 ||
-                        hit->m_queryStart > previousHit->m_queryStart)
+                if (previousHitId == -1 ||
+                        hits.getQueryStart(hitId) > hits.getQueryStart(previousHitId))
                 {
-                    m_hits.push_back(hit);
-                    previousHit = hit;
+                    m_hits.push_back(hitId);
+                    previousHitId = hitId;
                 }
             }
         }
@@ -78,17 +80,26 @@ BlastQueryPath::BlastQueryPath(Path path, BlastQuery * query) :
 
 
 
+//This function makes the path's hit at the given place in its hit list from
+//the search's hit store.
+BlastHit BlastQueryPath::getHit(int index) const
+{
+    return g_blastSearch->m_allHits.getHit(m_hits[index]);
+}
+
+
 double BlastQueryPath::getMeanHitPercIdentity() const
 {
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
     int totalHitLength = 0;
     double sum = 0.0;
 
     for (int i = 0; i < m_hits.size(); ++i)
     {
-        int hitLength = m_hits[i]->m_alignmentLength;
+        int hitLength = hits.getAlignmentLength(m_hits[i]);
         totalHitLength += hitLength;
 
-        double hitIdentity = m_hits[i]->m_percentIdentity;
+        double hitIdentity = hits.getPercentIdentity(m_hits[i]);
         sum += hitIdentity * hitLength;
     }
 
@@ -112,23 +123,23 @@ SciNot BlastQueryPath::getEvalueProduct() const
 
     for (int i = 0; i < m_hits.size(); ++i)
     {
-        BlastHit * thisHit = m_hits[i];
-        SciNot thisHitEValue = thisHit->m_eValue;
+        BlastHit thisHit = getHit(i);
+        SciNot thisHitEValue = thisHit.m_eValue;
         double eValueLenToRemove = 0.0;
         if (i > 0) {
-            BlastHit * previousHit = m_hits[i-1];
+            BlastHit previousHit = getHit(i-1);
             int overlap = getHitOverlap(previousHit, thisHit);
             if (overlap > 0)
                 eValueLenToRemove += overlap / 2.0;
         }
         if (i < m_hits.size() - 1) {
-            BlastHit * nextHit = m_hits[i+1];
+            BlastHit nextHit = getHit(i+1);
             int overlap = getHitOverlap(thisHit, nextHit);
             if (overlap > 0)
                 eValueLenToRemove += overlap / 2.0;
         }
         if (eValueLenToRemove > 0.0) {
-            int thisHitLength = thisHit->getNodeLength();
+            int thisHitLength = thisHit.getNodeLength();
             double reduction = (thisHitLength - eValueLenToRemove) / thisHitLength;
             thisHitEValue.power(reduction);
         }
@@ -141,17 +152,17 @@ SciNot BlastQueryPath::getEvalueProduct() const
 }
 
 
-int BlastQueryPath::getHitOverlap(BlastHit * hit1, BlastHit * hit2) const
+int BlastQueryPath::getHitOverlap(const BlastHit & hit1, const BlastHit & hit2) const
 {
     int hit1Start, hit1End, hit2Start, hit2End;
-    QPair<DeBruijnNode *, DeBruijnNode *> possibleEdge(hit1->m_node, hit2->m_node);
+    QPair<DeBruijnNode *, DeBruijnNode *> possibleEdge(hit1.m_node, hit2.m_node);
 
     // Overlap in the same node is simple.
-    if (hit1->m_node == hit2->m_node) {
-        hit1Start = hit1->m_nodeStart - 1;
-        hit1End = hit1->m_nodeEnd;
-        hit2Start = hit2->m_nodeStart - 1;
-        hit2End = hit2->m_nodeEnd;
+    if (hit1.m_node == hit2.m_node) {
+        hit1Start = hit1.m_nodeStart - 1;
+        hit1End = hit1.m_nodeEnd;
+        hit2Start = hit2.m_nodeStart - 1;
+        hit2End = hit2.m_nodeEnd;
     }
 
     // Overlap in connected nodes is a bit more complex - we need to express
@@ -159,11 +170,11 @@ int BlastQueryPath::getHitOverlap(BlastHit * hit1, BlastHit * hit2) const
     else if (g_assemblyGraph->m_deBruijnGraphEdges.contains(possibleEdge)) {
         DeBruijnEdge * edge = g_assemblyGraph->m_deBruijnGraphEdges[possibleEdge];
         int overlap = edge->getOverlap();
-        hit1Start = hit1->m_nodeStart;
-        hit1End = hit1->m_nodeEnd;
-        int hit1NodeLen = hit1->m_node->getLength();
-        hit2Start = hit2->m_nodeStart + hit1NodeLen - overlap;
-        hit2End = hit2->m_nodeEnd + hit1NodeLen - overlap;
+        hit1Start = hit1.m_nodeStart;
+        hit1End = hit1.m_nodeEnd;
+        int hit1NodeLen = hit1.m_node->getLength();
+        hit2Start = hit2.m_nodeStart + hit1NodeLen - overlap;
+        hit2End = hit2.m_nodeEnd + hit1NodeLen - overlap;
     }
     else
         return 0;
@@ -229,8 +240,9 @@ double BlastQueryPath::getPathQueryCoverage() const
     if (m_hits.empty())
         return 0.0;
 
-    int queryStart = m_hits.front()->m_queryStart;
-    int queryEnd = m_hits.back()->m_queryEnd;
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
+    int queryStart = hits.getQueryStart(m_hits.front());
+    int queryEnd = hits.getQueryEnd(m_hits.back());
     int queryLength = m_query->getLength();
 
     int notIncluded = queryStart - 1;
@@ -253,8 +265,9 @@ double BlastQueryPath::getHitsQueryCoverage() const
 //sequence.
 int BlastQueryPath::getHitQueryLength() const
 {
-    int queryStart = m_hits.front()->m_queryStart;
-    int queryEnd = m_hits.back()->m_queryEnd;
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
+    int queryStart = hits.getQueryStart(m_hits.front());
+    int queryEnd = hits.getQueryEnd(m_hits.back());
     int hitQueryLength = queryEnd - queryStart + 1;
 
     if (m_query->getSequenceType() == PROTEIN)
@@ -267,17 +280,19 @@ int BlastQueryPath::getHitQueryLength() const
 
 int BlastQueryPath::getTotalHitMismatches() const
 {
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
     int total = 0;
     for (int i = 0; i < m_hits.size(); ++i)
-        total += m_hits[i]->m_numberMismatches;
+        total += hits.getNumberMismatches(m_hits[i]);
     return total;
 }
 
 int BlastQueryPath::getTotalHitGapOpens() const
 {
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
     int total = 0;
     for (int i = 0; i < m_hits.size(); ++i)
-        total += m_hits[i]->m_numberGapOpens;
+        total += hits.getNumberGapOpens(m_hits[i]);
     return total;
 }
 
@@ -35,7 +35,8 @@ public:
 
     //ACCESSORS
     Path getPath() const {return m_path;}
-    QList<BlastHit *> getHits() const {return m_hits;}
+    QList<int> getHitIds() const {return m_hits;}
+    BlastHit getHit(int index) const;
     SciNot getEvalueProduct() const;
     double getMeanHitPercIdentity() const;
     double getRelativeLengthDiscrepancy() const;
@@ -52,10 +53,10 @@ public:
 private:
     Path m_path;
     BlastQuery * m_query;
-    QList<BlastHit *> m_hits;
+    QList<int> m_hits;
 
     int getHitQueryLength() const;
-    int getHitOverlap(BlastHit * hit1, BlastHit * hit2) const;
+    int getHitOverlap(const BlastHit & hit1, const BlastHit & hit2) const;
 };
 
 #endif // BLASTQUERYPATH_H
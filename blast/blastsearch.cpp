@@ -26,7 +26,10 @@
 #include <QApplication>
 #include "../graph/debruijnnode.h"
 #include "../program/memory.h"
+#include "../graph/sequenceindex.h"
+#include "graphaligner.h"
 #include <math.h>
+#include <QSet>
 
 BlastSearch::BlastSearch() :
     m_blastQueries(), m_tempDirectory("bandage_temp/")
@@ -42,86 +45,231 @@ void BlastSearch::clearBlastHits()
 {
     m_allHits.clear();
     m_blastQueries.clearSearchResults();
-    m_blastOutput = "";
 }
 
 void BlastSearch::cleanUp()
 {
     clearBlastHits();
     m_blastQueries.clearAllQueries();
+    m_blastDatabase = "";
     emptyTempDirectory();
 }
 
-//This function uses the contents of m_blastOutput (the raw output from the
-//BLAST search) to construct the BlastHit objects.
-//It looks at the filters to possibly exclude hits which fail to meet user-
-//defined thresholds.
-void BlastSearch::buildHitsFromBlastOutput()
+//This function makes a hit from one line of BLAST's tabular output (outfmt 6).
+//It works directly on the bytes of the line, so the output never has to be
+//held as a whole or converted to a QString.  It returns false if the line
+//isn't a usable hit.  The filters aren't applied here: hits which fail them
+//are kept (see addHit) so the filters can be changed later.
+bool BlastSearch::makeHitFromBlastLine(const char * line, int length, BlastHit * hit)
 {
-    QStringList blastHitList = m_blastOutput.split("\n", Qt::SkipEmptyParts);
+    const char * fieldStarts[12];
+    const char * fieldEnds[12];
+    int fieldCount = 0;
+    const char * lineEnd = line + length;
+    const char * fieldStart = line;
+    for (const char * c = line; c <= lineEnd && fieldCount < 12; ++c)
+    {
+        if (c == lineEnd || *c == '\t' || *c == '\r')
+        {
+            fieldStarts[fieldCount] = fieldStart;
+            fieldEnds[fieldCount] = c;
+            ++fieldCount;
+            fieldStart = c + 1;
+        }
+    }
+    if (fieldCount < 12)
+        return false;
+
+    int nodeStart = parseBlastInt(fieldStarts[8], fieldEnds[8]);
+    int nodeEnd = parseBlastInt(fieldStarts[9], fieldEnds[9]);
+
+    //Only save BLAST hits that are on forward strands.
+    if (nodeStart > nodeEnd)
+        return false;
+
+    QString nodeLabel = QString::fromUtf8(fieldStarts[1], int(fieldEnds[1] - fieldStarts[1]));
+    QString nodeName = getNodeNameFromString(nodeLabel);
+    DeBruijnNode * node;
+    if (g_assemblyGraph->m_deBruijnGraphNodes.contains(nodeName))
+        node = g_assemblyGraph->m_deBruijnGraphNodes[nodeName];
+    else
+        return false;
+
+    QString queryName = QString::fromUtf8(fieldStarts[0], int(fieldEnds[0] - fieldStarts[0]));
+    BlastQuery * query = m_blastQueries.getQueryFromName(queryName);
+    if (query == 0)
+        return false;
+
+    double percentIdentity = parseBlastDouble(fieldStarts[2], fieldEnds[2]);
+    int alignmentLength = parseBlastInt(fieldStarts[3], fieldEnds[3]);
+    int numberMismatches = parseBlastInt(fieldStarts[4], fieldEnds[4]);
+    int numberGapOpens = parseBlastInt(fieldStarts[5], fieldEnds[5]);
+    int queryStart = parseBlastInt(fieldStarts[6], fieldEnds[6]);
+    int queryEnd = parseBlastInt(fieldStarts[7], fieldEnds[7]);
+    SciNot eValue(QString::fromLatin1(fieldStarts[10], int(fieldEnds[10] - fieldStarts[10])));
+    double bitScore = parseBlastDouble(fieldStarts[11], fieldEnds[11]);
+
+    *hit = BlastHit(query, node, percentIdentity, alignmentLength,
+                    numberMismatches, numberGapOpens, queryStart, queryEnd,
+                    nodeStart, nodeEnd, eValue, bitScore);
+    return true;
+}
+
+
+int BlastSearch::parseBlastInt(const char * start, const char * end)
+{
+    bool negative = (start < end && *start == '-');
+    if (negative)
+        ++start;
+    int value = 0;
+    for (const char * c = start; c < end && *c >= '0' && *c <= '9'; ++c)
+        value = value * 10 + (*c - '0');
+    return negative ? -value : value;
+}
+
+
+//BLAST always writes decimals with a point, so this uses QByteArray's
+//conversion, which ignores the locale (unlike strtod).
+double BlastSearch::parseBlastDouble(const char * start, const char * end)
+{
+    return QByteArray::fromRawData(start, int(end - start)).toDouble();
+}
+
+
+//This function puts the hit in the store of all hits and, if it meets the
+//user-defined filter thresholds, gives it to its query.  It returns the
+//hit's ID in the store.
+int BlastSearch::addHit(const BlastHit & hit)
+{
+    int hitId = m_allHits.add(hit);
+    if (m_allHits.hitPassesFilters(hitId))
+        hit.m_query->addHit(hitId);
+    return hitId;
+}
+
+
+//This function applies the current filters to all of the hits from the last
+//search, without searching again.  Only the queries whose hits change have
+//their paths searched for again.  Afterwards, blastQueryChanged must be
+//called to update the nodes' hits.
+void BlastSearch::applyHitFilters()
+{
+    m_allHits.applyFilter();
 
-    for (int i = 0; i < blastHitList.size(); ++i)
+    std::vector< QList<int> > queryHits(m_allHits.getQueryCount());
+    for (int i = 0; i < m_allHits.size(); ++i)
     {
-        QString hitString = blastHitList[i];
-        QStringList alignmentParts = hitString.split('\t');
+        int hitId = m_allHits.getHitId(i);
+        queryHits[m_allHits.getQueryId(hitId)].push_back(hitId);
+    }
 
-        if (alignmentParts.size() < 12)
+    std::vector<BlastQuery *> changedQueries;
+    for (size_t i = 0; i < m_blastQueries.m_queries.size(); ++i)
+    {
+        BlastQuery * query = m_blastQueries.m_queries[i];
+        int queryId = m_allHits.findQueryId(query);
+        QList<int> hits;
+        if (queryId >= 0)
+            hits = queryHits[queryId];
+        if (hits == query->getHitIds())
             continue;
+        query->setHits(hits);
+        changedQueries.push_back(query);
+    }
+    m_blastQueries.findQueryPaths(changedQueries);
+}
 
-        QString queryName = alignmentParts[0];
-        QString nodeLabel = alignmentParts[1];
-        double percentIdentity = alignmentParts[2].toDouble();
-        int alignmentLength = alignmentParts[3].toInt();
-        int numberMismatches = alignmentParts[4].toInt();
-        int numberGapOpens = alignmentParts[5].toInt();
-        int queryStart = alignmentParts[6].toInt();
-        int queryEnd = alignmentParts[7].toInt();
-        int nodeStart = alignmentParts[8].toInt();
-        int nodeEnd = alignmentParts[9].toInt();
-        SciNot eValue(alignmentParts[10]);
-        double bitScore = alignmentParts[11].toDouble();
-
-        //Only save BLAST hits that are on forward strands.
-        if (nodeStart > nodeEnd)
-            continue;
 
-        QString nodeName = getNodeNameFromString(nodeLabel);
-        DeBruijnNode * node;
-        if (g_assemblyGraph->m_deBruijnGraphNodes.contains(nodeName))
-            node = g_assemblyGraph->m_deBruijnGraphNodes[nodeName];
-        else
-            continue;
+//This function builds the graph's indexes which the built-in aligner needs
+//for the current queries: the sequence index, and the translated index if
+//there are protein queries.  They belong to the graph, so in the GUI this is
+//done on the main thread before the search's thread starts.
+void BlastSearch::buildGraphAlignerIndexes()
+{
+    g_assemblyGraph->getSequenceIndex();
+    if (m_blastQueries.getQueryCount(PROTEIN) > 0)
+        g_assemblyGraph->getTranslatedIndex();
+}
 
-        BlastQuery * query = g_blastSearch->m_blastQueries.getQueryFromName(queryName);
-        if (query == 0)
-            continue;
 
-        QSharedPointer<BlastHit> hit(new BlastHit(query, node, percentIdentity, alignmentLength,
-                                                  numberMismatches, numberGapOpens, queryStart, queryEnd,
-                                                  nodeStart, nodeEnd, eValue, bitScore));
+//This function searches for the queries with the built-in aligner instead
+//of BLAST.  Its alignments become BLAST hits, and its chains of alignments
+//through edges become the candidate query paths, so the path search isn't
+//needed.  Protein queries are aligned to the graph's six-frame translation.
+//On the command line, the graph's indexes are built here when first needed.
+void BlastSearch::runGraphAligner()
+{
+    std::vector<BlastQuery *> queries;
+    std::vector<QByteArray> sequences;
+    std::vector<bool> proteinQueries;
+    bool anyProteinQueries = false;
+    for (size_t i = 0; i < m_blastQueries.m_queries.size(); ++i)
+    {
+        BlastQuery * query = m_blastQueries.m_queries[i];
+        bool protein = (query->getSequenceType() == PROTEIN);
+        queries.push_back(query);
+        sequences.push_back(query->getSequence().toLatin1());
+        proteinQueries.push_back(protein);
+        anyProteinQueries = anyProteinQueries || protein;
+    }
+    if (queries.empty())
+        return;
+
+    const SequenceIndex * index = g_assemblyGraph->getSequenceIndex();
+    const TranslatedIndex * translatedIndex = 0;
+    if (anyProteinQueries)
+        translatedIndex = g_assemblyGraph->getTranslatedIndex();
+    GraphAligner aligner(index, translatedIndex);
+    std::vector<GraphAlignmentResult> results = aligner.alignQueries(sequences, proteinQueries,
+                                                                     g_settings->threads,
+                                                                     &m_cancelRunBlastSearch);
+    if (m_cancelRunBlastSearch)
+        return;
 
-        //Check the user-defined filters.
-        if (g_settings->blastAlignmentLengthFilter.on &&
-                alignmentLength < g_settings->blastAlignmentLengthFilter)
-            continue;
-        if (g_settings->blastQueryCoverageFilter.on)
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        BlastQuery * query = queries[i];
+        const GraphAlignmentResult & result = results[i];
+
+        //Each alignment's hit ID is remembered (or -1 if it was filtered
+        //out) so the chains can be made into paths.
+        std::vector<int> alignmentHits(result.alignments.size(), -1);
+        for (size_t j = 0; j < result.alignments.size(); ++j)
         {
-            double hitCoveragePercentage = 100.0 * hit->getQueryCoverageFraction();
-            if (hitCoveragePercentage < g_settings->blastQueryCoverageFilter)
-                continue;
+            const NodeAlignment & alignment = result.alignments[j];
+            double percentIdentity = 100.0 * alignment.matches / alignment.alignmentLength;
+            BlastHit hit(query, index->getNode(alignment.node), percentIdentity,
+                         alignment.alignmentLength, alignment.mismatches,
+                         alignment.gapOpens, alignment.queryStart, alignment.queryEnd,
+                         alignment.nodeStart, alignment.nodeEnd,
+                         alignment.eValue, alignment.bitScore);
+            int hitId = addHit(hit);
+            if (m_allHits.hitPassesFilters(hitId))
+                alignmentHits[j] = hitId;
         }
-        if (g_settings->blastIdentityFilter.on &&
-                percentIdentity < g_settings->blastIdentityFilter)
-            continue;
-        if (g_settings->blastEValueFilter.on &&
-                eValue > g_settings->blastEValueFilter)
-                continue;
-        if (g_settings->blastBitScoreFilter.on &&
-                bitScore < g_settings->blastBitScoreFilter)
-            continue;
 
-        m_allHits.push_back(hit);
-        query->addHit(hit);
+        QList<Path> possiblePaths;
+        if (query->hitCount() <= g_settings->maxHitsForQueryPath)
+        {
+            for (size_t j = 0; j < result.chains.size(); ++j)
+            {
+                const std::vector<int> & chain = result.chains[j];
+                if (int(chain.size()) > g_settings->maxQueryPathNodes)
+                    continue;
+
+                QList<DeBruijnNode *> pathNodes;
+                for (size_t k = 0; k < chain.size() && alignmentHits[chain[k]] != -1; ++k)
+                    pathNodes.push_back(m_allHits.getNode(alignmentHits[chain[k]]));
+                if (pathNodes.size() < int(chain.size()))
+                    continue;
+
+                Path path = Path::makeFromOrderedNodes(pathNodes, m_allHits.getHit(alignmentHits[chain.front()]).getHitStart(),
+                                                       m_allHits.getHit(alignmentHits[chain.back()]).getHitEnd());
+                if (!path.isEmpty())
+                    possiblePaths.push_back(path);
+            }
+        }
+        query->setPathsFromCandidates(possiblePaths);
     }
 }
 
@@ -222,16 +370,10 @@ bool BlastSearch::findProgram(QString programName, QString * command)
 void BlastSearch::clearSomeQueries(std::vector<BlastQuery *> queriesToRemove)
 {
     //Remove any hits that are for queries that will be deleted.
-    QList< QSharedPointer<BlastHit> >::iterator i = m_allHits.begin();
-    while (i != m_allHits.end())
-    {
-        BlastQuery * hitQuery = (*i)->m_query;
-        bool hitIsForDeletedQuery = (std::find(queriesToRemove.begin(), queriesToRemove.end(), hitQuery) != queriesToRemove.end());
-        if (hitIsForDeletedQuery)
-            i = m_allHits.erase(i);
-        else
-            ++i;
-    }
+    QSet<BlastQuery *> removeSet;
+    for (size_t i = 0; i < queriesToRemove.size(); ++i)
+        removeSet.insert(queriesToRemove[i]);
+    m_allHits.removeHitsForQueries(removeSet);
 
     //Now actually delete the queries.
     m_blastQueries.clearSomeQueries(queriesToRemove);
@@ -258,26 +400,48 @@ void BlastSearch::emptyTempDirectory()
 //This function carries out the entire BLAST search procedure automatically, without user input.
 //It returns an error string which is empty if all goes well.
 QString BlastSearch::doAutoBlastSearch()
+{
+    std::vector<QString> queryNames;
+    std::vector<QByteArray> querySequences;
+    AssemblyGraph::readFastaOrFastqFile(g_settings->blastQueryFilename, &queryNames, &querySequences);
+    return doAutoBlastSearch(queryNames, querySequences);
+}
+
+
+//This version takes queries which have already been read from their file, so
+//the same queries can be searched for in many graphs but only read once.
+QString BlastSearch::doAutoBlastSearch(const std::vector<QString> & queryNames,
+                                       const std::vector<QByteArray> & querySequences)
 {
     cleanUp();
 
+    //The built-in aligner needs neither a BLAST database nor the BLAST
+    //programs.
+    bool builtInAligner = (g_settings->blastAligner == BUILT_IN_ALIGNER);
+
     QString makeblastdbCommand;
-    if (!findProgram("makeblastdb", &makeblastdbCommand))
-        return "Error: The program makeblastdb was not found.  Please install NCBI BLAST to use this feature.";
+    if (!builtInAligner)
+    {
+        if (!findProgram("makeblastdb", &makeblastdbCommand))
+            return "Error: The program makeblastdb was not found.  Please install NCBI BLAST to use this feature.";
 
-    BuildBlastDatabaseWorker buildBlastDatabaseWorker(makeblastdbCommand);
-    buildBlastDatabaseWorker.buildBlastDatabase();
-    if (buildBlastDatabaseWorker.m_error != "")
-        return buildBlastDatabaseWorker.m_error;
+        BuildBlastDatabaseWorker buildBlastDatabaseWorker(makeblastdbCommand);
+        buildBlastDatabaseWorker.buildBlastDatabase();
+        if (buildBlastDatabaseWorker.m_error != "")
+            return buildBlastDatabaseWorker.m_error;
+    }
 
-    loadBlastQueriesFromFastaFile(g_settings->blastQueryFilename);
+    addBlastQueries(queryNames, querySequences);
 
     QString blastnCommand;
-    if (!findProgram("blastn", &blastnCommand))
-        return "Error: The program blastn was not found.  Please install NCBI BLAST to use this feature.";
     QString tblastnCommand;
-    if (!findProgram("tblastn", &tblastnCommand))
-        return "Error: The program tblastn was not found.  Please install NCBI BLAST to use this feature.";
+    if (!builtInAligner)
+    {
+        if (!findProgram("blastn", &blastnCommand))
+            return "Error: The program blastn was not found.  Please install NCBI BLAST to use this feature.";
+        if (!findProgram("tblastn", &tblastnCommand))
+            return "Error: The program tblastn was not found.  Please install NCBI BLAST to use this feature.";
+    }
 
     RunBlastSearchWorker runBlastSearchWorker(blastnCommand, tblastnCommand, g_settings->blastSearchParameters);
     runBlastSearchWorker.runBlastSearch();
@@ -298,7 +462,16 @@ int BlastSearch::loadBlastQueriesFromFastaFile(QString fullFileName)
     std::vector<QString> queryNames;
     std::vector<QByteArray> querySequences;
     AssemblyGraph::readFastaOrFastqFile(fullFileName, &queryNames, &querySequences);
+    addBlastQueries(queryNames, querySequences);
+
+    int queriesAfter = int(g_blastSearch->m_blastQueries.m_queries.size());
+    return queriesAfter - queriesBefore;
+}
 
+
+void BlastSearch::addBlastQueries(const std::vector<QString> & queryNames,
+                                  const std::vector<QByteArray> & querySequences)
+{
     for (size_t i = 0; i < queryNames.size(); ++i)
     {
         QApplication::processEvents();
@@ -312,9 +485,6 @@ int BlastSearch::loadBlastQueriesFromFastaFile(QString fullFileName)
         g_blastSearch->m_blastQueries.addQuery(new BlastQuery(queryName,
                                                               querySequences[i]));
     }
-
-    int queriesAfter = int(g_blastSearch->m_blastQueries.m_queries.size());
-    return queriesAfter - queriesBefore;
 }
 
 
@@ -360,16 +530,7 @@ void BlastSearch::blastQueryChanged(QString queryName)
             shownQueries.push_back(query);
     }
 
-    //Add the blast hit pointers to nodes that have a hit for
-    //the selected target(s).
-    for (size_t i = 0; i < shownQueries.size(); ++i)
-    {
-        BlastQuery * query = shownQueries[i];
-        for (int j = 0; j < g_blastSearch->m_allHits.size(); ++j)
-        {
-            BlastHit * hit = g_blastSearch->m_allHits[j].data();
-            if (hit->m_query == query)
-                hit->m_node->addBlastHit(hit);
-        }
-    }
+    //Give the nodes that have a hit for the selected target(s) their spans
+    //of those hits.
+    m_allHits.setNodeHits(shownQueries);
 }
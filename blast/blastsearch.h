@@ -21,6 +21,7 @@
 
 #include "blasthit.h"
 #include "blastqueries.h"
+#include "blasthitstore.h"
 #include <vector>
 #include <QString>
 #include <QList>
@@ -38,24 +39,33 @@ public:
     ~BlastSearch();
 
     BlastQueries m_blastQueries;
-    QString m_blastOutput;
     bool m_cancelBuildBlastDatabase;
     bool m_cancelRunBlastSearch;
     QProcess * m_makeblastdb;
-    QProcess * m_blast;
     QString m_tempDirectory;
-    QList< QSharedPointer<BlastHit> > m_allHits;
+    QString m_blastDatabase;
+    BlastHitStore m_allHits;
 
     void clearBlastHits();
     void cleanUp();
-    void buildHitsFromBlastOutput();
+    bool makeHitFromBlastLine(const char * line, int length, BlastHit * hit);
+    int addHit(const BlastHit & hit);
+    void applyHitFilters();
     void findQueryPaths();
+    void buildGraphAlignerIndexes();
+    void runGraphAligner();
     static QString getNodeNameFromString(QString nodeString);
+    static int parseBlastInt(const char * start, const char * end);
+    static double parseBlastDouble(const char * start, const char * end);
     bool findProgram(QString programName, QString * command);
     void clearSomeQueries(std::vector<BlastQuery *> queriesToRemove);
     void emptyTempDirectory();
     QString doAutoBlastSearch();
+    QString doAutoBlastSearch(const std::vector<QString> & queryNames,
+                              const std::vector<QByteArray> & querySequences);
     int loadBlastQueriesFromFastaFile(QString fullFileName);
+    void addBlastQueries(const std::vector<QString> & queryNames,
+                         const std::vector<QByteArray> & querySequences);
     QString cleanQueryName(QString queryName);
     void blastQueryChanged(QString queryName);
 };
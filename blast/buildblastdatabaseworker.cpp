@@ -22,6 +22,9 @@
 #include "../program/settings.h"
 #include <QFile>
 #include <QTextStream>
+#include <QDir>
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QMapIterator>
 #include "../graph/debruijnnode.h"
 #include "../graph/assemblygraph.h"
@@ -32,28 +35,14 @@ BuildBlastDatabaseWorker::BuildBlastDatabaseWorker(QString makeblastdbCommand) :
 {
 }
 
+//If a database cache directory is set, the database is looked for there
+//first, under a hash of the graph's node names and sequences.  Otherwise, or
+//if it isn't there, it is built.  Either way, g_blastSearch->m_blastDatabase
+//is set to the database which the BLAST search should use.
 void BuildBlastDatabaseWorker::buildBlastDatabase()
 {
     g_blastSearch->m_cancelBuildBlastDatabase = false;
-
-    QFile file(g_blastSearch->m_tempDirectory + "all_nodes.fasta");
-    file.open(QIODevice::WriteOnly | QIODevice::Text);
-    QTextStream out(&file);
-
-    QMapIterator<QString, DeBruijnNode*> i(g_assemblyGraph->m_deBruijnGraphNodes);
-    while (i.hasNext())
-    {
-        if (g_blastSearch->m_cancelBuildBlastDatabase)
-        {
-            emit finishedBuild("Build cancelled.");
-            return;
-        }
-
-        i.next();
-        DeBruijnNode * node = i.value();
-        out << node->getFasta(true, false, false);
-    }
-    file.close();
+    g_blastSearch->m_blastDatabase = "";
 
     // Make sure the graph has sequences to BLAST.
     bool atLeastOneSequence = false;
@@ -75,7 +64,141 @@ void BuildBlastDatabaseWorker::buildBlastDatabase()
         return;
     }
 
-    QStringList makeblastdbArguments = { "-in", g_blastSearch->m_tempDirectory + "all_nodes.fasta", "-dbtype", "nucl" };
+    if (g_settings->blastDatabaseCacheDirectory == "")
+    {
+        QString fastaFilename = g_blastSearch->m_tempDirectory + "all_nodes.fasta";
+        if (writeNodesFasta(fastaFilename))
+            runMakeblastdb(fastaFilename);
+        if (m_error == "")
+            g_blastSearch->m_blastDatabase = fastaFilename;
+        emit finishedBuild(m_error);
+        return;
+    }
+
+    QString graphHash = getGraphHash();
+    if (g_blastSearch->m_cancelBuildBlastDatabase)
+    {
+        m_error = "Build cancelled.";
+        emit finishedBuild(m_error);
+        return;
+    }
+
+    QDir cacheDirectory(g_settings->blastDatabaseCacheDirectory);
+    if (!cacheDirectory.exists() && !QDir().mkpath(cacheDirectory.absolutePath()))
+    {
+        m_error = "Could not create the BLAST database cache directory: " + g_settings->blastDatabaseCacheDirectory;
+        emit finishedBuild(m_error);
+        return;
+    }
+    QString cachedDatabaseDirectory = cacheDirectory.absoluteFilePath(graphHash) + "/";
+
+    //A cached database is only used once it is complete, which the marker
+    //file shows.
+    if (!QFile(cachedDatabaseDirectory + "complete").exists())
+    {
+        //The database is built in a directory of its own and then renamed
+        //into place, so another Bandage process building the same database at
+        //the same time can't see (or clobber) a partial one.
+        QString buildDirectory = cacheDirectory.absoluteFilePath(graphHash + ".building-" +
+                                                                 QString::number(QCoreApplication::applicationPid())) + "/";
+        QDir(buildDirectory).removeRecursively();
+        QDir().mkpath(buildDirectory);
+
+        QString fastaFilename = buildDirectory + "all_nodes.fasta";
+        if (writeNodesFasta(fastaFilename))
+            runMakeblastdb(fastaFilename);
+
+        //The FASTA file isn't needed to search the database, so it isn't
+        //kept in the cache.
+        QFile::remove(fastaFilename);
+        if (m_error == "")
+        {
+            QFile completeFile(buildDirectory + "complete");
+            completeFile.open(QIODevice::WriteOnly);
+            completeFile.close();
+        }
+
+        //If another process finished the same database first, its copy is
+        //used and ours is thrown away.
+        if (m_error != "" || !QDir().rename(buildDirectory, cachedDatabaseDirectory))
+            QDir(buildDirectory).removeRecursively();
+        if (m_error != "")
+        {
+            emit finishedBuild(m_error);
+            return;
+        }
+        if (!QFile(cachedDatabaseDirectory + "complete").exists())
+        {
+            m_error = "Could not save the BLAST database in the cache directory: " + g_settings->blastDatabaseCacheDirectory;
+            emit finishedBuild(m_error);
+            return;
+        }
+    }
+
+    m_error = "";
+    g_blastSearch->m_blastDatabase = cachedDatabaseDirectory + "all_nodes.fasta";
+    emit finishedBuild(m_error);
+}
+
+
+//This function returns a hash of the graph's node names and sequences, which
+//are all that a BLAST database of the graph depends on.
+QString BuildBlastDatabaseWorker::getGraphHash()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QMapIterator<QString, DeBruijnNode*> i(g_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        if (g_blastSearch->m_cancelBuildBlastDatabase)
+            return "";
+
+        i.next();
+        DeBruijnNode * node = i.value();
+        hash.addData(node->getName().toUtf8());
+        hash.addData("\n", 1);
+        hash.addData(node->getSequence());
+        hash.addData("\n", 1);
+    }
+    return hash.result().toHex();
+}
+
+
+//This function writes both strands of every node to a FASTA file for
+//makeblastdb.  It returns false (with m_error set) if the build is
+//cancelled.
+bool BuildBlastDatabaseWorker::writeNodesFasta(QString fastaFilename)
+{
+    QFile file(fastaFilename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        m_error = "Could not write the BLAST database FASTA file: " + fastaFilename;
+        return false;
+    }
+    QTextStream out(&file);
+
+    QMapIterator<QString, DeBruijnNode*> i(g_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        if (g_blastSearch->m_cancelBuildBlastDatabase)
+        {
+            m_error = "Build cancelled.";
+            return false;
+        }
+
+        i.next();
+        DeBruijnNode * node = i.value();
+        out << node->getFasta(true, false, false);
+    }
+    file.close();
+    return true;
+}
+
+
+//This function runs makeblastdb on the FASTA file, making the database files
+//next to it.  m_error is set if it doesn't succeed.
+void BuildBlastDatabaseWorker::runMakeblastdb(QString fastaFilename)
+{
+    QStringList makeblastdbArguments = { "-in", fastaFilename, "-dbtype", "nucl" };
     g_blastSearch->m_makeblastdb = new QProcess();
     g_blastSearch->m_makeblastdb->start(m_makeblastdbCommand, makeblastdbArguments);
 
@@ -95,8 +218,6 @@ void BuildBlastDatabaseWorker::buildBlastDatabase()
     else
         m_error = "";
 
-    emit finishedBuild(m_error);
-
     g_blastSearch->m_makeblastdb->deleteLater();
     g_blastSearch->m_makeblastdb = 0;
 }
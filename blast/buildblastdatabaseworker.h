@@ -26,6 +26,9 @@
 //the graph's nodes.
 //It is a separate class because when run from the GUI, this
 //process takes place in a separate thread.
+//If a database cache directory is set, finished databases are kept there
+//under a hash of the graph's node names and sequences, so a graph which has
+//been searched before doesn't need its database built again.
 
 class BuildBlastDatabaseWorker : public QObject
 {
@@ -38,6 +41,10 @@ public:
 private:
     QString m_makeblastdbCommand;
 
+    QString getGraphHash();
+    bool writeNodesFasta(QString fastaFilename);
+    void runMakeblastdb(QString fastaFilename);
+
 public slots:
     void buildBlastDatabase();
 
@@ -0,0 +1,781 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "graphaligner.h"
+#include "../graph/sequenceindex.h"
+#include "../graph/translatedindex.h"
+#include "../program/runjobs.h"
+#include <QList>
+#include <QSharedPointer>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+
+//These are blastn's default scores, along with the Karlin-Altschul
+//parameters it uses for them.
+static const int MATCH_SCORE = 2;
+static const int MISMATCH_PENALTY = 3;
+static const int GAP_OPEN_PENALTY = 5;
+static const int GAP_EXTEND_PENALTY = 2;
+static const double KARLIN_LAMBDA = 0.625;
+static const double KARLIN_K = 0.41;
+
+//An extension stops once its score falls this far below the best so far.
+static const int X_DROP = 30;
+
+//These are tblastn's defaults: BLOSUM62 with its gap penalties, the
+//Karlin-Altschul parameters for them and a gapped X-drop of 15 bits.
+static const int PROTEIN_GAP_OPEN_PENALTY = 11;
+static const int PROTEIN_GAP_EXTEND_PENALTY = 1;
+static const double PROTEIN_KARLIN_LAMBDA = 0.267;
+static const double PROTEIN_KARLIN_K = 0.041;
+static const int PROTEIN_X_DROP = 38;
+
+static const char BLOSUM62_AMINO_ACIDS[] = "ARNDCQEGHILKMFPSTWYVBZX*";
+static const signed char BLOSUM62[24][24] = {
+    { 4,-1,-2,-2, 0,-1,-1, 0,-2,-1,-1,-1,-1,-2,-1, 1, 0,-3,-2, 0,-2,-1, 0,-4},
+    {-1, 5, 0,-2,-3, 1, 0,-2, 0,-3,-2, 2,-1,-3,-2,-1,-1,-3,-2,-3,-1, 0,-1,-4},
+    {-2, 0, 6, 1,-3, 0, 0, 0, 1,-3,-3, 0,-2,-3,-2, 1, 0,-4,-2,-3, 3, 0,-1,-4},
+    {-2,-2, 1, 6,-3, 0, 2,-1,-1,-3,-4,-1,-3,-3,-1, 0,-1,-4,-3,-3, 4, 1,-1,-4},
+    { 0,-3,-3,-3, 9,-3,-4,-3,-3,-1,-1,-3,-1,-2,-3,-1,-1,-2,-2,-1,-3,-3,-2,-4},
+    {-1, 1, 0, 0,-3, 5, 2,-2, 0,-3,-2, 1, 0,-3,-1, 0,-1,-2,-1,-2, 0, 3,-1,-4},
+    {-1, 0, 0, 2,-4, 2, 5,-2, 0,-3,-3, 1,-2,-3,-1, 0,-1,-3,-2,-2, 1, 4,-1,-4},
+    { 0,-2, 0,-1,-3,-2,-2, 6,-2,-4,-4,-2,-3,-3,-2, 0,-2,-2,-3,-3,-1,-2,-1,-4},
+    {-2, 0, 1,-1,-3, 0, 0,-2, 8,-3,-3,-1,-2,-1,-2,-1,-2,-2, 2,-3, 0, 0,-1,-4},
+    {-1,-3,-3,-3,-1,-3,-3,-4,-3, 4, 2,-3, 1, 0,-3,-2,-1,-3,-1, 3,-3,-3,-1,-4},
+    {-1,-2,-3,-4,-1,-2,-3,-4,-3, 2, 4,-2, 2, 0,-3,-2,-1,-2,-1, 1,-4,-3,-1,-4},
+    {-1, 2, 0,-1,-3, 1, 1,-2,-1,-3,-2, 5,-1,-3,-1, 0,-1,-3,-2,-2, 0, 1,-1,-4},
+    {-1,-1,-2,-3,-1, 0,-2,-3,-2, 1, 2,-1, 5, 0,-2,-1,-1,-1,-1, 1,-3,-1,-1,-4},
+    {-2,-3,-3,-3,-2,-3,-3,-3,-1, 0, 0,-3, 0, 6,-4,-2,-2, 1, 3,-1,-3,-3,-1,-4},
+    {-1,-2,-2,-1,-3,-1,-1,-2,-2,-3,-3,-1,-2,-4, 7,-1,-1,-4,-3,-2,-2,-1,-2,-4},
+    { 1,-1, 1, 0,-1, 0, 0, 0,-1,-2,-2, 0,-1,-2,-1, 4, 1,-3,-2,-2, 0, 0, 0,-4},
+    { 0,-1, 0,-1,-1,-1,-1,-2,-2,-1,-1,-1,-1,-2,-1, 1, 5,-2,-2, 0,-1,-1, 0,-4},
+    {-3,-3,-4,-4,-2,-2,-3,-2,-2,-3,-2,-3,-1, 1,-4,-3,-2,11, 2,-3,-4,-3,-2,-4},
+    {-2,-2,-2,-3,-2,-1,-2,-3, 2,-1,-1,-2,-1, 3,-3,-2,-2, 2, 7,-1,-3,-2,-1,-4},
+    { 0,-3,-3,-3,-1,-2,-2,-3,-3, 3, 1,-2, 1,-1,-2,-2, 0,-3,-1, 4,-3,-2,-1,-4},
+    {-2,-1, 3, 4,-3, 0, 1,-1, 0,-3,-4, 0,-3,-3,-2, 0,-1,-4,-3,-3, 4, 1,-1,-4},
+    {-1, 0, 0, 1,-3, 3, 4,-2, 0,-3,-3, 1,-1,-3,-1, 0,-1,-3,-2,-2, 1, 4,-1,-4},
+    { 0,-1,-1,-1,-2,-1,-1,-1,-1,-1,-1,-1,-1,-1,-2, 0, 0,-2,-1,-1,-1,-1,-1,-4},
+    {-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4,-4, 1}};
+
+//Like BLAST's default, alignments with larger e-values are not kept.
+static const double MAX_EVALUE = 10.0;
+
+//This is how far an alignment may wander off its starting diagonal.
+static const int BAND_WIDTH = 16;
+
+//These limit which seeds can be chained: the distance between them, how far
+//apart their diagonals can be, and how many earlier seeds are tried.
+static const int MAX_SEED_GAP = 1000;
+static const int MAX_DIAGONAL_SHIFT = 64;
+static const int MAX_CHAIN_PREDECESSORS = 50;
+
+//Minimizers found more often than this in the graph are not used as seeds.
+//This applies to the translated index's minimizers too.
+static const int MAX_SEED_OCCURRENCES = 500;
+
+//Alignments meeting over an edge can fall this far short of the node ends,
+//and this far off the expected query position, and still be chained.
+static const int JUNCTION_SLACK = 20;
+
+//These describe each cell of the banded alignment's traceback: where its
+//best score came from and whether its gaps were opened or extended there.
+static const unsigned char FROM_DIAGONAL = 0;
+static const unsigned char FROM_NODE_GAP = 1;
+static const unsigned char FROM_QUERY_GAP = 2;
+static const unsigned char SOURCE_MASK = 3;
+static const unsigned char NODE_GAP_EXTENDED = 4;
+static const unsigned char QUERY_GAP_EXTENDED = 8;
+static const int NO_SCORE = -1000000000;
+
+GraphAligner::GraphAligner(const SequenceIndex * index, const TranslatedIndex * translatedIndex) :
+    m_index(index), m_translatedIndex(translatedIndex), m_databaseLength(0)
+{
+    for (int i = 0; i < m_index->getNodeCount(); ++i)
+        m_databaseLength += m_index->getNodeSequence(i).length();
+}
+
+
+//This function aligns one nucleotide query to the graph.
+GraphAlignmentResult GraphAligner::alignQuery(QByteArray query) const
+{
+    query = query.toUpper();
+    return alignSeeds(query, m_index->findSeeds(query, MAX_SEED_OCCURRENCES), false);
+}
+
+
+//This function aligns one protein query to the graph's translation.  Each
+//seed is moved into its node's frame: the seed's node becomes the node's
+//index times 3 plus the frame, and its node position is in amino acids.
+//Seeds whose first codon runs off the end of the node are left out, as the
+//node's translation doesn't include that codon.
+GraphAlignmentResult GraphAligner::alignProteinQuery(QByteArray query) const
+{
+    if (m_translatedIndex == 0)
+        return GraphAlignmentResult();
+
+    query = query.toUpper();
+    std::vector<SequenceSeed> seeds = m_translatedIndex->findSeeds(query, MAX_SEED_OCCURRENCES);
+    std::vector<SequenceSeed> frameSeeds;
+    frameSeeds.reserve(seeds.size());
+    for (size_t i = 0; i < seeds.size(); ++i)
+    {
+        int frame = seeds[i].nodePosition % 3;
+        int peptidePosition = seeds[i].nodePosition / 3;
+        if (peptidePosition >= m_translatedIndex->getNodePeptide(seeds[i].node, frame).length())
+            continue;
+        SequenceSeed frameSeed = {seeds[i].queryPosition, seeds[i].node * 3 + frame, peptidePosition};
+        frameSeeds.push_back(frameSeed);
+    }
+    return alignSeeds(query, frameSeeds, true);
+}
+
+
+//This function makes the seeds into alignments, one node (or, for proteins,
+//one node's frame) at a time.  Protein alignments are then moved back into
+//bases in their node.
+GraphAlignmentResult GraphAligner::alignSeeds(const QByteArray & query, std::vector<SequenceSeed> seeds,
+                                              bool protein) const
+{
+    GraphAlignmentResult result;
+    std::sort(seeds.begin(), seeds.end(), seedIsBefore);
+
+    const AlignmentScoring & scoring = protein ? getProteinScoring() : getNucleotideScoring();
+    int kmerSize = protein ? m_translatedIndex->getKmerSize() : m_index->getKmerSize();
+    long long databaseLength = protein ? m_databaseLength / 3 : m_databaseLength;
+
+    std::vector<NodeAlignment> alignments;
+    size_t firstSeed = 0;
+    while (firstSeed < seeds.size())
+    {
+        size_t lastSeed = firstSeed;
+        while (lastSeed < seeds.size() && seeds[lastSeed].node == seeds[firstSeed].node)
+            ++lastSeed;
+
+        int subjectNode = seeds[firstSeed].node;
+        const QByteArray & subject = protein ? m_translatedIndex->getNodePeptide(subjectNode / 3, subjectNode % 3) :
+                                               m_index->getNodeSequence(subjectNode);
+        std::vector< std::vector<int> > chains = chainSeeds(seeds, int(firstSeed), int(lastSeed), kmerSize);
+        for (size_t i = 0; i < chains.size(); ++i)
+        {
+            NodeAlignment alignment = alignChain(query, subject, seeds, chains[i], kmerSize, scoring);
+            if (protein)
+            {
+                int frame = subjectNode % 3;
+                alignment.node = subjectNode / 3;
+                alignment.nodeStart = frame + 3 * (alignment.nodeStart - 1) + 1;
+                alignment.nodeEnd = frame + 3 * alignment.nodeEnd;
+            }
+            setSignificance(&alignment, query.length(), scoring, databaseLength);
+            alignments.push_back(alignment);
+        }
+        firstSeed = lastSeed;
+    }
+
+    //Different chains in a node often extend into the same alignment, so
+    //alignments inside a better one are dropped, as are insignificant ones.
+    std::sort(alignments.begin(), alignments.end(), alignmentIsBetter);
+    SciNot maxEValue(MAX_EVALUE);
+    for (size_t i = 0; i < alignments.size(); ++i)
+    {
+        if (alignments[i].alignmentLength == 0 || alignments[i].eValue > maxEValue)
+            continue;
+        bool redundant = false;
+        for (size_t j = 0; j < result.alignments.size() && !redundant; ++j)
+            redundant = alignmentContains(result.alignments[j], alignments[i]);
+        if (!redundant)
+            result.alignments.push_back(alignments[i]);
+    }
+    std::sort(result.alignments.begin(), result.alignments.end(), alignmentIsEarlier);
+
+    result.chains = chainAlignments(result.alignments, protein ? 3 : 1);
+    return result;
+}
+
+
+//This function aligns many queries, in a thread pool if more than one thread
+//is to be used.  Each query is a protein if its flag is set.  The results are
+//in the same order as the queries.  If the cancel flag is set, the remaining
+//queries are given no alignments.
+std::vector<GraphAlignmentResult> GraphAligner::alignQueries(const std::vector<QByteArray> & queries,
+                                                             const std::vector<bool> & proteinQueries,
+                                                             int threads, const bool * cancel) const
+{
+    std::vector<GraphAlignmentResult> results(queries.size());
+    int queryCount = int(queries.size());
+    int blockCount = std::max(1, std::min(queryCount, threads * 4));
+    QList< QSharedPointer<GraphAlignmentJob> > jobs;
+    for (int i = 0; i < blockCount; ++i)
+    {
+        int firstQuery = int((long long)(queryCount) * i / blockCount);
+        int lastQuery = int((long long)(queryCount) * (i + 1) / blockCount) - 1;
+        jobs.push_back(QSharedPointer<GraphAlignmentJob>(new GraphAlignmentJob(this, &queries, &proteinQueries,
+                                                                               firstQuery, lastQuery,
+                                                                               cancel, &results)));
+    }
+
+    runJobs(jobs, threads);
+
+    return results;
+}
+
+
+
+//This function chains the seeds of one node (from firstSeed up to but not
+//including lastSeed, sorted by node position).  A seed may follow an earlier
+//seed which is before it in both the query and the node, on a nearby
+//diagonal, and a chain scores the bases its seeds cover less the shifts in
+//diagonal between them.  Chains are then taken best first, each seed being
+//used in only one.  Each chain is given as seed indices, in order.
+std::vector< std::vector<int> > GraphAligner::chainSeeds(const std::vector<SequenceSeed> & seeds,
+                                                         int firstSeed, int lastSeed, int kmerSize) const
+{
+    int seedCount = lastSeed - firstSeed;
+    std::vector<int> scores(seedCount, kmerSize);
+    std::vector<int> previous(seedCount, -1);
+    for (int i = 0; i < seedCount; ++i)
+    {
+        const SequenceSeed & seed = seeds[firstSeed + i];
+        for (int j = i - 1; j >= 0 && j >= i - MAX_CHAIN_PREDECESSORS; --j)
+        {
+            const SequenceSeed & earlierSeed = seeds[firstSeed + j];
+            int nodeDistance = seed.nodePosition - earlierSeed.nodePosition;
+            int queryDistance = seed.queryPosition - earlierSeed.queryPosition;
+            if (nodeDistance > MAX_SEED_GAP)
+                break;
+            if (nodeDistance <= 0 || queryDistance <= 0 || queryDistance > MAX_SEED_GAP)
+                continue;
+            int diagonalShift = std::abs(nodeDistance - queryDistance);
+            if (diagonalShift > MAX_DIAGONAL_SHIFT)
+                continue;
+            int score = scores[j] + std::min(std::min(nodeDistance, queryDistance), kmerSize) - diagonalShift;
+            if (score > scores[i])
+            {
+                scores[i] = score;
+                previous[i] = j;
+            }
+        }
+    }
+
+    std::vector< QPair<int, int> > chainEnds;
+    for (int i = 0; i < seedCount; ++i)
+        chainEnds.push_back(QPair<int, int>(-scores[i], i));
+    std::sort(chainEnds.begin(), chainEnds.end());
+
+    std::vector< std::vector<int> > chains;
+    std::vector<bool> used(seedCount, false);
+    for (size_t i = 0; i < chainEnds.size(); ++i)
+    {
+        std::vector<int> chain;
+        for (int j = chainEnds[i].second; j != -1 && !used[j]; j = previous[j])
+        {
+            chain.push_back(firstSeed + j);
+            used[j] = true;
+        }
+        if (chain.empty())
+            continue;
+        std::reverse(chain.begin(), chain.end());
+        chains.push_back(chain);
+    }
+    return chains;
+}
+
+
+//This function makes a chain of seeds into an alignment.  The stretches
+//between seeds are aligned end to end, in a band wide enough for any shift
+//in diagonal between the seeds, and the alignment is extended out from the
+//first and last seeds as far as it scores well.  The extension to the left
+//is done on the reversed sequences.  The last seed's k-mer may run off the
+//end of its node, so only the part inside the node is used.  The subject is
+//the node's sequence, or its translation in the seeds' frame.
+NodeAlignment GraphAligner::alignChain(const QByteArray & query, const QByteArray & subject,
+                                       const std::vector<SequenceSeed> & seeds,
+                                       const std::vector<int> & chain, int kmerSize,
+                                       const AlignmentScoring & scoring) const
+{
+    const SequenceSeed & firstSeed = seeds[chain.front()];
+    const SequenceSeed & lastSeed = seeds[chain.back()];
+    const QByteArray & nodeSequence = subject;
+    const char * querySequence = query.constData();
+
+    NodeAlignment alignment;
+    alignment.node = firstSeed.node;
+    alignment.alignmentLength = 0;
+    alignment.matches = 0;
+    alignment.mismatches = 0;
+    alignment.gapOpens = 0;
+    alignment.score = 0;
+
+    int leftQueryLength = firstSeed.queryPosition;
+    int leftNodeLength = std::min(firstSeed.nodePosition, leftQueryLength + BAND_WIDTH);
+    QByteArray queryBefore = query.mid(firstSeed.queryPosition - leftQueryLength, leftQueryLength);
+    QByteArray nodeBefore = nodeSequence.mid(firstSeed.nodePosition - leftNodeLength, leftNodeLength);
+    std::reverse(queryBefore.begin(), queryBefore.end());
+    std::reverse(nodeBefore.begin(), nodeBefore.end());
+    AlignmentStretch left = alignBanded(queryBefore.constData(), leftQueryLength,
+                                        nodeBefore.constData(), leftNodeLength, BAND_WIDTH, true, scoring);
+    addStretch(&alignment, left);
+    alignment.queryStart = firstSeed.queryPosition - left.queryLength + 1;
+    alignment.nodeStart = firstSeed.nodePosition - left.nodeLength + 1;
+
+    for (size_t i = 0; i + 1 < chain.size(); ++i)
+    {
+        const SequenceSeed & seed = seeds[chain[i]];
+        const SequenceSeed & nextSeed = seeds[chain[i + 1]];
+        int queryDistance = nextSeed.queryPosition - seed.queryPosition;
+        int nodeDistance = nextSeed.nodePosition - seed.nodePosition;
+        addStretch(&alignment, alignBanded(querySequence + seed.queryPosition, queryDistance,
+                                           nodeSequence.constData() + seed.nodePosition, nodeDistance,
+                                           BAND_WIDTH + std::abs(queryDistance - nodeDistance), false, scoring));
+    }
+
+    int lastKmerLength = std::min(kmerSize, nodeSequence.length() - lastSeed.nodePosition);
+    addStretch(&alignment, alignBanded(querySequence + lastSeed.queryPosition, lastKmerLength,
+                                       nodeSequence.constData() + lastSeed.nodePosition, lastKmerLength,
+                                       BAND_WIDTH, false, scoring));
+
+    int queryEnd = lastSeed.queryPosition + lastKmerLength;
+    int nodeEnd = lastSeed.nodePosition + lastKmerLength;
+    AlignmentStretch right = alignBanded(querySequence + queryEnd, query.length() - queryEnd,
+                                         nodeSequence.constData() + nodeEnd, nodeSequence.length() - nodeEnd,
+                                         BAND_WIDTH, true, scoring);
+    addStretch(&alignment, right);
+    alignment.queryEnd = queryEnd + right.queryLength;
+    alignment.nodeEnd = nodeEnd + right.nodeLength;
+
+    return alignment;
+}
+
+
+//This function chains alignments (sorted by query start) which follow each
+//other through edges.  Each alignment may follow whichever earlier one gives
+//the best total score, and a chain is given for each alignment which nothing
+//follows.  For proteins, there are 3 bases in the node per query position.
+std::vector< std::vector<int> > GraphAligner::chainAlignments(const std::vector<NodeAlignment> & alignments,
+                                                              int basesPerQueryPosition) const
+{
+    int alignmentCount = int(alignments.size());
+    std::vector<int> scores(alignmentCount);
+    std::vector<int> previous(alignmentCount, -1);
+    std::vector<bool> followed(alignmentCount, false);
+    for (int i = 0; i < alignmentCount; ++i)
+    {
+        scores[i] = alignments[i].score;
+        for (int j = 0; j < i; ++j)
+        {
+            if (scores[j] + alignments[i].score > scores[i] && followsThroughEdge(alignments[j], alignments[i], basesPerQueryPosition))
+            {
+                scores[i] = scores[j] + alignments[i].score;
+                previous[i] = j;
+            }
+        }
+        if (previous[i] != -1)
+            followed[previous[i]] = true;
+    }
+
+    std::vector< std::vector<int> > chains;
+    for (int i = 0; i < alignmentCount; ++i)
+    {
+        if (followed[i])
+            continue;
+        std::vector<int> chain;
+        for (int j = i; j != -1; j = previous[j])
+            chain.push_back(j);
+        std::reverse(chain.begin(), chain.end());
+        chains.push_back(chain);
+    }
+    return chains;
+}
+
+
+//This function decides whether the next alignment carries on from the
+//previous one through an edge: the previous one must run to (or nearly to)
+//the end of its node, the next one must start at (or near) the start of the
+//following node after the overlap, and the next one's query start must be
+//close to where the previous one would have reached by then.  For proteins,
+//a codon split over the junction is in neither node's translation, so the
+//query position for it is skipped.
+bool GraphAligner::followsThroughEdge(const NodeAlignment & previous, const NodeAlignment & next,
+                                      int basesPerQueryPosition) const
+{
+    if (next.queryStart <= previous.queryStart || next.queryEnd <= previous.queryEnd)
+        return false;
+    int previousLength = m_index->getNodeSequence(previous.node).length();
+    if (previous.nodeEnd < previousLength - JUNCTION_SLACK)
+        return false;
+
+    const std::vector< QPair<int, int> > & successors = m_index->getSuccessors(previous.node);
+    for (size_t i = 0; i < successors.size(); ++i)
+    {
+        if (successors[i].first != next.node)
+            continue;
+        int overlap = successors[i].second;
+        if (next.nodeStart > overlap + JUNCTION_SLACK + 1)
+            continue;
+        int skippedBases = (previousLength - previous.nodeEnd) + (next.nodeStart - 1 - overlap);
+        int expectedQueryStart = previous.queryEnd + 1 + skippedBases / basesPerQueryPosition;
+        if (std::abs(next.queryStart - expectedQueryStart) <= JUNCTION_SLACK)
+            return true;
+    }
+    return false;
+}
+
+
+//This function gives an alignment the bit score and e-value that BLAST
+//would, using the whole graph as the database.  The e-value is worked out
+//in log space, as it can be too small for a double.
+void GraphAligner::setSignificance(NodeAlignment * alignment, int queryLength,
+                                   const AlignmentScoring & scoring, long long databaseLength) const
+{
+    double bitScore = (scoring.lambda * alignment->score - std::log(scoring.k)) / std::log(2.0);
+    alignment->bitScore = std::floor(bitScore * 10.0 + 0.5) / 10.0;
+
+    double log10EValue = std::log10(double(queryLength)) + std::log10(double(std::max(1LL, databaseLength))) -
+            bitScore * std::log10(2.0);
+    int exponent = int(std::floor(log10EValue));
+    alignment->eValue = SciNot(std::pow(10.0, log10EValue - exponent), exponent);
+}
+
+
+
+//This function aligns part of a query to part of a node in a band around
+//the main diagonal, with affine gap penalties.  If extend is false, the
+//whole of both sequences is aligned (the band is widened to reach the far
+//corner).  If extend is true, the alignment starts at the start of both but
+//may stop anywhere: it ends where it scores best, and cells which fall more
+//than the X-drop below the best are abandoned.  Only the traceback is kept
+//for every cell; the scores are kept for just two rows.
+AlignmentStretch GraphAligner::alignBanded(const char * query, int queryLength,
+                                           const char * node, int nodeLength,
+                                           int bandWidth, bool extend,
+                                           const AlignmentScoring & scoring)
+{
+    int gapOpenPenalty = scoring.gapOpenPenalty;
+    int gapExtendPenalty = scoring.gapExtendPenalty;
+
+    if (extend)
+        nodeLength = std::min(nodeLength, queryLength + bandWidth);
+    else
+        bandWidth = std::max(bandWidth, std::abs(queryLength - nodeLength));
+    int width = 2 * bandWidth + 1;
+
+    //A cell (i, j) is stored in its row (query position i) at column
+    //j - i + bandWidth.
+    std::vector<int> previousScores(width, NO_SCORE), previousQueryGaps(width, NO_SCORE);
+    std::vector<int> scores(width, NO_SCORE), nodeGaps(width, NO_SCORE), queryGaps(width, NO_SCORE);
+    std::vector<unsigned char> traceback(width, FROM_DIAGONAL);
+
+    int bestScore = 0;
+    int bestRow = 0;
+    int bestColumn = bandWidth;
+
+    //The first row can only be reached by gaps in the query.
+    scores[bandWidth] = 0;
+    for (int j = 1; j <= std::min(nodeLength, bandWidth); ++j)
+    {
+        int column = j + bandWidth;
+        int score = -gapOpenPenalty - gapExtendPenalty * j;
+        if (extend && score < bestScore - scoring.xDrop)
+            break;
+        scores[column] = score;
+        nodeGaps[column] = score;
+        traceback[column] = FROM_NODE_GAP | (j > 1 ? NODE_GAP_EXTENDED : 0);
+    }
+
+    for (int i = 1; i <= queryLength; ++i)
+    {
+        int firstJ = std::max(0, i - bandWidth);
+        int lastJ = std::min(nodeLength, i + bandWidth);
+        if (firstJ > lastJ)
+            break;
+
+        scores.swap(previousScores);
+        queryGaps.swap(previousQueryGaps);
+        std::fill(scores.begin(), scores.end(), NO_SCORE);
+        std::fill(nodeGaps.begin(), nodeGaps.end(), NO_SCORE);
+        std::fill(queryGaps.begin(), queryGaps.end(), NO_SCORE);
+        traceback.resize(size_t(i + 1) * width, FROM_DIAGONAL);
+        unsigned char * rowTraceback = &traceback[size_t(i) * width];
+
+        bool rowAlive = false;
+        for (int j = firstJ; j <= lastJ; ++j)
+        {
+            int column = j - i + bandWidth;
+            unsigned char trace = FROM_DIAGONAL;
+
+            //A gap in the query uses up a node base: it comes from the left.
+            int nodeGap = NO_SCORE;
+            if (j > firstJ)
+            {
+                int open = scores[column - 1] - gapOpenPenalty - gapExtendPenalty;
+                int extension = nodeGaps[column - 1] - gapExtendPenalty;
+                nodeGap = std::max(open, extension);
+                if (extension > open)
+                    trace |= NODE_GAP_EXTENDED;
+            }
+
+            //A gap in the node uses up a query base: it comes from above.
+            int queryGap = NO_SCORE;
+            if (column + 1 < width)
+            {
+                int open = previousScores[column + 1] - gapOpenPenalty - gapExtendPenalty;
+                int extension = previousQueryGaps[column + 1] - gapExtendPenalty;
+                queryGap = std::max(open, extension);
+                if (extension > open)
+                    trace |= QUERY_GAP_EXTENDED;
+            }
+
+            int score = NO_SCORE;
+            if (j > 0)
+                score = previousScores[column] + scoring.scores[query[i - 1] & 127][node[j - 1] & 127];
+            if (nodeGap > score)
+            {
+                score = nodeGap;
+                trace = (trace & ~SOURCE_MASK) | FROM_NODE_GAP;
+            }
+            if (queryGap > score)
+            {
+                score = queryGap;
+                trace = (trace & ~SOURCE_MASK) | FROM_QUERY_GAP;
+            }
+
+            //Scores are never let fall far below NO_SCORE, so they can't
+            //overflow.
+            score = std::max(score, NO_SCORE);
+            nodeGap = std::max(nodeGap, NO_SCORE);
+            queryGap = std::max(queryGap, NO_SCORE);
+
+            if (extend)
+            {
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestRow = i;
+                    bestColumn = column;
+                }
+                else if (score < bestScore - scoring.xDrop)
+                {
+                    score = NO_SCORE;
+                    nodeGap = NO_SCORE;
+                    queryGap = NO_SCORE;
+                }
+            }
+
+            scores[column] = score;
+            nodeGaps[column] = nodeGap;
+            queryGaps[column] = queryGap;
+            rowTraceback[column] = trace;
+            if (score > NO_SCORE)
+                rowAlive = true;
+        }
+        if (!rowAlive)
+            break;
+    }
+
+    int endRow = bestRow;
+    int endJ = bestColumn - bandWidth + bestRow;
+    if (!extend)
+    {
+        endRow = queryLength;
+        endJ = nodeLength;
+        bestScore = scores[nodeLength - queryLength + bandWidth];
+    }
+
+    AlignmentStretch stretch;
+    stretch.queryLength = endRow;
+    stretch.nodeLength = endJ;
+    stretch.alignmentLength = 0;
+    stretch.matches = 0;
+    stretch.mismatches = 0;
+    stretch.gapOpens = 0;
+    stretch.score = bestScore;
+
+    unsigned char state = FROM_DIAGONAL;
+    int i = endRow;
+    int j = endJ;
+    while (i > 0 || j > 0)
+    {
+        unsigned char trace = traceback[size_t(i) * width + (j - i + bandWidth)];
+        if (state == FROM_DIAGONAL)
+        {
+            state = trace & SOURCE_MASK;
+            if (state != FROM_DIAGONAL)
+                continue;
+            ++stretch.alignmentLength;
+            if (query[i - 1] == node[j - 1])
+                ++stretch.matches;
+            else
+                ++stretch.mismatches;
+            --i;
+            --j;
+        }
+        else if (state == FROM_NODE_GAP)
+        {
+            ++stretch.alignmentLength;
+            if (!(trace & NODE_GAP_EXTENDED))
+            {
+                ++stretch.gapOpens;
+                state = FROM_DIAGONAL;
+            }
+            --j;
+        }
+        else
+        {
+            ++stretch.alignmentLength;
+            if (!(trace & QUERY_GAP_EXTENDED))
+            {
+                ++stretch.gapOpens;
+                state = FROM_DIAGONAL;
+            }
+            --i;
+        }
+    }
+
+    return stretch;
+}
+
+
+
+//The scorings are made when first used.  Every character matches itself,
+//so nucleotide alignments treat N (for example) like any other base.
+const AlignmentScoring & GraphAligner::getNucleotideScoring()
+{
+    static AlignmentScoring scoring = makeNucleotideScoring();
+    return scoring;
+}
+
+const AlignmentScoring & GraphAligner::getProteinScoring()
+{
+    static AlignmentScoring scoring = makeProteinScoring();
+    return scoring;
+}
+
+AlignmentScoring GraphAligner::makeNucleotideScoring()
+{
+    AlignmentScoring scoring;
+    for (int i = 0; i < 128; ++i)
+    {
+        for (int j = 0; j < 128; ++j)
+            scoring.scores[i][j] = (i == j) ? MATCH_SCORE : -MISMATCH_PENALTY;
+    }
+    scoring.gapOpenPenalty = GAP_OPEN_PENALTY;
+    scoring.gapExtendPenalty = GAP_EXTEND_PENALTY;
+    scoring.xDrop = X_DROP;
+    scoring.lambda = KARLIN_LAMBDA;
+    scoring.k = KARLIN_K;
+    return scoring;
+}
+
+//Characters which aren't in BLOSUM62 are scored as X.
+AlignmentScoring GraphAligner::makeProteinScoring()
+{
+    std::vector<int> matrixIndices(128, 22);
+    for (int i = 0; i < 24; ++i)
+    {
+        int aminoAcid = BLOSUM62_AMINO_ACIDS[i];
+        matrixIndices[aminoAcid] = i;
+        matrixIndices[tolower(aminoAcid)] = i;
+    }
+
+    AlignmentScoring scoring;
+    for (int i = 0; i < 128; ++i)
+    {
+        for (int j = 0; j < 128; ++j)
+            scoring.scores[i][j] = BLOSUM62[matrixIndices[i]][matrixIndices[j]];
+    }
+    scoring.gapOpenPenalty = PROTEIN_GAP_OPEN_PENALTY;
+    scoring.gapExtendPenalty = PROTEIN_GAP_EXTEND_PENALTY;
+    scoring.xDrop = PROTEIN_X_DROP;
+    scoring.lambda = PROTEIN_KARLIN_LAMBDA;
+    scoring.k = PROTEIN_KARLIN_K;
+    return scoring;
+}
+
+
+void GraphAligner::addStretch(NodeAlignment * alignment, const AlignmentStretch & stretch)
+{
+    alignment->alignmentLength += stretch.alignmentLength;
+    alignment->matches += stretch.matches;
+    alignment->mismatches += stretch.mismatches;
+    alignment->gapOpens += stretch.gapOpens;
+    alignment->score += stretch.score;
+}
+
+
+bool GraphAligner::seedIsBefore(const SequenceSeed & a, const SequenceSeed & b)
+{
+    if (a.node != b.node)
+        return a.node < b.node;
+    if (a.nodePosition != b.nodePosition)
+        return a.nodePosition < b.nodePosition;
+    return a.queryPosition < b.queryPosition;
+}
+
+bool GraphAligner::alignmentIsBetter(const NodeAlignment & a, const NodeAlignment & b)
+{
+    if (a.score != b.score)
+        return a.score > b.score;
+    if (a.node != b.node)
+        return a.node < b.node;
+    if (a.queryStart != b.queryStart)
+        return a.queryStart < b.queryStart;
+    return a.nodeStart < b.nodeStart;
+}
+
+bool GraphAligner::alignmentIsEarlier(const NodeAlignment & a, const NodeAlignment & b)
+{
+    if (a.queryStart != b.queryStart)
+        return a.queryStart < b.queryStart;
+    return alignmentIsBetter(a, b);
+}
+
+//This function returns whether alignment b lies within alignment a, in both
+//the query and the node.
+bool GraphAligner::alignmentContains(const NodeAlignment & a, const NodeAlignment & b)
+{
+    return a.node == b.node &&
+            b.queryStart >= a.queryStart && b.queryEnd <= a.queryEnd &&
+            b.nodeStart >= a.nodeStart && b.nodeEnd <= a.nodeEnd;
+}
+
+
+
+GraphAlignmentJob::GraphAlignmentJob(const GraphAligner * aligner, const std::vector<QByteArray> * queries,
+                                     const std::vector<bool> * proteinQueries,
+                                     int firstQuery, int lastQuery, const bool * cancel,
+                                     std::vector<GraphAlignmentResult> * results) :
+    m_aligner(aligner), m_queries(queries), m_proteinQueries(proteinQueries),
+    m_firstQuery(firstQuery), m_lastQuery(lastQuery),
+    m_cancel(cancel), m_results(results)
+{
+}
+
+
+void GraphAlignmentJob::run()
+{
+    for (int i = m_firstQuery; i <= m_lastQuery; ++i)
+    {
+        if (m_cancel != 0 && *m_cancel)
+            return;
+        if ((*m_proteinQueries)[i])
+            (*m_results)[i] = m_aligner->alignProteinQuery((*m_queries)[i]);
+        else
+            (*m_results)[i] = m_aligner->alignQuery((*m_queries)[i]);
+    }
+}
@@ -0,0 +1,179 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef GRAPHALIGNER_H
+#define GRAPHALIGNER_H
+
+#include <vector>
+#include <QByteArray>
+#include <QRunnable>
+#include "../program/scinot.h"
+
+class SequenceIndex;
+class TranslatedIndex;
+struct SequenceSeed;
+
+//This is one local alignment of a query to one node, in the same terms as a
+//line of BLAST's tabular output.  Positions are 1-based and inclusive, and
+//the node is given by its index in the sequence index.
+struct NodeAlignment
+{
+    int node;
+    int queryStart;
+    int queryEnd;
+    int nodeStart;
+    int nodeEnd;
+    int alignmentLength;
+    int matches;
+    int mismatches;
+    int gapOpens;
+    int score;
+    double bitScore;
+    SciNot eValue;
+};
+
+//These are a query's alignments, sorted by where they start in the query,
+//and the chains of them which run through the graph.  Each chain lists
+//alignments (by index) whose nodes follow each other through edges.
+struct GraphAlignmentResult
+{
+    std::vector<NodeAlignment> alignments;
+    std::vector< std::vector<int> > chains;
+};
+
+//This is how a banded alignment is scored: a score for each pair of
+//characters, the affine gap penalties, the X-drop for extensions and the
+//Karlin-Altschul parameters for the scores.
+struct AlignmentScoring
+{
+    signed char scores[128][128];
+    int gapOpenPenalty;
+    int gapExtendPenalty;
+    int xDrop;
+    double lambda;
+    double k;
+};
+
+//This is the tally of one stretch of a banded alignment: how much of each
+//sequence it used and what it is made of.
+struct AlignmentStretch
+{
+    int queryLength;
+    int nodeLength;
+    int alignmentLength;
+    int matches;
+    int mismatches;
+    int gapOpens;
+    int score;
+};
+
+
+//This class is a built-in alternative to BLAST for nucleotide queries.  It
+//works in three steps:
+// 1) Seeds: the query's minimizers are looked up in the graph's sequence
+//    index, giving k-mers it shares with the nodes.
+// 2) Chaining: in each node, seeds which are colinear (in order in both the
+//    query and the node, on nearby diagonals) are chained, best chains first.
+// 3) Extension: each chain is made into an alignment by a banded alignment
+//    between its seeds and an X-drop extension out from its ends.
+//The alignments are scored like blastn's (match 2, mismatch -3, gap open 5,
+//gap extend 2) and given blastn's bit scores and e-values, so they can be
+//used as BLAST hits.  Alignments which meet over an edge (one running to the
+//end of a node and the next starting in the following node at the matching
+//place in the query) are then chained into paths through the graph.
+//Protein queries are done the same way against the six-frame translation of
+//the nodes, each node's frame being aligned as its own peptide, and scored
+//like tblastn's (BLOSUM62, gap open 11, gap extend 1).  Like tblastn's hits,
+//their query positions are in amino acids and their node positions are in
+//bases.
+class GraphAligner
+{
+public:
+    //CREATORS
+    GraphAligner(const SequenceIndex * index, const TranslatedIndex * translatedIndex = 0);
+
+    //ACCESSORS
+    GraphAlignmentResult alignQuery(QByteArray query) const;
+    GraphAlignmentResult alignProteinQuery(QByteArray query) const;
+    std::vector<GraphAlignmentResult> alignQueries(const std::vector<QByteArray> & queries,
+                                                   const std::vector<bool> & proteinQueries,
+                                                   int threads, const bool * cancel) const;
+
+    //STATIC
+    static AlignmentStretch alignBanded(const char * query, int queryLength,
+                                        const char * node, int nodeLength,
+                                        int bandWidth, bool extend,
+                                        const AlignmentScoring & scoring);
+    static const AlignmentScoring & getNucleotideScoring();
+    static const AlignmentScoring & getProteinScoring();
+
+private:
+    const SequenceIndex * m_index;
+    const TranslatedIndex * m_translatedIndex;
+    long long m_databaseLength;
+
+    GraphAlignmentResult alignSeeds(const QByteArray & query, std::vector<SequenceSeed> seeds,
+                                    bool protein) const;
+    std::vector< std::vector<int> > chainSeeds(const std::vector<SequenceSeed> & seeds,
+                                               int firstSeed, int lastSeed, int kmerSize) const;
+    NodeAlignment alignChain(const QByteArray & query, const QByteArray & subject,
+                             const std::vector<SequenceSeed> & seeds,
+                             const std::vector<int> & chain, int kmerSize,
+                             const AlignmentScoring & scoring) const;
+    std::vector< std::vector<int> > chainAlignments(const std::vector<NodeAlignment> & alignments,
+                                                    int basesPerQueryPosition) const;
+    bool followsThroughEdge(const NodeAlignment & previous, const NodeAlignment & next,
+                            int basesPerQueryPosition) const;
+    void setSignificance(NodeAlignment * alignment, int queryLength,
+                         const AlignmentScoring & scoring, long long databaseLength) const;
+
+    static AlignmentScoring makeNucleotideScoring();
+    static AlignmentScoring makeProteinScoring();
+    static void addStretch(NodeAlignment * alignment, const AlignmentStretch & stretch);
+    static bool seedIsBefore(const SequenceSeed & a, const SequenceSeed & b);
+    static bool alignmentIsBetter(const NodeAlignment & a, const NodeAlignment & b);
+    static bool alignmentIsEarlier(const NodeAlignment & a, const NodeAlignment & b);
+    static bool alignmentContains(const NodeAlignment & a, const NodeAlignment & b);
+};
+
+
+//This class aligns one block of queries, so the blocks can be spread over a
+//thread pool.  Each query's result goes in its own place in the results.
+class GraphAlignmentJob : public QRunnable
+{
+public:
+    //CREATORS
+    GraphAlignmentJob(const GraphAligner * aligner, const std::vector<QByteArray> * queries,
+                      const std::vector<bool> * proteinQueries,
+                      int firstQuery, int lastQuery, const bool * cancel,
+                      std::vector<GraphAlignmentResult> * results);
+
+    //MODIFERS
+    void run();
+
+private:
+    const GraphAligner * m_aligner;
+    const std::vector<QByteArray> * m_queries;
+    const std::vector<bool> * m_proteinQueries;
+    int m_firstQuery;
+    int m_lastQuery;
+    const bool * m_cancel;
+    std::vector<GraphAlignmentResult> * m_results;
+};
+
+#endif // GRAPHALIGNER_H
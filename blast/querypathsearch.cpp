@@ -0,0 +1,40 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "querypathsearch.h"
+#include "blastquery.h"
+
+QueryPathSearch::QueryPathSearch(GraphLocation startLocation, GraphLocation endLocation,
+                                 int nodeSearchDepth, int minLength, int maxLength) :
+    m_startLocation(startLocation), m_endLocation(endLocation),
+    m_nodeSearchDepth(nodeSearchDepth), m_minLength(minLength), m_maxLength(maxLength)
+{
+}
+
+
+void QueryPathSearch::run()
+{
+    m_paths = Path::getAllPossiblePaths(m_startLocation, m_endLocation,
+                                        m_nodeSearchDepth, m_minLength, m_maxLength);
+}
+
+
+void QueryPathSearchFinisher::run()
+{
+    m_query->finishQueryPathSearches();
+}
@@ -0,0 +1,70 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef QUERYPATHSEARCH_H
+#define QUERYPATHSEARCH_H
+
+#include <QRunnable>
+#include <QList>
+#include "../graph/graphlocation.h"
+#include "../graph/path.h"
+
+class BlastQuery;
+
+//This class holds a search for paths between one pair of BLAST hits (a start
+//hit and an end hit) for a query.  It is a QRunnable so the searches can be
+//spread over a thread pool, but it can also just be run directly.
+class QueryPathSearch : public QRunnable
+{
+public:
+    //CREATORS
+    QueryPathSearch(GraphLocation startLocation, GraphLocation endLocation,
+                    int nodeSearchDepth, int minLength, int maxLength);
+
+    //ACCESSORS
+    QList<Path> getPaths() const {return m_paths;}
+
+    //MODIFERS
+    void run();
+
+private:
+    GraphLocation m_startLocation;
+    GraphLocation m_endLocation;
+    int m_nodeSearchDepth;
+    int m_minLength;
+    int m_maxLength;
+    QList<Path> m_paths;
+};
+
+
+//This class turns the finished path searches for a query into the query's
+//paths, so that this step can also be spread over a thread pool.
+class QueryPathSearchFinisher : public QRunnable
+{
+public:
+    //CREATORS
+    QueryPathSearchFinisher(BlastQuery * query) : m_query(query) {}
+
+    //MODIFERS
+    void run();
+
+private:
+    BlastQuery * m_query;
+};
+
+#endif // QUERYPATHSEARCH_H
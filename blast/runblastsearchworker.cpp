@@ -21,6 +21,16 @@
 #include "../program/settings.h"
 #include "blastsearch.h"
 #include "../program/memory.h"
+#include "blastquery.h"
+#include "blasthit.h"
+#include <QFile>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+
+//While waiting for the shards, they are all checked this often for whether
+//they have finished or the search has been cancelled.
+static const int SHARD_WAIT_MILLISECONDS = 100;
 
 
 RunBlastSearchWorker::RunBlastSearchWorker(QString blastnCommand, QString tblastnCommand, QString parameters) :
@@ -34,31 +44,64 @@ void RunBlastSearchWorker::runBlastSearch()
 {
     g_blastSearch->m_cancelRunBlastSearch = false;
 
-    bool success;
-
-    if (g_blastSearch->m_blastQueries.getQueryCount(NUCLEOTIDE) > 0)
+    if (g_settings->blastAligner == BUILT_IN_ALIGNER)
     {
-        g_blastSearch->m_blastOutput += runOneBlastSearch(NUCLEOTIDE, &success);
-        if (!success)
+        g_blastSearch->runGraphAligner();
+        if (g_blastSearch->m_cancelRunBlastSearch)
+        {
+            m_error = "BLAST search cancelled.";
+            emit finishedSearch(m_error);
             return;
+        }
+        g_blastSearch->m_blastQueries.searchOccurred();
+        m_error = "";
+        emit finishedSearch(m_error);
+        return;
     }
 
-    if (g_blastSearch->m_blastQueries.getQueryCount(PROTEIN) > 0 && !g_blastSearch->m_cancelRunBlastSearch)
+    makeShards();
+    if (!m_error.isEmpty())
     {
-        g_blastSearch->m_blastOutput += runOneBlastSearch(PROTEIN, &success);
-        if (!success)
-            return;
+        deleteShards();
+        emit finishedSearch(m_error);
+        return;
     }
 
+    //If there are more threads than shards (i.e. only a few queries), the
+    //spare threads are given to the BLAST processes, unless the user has
+    //already set BLAST's thread count.
+    int threadsPerShard = 1;
+    if (!m_shards.empty() && !m_parameters.contains("-num_threads"))
+        threadsPerShard = std::max(1, g_settings->threads / int(m_shards.size()));
+
+    emit setShardCount(int(m_shards.size()));
+    for (size_t i = 0; i < m_shards.size(); ++i)
+        startShard(&m_shards[i], threadsPerShard);
+    waitForShards();
+
     if (g_blastSearch->m_cancelRunBlastSearch)
     {
+        deleteShards();
         m_error = "BLAST search cancelled.";
         emit finishedSearch(m_error);
         return;
     }
 
+    m_error = getShardError();
+    if (m_error != "")
+    {
+        deleteShards();
+        emit finishedSearch(m_error);
+        return;
+    }
+
     //If the code got here, then the search completed successfully.
-    g_blastSearch->buildHitsFromBlastOutput();
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        for (size_t j = 0; j < m_shards[i].hits.size(); ++j)
+            g_blastSearch->addHit(m_shards[i].hits[j]);
+    }
+    deleteShards();
     g_blastSearch->findQueryPaths();
     g_blastSearch->m_blastQueries.searchOccurred();
     m_error = "";
@@ -66,52 +109,255 @@ void RunBlastSearchWorker::runBlastSearch()
 }
 
 
-QString RunBlastSearchWorker::runOneBlastSearch(SequenceType sequenceType, bool * success)
+//This function splits the queries into one shard per thread.  The shards are
+//shared between the nucleotide and protein queries in proportion to their
+//counts.
+void RunBlastSearchWorker::makeShards()
 {
-    QString blastCommand;
-    QStringList blastCommandArguments = { "-query" };
-    if (sequenceType == NUCLEOTIDE) {
-        blastCommand = m_blastnCommand;
-        blastCommandArguments << g_blastSearch-> m_tempDirectory + "nucl_queries.fasta";
+    m_shards.clear();
+    m_error = "";
+
+    int nuclCount = g_blastSearch->m_blastQueries.getQueryCount(NUCLEOTIDE);
+    int protCount = g_blastSearch->m_blastQueries.getQueryCount(PROTEIN);
+    int queryCount = nuclCount + protCount;
+    if (queryCount == 0)
+        return;
+
+    int shardCount = std::min(int(g_settings->threads), queryCount);
+    int nuclShardCount = 0;
+    if (nuclCount > 0)
+        nuclShardCount = std::max(1, std::min(nuclCount, shardCount * nuclCount / queryCount));
+    int protShardCount = 0;
+    if (protCount > 0)
+        protShardCount = std::max(1, std::min(protCount, shardCount - nuclShardCount));
+
+    addShards(NUCLEOTIDE, nuclShardCount);
+    addShards(PROTEIN, protShardCount);
+
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        if (!writeShardQueryFile(m_shards[i]))
+        {
+            m_error = "There was a problem writing the BLAST query file " + m_shards[i].queryFilename + ".";
+            return;
+        }
+    }
+}
+
+
+//This function splits the queries of one type into contiguous blocks with
+//roughly equal total lengths, so the shards take roughly equal times.  Empty
+//queries can't have hits, so they are left out.  That also keeps each
+//query's shard index below the shard count, as every query then starts
+//before the total length.
+void RunBlastSearchWorker::addShards(SequenceType sequenceType, int shardCount)
+{
+    if (shardCount == 0)
+        return;
+
+    std::vector<BlastQuery *> queries;
+    long long totalLength = 0;
+    for (size_t i = 0; i < g_blastSearch->m_blastQueries.m_queries.size(); ++i)
+    {
+        BlastQuery * query = g_blastSearch->m_blastQueries.m_queries[i];
+        if (query->getSequenceType() != sequenceType || query->getLength() == 0)
+            continue;
+        queries.push_back(query);
+        totalLength += query->getLength();
+    }
+
+    QString prefix = (sequenceType == NUCLEOTIDE) ? "nucl" : "prot";
+    std::vector<BlastShard> shards(shardCount);
+    long long lengthBefore = 0;
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        int shardIndex = int(lengthBefore * shardCount / std::max(1LL, totalLength));
+        shards[shardIndex].queries.push_back(queries[i]);
+        lengthBefore += queries[i]->getLength();
+    }
+
+    for (int i = 0; i < shardCount; ++i)
+    {
+        BlastShard & shard = shards[i];
+        if (shard.queries.empty())
+            continue;
+        QString shardName = prefix + "_shard_" + QString::number(i + 1);
+        shard.sequenceType = sequenceType;
+        shard.queryFilename = g_blastSearch->m_tempDirectory + shardName + "_queries.fasta";
+        shard.outputFilename = g_blastSearch->m_tempDirectory + shardName + "_output.tsv";
+        shard.errorFilename = g_blastSearch->m_tempDirectory + shardName + "_error.txt";
+        shard.process = 0;
+        shard.finished = false;
+        shard.hits.clear();
+        m_shards.push_back(shard);
     }
-    else {
-        blastCommand = m_tblastnCommand;
-        blastCommandArguments << g_blastSearch-> m_tempDirectory + "prot_queries.fasta";
+}
+
+
+bool RunBlastSearchWorker::writeShardQueryFile(const BlastShard & shard)
+{
+    QFile file(shard.queryFilename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    QTextStream out(&file);
+    for (size_t i = 0; i < shard.queries.size(); ++i)
+    {
+        out << ">" << shard.queries[i]->getName() << "\n";
+        out << shard.queries[i]->getSequence();
+        out << "\n";
     }
-    blastCommandArguments << "-db" << (g_blastSearch->m_tempDirectory + "all_nodes.fasta");
+    file.close();
+    return true;
+}
+
+
+//The BLAST output goes to files, not pipes, so a process never has to wait
+//for this thread to read its output while it waits on another shard.
+void RunBlastSearchWorker::startShard(BlastShard * shard, int threadsPerShard)
+{
+    QString blastCommand = (shard->sequenceType == NUCLEOTIDE) ? m_blastnCommand : m_tblastnCommand;
+    QStringList blastCommandArguments = { "-query", shard->queryFilename };
+    blastCommandArguments << "-db" << g_blastSearch->m_blastDatabase;
     blastCommandArguments << "-outfmt" << "6";
+    if (threadsPerShard > 1)
+        blastCommandArguments << "-num_threads" << QString::number(threadsPerShard);
     blastCommandArguments += m_parameters.split(" ", Qt::SkipEmptyParts);
 
-    g_blastSearch->m_blast = new QProcess();
-    g_blastSearch->m_blast->start(blastCommand, blastCommandArguments);
+    shard->process = new QProcess();
+    shard->process->setStandardOutputFile(shard->outputFilename);
+    shard->process->setStandardErrorFile(shard->errorFilename);
+    shard->process->start(blastCommand, blastCommandArguments);
+}
 
-    bool finished = g_blastSearch->m_blast->waitForFinished(-1);
 
-    if (g_blastSearch->m_blast->exitCode() != 0 || !finished)
+//This function waits for all of the shards to finish, parsing their output
+//as it comes and reporting each shard as it finishes.  If the search is
+//cancelled, all the shards still running are killed.  Each pass waits once
+//and then only polls the shards, so cancelling and progress don't slow down
+//as the number of shards grows.  A process's state is only updated when it
+//is waited on, hence the polls with no wait.
+void RunBlastSearchWorker::waitForShards()
+{
+    int finishedCount = 0;
+    int hitCount = 0;
+    int reportedHitCount = 0;
+    while (finishedCount < int(m_shards.size()))
     {
         if (g_blastSearch->m_cancelRunBlastSearch)
         {
-            m_error = "BLAST search cancelled.";
-            emit finishedSearch(m_error);
+            for (size_t i = 0; i < m_shards.size(); ++i)
+            {
+                if (!m_shards[i].finished)
+                {
+                    m_shards[i].process->kill();
+                    m_shards[i].process->waitForFinished(-1);
+                }
+            }
+            return;
         }
-        else
+
+        QThread::msleep(SHARD_WAIT_MILLISECONDS);
+        for (size_t i = 0; i < m_shards.size(); ++i)
         {
-            m_error = "There was a problem running the BLAST search";
-            QString stdErr = g_blastSearch->m_blast->readAllStandardError();
-            if (stdErr.length() > 0)
-                m_error += ":\n\n" + stdErr;
+            BlastShard & shard = m_shards[i];
+            if (shard.finished)
+                continue;
+            if (shard.process->state() == QProcess::NotRunning || shard.process->waitForFinished(0))
+            {
+                shard.finished = true;
+                hitCount += readShardOutput(&shard, true);
+                ++finishedCount;
+                emit setFinishedShardCount(finishedCount);
+            }
             else
-                m_error += ".";
-            emit finishedSearch(m_error);
+                hitCount += readShardOutput(&shard, false);
+        }
+
+        if (hitCount != reportedHitCount)
+        {
+            reportedHitCount = hitCount;
+            emit setProgressMessage("Running BLAST search...\n" + QString::number(hitCount) +
+                                    (hitCount == 1 ? " hit" : " hits") + " found so far");
         }
-        *success = false;
-        return "";
     }
+}
 
-    QString blastOutput = g_blastSearch->m_blast->readAllStandardOutput();
-    g_blastSearch->m_blast->deleteLater();
-    g_blastSearch->m_blast = 0;
 
-    *success = true;
-    return blastOutput;
+//This function parses whatever the shard's BLAST process has written since
+//the last call, keeping any incomplete last line for next time.  It returns
+//the number of new hits.
+int RunBlastSearchWorker::readShardOutput(BlastShard * shard, bool finished)
+{
+    if (shard->outputFile.isNull())
+    {
+        shard->outputFile.reset(new QFile(shard->outputFilename));
+        if (!shard->outputFile->open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        {
+            shard->outputFile.reset();
+            return 0;
+        }
+    }
+
+    shard->partialLine += shard->outputFile->readAll();
+    if (finished && !shard->partialLine.isEmpty() && !shard->partialLine.endsWith('\n'))
+        shard->partialLine += '\n';
+
+    int hitsBefore = int(shard->hits.size());
+    BlastHit hit;
+    const char * data = shard->partialLine.constData();
+    int lineStart = 0;
+    while (true)
+    {
+        int lineEnd = shard->partialLine.indexOf('\n', lineStart);
+        if (lineEnd == -1)
+            break;
+        if (g_blastSearch->makeHitFromBlastLine(data + lineStart, lineEnd - lineStart, &hit))
+            shard->hits.push_back(hit);
+        lineStart = lineEnd + 1;
+    }
+    shard->partialLine.remove(0, lineStart);
+
+    if (finished)
+        shard->outputFile.reset();
+    return int(shard->hits.size()) - hitsBefore;
+}
+
+
+//This function returns an error for the first shard that failed, or an empty
+//string if they all succeeded.
+QString RunBlastSearchWorker::getShardError()
+{
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        QProcess * process = m_shards[i].process;
+        if (process->exitStatus() == QProcess::NormalExit && process->exitCode() == 0 &&
+                process->error() == QProcess::UnknownError)
+            continue;
+
+        QString error = "There was a problem running the BLAST search";
+        QFile file(m_shards[i].errorFilename);
+        QString stdErr;
+        if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+            stdErr = file.readAll();
+        if (stdErr.length() > 0)
+            error += ":\n\n" + stdErr;
+        else
+            error += ".";
+        return error;
+    }
+    return "";
+}
+
+
+void RunBlastSearchWorker::deleteShards()
+{
+    for (size_t i = 0; i < m_shards.size(); ++i)
+    {
+        delete m_shards[i].process;
+        m_shards[i].outputFile.reset();
+        QFile::remove(m_shards[i].queryFilename);
+        QFile::remove(m_shards[i].outputFilename);
+        QFile::remove(m_shards[i].errorFilename);
+    }
+    m_shards.clear();
 }
@@ -22,12 +22,40 @@
 #include <QObject>
 #include <QProcess>
 #include <QString>
+#include <vector>
+#include <QFile>
+#include <QByteArray>
+#include <QSharedPointer>
 #include "../program/globals.h"
+#include "blasthit.h"
+
+class BlastQuery;
+
+//This is one part of a BLAST search: a contiguous block of the queries of one
+//type, searched by its own blastn or tblastn process.
+struct BlastShard
+{
+    SequenceType sequenceType;
+    std::vector<BlastQuery *> queries;
+    QString queryFilename;
+    QString outputFilename;
+    QString errorFilename;
+    QProcess * process;
+    bool finished;
+    QSharedPointer<QFile> outputFile;
+    QByteArray partialLine;
+    std::vector<BlastHit> hits;
+};
 
 //This class carries out the task of running blastn and/or
-//tblastn.
+//tblastn, or the built-in aligner in their place.
 //It is a separate class because when run from the GUI, this
 //process takes place in a separate thread.
+//The queries are split into shards which are searched by concurrent BLAST
+//processes, one per thread (g_settings->threads).  Each shard's output is
+//parsed into hits as it is written, so it is never held in full.  The hits
+//are added in shard order, which is the query order, so the result doesn't
+//depend on which shard finishes first.
 
 class RunBlastSearchWorker : public QObject
 {
@@ -41,12 +69,24 @@ private:
     QString m_blastnCommand;
     QString m_tblastnCommand;
     QString m_parameters;
-    QString runOneBlastSearch(SequenceType sequenceType, bool * success);
+    std::vector<BlastShard> m_shards;
+
+    void makeShards();
+    void addShards(SequenceType sequenceType, int shardCount);
+    bool writeShardQueryFile(const BlastShard & shard);
+    void startShard(BlastShard * shard, int threadsPerShard);
+    void waitForShards();
+    int readShardOutput(BlastShard * shard, bool finished);
+    QString getShardError();
+    void deleteShards();
 
 public slots:
     void runBlastSearch();
 
 signals:
+    void setShardCount(int count);
+    void setFinishedShardCount(int count);
+    void setProgressMessage(QString message);
     void finishedSearch(QString error);
 };
 
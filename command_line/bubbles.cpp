@@ -0,0 +1,150 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "bubbles.h"
+#include "commoncommandlinefunctions.h"
+#include "../program/settings.h"
+#include "../graph/assemblygraph.h"
+#include "../graph/debruijnnode.h"
+#include "../graph/superbubblefinder.h"
+
+int bandageBubbles(QStringList arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (checkForHelp(arguments))
+    {
+        printBubblesUsage(&out, false);
+        return 0;
+    }
+
+    if (checkForHelpAll(arguments))
+    {
+        printBubblesUsage(&out, true);
+        return 0;
+    }
+
+    if (arguments.size() < 1)
+    {
+        printBubblesUsage(&err, false);
+        return 1;
+    }
+
+    QString graphFilename = arguments.at(0);
+    arguments.pop_front();
+
+    if (!checkIfFileExists(graphFilename))
+    {
+        outputText("Bandage error: " + graphFilename + " does not exist.", &err);
+        return 1;
+    }
+
+    QString error = checkForInvalidBubblesOptions(arguments);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    bool loadSuccess = g_assemblyGraph->loadGraphFromFile(graphFilename);
+    if (!loadSuccess)
+    {
+        outputText("Bandage error: could not load " + graphFilename, &err);
+        return 1;
+    }
+
+    parseBubblesOptions(arguments);
+
+    int truncatedSearchCount = 0;
+    std::vector<Superbubble> superbubbles = g_assemblyGraph->findSuperbubbles(&truncatedSearchCount);
+    if (truncatedSearchCount > 0)
+        outputText("Bandage warning: " + QString::number(truncatedSearchCount) +
+                   (truncatedSearchCount == 1 ? " bubble search" : " bubble searches") +
+                   " stopped at the maximum bubble size of " + QString::number(int(g_settings->maxBubbleNodes)) +
+                   " nodes, so any larger bubbles are not reported. Use --maxbubble to search further.", &err);
+
+    out << "Entrance\tExit\tInternal node count\tShortest path length (bp)\tLongest path length (bp)\tInternal nodes\n";
+    for (size_t i = 0; i < superbubbles.size(); ++i)
+    {
+        const Superbubble * superbubble = &superbubbles[i];
+
+        QStringList internalNodeNames;
+        for (size_t j = 0; j < superbubble->internalNodes.size(); ++j)
+            internalNodeNames << superbubble->internalNodes[j]->getName();
+
+        out << superbubble->entrance->getName() << "\t" << superbubble->exit->getName() << "\t"
+            << int(superbubble->internalNodes.size()) << "\t"
+            << superbubble->shortestPathLength << "\t" << superbubble->longestPathLength << "\t"
+            << internalNodeNames.join(",") << "\n";
+    }
+
+    return 0;
+}
+
+
+void printBubblesUsage(QTextStream * out, bool all)
+{
+    QStringList text;
+
+    text << "Bandage bubbles finds the bubbles (superbubbles) in a graph: regions that split from one node (the entrance) and rejoin at another (the exit), with no dead ends or cycles in between. Each bubble is only reported for one strand. The results are output (to stdout) as a tab-delimited table of bubbles, with the shortest and longest path lengths through each bubble including its entrance and exit.";
+    text << "";
+    text << "The search from each possible entrance stops once it has taken in more nodes than the maximum bubble size, so the search time grows with that size, and bubbles larger than it are not found. A warning is given (to stderr) when any search stops there.";
+    text << "";
+    text << "Usage:    Bandage bubbles <graph> [options]";
+    text << "";
+    text << "Positional parameters:";
+    text << "<graph>             A graph file of any type supported by Bandage";
+    text << "";
+    text << "Options:  --maxbubble <int>   The largest bubble to find, in nodes " + getRangeAndDefault(g_settings->maxBubbleNodes);
+    text << "--threads <int>     Number of threads to use, one connected component per thread " + getRangeAndDefault(g_settings->threads);
+    text << "";
+
+    getCommonHelp(&text);
+    if (all)
+        getSettingsUsage(&text);
+    getOnlineHelpMessage(&text);
+
+    outputText(text, out);
+}
+
+
+
+QString checkForInvalidBubblesOptions(QStringList arguments)
+{
+    QString error = checkOptionForInt("--maxbubble", &arguments, g_settings->maxBubbleNodes, false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForInt("--threads", &arguments, g_settings->threads, false);
+    if (error.length() > 0) return error;
+
+    return checkForInvalidOrExcessSettings(&arguments);
+}
+
+
+
+void parseBubblesOptions(QStringList arguments)
+{
+    if (isOptionPresent("--maxbubble", &arguments))
+        g_settings->maxBubbleNodes = getIntOption("--maxbubble", &arguments);
+
+    if (isOptionPresent("--threads", &arguments))
+        g_settings->threads = getIntOption("--threads", &arguments);
+
+    parseSettings(arguments);
+}
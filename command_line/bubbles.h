@@ -16,19 +16,15 @@
 //along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
 
 
-#ifndef TABLEWIDGETITEMSHOWN_H
-#define TABLEWIDGETITEMSHOWN_H
+#ifndef BUBBLES_H
+#define BUBBLES_H
 
-#include <QTableWidgetItem>
+#include <QStringList>
+#include <QTextStream>
 
-class TableWidgetItemShown : public QTableWidgetItem
-{
-public:
-    TableWidgetItemShown(bool shown);
+int bandageBubbles(QStringList arguments);
+void printBubblesUsage(QTextStream * out, bool all);
+QString checkForInvalidBubblesOptions(QStringList arguments);
+void parseBubblesOptions(QStringList arguments);
 
-    bool m_shown;
-
-    virtual bool operator<(QTableWidgetItem const &other) const;
-};
-
-#endif // TABLEWIDGETITEMSHOWN_H
+#endif // BUBBLES_H
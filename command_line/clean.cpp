@@ -0,0 +1,165 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "clean.h"
+#include "commoncommandlinefunctions.h"
+#include "../program/settings.h"
+#include "../graph/assemblygraph.h"
+#include "../graph/graphcleaner.h"
+
+int bandageClean(QStringList arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (checkForHelp(arguments))
+    {
+        printCleanUsage(&out, false);
+        return 0;
+    }
+
+    if (checkForHelpAll(arguments))
+    {
+        printCleanUsage(&out, true);
+        return 0;
+    }
+
+    if (arguments.size() < 2)
+    {
+        printCleanUsage(&err, false);
+        return 1;
+    }
+
+    QString inputFilename = arguments.at(0);
+    arguments.pop_front();
+
+    if (!checkIfFileExists(inputFilename))
+    {
+        outputText("Bandage error: " + inputFilename + " does not exist", &err);
+        return 1;
+    }
+
+    QString outputFilename = arguments.at(0);
+    arguments.pop_front();
+    if (!outputFilename.endsWith(".gfa"))
+        outputFilename += ".gfa";
+
+    QString error = checkForInvalidCleanOptions(arguments);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    bool loadSuccess = g_assemblyGraph->loadGraphFromFile(inputFilename);
+    if (!loadSuccess)
+    {
+        outputText("Bandage error: could not load " + inputFilename, &err);
+        return 1;
+    }
+
+    parseCleanOptions(arguments);
+
+    GraphCleaner graphCleaner(g_assemblyGraph);
+    graphCleaner.clipTips(g_settings->cleanMaxTipLength);
+    graphCleaner.pruneLowDepth(g_settings->cleanMinRelativeDepth);
+    graphCleaner.removeSmallComponents(g_settings->cleanMinComponentLength);
+    graphCleaner.deleteRemovedNodesAndEdges();
+    if (g_settings->cleanMergeUnitigs)
+        graphCleaner.mergeUnitigs();
+
+    bool success = g_assemblyGraph->saveEntireGraphToGfa(outputFilename);
+    if (!success)
+    {
+        err << "Bandage was unable to save the graph file." << Qt::endl;
+        return 1;
+    }
+
+    std::vector<GraphCleaningPass> passes = graphCleaner.getPasses();
+    out << "Pass\tNodes removed\tEdges removed\tLength removed (bp)\n";
+    for (size_t i = 0; i < passes.size(); ++i)
+        out << passes[i].name << "\t" << passes[i].nodesRemoved << "\t"
+            << passes[i].edgesRemoved << "\t" << passes[i].lengthRemoved << "\n";
+
+    return 0;
+}
+
+
+void printCleanUsage(QTextStream * out, bool all)
+{
+    QStringList text;
+
+    text << "Bandage clean takes an input graph and saves a cleaned copy in GFA format. It clips short tips, prunes low depth nodes and edges, removes small connected components and then merges unitigs. A table of what each pass removed is output to stdout.";
+    text << "";
+    text << "The removal passes only mark nodes and edges, and each pass sees what the earlier ones have removed. Everything marked is then removed from the graph in a single step, before unitigs are merged.";
+    text << "";
+    text << "Usage:    Bandage clean <inputgraph> <outputgraph> [options]";
+    text << "";
+    text << "Positional parameters:";
+    text << "<inputgraph>        A graph file of any type supported by Bandage";
+    text << "<outputgraph>       The filename for the GFA graph to be made (if it does not end in '.gfa', that extension will be added)";
+    text << "";
+    text << "Options:  --tiplen <int>      Clip dead end tips shorter than this, 0 = off " + getRangeAndDefault(g_settings->cleanMaxTipLength);
+    text << "--reldepth <float>  Remove nodes with a depth below this fraction of the median depth, and edges between nodes whose depths differ by more than this fraction, 0 = off " + getRangeAndDefault(g_settings->cleanMinRelativeDepth);
+    text << "--complen <int>     Remove connected components with less than this total length, 0 = off " + getRangeAndDefault(g_settings->cleanMinComponentLength);
+    text << "--nomerge           Do not merge unitigs after the removal passes";
+    text << "";
+
+    getCommonHelp(&text);
+    if (all)
+        getSettingsUsage(&text);
+    getOnlineHelpMessage(&text);
+
+    outputText(text, out);
+}
+
+
+
+QString checkForInvalidCleanOptions(QStringList arguments)
+{
+    QString error = checkOptionForInt("--tiplen", &arguments, g_settings->cleanMaxTipLength, false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForFloat("--reldepth", &arguments, g_settings->cleanMinRelativeDepth, false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForInt("--complen", &arguments, g_settings->cleanMinComponentLength, false);
+    if (error.length() > 0) return error;
+
+    checkOptionWithoutValue("--nomerge", &arguments);
+
+    return checkForInvalidOrExcessSettings(&arguments);
+}
+
+
+
+void parseCleanOptions(QStringList arguments)
+{
+    if (isOptionPresent("--tiplen", &arguments))
+        g_settings->cleanMaxTipLength = getIntOption("--tiplen", &arguments);
+
+    if (isOptionPresent("--reldepth", &arguments))
+        g_settings->cleanMinRelativeDepth = getFloatOption("--reldepth", &arguments);
+
+    if (isOptionPresent("--complen", &arguments))
+        g_settings->cleanMinComponentLength = getIntOption("--complen", &arguments);
+
+    g_settings->cleanMergeUnitigs = !isOptionPresent("--nomerge", &arguments);
+
+    parseSettings(arguments);
+}
@@ -16,21 +16,15 @@
 //along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
 
 
-#ifndef TABLEWIDGETITEMNAME_H
-#define TABLEWIDGETITEMNAME_H
+#ifndef CLEAN_H
+#define CLEAN_H
 
-#include <QTableWidgetItem>
+#include <QStringList>
+#include <QTextStream>
 
-class BlastQuery;
+int bandageClean(QStringList arguments);
+void printCleanUsage(QTextStream * out, bool all);
+QString checkForInvalidCleanOptions(QStringList arguments);
+void parseCleanOptions(QStringList arguments);
 
-class TableWidgetItemName : public QTableWidgetItem
-{
-public:
-    TableWidgetItemName(BlastQuery * query);
-    BlastQuery * getQuery() const {return m_query;}
-
-private:
-    BlastQuery * m_query;
-};
-
-#endif // TABLEWIDGETITEMNAME_H
+#endif // CLEAN_H
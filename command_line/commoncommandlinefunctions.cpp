@@ -135,10 +135,16 @@ void getSettingsUsage(QStringList * text)
     *text << "--depvallow <float> Low depth value " + getRangeAndDefault(g_settings->lowDepthValue, "auto");
     *text << "--depvalhi <float>  High depth value " + getRangeAndDefault(g_settings->highDepthValue, "auto");
     *text << "";
+    *text << "Contiguity";
+    *text << dashes;
+    *text << "--contsteps <int>   The number of node steps to search when determining contiguity " + getRangeAndDefault(g_settings->contiguitySearchSteps);
+    *text << "";
     *text << "BLAST search";
     *text << dashes;
     *text << "--query <fastafile> A FASTA file of either nucleotide or protein sequences to be used as BLAST queries (default: none)";
     *text << "--blastp <param>    Parameters to be used by blastn and tblastn when conducting a BLAST search in Bandage (default: none). Format BLAST parameters exactly as they would be used for blastn/tblastn on the command line, and enclose them in quotes.";
+    *text << "--aligner <aligner> Program used for the BLAST search, from the following options: blast, internal (default: blast). The internal aligner needs no BLAST installation and searches for protein queries in a six-frame translation of the graph.";
+    *text << "--dbcache <dir>     Directory in which to keep BLAST databases, so later searches on the same graph reuse the database instead of rebuilding it (default: none)";
     *text << "--alfilter <int>    Alignment length filter for BLAST hits. Hits with shorter alignments will be excluded " + getRangeAndDefault(g_settings->blastAlignmentLengthFilter);
     *text << "--qcfilter <float>  Query coverage filter for BLAST hits. Hits with less coverage will be excluded " + getRangeAndDefault(g_settings->blastQueryCoverageFilter);
     *text << "--ifilter <float>   Identity filter for BLAST hits. Hits with less identity will be excluded " + getRangeAndDefault(g_settings->blastIdentityFilter);
@@ -212,7 +218,7 @@ void outputText(QStringList text, QTextStream * out)
 //also displays these.
 void getGraphScopeOptions(QStringList * text)
 {
-    *text << "--scope <scope>     Graph scope, from one of the following options: entire, aroundnodes, aroundblast, depthrange (default: entire)";
+    *text << "--scope <scope>     Graph scope, from one of the following options: entire, aroundnodes, aroundblast, depthrange, bubbles (default: entire)";
     *text << "--nodes <list>      A comma-separated list of starting nodes for the aroundnodes scope (default: none)";
     *text << "--partial           Use partial node name matching (default: exact node name matching)";
     *text << "--distance <int>    The number of node steps away to draw for the aroundnodes and aroundblast scopes " + getRangeAndDefault(g_settings->nodeDistance);
@@ -229,7 +235,7 @@ QString checkForInvalidOrExcessSettings(QStringList * arguments)
     QStringList argumentsCopy = *arguments;
 
     QStringList validScopeOptions;
-    validScopeOptions << "entire" << "aroundnodes" << "aroundblast" << "depthrange";
+    validScopeOptions << "entire" << "aroundnodes" << "aroundblast" << "depthrange" << "bubbles";
     QString error;
 
     error = checkOptionForString("--scope", arguments, validScopeOptions); if (error.length() > 0) return error;
@@ -241,6 +247,10 @@ QString checkForInvalidOrExcessSettings(QStringList * arguments)
     if (isOptionPresent("--query", arguments) && g_memory->commandLineCommand == NO_COMMAND) return "A graph must be given (e.g. via Bandage load) to use the --query option";
     error = checkOptionForFile("--query", arguments); if (error.length() > 0) return error;
     error = checkOptionForString("--blastp", arguments, QStringList(), "blastn/tblastn parameters"); if (error.length() > 0) return error;
+    QStringList validAlignerOptions;
+    validAlignerOptions << "blast" << "internal";
+    error = checkOptionForString("--aligner", arguments, validAlignerOptions); if (error.length() > 0) return error;
+    error = checkOptionForString("--dbcache", arguments, QStringList(), "a directory"); if (error.length() > 0) return error;
     checkOptionWithoutValue("--double", arguments);
     error = checkOptionForFloat("--nodelen", arguments, g_settings->manualNodeLengthPerMegabase, false); if (error.length() > 0) return error;
     error = checkOptionForFloat("--minnodlen", arguments, g_settings->minimumNodeLength, false); if (error.length() > 0) return error;
@@ -283,6 +293,7 @@ QString checkForInvalidOrExcessSettings(QStringList * arguments)
     error = checkOptionForColour("--depcollow", arguments); if (error.length() > 0) return error;
     error = checkOptionForColour("--depcolhi", arguments); if (error.length() > 0) return error;
     error = checkTwoOptionsForFloats("--depvallow", "--depvalhi", arguments, g_settings->lowDepthValue, g_settings->highDepthValue, true); if (error.length() > 0) return error;
+    error = checkOptionForInt("--contsteps", arguments, g_settings->contiguitySearchSteps, false); if (error.length() > 0) return error;
     error = checkOptionForInt("--pathnodes", arguments, g_settings->maxQueryPathNodes, false); if (error.length() > 0) return error;
     error = checkOptionForFloat("--minpatcov", arguments, g_settings->minQueryCoveredByPath, false); if (error.length() > 0) return error;
     error = checkOptionForFloat("--minhitcov", arguments, g_settings->minQueryCoveredByHits, true); if (error.length() > 0) return error;
@@ -415,6 +426,10 @@ void parseSettings(QStringList arguments)
         g_settings->blastQueryFilename = getStringOption("--query", &arguments);
     if (isOptionPresent("--blastp", &arguments))
         g_settings->blastSearchParameters = getStringOption("--blastp", &arguments);
+    if (isOptionPresent("--aligner", &arguments))
+        g_settings->blastAligner = getBlastAlignerOption("--aligner", &arguments);
+    if (isOptionPresent("--dbcache", &arguments))
+        g_settings->blastDatabaseCacheDirectory = getStringOption("--dbcache", &arguments);
 
     g_settings->doubleMode = isOptionPresent("--double", &arguments);
 
@@ -528,6 +543,9 @@ void parseSettings(QStringList arguments)
         g_settings->autoDepthValue = false;
     }
 
+    if (isOptionPresent("--contsteps", &arguments))
+        g_settings->contiguitySearchSteps = getIntOption("--contsteps", &arguments);
+
     if (isOptionPresent("--pathnodes", &arguments))
         g_settings->maxQueryPathNodes = getIntOption("--pathnodes", &arguments);
     if (isOptionPresent("--minpatcov", &arguments))
@@ -1057,6 +1075,17 @@ NodeColourScheme getColourSchemeOption(QString option, QStringList * arguments)
 }
 
 
+BlastAligner getBlastAlignerOption(QString option, QStringList * arguments)
+{
+    QString alignerString = getStringOption(option, arguments).toLower();
+    if (alignerString == "internal")
+        return BUILT_IN_ALIGNER;
+
+    //BLAST is the default.
+    return BLAST_PROGRAMS;
+}
+
+
 GraphScope getGraphScopeOption(QString option, QStringList * arguments)
 {
     int optionIndex = arguments->indexOf(option);
@@ -1076,6 +1105,8 @@ GraphScope getGraphScopeOption(QString option, QStringList * arguments)
         return AROUND_BLAST_HITS;
     else if (scopeString == "depthrange")
         return DEPTH_RANGE;
+    else if (scopeString == "bubbles")
+        return BUBBLES;
 
     //Entire graph scope is the default.
     return WHOLE_GRAPH;
@@ -1291,7 +1322,13 @@ bool isCommand(QString text)
             text.startsWith("info   ") ||
             text.startsWith("image   ") ||
             text.startsWith("querypaths   ") ||
-            text.startsWith("reduce   ");
+            text.startsWith("reduce   ") ||
+            text.startsWith("contiguity   ") ||
+            text.startsWith("filter   ") ||
+            text.startsWith("shortestpath ") ||
+            text.startsWith("bubbles   ") ||
+            text.startsWith("clean   ") ||
+            text.startsWith("find   ");
 }
 
 
@@ -61,6 +61,7 @@ SciNot getSciNotOption(QString option, QStringList * arguments);
 QColor getColourOption(QString option, QStringList * arguments);
 NodeColourScheme getColourSchemeOption(QString option, QStringList * arguments);
 GraphScope getGraphScopeOption(QString option, QStringList * arguments);
+BlastAligner getBlastAlignerOption(QString option, QStringList * arguments);
 QString getStringOption(QString option, QStringList * arguments);
 
 QString checkForInvalidOrExcessSettings(QStringList * arguments);
@@ -0,0 +1,170 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "contiguity.h"
+#include "commoncommandlinefunctions.h"
+#include "../program/settings.h"
+#include "../graph/assemblygraph.h"
+#include "../graph/debruijnnode.h"
+
+int bandageContiguity(QStringList arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (checkForHelp(arguments))
+    {
+        printContiguityUsage(&out, false);
+        return 0;
+    }
+
+    if (checkForHelpAll(arguments))
+    {
+        printContiguityUsage(&out, true);
+        return 0;
+    }
+
+    if (arguments.size() < 2)
+    {
+        printContiguityUsage(&err, false);
+        return 1;
+    }
+
+    QString graphFilename = arguments.at(0);
+    arguments.pop_front();
+
+    if (!checkIfFileExists(graphFilename))
+    {
+        outputText("Bandage error: " + graphFilename + " does not exist.", &err);
+        return 1;
+    }
+
+    QString nodesList = arguments.at(0);
+    arguments.pop_front();
+
+    QString error = checkForInvalidContiguityOptions(arguments);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    bool loadSuccess = g_assemblyGraph->loadGraphFromFile(graphFilename);
+    if (!loadSuccess)
+    {
+        outputText("Bandage error: could not load " + graphFilename, &err);
+        return 1;
+    }
+
+    parseContiguityOptions(arguments);
+
+    std::vector<QString> nodesNotInGraph;
+    std::vector<DeBruijnNode *> startingNodes = g_assemblyGraph->getNodesFromString(nodesList,
+                                                                                    g_settings->startingNodesExactMatch,
+                                                                                    &nodesNotInGraph);
+    if (nodesNotInGraph.size() > 0)
+    {
+        outputText("Bandage error: " + g_assemblyGraph->generateNodesNotFoundErrorMessage(nodesNotInGraph,
+                                                                                          g_settings->startingNodesExactMatch), &err);
+        return 1;
+    }
+    if (startingNodes.size() == 0)
+    {
+        outputText("Bandage error: no starting nodes were given.", &err);
+        return 1;
+    }
+
+    g_assemblyGraph->resetNodeContiguityStatus();
+    for (size_t i = 0; i < startingNodes.size(); ++i)
+        startingNodes[i]->determineContiguity();
+    g_assemblyGraph->m_contiguitySearchDone = true;
+
+    out << "Node\tContiguity\n";
+    QMapIterator<QString, DeBruijnNode*> i(g_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        ContiguityStatus status = node->getContiguityStatus();
+        if (status == NOT_CONTIGUOUS)
+            continue;
+        out << node->getName() << "\t" << getContiguityStatusString(status) << "\n";
+    }
+
+    return 0;
+}
+
+
+void printContiguityUsage(QTextStream * out, bool all)
+{
+    QStringList text;
+
+    text << "Bandage contiguity determines which nodes are contiguous with one or more starting nodes, as done by the 'Determine contiguity' button in the Bandage GUI. The results are output (to stdout) as a tab-delimited table of each node with a contiguity status other than not contiguous.";
+    text << "";
+    text << "Usage:    Bandage contiguity <graph> <nodes> [options]";
+    text << "";
+    text << "Positional parameters:";
+    text << "<graph>             A graph file of any type supported by Bandage";
+    text << "<nodes>             A comma-separated list of starting nodes (use --partial for partial node name matching)";
+    text << "";
+
+    int nextLineIndex = text.size();
+    getCommonHelp(&text);
+    text[nextLineIndex] = "Options:  " + text[nextLineIndex];
+
+    if (all)
+        getSettingsUsage(&text);
+    else
+    {
+        text << "Settings: --contsteps <int>   The number of node steps to search when determining contiguity " + getRangeAndDefault(g_settings->contiguitySearchSteps);
+        text << "--partial           Use partial node name matching (default: exact node name matching)";
+    }
+    text << "";
+    getOnlineHelpMessage(&text);
+
+    outputText(text, out);
+}
+
+
+
+QString checkForInvalidContiguityOptions(QStringList arguments)
+{
+    return checkForInvalidOrExcessSettings(&arguments);
+}
+
+
+
+//This function parses the command line options.  It assumes that the options
+//have already been checked for correctness.
+void parseContiguityOptions(QStringList arguments)
+{
+    parseSettings(arguments);
+}
+
+
+QString getContiguityStatusString(ContiguityStatus status)
+{
+    switch (status)
+    {
+    case STARTING: return "starting";
+    case CONTIGUOUS_STRAND_SPECIFIC: return "contiguous";
+    case CONTIGUOUS_EITHER_STRAND: return "contiguous (either strand)";
+    case MAYBE_CONTIGUOUS: return "maybe contiguous";
+    default: return "not contiguous";
+    }
+}
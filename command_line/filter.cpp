@@ -0,0 +1,140 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "filter.h"
+#include "commoncommandlinefunctions.h"
+#include "../program/settings.h"
+#include "../graph/assemblygraph.h"
+
+int bandageFilter(QStringList arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (checkForHelp(arguments))
+    {
+        printFilterUsage(&out, false);
+        return 0;
+    }
+
+    if (checkForHelpAll(arguments))
+    {
+        printFilterUsage(&out, true);
+        return 0;
+    }
+
+    if (arguments.size() < 2)
+    {
+        printFilterUsage(&err, false);
+        return 1;
+    }
+
+    QString inputFilename = arguments.at(0);
+    arguments.pop_front();
+
+    if (!checkIfFileExists(inputFilename))
+    {
+        outputText("Bandage error: " + inputFilename + " does not exist", &err);
+        return 1;
+    }
+
+    QString outputFilename = arguments.at(0);
+    arguments.pop_front();
+    if (!outputFilename.endsWith(".gfa"))
+        outputFilename += ".gfa";
+
+    QString error = checkForInvalidFilterOptions(arguments);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    bool loadSuccess = g_assemblyGraph->loadGraphFromFile(inputFilename);
+    if (!loadSuccess)
+    {
+        outputText("Bandage error: could not load " + inputFilename, &err);
+        return 1;
+    }
+
+    parseFilterOptions(arguments);
+
+    g_assemblyGraph->filterNodes(g_settings->filterMinNodeLength, g_settings->filterMinNodeDepth);
+
+    bool success = g_assemblyGraph->saveEntireGraphToGfa(outputFilename);
+    if (!success)
+    {
+        err << "Bandage was unable to save the graph file." << Qt::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+void printFilterUsage(QTextStream * out, bool all)
+{
+    QStringList text;
+
+    text << "Bandage filter takes an input graph and saves a copy with short and/or low depth nodes removed. The saved graph will be in GFA format.";
+    text << "";
+    text << "All of the nodes are removed in a single pass, along with any edges that connect to them.";
+    text << "";
+    text << "Usage:    Bandage filter <inputgraph> <outputgraph> [options]";
+    text << "";
+    text << "Positional parameters:";
+    text << "<inputgraph>        A graph file of any type supported by Bandage";
+    text << "<outputgraph>       The filename for the GFA graph to be made (if it does not end in '.gfa', that extension will be added)";
+    text << "";
+    text << "Options:  --filtlen <int>     Remove nodes shorter than this length " + getRangeAndDefault(g_settings->filterMinNodeLength);
+    text << "--filtdepth <float> Remove nodes with a depth lower than this " + getRangeAndDefault(g_settings->filterMinNodeDepth);
+    text << "";
+
+    getCommonHelp(&text);
+    if (all)
+        getSettingsUsage(&text);
+    getOnlineHelpMessage(&text);
+
+    outputText(text, out);
+}
+
+
+
+QString checkForInvalidFilterOptions(QStringList arguments)
+{
+    QString error = checkOptionForInt("--filtlen", &arguments, g_settings->filterMinNodeLength, false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForFloat("--filtdepth", &arguments, g_settings->filterMinNodeDepth, false);
+    if (error.length() > 0) return error;
+
+    return checkForInvalidOrExcessSettings(&arguments);
+}
+
+
+
+void parseFilterOptions(QStringList arguments)
+{
+    if (isOptionPresent("--filtlen", &arguments))
+        g_settings->filterMinNodeLength = getIntOption("--filtlen", &arguments);
+
+    if (isOptionPresent("--filtdepth", &arguments))
+        g_settings->filterMinNodeDepth = getFloatOption("--filtdepth", &arguments);
+
+    parseSettings(arguments);
+}
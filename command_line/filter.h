@@ -16,20 +16,15 @@
 //along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
 
 
-#include "tablewidgetitemshown.h"
+#ifndef FILTER_H
+#define FILTER_H
 
-TableWidgetItemShown::TableWidgetItemShown(bool shown) :
-    QTableWidgetItem(), m_shown(shown)
-{
-}
+#include <QStringList>
+#include <QTextStream>
 
+int bandageFilter(QStringList arguments);
+void printFilterUsage(QTextStream * out, bool all);
+QString checkForInvalidFilterOptions(QStringList arguments);
+void parseFilterOptions(QStringList arguments);
 
-
-bool TableWidgetItemShown::operator<(QTableWidgetItem const &other) const
-{
-    TableWidgetItemShown const *item = dynamic_cast<TableWidgetItemShown const*>(&other);
-    if (item)
-        return !m_shown && item->m_shown;
-    else
-        return QTableWidgetItem::operator<(other);
-}
+#endif // FILTER_H
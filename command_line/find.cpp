@@ -0,0 +1,187 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "find.h"
+#include "commoncommandlinefunctions.h"
+#include "../program/settings.h"
+#include "../graph/assemblygraph.h"
+#include "../graph/debruijnnode.h"
+#include "../graph/sequenceindex.h"
+
+int bandageFind(QStringList arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (checkForHelp(arguments))
+    {
+        printFindUsage(&out, false);
+        return 0;
+    }
+
+    if (checkForHelpAll(arguments))
+    {
+        printFindUsage(&out, true);
+        return 0;
+    }
+
+    if (arguments.size() < 2)
+    {
+        printFindUsage(&err, false);
+        return 1;
+    }
+
+    QString graphFilename = arguments.at(0);
+    arguments.pop_front();
+
+    if (!checkIfFileExists(graphFilename))
+    {
+        outputText("Bandage error: " + graphFilename + " does not exist.", &err);
+        return 1;
+    }
+
+    QString queriesFilename = arguments.at(0);
+    arguments.pop_front();
+
+    if (!checkIfFileExists(queriesFilename))
+    {
+        outputText("Bandage error: " + queriesFilename + " does not exist.", &err);
+        return 1;
+    }
+
+    QString error = checkForInvalidFindOptions(arguments);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    bool loadSuccess = g_assemblyGraph->loadGraphFromFile(graphFilename);
+    if (!loadSuccess)
+    {
+        outputText("Bandage error: could not load " + graphFilename, &err);
+        return 1;
+    }
+
+    parseFindOptions(arguments);
+
+    std::vector<QString> queryNames;
+    std::vector<QByteArray> querySequences;
+    AssemblyGraph::readFastaOrFastqFile(queriesFilename, &queryNames, &querySequences);
+    if (querySequences.empty())
+    {
+        outputText("Bandage error: no sequences could be read from " + queriesFilename, &err);
+        return 1;
+    }
+
+    const SequenceIndex * sequenceIndex = g_assemblyGraph->getSequenceIndex();
+    std::vector< std::vector<SequenceHit> > results = sequenceIndex->findSequences(querySequences,
+                                                                                   g_settings->findMaxMismatches,
+                                                                                   g_settings->threads);
+
+    int truncatedJunctionCount = sequenceIndex->getTruncatedJunctionCount();
+    if (truncatedJunctionCount > 0)
+        outputText("Bandage warning: " + QString::number(truncatedJunctionCount) +
+                   (truncatedJunctionCount == 1 ? " junction has" : " junctions have") +
+                   " too many paths to index them all, so queries which run over them may not be found.", &err);
+
+    out << "Query\tNodes\tStart\tEnd\tMismatches\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        for (size_t j = 0; j < results[i].size(); ++j)
+        {
+            const SequenceHit * hit = &results[i][j];
+
+            QStringList nodeNames;
+            for (size_t k = 0; k < hit->nodes.size(); ++k)
+                nodeNames << hit->nodes[k]->getName();
+
+            out << queryNames[i] << "\t" << nodeNames.join(",") << "\t"
+                << hit->startPosition << "\t" << hit->endPosition << "\t" << hit->mismatches << "\n";
+        }
+    }
+
+    return 0;
+}
+
+
+void printFindUsage(QTextStream * out, bool all)
+{
+    QStringList text;
+
+    text << "Bandage find finds where each query sequence occurs in a graph, without using BLAST. Queries can run over edges from one node to the next, and both strands are searched. The results are output (to stdout) as a tab-delimited table with one line per hit: the nodes the hit passes through, its start position in the first node and its end position in the last node (1-based, inclusive). Nothing is output for queries which are not found.";
+    text << "";
+    text << "The graph's sequences are indexed by their minimizers (for each window of w consecutive k-mers, the one with the smallest hash), so a query must be at least k + w - 1 bases long to be sure of being found. A query with mismatches is found if at least one of its windows has none. In tangled regions, only the first 64 paths are indexed past the end of any one node, so a query which runs over such a junction may be missed. A warning is given (to stderr) when this happens.";
+    text << "";
+    text << "Usage:    Bandage find <graph> <queries> [options]";
+    text << "";
+    text << "Positional parameters:";
+    text << "<graph>             A graph file of any type supported by Bandage";
+    text << "<queries>           A FASTA or FASTQ file of query sequences";
+    text << "";
+    text << "Options:  --mismatches <int>  The most mismatches allowed in a hit (no insertions or deletions) " + getRangeAndDefault(g_settings->findMaxMismatches);
+    text << "--indexk <int>      The k-mer size of the sequence index " + getRangeAndDefault(g_settings->sequenceIndexKmerSize);
+    text << "--indexw <int>      The number of k-mers in each minimizer window " + getRangeAndDefault(g_settings->sequenceIndexWindowSize);
+    text << "--threads <int>     Number of threads to use when building the index and finding queries " + getRangeAndDefault(g_settings->threads);
+    text << "";
+
+    getCommonHelp(&text);
+    if (all)
+        getSettingsUsage(&text);
+    getOnlineHelpMessage(&text);
+
+    outputText(text, out);
+}
+
+
+
+QString checkForInvalidFindOptions(QStringList arguments)
+{
+    QString error = checkOptionForInt("--mismatches", &arguments, g_settings->findMaxMismatches, false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForInt("--indexk", &arguments, g_settings->sequenceIndexKmerSize, false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForInt("--indexw", &arguments, g_settings->sequenceIndexWindowSize, false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForInt("--threads", &arguments, g_settings->threads, false);
+    if (error.length() > 0) return error;
+
+    return checkForInvalidOrExcessSettings(&arguments);
+}
+
+
+
+void parseFindOptions(QStringList arguments)
+{
+    if (isOptionPresent("--mismatches", &arguments))
+        g_settings->findMaxMismatches = getIntOption("--mismatches", &arguments);
+
+    if (isOptionPresent("--indexk", &arguments))
+        g_settings->sequenceIndexKmerSize = getIntOption("--indexk", &arguments);
+
+    if (isOptionPresent("--indexw", &arguments))
+        g_settings->sequenceIndexWindowSize = getIntOption("--indexw", &arguments);
+
+    if (isOptionPresent("--threads", &arguments))
+        g_settings->threads = getIntOption("--threads", &arguments);
+
+    parseSettings(arguments);
+}
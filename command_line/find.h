@@ -16,10 +16,15 @@
 //along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
 
 
-#include "tablewidgetitemname.h"
-#include "../blast/blastquery.h"
+#ifndef FIND_H
+#define FIND_H
 
-TableWidgetItemName::TableWidgetItemName(BlastQuery * query) :
-    QTableWidgetItem(query->getName()), m_query(query)
-{
-}
+#include <QStringList>
+#include <QTextStream>
+
+int bandageFind(QStringList arguments);
+void printFindUsage(QTextStream * out, bool all);
+QString checkForInvalidFindOptions(QStringList arguments);
+void parseFindOptions(QStringList arguments);
+
+#endif // FIND_H
@@ -28,6 +28,7 @@
 #include <QSvgGenerator>
 #include <QDir>
 #include "../blast/blastsearch.h"
+#include "../graph/graphcoarsener.h"
 
 int bandageImage(QStringList arguments)
 {
@@ -92,12 +93,13 @@ int bandageImage(QStringList arguments)
 
     int width = 0;
     int height = 0;
+    int levelOfDetail = 0;
 
     //Since frame rate performance doesn't matter for a fixed image, set the
     //default node outline to a nonzero value.
     g_settings->outlineThickness = 0.3;
 
-    parseImageOptions(arguments, &width, &height);
+    parseImageOptions(arguments, &width, &height, &levelOfDetail);
 
     //For Bandage image, it is necessary to position node labels at the
     //centre of the node, not the visible centre(s).  This is because there
@@ -110,6 +112,12 @@ int bandageImage(QStringList arguments)
 
     bool blastUsed = isOptionPresent("--query", &arguments);
 
+    if (levelOfDetail > 0 && (blastUsed || g_settings->graphScope == AROUND_BLAST_HITS))
+    {
+        outputText("Bandage error: BLAST hits can only be drawn at level 0", &err);
+        return 1;
+    }
+
     if (blastUsed)
     {
         if (!createBlastTempDirectory())
@@ -127,6 +135,17 @@ int bandageImage(QStringList arguments)
         }
     }
 
+    //Above level 0, a coarsened copy of the graph is drawn in its place.
+    if (levelOfDetail > 0)
+    {
+        GraphCoarsener graphCoarsener(g_assemblyGraph.data());
+        graphCoarsener.setLevel(levelOfDetail);
+        QSharedPointer<AssemblyGraph> levelGraph(new AssemblyGraph());
+        graphCoarsener.buildLevelGraph(levelGraph.data());
+        g_assemblyGraph->cleanUp();
+        g_assemblyGraph = levelGraph;
+    }
+
     QString errorTitle;
     QString errorMessage;
     std::vector<DeBruijnNode *> startingNodes = g_assemblyGraph->getStartingNodes(&errorTitle, &errorMessage,
@@ -237,6 +256,7 @@ void printImageUsage(QTextStream * out, bool all)
     text << "Options:  --height <int>      Image height (default: 1000)";
     text << "--width <int>       Image width (default: not set)";
     text << "--color <file>       csv file with 2 column first the node name second the node color";
+    text << "--level <int>       Level of detail: 0 draws the graph as it is, 1 collapses non-branching chains, 2 also collapses simple bubbles and 3 and above join neighbouring nodes into clusters (0 to 20, default: 0)";
     text << "";
     text << "If only height or width is set, the other will be determined automatically. If both are set, the image will be exactly that size.";
     text << "";
@@ -257,6 +277,9 @@ QString checkForInvalidImageOptions(QStringList arguments)
     error = checkOptionForInt("--width", &arguments, IntSetting(0, 1, 32767), false);
     if (error.length() > 0) return error;
 
+    error = checkOptionForInt("--level", &arguments, IntSetting(0, 0, 20), false);
+    if (error.length() > 0) return error;
+
     error = checkOptionForString("--colors", &arguments, QStringList(), "a path of csv file");
     if (error.length() > 0) return error;
 
@@ -268,7 +291,7 @@ QString checkForInvalidImageOptions(QStringList arguments)
 
 //This function parses the command line options.  It assumes that the options
 //have already been checked for correctness.
-void parseImageOptions(QStringList arguments, int * width, int * height)
+void parseImageOptions(QStringList arguments, int * width, int * height, int * levelOfDetail)
 {
     if (isOptionPresent("--height", &arguments))
         *height = getIntOption("--height", &arguments);
@@ -276,6 +299,9 @@ void parseImageOptions(QStringList arguments, int * width, int * height)
     if (isOptionPresent("--width", &arguments))
         *width = getIntOption("--width", &arguments);
 
+    if (isOptionPresent("--level", &arguments))
+        *levelOfDetail = getIntOption("--level", &arguments);
+
     parseSettings(arguments);
 }
 
@@ -0,0 +1,622 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "querybatch.h"
+#include "querypaths.h"
+#include "commoncommandlinefunctions.h"
+#include "../program/settings.h"
+#include "../graph/assemblygraph.h"
+#include "../blast/blastsearch.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QSet>
+#include <algorithm>
+
+static const int MAX_QUERY_BATCH_JOBS = 256;
+
+//A worker process reports each finished graph with a line starting with
+//this, followed by an error (empty if all went well).  Anything else the
+//worker prints to stdout is ignored.
+static const QByteArray WORKER_REPORT_PREFIX = "querybatch\t";
+
+//While waiting for the worker processes, each busy one is checked this often
+//for a report.
+static const int WORKER_WAIT_MILLISECONDS = 100;
+
+//This is one worker process and the manifest entry it is searching (-1 if it
+//is waiting for one).
+struct QueryBatchWorker
+{
+    QProcess * process;
+    int entryIndex;
+    QByteArray partialOutput;
+};
+
+static int runQueryBatchWorkers(const std::vector<QueryBatchEntry> & entries,
+                                const std::vector<int> & pendingEntries, int jobs,
+                                QStringList workerArguments, QString workDirectory,
+                                QFile * tableFile, QFile * progressFile,
+                                QTextStream * out, QTextStream * err);
+static int runQueryBatchWorker(const std::vector<QueryBatchEntry> & entries,
+                               QString workDirectory);
+static bool finishQueryBatchEntry(const QueryBatchEntry & entry, QString partFilename,
+                                  QString error, QFile * tableFile, QFile * progressFile,
+                                  QTextStream * out, QTextStream * err);
+static QString getPartFilename(QString workDirectory, int entryIndex);
+static QString getProgressKey(const QueryBatchEntry & entry);
+static QString getTimeString();
+
+
+//Graphs are searched in separate processes, as each search needs the whole
+//program (the graph, the BLAST search and the settings) to itself.  With
+//more than one job, this process hands the graphs out to long-running worker
+//processes (this same program, run with --worker), so a worker which
+//searches many graphs for the same queries only reads them once.  With one
+//job, the graphs are simply searched here, one after the other.
+int bandageQueryBatch(QStringList arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (checkForHelp(arguments))
+    {
+        printQueryBatchUsage(&out, false);
+        return 0;
+    }
+
+    if (checkForHelpAll(arguments))
+    {
+        printQueryBatchUsage(&out, true);
+        return 0;
+    }
+
+    if (arguments.size() < 2)
+    {
+        printQueryBatchUsage(&err, false);
+        return 1;
+    }
+
+    QString manifestFilename = arguments.at(0);
+    arguments.pop_front();
+    if (!checkIfFileExists(manifestFilename))
+    {
+        outputText("Bandage error: " + manifestFilename + " does not exist.", &err);
+        return 1;
+    }
+
+    //The queries come from the manifest, so the --query option isn't allowed.
+    if (isOptionPresent("--query", &arguments))
+    {
+        err << "Bandage error: the --query option cannot be used with Bandage querybatch." << Qt::endl;
+        return 1;
+    }
+
+    QString outputPrefix = arguments.at(0);
+    QString tableFilename = outputPrefix + ".tsv";
+    QString progressFilename = outputPrefix + "_progress.txt";
+    QString workDirectory = outputPrefix + "_parts";
+    arguments.pop_front();
+
+    QString error = checkForInvalidQueryBatchOptions(arguments);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    //The workers are given the same options, apart from the ones which only
+    //matter to this process.
+    QStringList workerArguments;
+    workerArguments << "querybatch" << manifestFilename << outputPrefix << "--worker";
+    for (int i = 0; i < arguments.size(); ++i)
+    {
+        if (arguments[i] == "--resume")
+            continue;
+        if (arguments[i] == "--jobs")
+        {
+            ++i;
+            continue;
+        }
+        workerArguments << arguments[i];
+    }
+
+    int jobs = 1;
+    bool resume = false;
+    bool worker = false;
+    parseQueryBatchOptions(arguments, &jobs, &resume, &worker);
+
+    std::vector<QueryBatchEntry> entries;
+    error = loadQueryBatchManifest(manifestFilename, &entries);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    if (worker)
+        return runQueryBatchWorker(entries, workDirectory);
+
+    QFile tableFile(tableFilename);
+    if (tableFile.exists() && !resume)
+    {
+        outputText("Bandage error: " + tableFilename + " already exists.  Use --resume to continue an unfinished batch.", &err);
+        return 1;
+    }
+
+    //When resuming, the progress file gives the finished graphs and the size
+    //of the table after the last of them.  Anything after that in the table
+    //came from a graph which was interrupted, so it is removed.
+    QSet<QString> finishedEntries;
+    qint64 tableSize = 0;
+    QFile progressFile(progressFilename);
+    if (resume && tableFile.exists() && progressFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        while (!progressFile.atEnd())
+        {
+            QString line = QString::fromUtf8(progressFile.readLine());
+            if (line.endsWith("\n"))
+                line.chop(1);
+            QStringList parts = line.split("\t");
+            if (parts.size() != 3)
+                continue;
+            tableSize = parts[0].toLongLong();
+            finishedEntries.insert(parts[1] + "\t" + parts[2]);
+        }
+        progressFile.close();
+    }
+    if (tableFile.exists())
+        tableFile.resize(tableSize);
+
+    QIODevice::OpenMode progressMode = QIODevice::WriteOnly | QIODevice::Text;
+    progressMode |= finishedEntries.isEmpty() ? QIODevice::Truncate : QIODevice::Append;
+    if (!tableFile.open(QIODevice::WriteOnly | QIODevice::Append) || !progressFile.open(progressMode))
+    {
+        outputText("Bandage error: could not write " + tableFilename + " and " + progressFilename, &err);
+        return 1;
+    }
+    if (tableSize == 0)
+    {
+        QTextStream tableOut(&tableFile);
+        writeQueryPathsTableHeader(&tableOut, true, false);
+        tableOut.flush();
+    }
+
+    std::vector<int> pendingEntries;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (!finishedEntries.contains(getProgressKey(entries[i])))
+            pendingEntries.push_back(int(i));
+    }
+    int alreadyFinishedCount = int(entries.size() - pendingEntries.size());
+
+    if (!QDir().mkpath(workDirectory))
+    {
+        outputText("Bandage error: could not create " + workDirectory, &err);
+        return 1;
+    }
+
+    QDateTime startTime = QDateTime::currentDateTime();
+    out << Qt::endl << getTimeString() << "Searching " << pendingEntries.size() << " of "
+        << entries.size() << " graphs..." << Qt::endl;
+
+    int failedCount = 0;
+    if (jobs == 1)
+    {
+        if (!createBlastTempDirectory())
+        {
+            err << "Error creating temporary directory for BLAST files" << Qt::endl;
+            return 1;
+        }
+
+        QueryBatchQueryCache queryCache;
+        for (size_t i = 0; i < pendingEntries.size(); ++i)
+        {
+            const QueryBatchEntry & entry = entries[pendingEntries[i]];
+            QString partFilename = getPartFilename(workDirectory, pendingEntries[i]);
+            QString entryError = runQueryBatchEntry(entry, &queryCache, partFilename);
+            if (!finishQueryBatchEntry(entry, partFilename, entryError, &tableFile,
+                                       &progressFile, &out, &err))
+                ++failedCount;
+        }
+
+        deleteBlastTempDirectory();
+    }
+    else
+        failedCount = runQueryBatchWorkers(entries, pendingEntries, jobs, workerArguments,
+                                           workDirectory, &tableFile, &progressFile, &out, &err);
+
+    QDir().rmdir(workDirectory);
+
+    out << Qt::endl << "Results:      " + tableFilename << Qt::endl;
+
+    out << Qt::endl << "Summary: Graphs in manifest:            " << entries.size() << Qt::endl;
+    if (alreadyFinishedCount > 0)
+        out << "         Graphs finished before resuming: " << alreadyFinishedCount << Qt::endl;
+    out << "         Graphs searched:               " << int(pendingEntries.size()) - failedCount << Qt::endl;
+    out << "         Graphs failed:                 " << failedCount << Qt::endl;
+
+    out << Qt::endl << "Elapsed time: " << getElapsedTime(startTime, QDateTime::currentDateTime()) << Qt::endl;
+
+    if (failedCount > 0)
+    {
+        outputText("Bandage error: not all graphs could be searched.  Use --resume to try the failed graphs again.", &err);
+        return 1;
+    }
+    return 0;
+}
+
+
+void printQueryBatchUsage(QTextStream * out, bool all)
+{
+    QStringList text;
+
+    text << "Bandage querybatch runs Bandage querypaths for each graph and queries file in a manifest and combines the results in one tab-delimited file, with a column for the graph.";
+    text << "";
+    text << "Usage:    Bandage querybatch <manifest> <output_prefix> [options]";
+    text << "";
+    text << "Positional parameters:";
+    text << "<manifest>          A tab-delimited file with a graph file and a FASTA file of queries on each line, and optionally a name for the graph (file paths are relative to the manifest's directory)";
+    text << "<output_prefix>     The output file prefix (used to create the '.tsv' output file and a '_progress.txt' file of the finished graphs)";
+    text << "";
+    text << "Options:  --jobs <int>        Number of graphs to search at once, each in its own process " + getRangeAndDefault(1, MAX_QUERY_BATCH_JOBS, 1);
+    text << "--resume            Continue an unfinished batch, skipping the graphs which have already finished";
+    text << "--threads <int>     Number of threads to use for each graph's BLAST search (one BLAST process per thread) and when searching for query paths " + getRangeAndDefault(g_settings->threads);
+    text << "";
+
+    getCommonHelp(&text);
+    if (all)
+        getSettingsUsage(&text);
+    getOnlineHelpMessage(&text);
+
+    outputText(text, out);
+}
+
+
+
+//The --worker option isn't in the usage, as it is only used by Bandage
+//querybatch to start its own worker processes.
+QString checkForInvalidQueryBatchOptions(QStringList arguments)
+{
+    checkOptionWithoutValue("--resume", &arguments);
+    checkOptionWithoutValue("--worker", &arguments);
+
+    QString error = checkOptionForInt("--jobs", &arguments, IntSetting(1, 1, MAX_QUERY_BATCH_JOBS), false);
+    if (error.length() > 0) return error;
+
+    error = checkOptionForInt("--threads", &arguments, g_settings->threads, false);
+    if (error.length() > 0) return error;
+
+    return checkForInvalidOrExcessSettings(&arguments);
+}
+
+
+
+void parseQueryBatchOptions(QStringList arguments, int * jobs, bool * resume,
+                            bool * worker)
+{
+    if (isOptionPresent("--jobs", &arguments))
+        *jobs = getIntOption("--jobs", &arguments);
+
+    int resumeIndex = arguments.indexOf("--resume");
+    *resume = (resumeIndex > -1);
+
+    int workerIndex = arguments.indexOf("--worker");
+    *worker = (workerIndex > -1);
+
+    if (isOptionPresent("--threads", &arguments))
+        g_settings->threads = getIntOption("--threads", &arguments);
+
+    parseSettings(arguments);
+}
+
+
+
+//Each line of the manifest has a graph file and a queries file, separated by
+//a tab, and can have a name for the graph in a third column (the graph file
+//as given is used if not).  Relative paths are relative to the manifest's
+//directory.  Blank lines and lines starting with '#' are skipped.
+//This function returns an error, or an empty string if all went well.
+QString loadQueryBatchManifest(QString manifestFilename,
+                               std::vector<QueryBatchEntry> * entries)
+{
+    entries->clear();
+
+    QFile manifestFile(manifestFilename);
+    if (!manifestFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        return "could not read " + manifestFilename;
+
+    QDir manifestDirectory = QFileInfo(manifestFilename).absoluteDir();
+    QSet<QString> progressKeys;
+    QTextStream in(&manifestFile);
+    int lineNumber = 0;
+    while (!in.atEnd())
+    {
+        QString line = in.readLine();
+        ++lineNumber;
+        if (line.trimmed().isEmpty() || line.startsWith("#"))
+            continue;
+
+        QString lineDescription = "line " + QString::number(lineNumber) + " of " + manifestFilename;
+        QStringList parts = line.split("\t");
+        if (parts.size() < 2 || parts.size() > 3)
+            return lineDescription + " does not have a graph file and a queries file separated by a tab.";
+
+        QueryBatchEntry entry;
+        entry.graphFilename = QDir::cleanPath(manifestDirectory.absoluteFilePath(parts[0].trimmed()));
+        entry.queriesFilename = QDir::cleanPath(manifestDirectory.absoluteFilePath(parts[1].trimmed()));
+        entry.graphName = parts[0].trimmed();
+        if (parts.size() == 3 && parts[2].trimmed() != "")
+            entry.graphName = parts[2].trimmed();
+
+        if (!checkIfFileExists(entry.graphFilename))
+            return lineDescription + ": " + entry.graphFilename + " does not exist.";
+        if (!checkIfFileExists(entry.queriesFilename))
+            return lineDescription + ": " + entry.queriesFilename + " does not exist.";
+
+        QString progressKey = getProgressKey(entry);
+        if (progressKeys.contains(progressKey))
+            return lineDescription + " repeats an earlier graph and queries file.";
+        progressKeys.insert(progressKey);
+
+        entries->push_back(entry);
+    }
+
+    if (entries->empty())
+        return manifestFilename + " does not list any graphs.";
+    return "";
+}
+
+
+
+//This function loads one graph, searches it for its queries and saves the
+//query paths to a table with a graph column.  The queries are only read from
+//their file if they aren't already in the cache.  A BLAST temp directory
+//must have been made first.
+//It returns an error, or an empty string if all went well.
+QString runQueryBatchEntry(const QueryBatchEntry & entry,
+                           QueryBatchQueryCache * queryCache,
+                           QString tableFilename)
+{
+    g_blastSearch->cleanUp();
+    g_assemblyGraph->cleanUp();
+    if (!g_assemblyGraph->loadGraphFromFile(entry.graphFilename))
+        return "could not load " + entry.graphFilename;
+
+    QueryBatchQueryCache::iterator queries = queryCache->find(entry.queriesFilename);
+    if (queries == queryCache->end())
+    {
+        queries = queryCache->insert(entry.queriesFilename, QueryBatchQueries());
+        AssemblyGraph::readFastaOrFastqFile(entry.queriesFilename, &queries->names,
+                                            &queries->sequences);
+    }
+
+    g_settings->blastQueryFilename = entry.queriesFilename;
+    QString blastError = g_blastSearch->doAutoBlastSearch(queries->names, queries->sequences);
+    if (blastError != "")
+        return blastError;
+
+    QFile tableFile(tableFilename);
+    if (!tableFile.open(QIODevice::WriteOnly))
+        return "could not write " + tableFilename;
+    QTextStream tableOut(&tableFile);
+
+    QList<QString> pathSequenceIDs;
+    QList<QByteArray> pathSequences;
+    QList<QString> hitSequenceIDs;
+    QList<QByteArray> hitSequences;
+    writeQueryPathsTableHeader(&tableOut, true, false);
+    writeQueryPathsTableRows(&tableOut, entry.graphName, false, false,
+                             &pathSequenceIDs, &pathSequences,
+                             &hitSequenceIDs, &hitSequences);
+    return "";
+}
+
+
+
+//This function hands out the graphs to the worker processes until they have
+//all been searched, starting up to one worker per job.  A worker whose
+//process stops is replaced before it is given another graph.
+//It returns the number of graphs which failed.
+static int runQueryBatchWorkers(const std::vector<QueryBatchEntry> & entries,
+                                const std::vector<int> & pendingEntries, int jobs,
+                                QStringList workerArguments, QString workDirectory,
+                                QFile * tableFile, QFile * progressFile,
+                                QTextStream * out, QTextStream * err)
+{
+    std::vector<QueryBatchWorker> workers(std::min(jobs, int(pendingEntries.size())));
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        workers[i].process = 0;
+        workers[i].entryIndex = -1;
+    }
+
+    int failedCount = 0;
+    size_t nextPendingEntry = 0;
+    int busyWorkerCount = 0;
+    while (nextPendingEntry < pendingEntries.size() || busyWorkerCount > 0)
+    {
+        for (size_t i = 0; i < workers.size(); ++i)
+        {
+            QueryBatchWorker & worker = workers[i];
+            if (worker.entryIndex == -1)
+            {
+                if (nextPendingEntry == pendingEntries.size())
+                    continue;
+                if (worker.process == 0 || worker.process->state() == QProcess::NotRunning)
+                {
+                    delete worker.process;
+                    worker.process = new QProcess();
+                    worker.process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+                    worker.process->start(QCoreApplication::applicationFilePath(), workerArguments);
+                    worker.partialOutput.clear();
+                }
+                worker.entryIndex = pendingEntries[nextPendingEntry];
+                ++nextPendingEntry;
+                ++busyWorkerCount;
+                worker.process->write(QByteArray::number(worker.entryIndex) + "\n");
+                continue;
+            }
+
+            //The process's state is checked before its output is read, so a
+            //report written just before it stopped isn't missed.
+            bool stopped = (worker.process->state() == QProcess::NotRunning);
+            if (!stopped)
+                worker.process->waitForReadyRead(WORKER_WAIT_MILLISECONDS);
+            worker.partialOutput += worker.process->readAllStandardOutput();
+
+            bool reported = false;
+            QString entryError;
+            int lineEnd;
+            while ((lineEnd = worker.partialOutput.indexOf('\n')) != -1)
+            {
+                QByteArray line = worker.partialOutput.left(lineEnd);
+                worker.partialOutput.remove(0, lineEnd + 1);
+                if (!line.startsWith(WORKER_REPORT_PREFIX))
+                    continue;
+                reported = true;
+                entryError = QString::fromUtf8(line.mid(WORKER_REPORT_PREFIX.size()));
+            }
+            if (!reported && stopped)
+            {
+                reported = true;
+                if (worker.process->error() == QProcess::FailedToStart)
+                    entryError = "could not start a worker process";
+                else
+                    entryError = "the worker process stopped unexpectedly";
+            }
+            if (!reported)
+                continue;
+
+            if (!finishQueryBatchEntry(entries[worker.entryIndex],
+                                       getPartFilename(workDirectory, worker.entryIndex),
+                                       entryError, tableFile, progressFile, out, err))
+                ++failedCount;
+            worker.entryIndex = -1;
+            --busyWorkerCount;
+        }
+    }
+
+    //Closing a worker's input tells it there are no more graphs.
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        if (workers[i].process == 0)
+            continue;
+        workers[i].process->closeWriteChannel();
+        workers[i].process->waitForFinished(-1);
+        delete workers[i].process;
+    }
+
+    return failedCount;
+}
+
+
+//A worker reads manifest entry numbers from stdin, one per line, and reports
+//on stdout as it finishes each.  It keeps going until its input is closed.
+static int runQueryBatchWorker(const std::vector<QueryBatchEntry> & entries,
+                               QString workDirectory)
+{
+    QTextStream in(stdin);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (!createBlastTempDirectory())
+    {
+        err << "Error creating temporary directory for BLAST files" << Qt::endl;
+        return 1;
+    }
+
+    QueryBatchQueryCache queryCache;
+    while (true)
+    {
+        QString line = in.readLine();
+        if (line.isNull())
+            break;
+
+        bool isInt = false;
+        int entryIndex = line.trimmed().toInt(&isInt);
+        QString error;
+        if (!isInt || entryIndex < 0 || entryIndex >= int(entries.size()))
+            error = "unknown manifest entry " + line.trimmed();
+        else
+            error = runQueryBatchEntry(entries[entryIndex], &queryCache,
+                                       getPartFilename(workDirectory, entryIndex));
+
+        out << WORKER_REPORT_PREFIX << error.simplified() << "\n" << Qt::flush;
+    }
+
+    deleteBlastTempDirectory();
+    return 0;
+}
+
+
+//This function adds a searched graph's table to the combined table and then
+//records the graph in the progress file, so a resumed batch will skip it.
+//It returns false if the graph failed.
+static bool finishQueryBatchEntry(const QueryBatchEntry & entry, QString partFilename,
+                                  QString error, QFile * tableFile, QFile * progressFile,
+                                  QTextStream * out, QTextStream * err)
+{
+    QFile partFile(partFilename);
+    if (error == "" && !partFile.open(QIODevice::ReadOnly))
+        error = "could not read " + partFilename;
+    if (error != "")
+    {
+        partFile.remove();
+        *err << getTimeString() << "Bandage error: " << entry.graphName << ": " << error << Qt::endl;
+        return false;
+    }
+
+    //The part's header line is left out, as the combined table has its own.
+    QByteArray rows = partFile.readAll();
+    rows.remove(0, rows.indexOf('\n') + 1);
+    int pathCount = rows.count('\n');
+    partFile.remove();
+
+    tableFile->write(rows);
+    tableFile->flush();
+    progressFile->write(QByteArray::number(tableFile->size()) + "\t" + getProgressKey(entry).toUtf8() + "\n");
+    progressFile->flush();
+
+    *out << getTimeString() << entry.graphName << ": " << pathCount
+         << (pathCount == 1 ? " query path" : " query paths") << Qt::endl;
+    return true;
+}
+
+
+static QString getPartFilename(QString workDirectory, int entryIndex)
+{
+    return workDirectory + "/" + QString::number(entryIndex) + ".tsv";
+}
+
+
+//A graph is identified in the progress file by its graph and queries files,
+//so a resumed batch still works if the manifest has been reordered.
+static QString getProgressKey(const QueryBatchEntry & entry)
+{
+    return entry.graphFilename + "\t" + entry.queriesFilename;
+}
+
+
+static QString getTimeString()
+{
+    return "(" + QDateTime::currentDateTime().toString("dd MMM yyyy hh:mm:ss") + ") ";
+}
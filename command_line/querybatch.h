@@ -0,0 +1,58 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef QUERYBATCH_H
+#define QUERYBATCH_H
+
+#include <vector>
+#include <QStringList>
+#include <QTextStream>
+#include <QHash>
+#include <QByteArray>
+
+//This is one line of a querybatch manifest: a graph, the queries to search
+//for in it and the name used for the graph in the combined table.
+struct QueryBatchEntry
+{
+    QString graphFilename;
+    QString queriesFilename;
+    QString graphName;
+};
+
+//These are the queries read from one file.  They are kept so that a file
+//used for many graphs is only read once.
+struct QueryBatchQueries
+{
+    std::vector<QString> names;
+    std::vector<QByteArray> sequences;
+};
+
+typedef QHash<QString, QueryBatchQueries> QueryBatchQueryCache;
+
+int bandageQueryBatch(QStringList arguments);
+void printQueryBatchUsage(QTextStream * out, bool all);
+QString checkForInvalidQueryBatchOptions(QStringList arguments);
+void parseQueryBatchOptions(QStringList arguments, int * jobs, bool * resume,
+                            bool * worker);
+QString loadQueryBatchManifest(QString manifestFilename,
+                               std::vector<QueryBatchEntry> * entries);
+QString runQueryBatchEntry(const QueryBatchEntry & entry,
+                           QueryBatchQueryCache * queryCache,
+                           QString tableFilename);
+
+#endif // QUERYBATCH_H
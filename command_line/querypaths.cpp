@@ -137,26 +137,7 @@ int bandageQueryPaths(QStringList arguments)
     tableFile.open(QIODevice::WriteOnly | QIODevice::Text);
     QTextStream tableOut(&tableFile);
 
-    //Write the TSV header line.
-    tableOut << "Query\t"
-                "Path\t"
-                "Length\t"
-                "Query covered by path\t"
-                "Query covered by hits\t"
-                "Mean hit identity\t"
-                "Total hit mismatches\t"
-                "Total hit gap opens\t"
-                "Relative length\t"
-                "Length discrepancy\t"
-                "E-value product\t";
-
-    //If the user asked for a separate path sequence file, then the last column
-    //will be a reference to that sequence ID.  If not, the sequence will go in
-    //the table.
-    if (pathFasta)
-        tableOut << "Sequence ID\n";
-    else
-        tableOut << "Sequence\n";
+    writeQueryPathsTableHeader(&tableOut, false, pathFasta);
 
     //If a path sequence FASTA file is used, these will store the sequences
     //that will go there.
@@ -168,58 +149,9 @@ int bandageQueryPaths(QStringList arguments)
     QList<QString> hitSequenceIDs;
     QList<QByteArray> hitSequences;
 
-    for (size_t i = 0; i < g_blastSearch->m_blastQueries.m_queries.size(); ++i)
-    {
-        BlastQuery * query = g_blastSearch->m_blastQueries.m_queries[i];
-        QList<BlastQueryPath> queryPaths = query->getPaths();
-
-        for (int j = 0; j < queryPaths.size(); ++j)
-        {
-            BlastQueryPath queryPath = queryPaths[j];
-            Path path = queryPath.getPath();
-
-            tableOut << query->getName() << "\t";
-            tableOut << path.getString(true) << "\t";
-            tableOut << QString::number(path.getLength()) << "\t";
-            tableOut << QString::number(100.0 * queryPath.getPathQueryCoverage()) << "%\t";
-            tableOut << QString::number(100.0 * queryPath.getHitsQueryCoverage()) << "%\t";
-            tableOut << QString::number(queryPath.getMeanHitPercIdentity()) << "%\t";
-            tableOut << QString::number(queryPath.getTotalHitMismatches()) << "\t";
-            tableOut << QString::number(queryPath.getTotalHitGapOpens()) << "\t";
-            tableOut << QString::number(100.0 * queryPath.getRelativePathLength()) << "%\t";
-            tableOut << queryPath.getAbsolutePathLengthDifferenceString(false) << "\t";
-            tableOut << queryPath.getEvalueProduct().asString(false) << "\t";
-
-            //If we are using a separate file for the path sequences, save the
-            //sequence along with its ID to save later, and store the ID here.
-            //Otherwise, just include the sequence in this table.
-            QByteArray sequence = path.getPathSequence();
-            QString pathSequenceID = query->getName() + "_" + QString::number(j+1);
-            if (pathFasta)
-            {
-                pathSequenceIDs.push_back(pathSequenceID);
-                pathSequences.push_back(sequence);
-                tableOut << pathSequenceID << "\n";
-            }
-            else
-                tableOut << sequence << "\n";
-
-            //If we are also saving the hit sequences, save the hit sequence
-            //along with its ID to save later.
-            if (hitsFasta)
-            {
-                QList<BlastHit *> hits = queryPath.getHits();
-                for (int k = 0; k < hits.size(); ++k)
-                {
-                    BlastHit * hit = hits[k];
-                    QString hitSequenceID = pathSequenceID + "_" + QString::number(k+1);
-                    QByteArray hitSequence = hit->getNodeSequence();
-                    hitSequenceIDs.push_back(hitSequenceID);
-                    hitSequences.push_back(hitSequence);
-                }
-            }
-        }
-    }
+    writeQueryPathsTableRows(&tableOut, "", pathFasta, hitsFasta,
+                             &pathSequenceIDs, &pathSequences,
+                             &hitSequenceIDs, &hitSequences);
 
     //Write the path sequence FASTA file, if appropriate.
     if (pathFasta)
@@ -270,7 +202,7 @@ void printQueryPathsUsage(QTextStream * out, bool all)
 {
     QStringList text;
 
-    text << "Bandage querypaths searches for queries in the graph using BLAST and outputs the results to a tab-delimited file.";
+    text << "Bandage querypaths searches for queries in the graph using BLAST (or the built-in aligner, with --aligner internal) and outputs the results to a tab-delimited file.";
     text << "";
     text << "Usage:    Bandage querypaths <graph> <queries> <output_prefix> [options]";
     text << "";
@@ -281,6 +213,7 @@ void printQueryPathsUsage(QTextStream * out, bool all)
     text << "";
     text << "Options:  --pathfasta         Put all query path sequences in a multi-FASTA file, not in the TSV file";
     text << "--hitsfasta         Produce a multi-FASTA file of all BLAST hits in the query paths";
+    text << "--threads <int>     Number of threads to use for the BLAST search (one BLAST process per thread) and when searching for query paths " + getRangeAndDefault(g_settings->threads);
     text << "";
 
     getCommonHelp(&text);
@@ -298,7 +231,10 @@ QString checkForInvalidQueryPathsOptions(QStringList arguments)
     checkOptionWithoutValue("--pathfasta", &arguments);
     checkOptionWithoutValue("--hitsfasta", &arguments);
 
-    QString error = checkForInvalidOrExcessSettings(&arguments);
+    QString error = checkOptionForInt("--threads", &arguments, g_settings->threads, false);
+    if (error.length() > 0) return error;
+
+    error = checkForInvalidOrExcessSettings(&arguments);
     if (error.length() > 0) return error;
 
     return checkForInvalidOrExcessSettings(&arguments);
@@ -315,5 +251,105 @@ void parseQueryPathsOptions(QStringList arguments, bool * pathFasta,
     int hitsFastaIndex = arguments.indexOf("--hitsfasta");
     *hitsFasta = (hitsFastaIndex > -1);
 
+    if (isOptionPresent("--threads", &arguments))
+        g_settings->threads = getIntOption("--threads", &arguments);
+
     parseSettings(arguments);
 }
+
+
+
+//The table can start with a column for the graph, which Bandage querybatch
+//uses to combine the results of many graphs in one table.
+void writeQueryPathsTableHeader(QTextStream * tableOut, bool graphColumn, bool pathFasta)
+{
+    if (graphColumn)
+        *tableOut << "Graph\t";
+
+    *tableOut << "Query\t"
+                 "Path\t"
+                 "Length\t"
+                 "Query covered by path\t"
+                 "Query covered by hits\t"
+                 "Mean hit identity\t"
+                 "Total hit mismatches\t"
+                 "Total hit gap opens\t"
+                 "Relative length\t"
+                 "Length discrepancy\t"
+                 "E-value product\t";
+
+    //If the user asked for a separate path sequence file, then the last column
+    //will be a reference to that sequence ID.  If not, the sequence will go in
+    //the table.
+    if (pathFasta)
+        *tableOut << "Sequence ID\n";
+    else
+        *tableOut << "Sequence\n";
+}
+
+
+//This function writes one table row for each path of each query in the
+//current BLAST search.  If graphName isn't empty, it is put in a first
+//column.  Sequences for the FASTA files (if used) are added to the lists.
+void writeQueryPathsTableRows(QTextStream * tableOut, QString graphName,
+                              bool pathFasta, bool hitsFasta,
+                              QList<QString> * pathSequenceIDs,
+                              QList<QByteArray> * pathSequences,
+                              QList<QString> * hitSequenceIDs,
+                              QList<QByteArray> * hitSequences)
+{
+    for (size_t i = 0; i < g_blastSearch->m_blastQueries.m_queries.size(); ++i)
+    {
+        BlastQuery * query = g_blastSearch->m_blastQueries.m_queries[i];
+        QList<BlastQueryPath> queryPaths = query->getPaths();
+
+        for (int j = 0; j < queryPaths.size(); ++j)
+        {
+            BlastQueryPath queryPath = queryPaths[j];
+            Path path = queryPath.getPath();
+
+            if (graphName != "")
+                *tableOut << graphName << "\t";
+            *tableOut << query->getName() << "\t";
+            *tableOut << path.getString(true) << "\t";
+            *tableOut << QString::number(path.getLength()) << "\t";
+            *tableOut << QString::number(100.0 * queryPath.getPathQueryCoverage()) << "%\t";
+            *tableOut << QString::number(100.0 * queryPath.getHitsQueryCoverage()) << "%\t";
+            *tableOut << QString::number(queryPath.getMeanHitPercIdentity()) << "%\t";
+            *tableOut << QString::number(queryPath.getTotalHitMismatches()) << "\t";
+            *tableOut << QString::number(queryPath.getTotalHitGapOpens()) << "\t";
+            *tableOut << QString::number(100.0 * queryPath.getRelativePathLength()) << "%\t";
+            *tableOut << queryPath.getAbsolutePathLengthDifferenceString(false) << "\t";
+            *tableOut << queryPath.getEvalueProduct().asString(false) << "\t";
+
+            //If we are using a separate file for the path sequences, save the
+            //sequence along with its ID to save later, and store the ID here.
+            //Otherwise, just include the sequence in this table.
+            QByteArray sequence = path.getPathSequence();
+            QString pathSequenceID = query->getName() + "_" + QString::number(j+1);
+            if (pathFasta)
+            {
+                pathSequenceIDs->push_back(pathSequenceID);
+                pathSequences->push_back(sequence);
+                *tableOut << pathSequenceID << "\n";
+            }
+            else
+                *tableOut << sequence << "\n";
+
+            //If we are also saving the hit sequences, save the hit sequence
+            //along with its ID to save later.
+            if (hitsFasta)
+            {
+                int hitCount = queryPath.getHitIds().size();
+                for (int k = 0; k < hitCount; ++k)
+                {
+                    BlastHit hit = queryPath.getHit(k);
+                    QString hitSequenceID = pathSequenceID + "_" + QString::number(k+1);
+                    QByteArray hitSequence = hit.getNodeSequence();
+                    hitSequenceIDs->push_back(hitSequenceID);
+                    hitSequences->push_back(hitSequence);
+                }
+            }
+        }
+    }
+}
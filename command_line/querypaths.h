@@ -30,5 +30,12 @@ void printQueryPathsUsage(QTextStream * out, bool all);
 QString checkForInvalidQueryPathsOptions(QStringList arguments);
 void parseQueryPathsOptions(QStringList arguments, bool *pathFasta,
                             bool * hitsFasta);
+void writeQueryPathsTableHeader(QTextStream * tableOut, bool graphColumn, bool pathFasta);
+void writeQueryPathsTableRows(QTextStream * tableOut, QString graphName,
+                              bool pathFasta, bool hitsFasta,
+                              QList<QString> * pathSequenceIDs,
+                              QList<QByteArray> * pathSequences,
+                              QList<QString> * hitSequenceIDs,
+                              QList<QByteArray> * hitSequences);
 
 #endif // QUERYPATHS_H
@@ -0,0 +1,144 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shortestpath.h"
+#include "commoncommandlinefunctions.h"
+#include "../program/settings.h"
+#include "../graph/assemblygraph.h"
+#include "../graph/debruijnnode.h"
+#include "../graph/shortestpathfinder.h"
+
+int bandageShortestPath(QStringList arguments)
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if (checkForHelp(arguments))
+    {
+        printShortestPathUsage(&out, false);
+        return 0;
+    }
+
+    if (checkForHelpAll(arguments))
+    {
+        printShortestPathUsage(&out, true);
+        return 0;
+    }
+
+    if (arguments.size() < 3)
+    {
+        printShortestPathUsage(&err, false);
+        return 1;
+    }
+
+    QString graphFilename = arguments.at(0);
+    arguments.pop_front();
+
+    if (!checkIfFileExists(graphFilename))
+    {
+        outputText("Bandage error: " + graphFilename + " does not exist.", &err);
+        return 1;
+    }
+
+    QString startNodeName = arguments.at(0).simplified();
+    arguments.pop_front();
+    QString endNodeName = arguments.at(0).simplified();
+    arguments.pop_front();
+
+    QString error = checkForInvalidShortestPathOptions(arguments);
+    if (error.length() > 0)
+    {
+        outputText("Bandage error: " + error, &err);
+        return 1;
+    }
+
+    bool loadSuccess = g_assemblyGraph->loadGraphFromFile(graphFilename);
+    if (!loadSuccess)
+    {
+        outputText("Bandage error: could not load " + graphFilename, &err);
+        return 1;
+    }
+
+    parseShortestPathOptions(arguments);
+
+    if (!g_assemblyGraph->m_deBruijnGraphNodes.contains(startNodeName))
+    {
+        outputText("Bandage error: " + startNodeName + " is not a node in the graph (node names must include + or -)", &err);
+        return 1;
+    }
+    if (!g_assemblyGraph->m_deBruijnGraphNodes.contains(endNodeName))
+    {
+        outputText("Bandage error: " + endNodeName + " is not a node in the graph (node names must include + or -)", &err);
+        return 1;
+    }
+
+    ShortestPathFinder shortestPathFinder(g_assemblyGraph->m_deBruijnGraphNodes[startNodeName],
+                                          g_assemblyGraph->m_deBruijnGraphNodes[endNodeName]);
+    QList<Path> paths = shortestPathFinder.getShortestPaths(g_settings->shortestPathCount);
+
+    out << "Path\tLength (bp)\tNodes\n";
+    for (int i = 0; i < paths.size(); ++i)
+        out << paths[i].getString(false) << "\t" << paths[i].getLength() << "\t" << paths[i].getNodeCount() << "\n";
+
+    return 0;
+}
+
+
+void printShortestPathUsage(QTextStream * out, bool all)
+{
+    QStringList text;
+
+    text << "Bandage shortestpath finds the shortest paths from one node to another, where the length of a path is the length of its sequence. The results are output (to stdout) as a tab-delimited table of paths, shortest first. Nothing is output if there is no path between the nodes.";
+    text << "";
+    text << "Usage:    Bandage shortestpath <graph> <start> <end> [options]";
+    text << "";
+    text << "Positional parameters:";
+    text << "<graph>             A graph file of any type supported by Bandage";
+    text << "<start>             The node at the start of the paths, with its directionality (e.g. 5+)";
+    text << "<end>               The node at the end of the paths, with its directionality (e.g. 12-)";
+    text << "";
+    text << "Options:  --paths <int>       The number of paths to output. Paths after the first do not repeat any node " + getRangeAndDefault(g_settings->shortestPathCount);
+    text << "";
+
+    getCommonHelp(&text);
+    if (all)
+        getSettingsUsage(&text);
+    getOnlineHelpMessage(&text);
+
+    outputText(text, out);
+}
+
+
+
+QString checkForInvalidShortestPathOptions(QStringList arguments)
+{
+    QString error = checkOptionForInt("--paths", &arguments, g_settings->shortestPathCount, false);
+    if (error.length() > 0) return error;
+
+    return checkForInvalidOrExcessSettings(&arguments);
+}
+
+
+
+void parseShortestPathOptions(QStringList arguments)
+{
+    if (isOptionPresent("--paths", &arguments))
+        g_settings->shortestPathCount = getIntOption("--paths", &arguments);
+
+    parseSettings(arguments);
+}
@@ -48,7 +48,7 @@
 
 AssemblyGraph::AssemblyGraph() :
     m_kmer(0), m_contiguitySearchDone(false),
-    m_sequencesLoadedFromFasta(NOT_READY)
+    m_sequencesLoadedFromFasta(NOT_READY), m_truncatedBubbleSearchCount(0)
 {
     m_ogdfGraph = new ogdf::Graph();
     m_edgeArray = new ogdf::EdgeArray<double>(*m_ogdfGraph);
@@ -67,6 +67,8 @@ AssemblyGraph::~AssemblyGraph()
 
 void AssemblyGraph::cleanUp()
 {
+    m_editJournal.clear();
+
     QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
     while (i.hasNext())
     {
@@ -84,6 +86,10 @@ void AssemblyGraph::cleanUp()
     m_deBruijnGraphEdges.clear();
 
     m_contiguitySearchDone = false;
+    m_nodeNameIndex.clear();
+    m_nodeDepthIndex.clear();
+    m_graphStatistics.clear();
+    invalidateSequenceIndexes();
 
     clearGraphInfo();
 }
@@ -150,6 +156,17 @@ void AssemblyGraph::createDeBruijnEdge(QString node1Name, QString node2Name,
     node2->addEdge(forwardEdge);
     negNode1->addEdge(backwardEdge);
     negNode2->addEdge(backwardEdge);
+
+    m_graphStatistics.addEdge(forwardEdge);
+    invalidateSequenceIndexes();
+    m_editJournal.recordAddedEdge(forwardEdge);
+    if (!isOwnPair)
+    {
+        m_graphStatistics.addEdge(backwardEdge);
+        m_editJournal.recordAddedEdge(backwardEdge);
+    }
+    m_graphStatistics.updateDeadEnds(node1);
+    m_graphStatistics.updateDeadEnds(node2);
 }
 
 
@@ -342,78 +359,66 @@ void AssemblyGraph::resetAllNodeColours()
     }
 }
 
+//The drawn nodes' BLAST hit parts are cleared too, as they are made again
+//from the new hit pointers.  Every change to the shown hits or their colours
+//(e.g. a query's colour) comes through here.
 void AssemblyGraph::clearAllBlastHitPointers()
 {
     QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
     while (i.hasNext())
     {
         i.next();
-        i.value()->clearBlastHits();
+        DeBruijnNode * node = i.value();
+        node->clearBlastHits();
+        if (node->getGraphicsItemNode() != 0)
+            node->getGraphicsItemNode()->clearBlastHitPartsCache();
     }
 }
 
+//This function calculates the graph's summary statistics from scratch.
 void AssemblyGraph::determineGraphInfo()
 {
-    m_shortestContig = std::numeric_limits<long long>::max();
-    m_longestContig = 0;
-    int nodeCount = 0;
-    long long totalLength = 0;
-    std::vector<double> nodeDepths;
+    m_graphStatistics.build(m_deBruijnGraphNodes, m_deBruijnGraphEdges);
 
-    QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
-    while (i.hasNext())
-    {
-        i.next();
-        long long nodeLength = i.value()->getLength();
+    //The depth index is rebuilt here so it reflects the graph as it is now.
+    m_nodeDepthIndex.build(m_deBruijnGraphNodes);
 
-        if (nodeLength < m_shortestContig)
-            m_shortestContig = nodeLength;
-        if (nodeLength > m_longestContig)
-            m_longestContig = nodeLength;
+    updateGraphInfo();
+}
 
-        //Only add up the length for positive nodes
-        if (i.value()->isPositiveNode())
-        {
-            totalLength += nodeLength;
-            ++nodeCount;
-        }
 
-        nodeDepths.push_back(i.value()->getDepth());
+//This function refreshes the graph's summary values from the graph
+//statistics, which are kept up to date as the graph is edited.  This makes it
+//much cheaper than determineGraphInfo after an edit.  If the statistics are
+//not built or have fallen out of step with the graph, they are rebuilt.
+void AssemblyGraph::updateGraphInfo()
+{
+    if (!m_graphStatistics.isBuilt() ||
+            m_graphStatistics.getNodeCount() * 2 != m_deBruijnGraphNodes.size())
+        m_graphStatistics.build(m_deBruijnGraphNodes, m_deBruijnGraphEdges);
+
+    m_nodeCount = m_graphStatistics.getNodeCount();
+    m_edgeCount = m_graphStatistics.getEdgeCount();
+    m_totalLength = m_graphStatistics.getTotalLength();
+    if (m_nodeCount > 0)
+    {
+        m_shortestContig = m_graphStatistics.getShortestNodeLength();
+        m_longestContig = m_graphStatistics.getLongestNodeLength();
     }
-
-    //Count up the edges that will be shown in single mode (i.e. positive
-    //edges).
-    int edgeCount = 0;
-    QMapIterator<QPair<DeBruijnNode*, DeBruijnNode*>, DeBruijnEdge*> j(m_deBruijnGraphEdges);
-    while (j.hasNext())
+    else
     {
-        j.next();
-        DeBruijnEdge * edge = j.value();
-        if (edge->isPositiveEdge())
-            ++edgeCount;
+        m_shortestContig = std::numeric_limits<long long>::max();
+        m_longestContig = 0;
     }
-
-    m_nodeCount = nodeCount;
-    m_edgeCount = edgeCount;
-    m_totalLength = totalLength;
-    m_meanDepth = getMeanDepth();
-
-    std::sort(nodeDepths.begin(), nodeDepths.end());
-
-    double firstQuartileIndex = (nodeDepths.size() - 1) / 4.0;
-    double medianIndex = (nodeDepths.size() - 1) / 2.0;
-    double thirdQuartileIndex = (nodeDepths.size() - 1) * 3.0 / 4.0;
-
-    m_firstQuartileDepth = getValueUsingFractionalIndex(&nodeDepths, firstQuartileIndex);
-    m_medianDepth = getValueUsingFractionalIndex(&nodeDepths, medianIndex);
-    m_thirdQuartileDepth = getValueUsingFractionalIndex(&nodeDepths, thirdQuartileIndex);
+    m_meanDepth = m_graphStatistics.getMeanDepth();
+    updateDepthQuantiles();
 
     //Set the auto node length setting. This is determined by aiming for a
     //target average node length. But if the graph is small, the value will be
     //increased (to avoid having an overly small and simple graph layout).
     double targetDrawnGraphLength = std::max(m_nodeCount * g_settings->meanNodeLength,
                                              g_settings->minTotalGraphLength);
-    double megabases = totalLength / 1000000.0;
+    double megabases = m_totalLength / 1000000.0;
     if (megabases > 0.0)
         g_settings->autoNodeLengthPerMegabase = targetDrawnGraphLength / megabases;
     else
@@ -444,6 +449,39 @@ template<typename T> double AssemblyGraph::getValueUsingFractionalIndex(std::vec
 
 
 
+void AssemblyGraph::updateDepthQuantiles()
+{
+    if (!m_graphStatistics.isBuilt())
+        m_graphStatistics.build(m_deBruijnGraphNodes, m_deBruijnGraphEdges);
+    m_firstQuartileDepth = m_graphStatistics.getDepthQuantile(0.25);
+    m_medianDepth = m_graphStatistics.getDepthQuantile(0.5);
+    m_thirdQuartileDepth = m_graphStatistics.getDepthQuantile(0.75);
+}
+
+
+//The depth index is built by determineGraphInfo, but it is also built here if
+//that hasn't happened yet or if nodes were added without it being told.
+void AssemblyGraph::buildNodeDepthIndexIfNecessary()
+{
+    if (!m_nodeDepthIndex.isBuilt() || m_nodeDepthIndex.getNodeCount() != m_deBruijnGraphNodes.size())
+        m_nodeDepthIndex.build(m_deBruijnGraphNodes);
+}
+
+
+//This function changes a node's depth, keeping the depth index and graph
+//statistics up to date.
+void AssemblyGraph::setNodeDepth(DeBruijnNode * node, double newDepth)
+{
+    m_editJournal.recordChangedDepth(node, node->getDepth(), newDepth);
+    m_nodeDepthIndex.removeNode(node);
+    m_graphStatistics.removeNode(node);
+    node->setDepth(newDepth);
+    m_nodeDepthIndex.addNode(node);
+    m_graphStatistics.addNode(node);
+}
+
+
+
 void AssemblyGraph::clearGraphInfo()
 {
     m_totalLength = 0;
@@ -1818,11 +1856,11 @@ void AssemblyGraph::buildOgdfGraphFromNodesAndEdges(std::vector<DeBruijnNode *>
                 i.value()->setAsDrawn();
         }
     }
-    else //The scope is either around specified nodes, around nodes with BLAST hits or a depth range.
+    else //The scope is either around specified nodes, around nodes with BLAST hits, a depth range or bubbles.
     {
         //Distance is only used for around nodes and around blast scopes, not
-        //for the depth range scope.
-        if (g_settings->graphScope == DEPTH_RANGE)
+        //for the depth range and bubbles scopes.
+        if (g_settings->graphScope == DEPTH_RANGE || g_settings->graphScope == BUBBLES)
             nodeDistance = 0;
 
         for (size_t i = 0; i < startingNodes.size(); ++i)
@@ -2050,10 +2088,9 @@ std::vector<DeBruijnNode *> AssemblyGraph::getStartingNodes(QString * errorTitle
             return startingNodes;
         }
 
-        std::vector<DeBruijnNode *> startingNodes = getNodesInDepthRange(g_settings->minDepthRange,
-                                                                             g_settings->maxDepthRange);
-
-        if (startingNodes.size() == 0)
+        buildNodeDepthIndexIfNecessary();
+        if (m_nodeDepthIndex.getNodeCountInRange(g_settings->minDepthRange,
+                                                 g_settings->maxDepthRange) == 0)
         {
             *errorTitle = "No nodes in range";
             *errorMessage = "There are no nodes with depths in the specified range.";
@@ -2061,6 +2098,20 @@ std::vector<DeBruijnNode *> AssemblyGraph::getStartingNodes(QString * errorTitle
         }
     }
 
+    //The bubble nodes found here are kept as the starting nodes, so the
+    //superbubble search isn't repeated below.
+    else if (g_settings->graphScope == BUBBLES)
+    {
+        startingNodes = getNodesInSuperbubbles(&m_truncatedBubbleSearchCount);
+
+        if (startingNodes.size() == 0)
+        {
+            *errorTitle = "No bubbles";
+            *errorMessage = "There are no bubbles in this graph.";
+            return startingNodes;
+        }
+    }
+
     g_settings->doubleMode = doubleMode;
     clearOgdfGraphAndResetNodes();
 
@@ -2169,32 +2220,27 @@ std::vector<DeBruijnNode *> AssemblyGraph::getNodesFromListExact(QStringList nod
     return returnVector;
 }
 
+//Partial matches are found using the node name index, which is built on the
+//first partial search.  If the graph has gained nodes without the index being
+//told (e.g. by loading more nodes), it is rebuilt.
 std::vector<DeBruijnNode *> AssemblyGraph::getNodesFromListPartial(QStringList nodesList,
                                                                    std::vector<QString> * nodesNotInGraph)
 {
     std::vector<DeBruijnNode *> returnVector;
 
+    if (!m_nodeNameIndex.isBuilt() || m_nodeNameIndex.getNodeCount() != m_deBruijnGraphNodes.size())
+        m_nodeNameIndex.build(m_deBruijnGraphNodes);
+
     for (int i = 0; i < nodesList.size(); ++i)
     {
         QString queryName = nodesList.at(i).simplified();
         if (queryName == "")
             continue;
 
-        bool found = false;
-        QMapIterator<QString, DeBruijnNode*> j(m_deBruijnGraphNodes);
-        while (j.hasNext())
-        {
-            j.next();
-            QString nodeName = j.value()->getName();
-
-            if (nodeName.contains(queryName))
-            {
-                found = true;
-                returnVector.push_back(j.value());
-            }
-        }
+        std::vector<DeBruijnNode *> matches = m_nodeNameIndex.findNodes(queryName);
+        returnVector.insert(returnVector.end(), matches.begin(), matches.end());
 
-        if (!found && nodesNotInGraph != 0)
+        if (matches.size() == 0 && nodesNotInGraph != 0)
             nodesNotInGraph->push_back(queryName.trimmed());
     }
 
@@ -2222,11 +2268,11 @@ std::vector<DeBruijnNode *> AssemblyGraph::getNodesFromBlastHits(QString queryNa
     for (size_t i = 0; i < queries.size(); ++i)
     {
         BlastQuery * currentQuery = queries[i];
-        for (int j = 0; j < g_blastSearch->m_allHits.size(); ++j)
-        {
-            if (g_blastSearch->m_allHits[j]->m_query == currentQuery)
-                returnVector.push_back(g_blastSearch->m_allHits[j]->m_node);
-        }
+        if (currentQuery == 0)
+            continue;
+        QList<int> hitIds = currentQuery->getHitIds();
+        for (int j = 0; j < hitIds.size(); ++j)
+            returnVector.push_back(g_blastSearch->m_allHits.getNode(hitIds[j]));
     }
 
     return returnVector;
@@ -2235,21 +2281,91 @@ std::vector<DeBruijnNode *> AssemblyGraph::getNodesFromBlastHits(QString queryNa
 std::vector<DeBruijnNode *> AssemblyGraph::getNodesInDepthRange(double min,
                                                                     double max)
 {
-    std::vector<DeBruijnNode *> returnVector;
+    buildNodeDepthIndexIfNecessary();
+    return m_nodeDepthIndex.getNodesInRange(min, max);
+}
+
+
+//If given, the number of searches which stopped at the maximum bubble size
+//is stored, as larger bubbles are missing from the results.
+std::vector<Superbubble> AssemblyGraph::findSuperbubbles(int * truncatedSearchCount) const
+{
+    SuperbubbleFinder superbubbleFinder(g_settings->maxBubbleNodes);
+    int truncatedCount = 0;
+    std::vector<Superbubble> superbubbles = superbubbleFinder.findSuperbubbles(&m_deBruijnGraphNodes, g_settings->threads,
+                                                                               &truncatedCount);
+    if (truncatedSearchCount != 0)
+        *truncatedSearchCount = truncatedCount;
+    return superbubbles;
+}
+
+
+//This function returns the nodes in all superbubbles, on both strands.
+std::vector<DeBruijnNode *> AssemblyGraph::getNodesInSuperbubbles(int * truncatedSearchCount) const
+{
+    std::vector<Superbubble> superbubbles = findSuperbubbles(truncatedSearchCount);
 
+    QSet<DeBruijnNode *> nodesInSuperbubbles;
+    for (size_t i = 0; i < superbubbles.size(); ++i)
+    {
+        std::vector<DeBruijnNode *> nodes = superbubbles[i].internalNodes;
+        nodes.push_back(superbubbles[i].entrance);
+        nodes.push_back(superbubbles[i].exit);
+        for (size_t j = 0; j < nodes.size(); ++j)
+        {
+            nodesInSuperbubbles.insert(nodes[j]);
+            nodesInSuperbubbles.insert(nodes[j]->getReverseComplement());
+        }
+    }
+
+    //The nodes are returned in node name order.
+    std::vector<DeBruijnNode *> returnVector;
     QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
     while (i.hasNext())
     {
         i.next();
-        DeBruijnNode * node = i.value();
-
-        if (node->isInDepthRange(min, max))
-            returnVector.push_back(node);
+        if (nodesInSuperbubbles.contains(i.value()))
+            returnVector.push_back(i.value());
     }
     return returnVector;
 }
 
 
+//The sequence indexes are built from the nodes and edges, so each operation
+//which changes those must call this function.
+void AssemblyGraph::invalidateSequenceIndexes()
+{
+    m_sequenceIndex.clear();
+    m_translatedIndex.clear();
+}
+
+
+//This function gives the sequence index, building it first if necessary.
+const SequenceIndex * AssemblyGraph::getSequenceIndex()
+{
+    if (!m_sequenceIndex.isBuilt())
+        m_sequenceIndex.build(m_deBruijnGraphNodes, g_settings->sequenceIndexKmerSize,
+                              g_settings->sequenceIndexWindowSize, g_settings->threads);
+    return &m_sequenceIndex;
+}
+
+
+//This function gives the six-frame translation index, building it (and the
+//sequence index it comes from) first if necessary.
+const TranslatedIndex * AssemblyGraph::getTranslatedIndex()
+{
+    if (!m_translatedIndex.isBuilt())
+        m_translatedIndex.build(getSequenceIndex(), g_settings->threads);
+    return &m_translatedIndex;
+}
+
+
+std::vector<SequenceHit> AssemblyGraph::findSequence(QByteArray sequence, int maxMismatches)
+{
+    return getSequenceIndex()->findSequence(sequence, maxMismatches);
+}
+
+
 QStringList AssemblyGraph::removeNullStringsFromList(QStringList in)
 {
     QStringList out;
@@ -2559,86 +2675,146 @@ int AssemblyGraph::getDrawnNodeCount() const
 
 void AssemblyGraph::deleteNodes(std::vector<DeBruijnNode *> * nodes)
 {
-    //Build a list of nodes to delete.
-    QList<DeBruijnNode *> nodesToDelete;
+    std::vector<DeBruijnEdge *> noEdges;
+    deleteNodesAndEdges(nodes, &noEdges);
+}
+
+
+void AssemblyGraph::deleteEdges(std::vector<DeBruijnEdge *> * edges)
+{
+    std::vector<DeBruijnNode *> noNodes;
+    deleteNodesAndEdges(&noNodes, edges);
+}
+
+
+//This function removes the given nodes and edges (along with their reverse
+//complements) from the graph as a single bulk operation.  Everything to be
+//deleted is first marked with a flag, so there are no repeated searches to
+//avoid duplicates.  Then each surviving node which lost an edge has its edge
+//vector compacted once, before the marked nodes and edges are removed from the
+//graph and deleted.
+void AssemblyGraph::deleteNodesAndEdges(const std::vector<DeBruijnNode *> * nodes,
+                                        const std::vector<DeBruijnEdge *> * edges)
+{
+    //Mark the nodes to delete.
+    std::vector<DeBruijnNode *> nodesToDelete;
     for (size_t i = 0; i < nodes->size(); ++i)
     {
         DeBruijnNode * node = (*nodes)[i];
         DeBruijnNode * rcNode = node->getReverseComplement();
 
-        if (!nodesToDelete.contains(node))
+        if (!node->isMarkedForDeletion())
+        {
+            node->markForDeletion();
             nodesToDelete.push_back(node);
-        if (!nodesToDelete.contains(rcNode))
+        }
+        if (!rcNode->isMarkedForDeletion())
+        {
+            rcNode->markForDeletion();
             nodesToDelete.push_back(rcNode);
+        }
     }
 
-    //Build a list of edges to delete.
+    //Mark the edges to delete: those given and those attached to a deleted
+    //node.
     std::vector<DeBruijnEdge *> edgesToDelete;
-    for (int i = 0; i < nodesToDelete.size(); ++i)
+    for (size_t i = 0; i < edges->size(); ++i)
+        markEdgeForDeletion((*edges)[i], &edgesToDelete);
+    for (size_t i = 0; i < nodesToDelete.size(); ++i)
     {
-        DeBruijnNode * node = nodesToDelete[i];
-        const std::vector<DeBruijnEdge *> * nodeEdges = node->getEdgesPointer();
+        const std::vector<DeBruijnEdge *> * nodeEdges = nodesToDelete[i]->getEdgesPointer();
         for (size_t j = 0; j < nodeEdges->size(); ++j)
-        {
-            DeBruijnEdge * edge = (*nodeEdges)[j];
-            bool alreadyAdded = std::find(edgesToDelete.begin(), edgesToDelete.end(), edge) != edgesToDelete.end();
-            if (!alreadyAdded)
-                edgesToDelete.push_back(edge);
-        }
+            markEdgeForDeletion((*nodeEdges)[j], &edgesToDelete);
     }
 
-    //Build a list of node names to delete.
-    QStringList nodesNamesToDelete;
-    for (int i = 0; i < nodesToDelete.size(); ++i)
+    //The graph statistics need to see the edges while their nodes still
+    //exist, to tell which of each pair is positive.
+    for (size_t i = 0; i < edgesToDelete.size(); ++i)
+        m_graphStatistics.removeEdge(edgesToDelete[i]);
+    invalidateSequenceIndexes();
+
+    //Compact the edge vectors of the surviving nodes which lost an edge.  The
+    //deleted nodes don't need this, as they are about to be deleted anyway.
+    QSet<DeBruijnNode *> nodesToCompact;
+    for (size_t i = 0; i < edgesToDelete.size(); ++i)
     {
-        DeBruijnNode * node = nodesToDelete[i];
-        nodesNamesToDelete.push_back(node->getName());
+        DeBruijnEdge * edge = edgesToDelete[i];
+        if (!edge->getStartingNode()->isMarkedForDeletion())
+            nodesToCompact.insert(edge->getStartingNode());
+        if (!edge->getEndingNode()->isMarkedForDeletion())
+            nodesToCompact.insert(edge->getEndingNode());
+    }
+    QSetIterator<DeBruijnNode *> i(nodesToCompact);
+    while (i.hasNext())
+    {
+        DeBruijnNode * node = i.next();
+        node->removeEdgesMarkedForDeletion();
+        m_graphStatistics.updateDeadEnds(node);
     }
 
-    //Remove the edges from the graph,
-    deleteEdges(&edgesToDelete);
-
-    //Remove the nodes from the graph.
-    for (int i = 0; i < nodesNamesToDelete.size(); ++i)
+    //Remove the edges and nodes from the graph.  If an edit is being recorded,
+    //they are handed to the edit journal instead of being deleted, so the edit
+    //can be undone.  If not, the journal forgets its history, which may refer
+    //to them.
+    for (size_t j = 0; j < edgesToDelete.size(); ++j)
     {
-        QString nodeName = nodesNamesToDelete[i];
-        m_deBruijnGraphNodes.remove(nodeName);
+        DeBruijnEdge * edge = edgesToDelete[j];
+        m_deBruijnGraphEdges.remove(QPair<DeBruijnNode*, DeBruijnNode*>(edge->getStartingNode(),
+                                                                         edge->getEndingNode()));
+        m_editJournal.recordRemovedEdge(edge);
+        if (!m_editJournal.isRecording())
+            delete edge;
     }
-    for (int i = 0; i < nodesToDelete.size(); ++i)
+    for (size_t j = 0; j < nodesToDelete.size(); ++j)
     {
-        DeBruijnNode * node = nodesToDelete[i];
-        delete node;
+        DeBruijnNode * node = nodesToDelete[j];
+        m_nodeNameIndex.removeNode(node);
+        m_nodeDepthIndex.removeNode(node);
+        m_graphStatistics.removeNode(node);
+        m_deBruijnGraphNodes.remove(node->getName());
+        m_editJournal.recordRemovedNode(node);
+        if (!m_editJournal.isRecording())
+            delete node;
     }
 }
 
-void AssemblyGraph::deleteEdges(std::vector<DeBruijnEdge *> * edges)
+
+void AssemblyGraph::markEdgeForDeletion(DeBruijnEdge * edge,
+                                        std::vector<DeBruijnEdge *> * edgesToDelete)
 {
-    //Build a list of edges to delete.
-    QList<DeBruijnEdge *> edgesToDelete;
-    for (size_t i = 0; i < edges->size(); ++i)
+    DeBruijnEdge * rcEdge = edge->getReverseComplement();
+    if (!edge->isMarkedForDeletion())
     {
-        DeBruijnEdge * edge = (*edges)[i];
-        DeBruijnEdge * rcEdge = edge->getReverseComplement();
-
-        if (!edgesToDelete.contains(edge))
-            edgesToDelete.push_back(edge);
-        if (!edgesToDelete.contains(rcEdge))
-            edgesToDelete.push_back(rcEdge);
+        edge->markForDeletion();
+        edgesToDelete->push_back(edge);
     }
-
-    //Remove the edges from the graph,
-    for (int i = 0; i < edgesToDelete.size(); ++i)
+    if (!rcEdge->isMarkedForDeletion())
     {
-        DeBruijnEdge * edge = edgesToDelete[i];
-        DeBruijnNode * startingNode = edge->getStartingNode();
-        DeBruijnNode * endingNode = edge->getEndingNode();
+        rcEdge->markForDeletion();
+        edgesToDelete->push_back(rcEdge);
+    }
+}
 
-        m_deBruijnGraphEdges.remove(QPair<DeBruijnNode*, DeBruijnNode*>(startingNode, endingNode));
-        startingNode->removeEdge(edge);
-        endingNode->removeEdge(edge);
 
-        delete edge;
+//This function removes nodes which are shorter than the minimum length or
+//which have less than the minimum depth.  It returns the number of nodes
+//removed (counting a node and its reverse complement as one).
+int AssemblyGraph::filterNodes(int minLength, double minDepth)
+{
+    std::vector<DeBruijnNode *> nodesToDelete;
+    QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        if (node->isNegativeNode())
+            continue;
+        if (node->getLength() < minLength || node->getDepth() < minDepth)
+            nodesToDelete.push_back(node);
     }
+
+    deleteNodes(&nodesToDelete);
+    return int(nodesToDelete.size());
 }
 
 
@@ -2673,6 +2849,15 @@ void AssemblyGraph::duplicateNodePair(DeBruijnNode * node, MyGraphicsScene * sce
 
     m_deBruijnGraphNodes.insert(newPosNodeName, newPosNode);
     m_deBruijnGraphNodes.insert(newNegNodeName, newNegNode);
+    m_nodeNameIndex.addNode(newPosNode);
+    m_nodeNameIndex.addNode(newNegNode);
+    m_nodeDepthIndex.addNode(newPosNode);
+    m_nodeDepthIndex.addNode(newNegNode);
+    m_graphStatistics.addNode(newPosNode);
+    m_graphStatistics.addNode(newNegNode);
+    invalidateSequenceIndexes();
+    m_editJournal.recordAddedNode(newPosNode);
+    m_editJournal.recordAddedNode(newNegNode);
 
     std::vector<DeBruijnEdge *> leavingEdges = originalPosNode->getLeavingEdges();
     for (size_t i = 0; i < leavingEdges.size(); ++i)
@@ -2692,8 +2877,8 @@ void AssemblyGraph::duplicateNodePair(DeBruijnNode * node, MyGraphicsScene * sce
                            edge->getOverlap(), edge->getOverlapType());
     }
 
-    originalPosNode->setDepth(newDepth);
-    originalNegNode->setDepth(newDepth);
+    setNodeDepth(originalPosNode, newDepth);
+    setNodeDepth(originalNegNode, newDepth);
 
     double meanDrawnDepth = getMeanDepth(true);
     double depthRelativeToMeanDrawnDepth;
@@ -2741,9 +2926,12 @@ void AssemblyGraph::duplicateGraphicsNode(DeBruijnNode * originalNode, DeBruijnN
     newGraphicsItemNode->setFlag(QGraphicsItem::ItemIsSelectable);
     newGraphicsItemNode->setFlag(QGraphicsItem::ItemIsMovable);
 
+    std::vector<QPointF> originalLinePoints = originalGraphicsItemNode->m_linePoints;
     originalGraphicsItemNode->shiftPointsLeft();
     newGraphicsItemNode->shiftPointsRight();
     originalGraphicsItemNode->fixEdgePaths();
+    m_editJournal.recordMovedGraphicsItemNode(originalGraphicsItemNode, originalLinePoints,
+                                              originalGraphicsItemNode->m_linePoints);
 
     originalGraphicsItemNode->setNodeColour();
     newGraphicsItemNode->setNodeColour();
@@ -2751,6 +2939,7 @@ void AssemblyGraph::duplicateGraphicsNode(DeBruijnNode * originalNode, DeBruijnN
     originalGraphicsItemNode->setWidth();
 
     scene->addItem(newGraphicsItemNode);
+    m_editJournal.recordAddedGraphicsItemNode(newGraphicsItemNode);
 
     const std::vector<DeBruijnEdge *> * newEdges = newNode->getEdgesPointer();
     for (size_t i = 0; i < newEdges->size(); ++i)
@@ -2761,6 +2950,7 @@ void AssemblyGraph::duplicateGraphicsNode(DeBruijnNode * originalNode, DeBruijnN
         newEdge->setGraphicsItemEdge(graphicsItemEdge);
         graphicsItemEdge->setFlag(QGraphicsItem::ItemIsSelectable);
         scene->addItem(graphicsItemEdge);
+        m_editJournal.recordAddedGraphicsItemEdge(graphicsItemEdge);
     }
 }
 
@@ -2865,6 +3055,15 @@ bool AssemblyGraph::mergeNodes(QList<DeBruijnNode *> nodes, MyGraphicsScene * sc
 
     m_deBruijnGraphNodes.insert(newPosNodeName, newPosNode);
     m_deBruijnGraphNodes.insert(newNegNodeName, newNegNode);
+    m_nodeNameIndex.addNode(newPosNode);
+    m_nodeNameIndex.addNode(newNegNode);
+    m_nodeDepthIndex.addNode(newPosNode);
+    m_nodeDepthIndex.addNode(newNegNode);
+    m_graphStatistics.addNode(newPosNode);
+    m_graphStatistics.addNode(newNegNode);
+    invalidateSequenceIndexes();
+    m_editJournal.recordAddedNode(newPosNode);
+    m_editJournal.recordAddedNode(newNegNode);
 
     std::vector<DeBruijnEdge *> leavingEdges = orderedList.back()->getLeavingEdges();
     for (size_t i = 0; i < leavingEdges.size(); ++i)
@@ -3034,6 +3233,7 @@ bool AssemblyGraph::mergeGraphicsNodes2(QList<DeBruijnNode *> * originalNodes,
         newGraphicsItemNode->setNodeColour();
 
         scene->addItem(newGraphicsItemNode);
+        m_editJournal.recordAddedGraphicsItemNode(newGraphicsItemNode);
 
         const std::vector<DeBruijnEdge *> * newEdges = newNode->getEdgesPointer();
         for (size_t i = 0; i < newEdges->size(); ++i)
@@ -3044,6 +3244,7 @@ bool AssemblyGraph::mergeGraphicsNodes2(QList<DeBruijnNode *> * originalNodes,
             newEdge->setGraphicsItemEdge(graphicsItemEdge);
             graphicsItemEdge->setFlag(QGraphicsItem::ItemIsSelectable);
             scene->addItem(graphicsItemEdge);
+            m_editJournal.recordAddedGraphicsItemEdge(graphicsItemEdge);
         }
     }
     return success;
@@ -3055,15 +3256,45 @@ bool AssemblyGraph::mergeGraphicsNodes2(QList<DeBruijnNode *> * originalNodes,
 void AssemblyGraph::removeGraphicsItemNodes(const std::vector<DeBruijnNode *> * nodes,
                                             bool reverseComplement,
                                             MyGraphicsScene * scene)
+{
+    std::vector<DeBruijnEdge *> noEdges;
+    removeGraphicsItemNodesAndEdges(nodes, &noEdges, reverseComplement, scene);
+}
+
+
+void AssemblyGraph::removeGraphicsItemEdges(const std::vector<DeBruijnEdge *> * edges,
+                                            bool reverseComplement,
+                                            MyGraphicsScene * scene)
+{
+    std::vector<DeBruijnNode *> noNodes;
+    removeGraphicsItemNodesAndEdges(&noNodes, edges, reverseComplement, scene);
+}
+
+
+//This function removes the graphics items for the given nodes (including all
+//of their edges) and the given edges.  All of the items are gathered first and
+//then taken out of the scene in one batch, with the scene's signals blocked
+//for the whole removal.
+void AssemblyGraph::removeGraphicsItemNodesAndEdges(const std::vector<DeBruijnNode *> * nodes,
+                                                    const std::vector<DeBruijnEdge *> * edges,
+                                                    bool reverseComplement,
+                                                    MyGraphicsScene * scene)
 {
     QSet<GraphicsItemNode *> graphicsItemNodesToDelete;
+    QSet<GraphicsItemEdge *> graphicsItemEdgesToDelete;
+
+    for (size_t i = 0; i < edges->size(); ++i)
+        collectGraphicsItemEdge((*edges)[i], reverseComplement, &graphicsItemEdgesToDelete);
+
     for (size_t i = 0; i < nodes->size(); ++i)
     {
         DeBruijnNode * node = (*nodes)[i];
-        removeAllGraphicsEdgesFromNode(node, reverseComplement, scene);
+        const std::vector<DeBruijnEdge *> * nodeEdges = node->getEdgesPointer();
+        for (size_t j = 0; j < nodeEdges->size(); ++j)
+            collectGraphicsItemEdge((*nodeEdges)[j], reverseComplement, &graphicsItemEdgesToDelete);
 
         GraphicsItemNode * graphicsItemNode = node->getGraphicsItemNode();
-        if (graphicsItemNode != 0 && !graphicsItemNodesToDelete.contains(graphicsItemNode))
+        if (graphicsItemNode != 0)
             graphicsItemNodesToDelete.insert(graphicsItemNode);
         node->setGraphicsItemNode(0);
 
@@ -3071,76 +3302,57 @@ void AssemblyGraph::removeGraphicsItemNodes(const std::vector<DeBruijnNode *> *
         {
             DeBruijnNode * rcNode = node->getReverseComplement();
             GraphicsItemNode * rcGraphicsItemNode = rcNode->getGraphicsItemNode();
-            if (rcGraphicsItemNode != 0 && !graphicsItemNodesToDelete.contains(rcGraphicsItemNode))
+            if (rcGraphicsItemNode != 0)
                 graphicsItemNodesToDelete.insert(rcGraphicsItemNode);
             rcNode->setGraphicsItemNode(0);
         }
     }
 
+    //As with the graph's nodes and edges, the items are kept in the edit
+    //journal if an edit is being recorded.
     if (scene != 0)
         scene->blockSignals(true);
-    QSetIterator<GraphicsItemNode *> i(graphicsItemNodesToDelete);
+    QSetIterator<GraphicsItemEdge *> i(graphicsItemEdgesToDelete);
     while (i.hasNext())
     {
-        GraphicsItemNode * graphicsItemNode = i.next();
-        if (graphicsItemNode != 0)
-        {
-            if (scene != 0)
-                scene->removeItem(graphicsItemNode);
+        GraphicsItemEdge * graphicsItemEdge = i.next();
+        if (scene != 0)
+            scene->removeItem(graphicsItemEdge);
+        m_editJournal.recordRemovedGraphicsItemEdge(graphicsItemEdge);
+        if (!m_editJournal.isRecording())
+            delete graphicsItemEdge;
+    }
+    QSetIterator<GraphicsItemNode *> j(graphicsItemNodesToDelete);
+    while (j.hasNext())
+    {
+        GraphicsItemNode * graphicsItemNode = j.next();
+        if (scene != 0)
+            scene->removeItem(graphicsItemNode);
+        m_editJournal.recordRemovedGraphicsItemNode(graphicsItemNode);
+        if (!m_editJournal.isRecording())
             delete graphicsItemNode;
-        }
     }
     if (scene != 0)
         scene->blockSignals(false);
 }
 
 
-void AssemblyGraph::removeAllGraphicsEdgesFromNode(DeBruijnNode * node, bool reverseComplement,
-                                                   MyGraphicsScene * scene)
+void AssemblyGraph::collectGraphicsItemEdge(DeBruijnEdge * edge, bool reverseComplement,
+                                            QSet<GraphicsItemEdge *> * graphicsItemEdges)
 {
-    const std::vector<DeBruijnEdge *> * edges = node->getEdgesPointer();
-    removeGraphicsItemEdges(edges, reverseComplement, scene);
-}
+    GraphicsItemEdge * graphicsItemEdge = edge->getGraphicsItemEdge();
+    if (graphicsItemEdge != 0)
+        graphicsItemEdges->insert(graphicsItemEdge);
+    edge->setGraphicsItemEdge(0);
 
-void AssemblyGraph::removeGraphicsItemEdges(const std::vector<DeBruijnEdge *> * edges,
-                                            bool reverseComplement,
-                                            MyGraphicsScene * scene)
-{
-    QSet<GraphicsItemEdge *> graphicsItemEdgesToDelete;
-    for (size_t i = 0; i < edges->size(); ++i)
+    if (reverseComplement)
     {
-        DeBruijnEdge * edge = (*edges)[i];
-
-        GraphicsItemEdge * graphicsItemEdge = edge->getGraphicsItemEdge();
-        if (graphicsItemEdge != 0 && !graphicsItemEdgesToDelete.contains(graphicsItemEdge))
-            graphicsItemEdgesToDelete.insert(graphicsItemEdge);
-        edge->setGraphicsItemEdge(0);
-
-        if (reverseComplement)
-        {
-            DeBruijnEdge * rcEdge = edge->getReverseComplement();
-            GraphicsItemEdge * rcGraphicsItemEdge = rcEdge->getGraphicsItemEdge();
-            if (rcGraphicsItemEdge != 0 && !graphicsItemEdgesToDelete.contains(rcGraphicsItemEdge))
-                graphicsItemEdgesToDelete.insert(rcGraphicsItemEdge);
-            rcEdge->setGraphicsItemEdge(0);
-        }
-    }
-
-    if (scene != 0)
-        scene->blockSignals(true);
-    QSetIterator<GraphicsItemEdge *> i(graphicsItemEdgesToDelete);
-    while (i.hasNext())
-    {
-        GraphicsItemEdge * graphicsItemEdge = i.next();
-        if (graphicsItemEdge != 0)
-        {
-            if (scene != 0)
-                scene->removeItem(graphicsItemEdge);
-            delete graphicsItemEdge;
-        }
+        DeBruijnEdge * rcEdge = edge->getReverseComplement();
+        GraphicsItemEdge * rcGraphicsItemEdge = rcEdge->getGraphicsItemEdge();
+        if (rcGraphicsItemEdge != 0)
+            graphicsItemEdges->insert(rcGraphicsItemEdge);
+        rcEdge->setGraphicsItemEdge(0);
     }
-    if (scene != 0)
-        scene->blockSignals(false);
 }
 
 
@@ -3376,17 +3588,25 @@ void AssemblyGraph::changeNodeName(QString oldName, QString newName)
     DeBruijnNode * posNode = m_deBruijnGraphNodes[posOldNodeName];
     DeBruijnNode * negNode = m_deBruijnGraphNodes[negOldNodeName];
 
-    m_deBruijnGraphNodes.remove(posOldNodeName);
-    m_deBruijnGraphNodes.remove(negOldNodeName);
-
     QString posNewNodeName = newName + "+";
     QString negNewNodeName = newName + "-";
 
-    posNode->setName(posNewNodeName);
-    negNode->setName(negNewNodeName);
+    m_editJournal.recordChangedName(posNode, posOldNodeName, posNewNodeName);
+    m_editJournal.recordChangedName(negNode, negOldNodeName, negNewNodeName);
+    renameNode(posNode, posNewNodeName);
+    renameNode(negNode, negNewNodeName);
+}
+
 
-    m_deBruijnGraphNodes.insert(posNewNodeName, posNode);
-    m_deBruijnGraphNodes.insert(negNewNodeName, negNode);
+//This function changes the full name (including the +/-) of one node,
+//keeping the node map and name index up to date.
+void AssemblyGraph::renameNode(DeBruijnNode * node, QString newName)
+{
+    m_nodeNameIndex.removeNode(node);
+    m_deBruijnGraphNodes.remove(node->getName());
+    node->setName(newName);
+    m_deBruijnGraphNodes.insert(newName, node);
+    m_nodeNameIndex.addNode(node);
 }
 
 
@@ -3423,9 +3643,10 @@ void AssemblyGraph::changeNodeDepth(std::vector<DeBruijnNode *> * nodes,
 
     for (size_t i = 0; i < nodes->size(); ++i)
     {
-        (*nodes)[i]->setDepth(newDepth);
-        (*nodes)[i]->getReverseComplement()->setDepth(newDepth);
+        setNodeDepth((*nodes)[i], newDepth);
+        setNodeDepth((*nodes)[i]->getReverseComplement(), newDepth);
     }
+    updateDepthQuantiles();
 
     //If this graph does not already have a depthTag, give it a depthTag of KC
     //so the depth info will be saved.
@@ -3435,6 +3656,255 @@ void AssemblyGraph::changeNodeDepth(std::vector<DeBruijnNode *> * nodes,
 
 
 
+//These functions mark the start and end of a user-level edit.  All changes to
+//the graph (and its graphics items) made in between are recorded in the edit
+//journal, so the edit can be undone as one.
+void AssemblyGraph::beginEdit(QString description)
+{
+    m_editJournal.beginEdit(description);
+}
+
+void AssemblyGraph::endEdit()
+{
+    m_editJournal.endEdit(g_settings->editHistoryMemory * 1048576LL);
+}
+
+
+//These functions undo or redo the most recent edit.  The scene must be the
+//one the edit's graphics items were made in (or null if there is no drawn
+//graph).  They return false if there was nothing to undo or redo.
+bool AssemblyGraph::undoEdit(MyGraphicsScene * scene)
+{
+    GraphEdit * edit = m_editJournal.getEditToUndo();
+    if (edit == 0 || m_editJournal.isRecording())
+        return false;
+
+    m_editJournal.beginApplyingEdit();
+    applyGraphEdit(edit, true, scene);
+    m_editJournal.finishUndo();
+    return true;
+}
+
+bool AssemblyGraph::redoEdit(MyGraphicsScene * scene)
+{
+    GraphEdit * edit = m_editJournal.getEditToRedo();
+    if (edit == 0 || m_editJournal.isRecording())
+        return false;
+
+    m_editJournal.beginApplyingEdit();
+    applyGraphEdit(edit, false, scene);
+    m_editJournal.finishRedo();
+    return true;
+}
+
+
+//This function must be called when the graphics scene is replaced, as the
+//graphics items in the edit history will no longer belong to it.
+void AssemblyGraph::clearEditHistoryGraphicsItems()
+{
+    m_editJournal.clearGraphicsItems();
+}
+
+
+//This function undoes an edit's changes (in reverse order) or redoes them (in
+//the original order).  Once they are all done, the graphics items which were
+//put back have their edge paths remade.
+void AssemblyGraph::applyGraphEdit(GraphEdit * edit, bool undo, MyGraphicsScene * scene)
+{
+    QSet<DeBruijnNode *> attachedNodes;
+    QSet<GraphicsItemNode *> shownGraphicsItemNodes;
+    QSet<GraphicsItemEdge *> shownGraphicsItemEdges;
+
+    if (scene != 0)
+        scene->blockSignals(true);
+    invalidateSequenceIndexes();
+    size_t changeCount = edit->changes.size();
+    for (size_t i = 0; i < changeCount; ++i)
+    {
+        const GraphChange & change = edit->changes[undo ? changeCount - 1 - i : i];
+        applyGraphChange(change, undo, scene, &attachedNodes,
+                         &shownGraphicsItemNodes, &shownGraphicsItemEdges);
+    }
+    if (scene != 0)
+        scene->blockSignals(false);
+
+    //A node which came back without a graphics item (e.g. because the graph
+    //has been redrawn since the edit) can't be counted as drawn.
+    if (scene != 0)
+    {
+        QSetIterator<DeBruijnNode *> i(attachedNodes);
+        while (i.hasNext())
+        {
+            DeBruijnNode * node = i.next();
+            if (node->getGraphicsItemNode() == 0)
+                node->setAsNotDrawn();
+        }
+    }
+
+    QSetIterator<GraphicsItemNode *> j(shownGraphicsItemNodes);
+    while (j.hasNext())
+    {
+        GraphicsItemNode * graphicsItemNode = j.next();
+        if (graphicsItemNode->m_deBruijnNode->getGraphicsItemNode() == graphicsItemNode)
+            graphicsItemNode->fixEdgePaths();
+    }
+    QSetIterator<GraphicsItemEdge *> k(shownGraphicsItemEdges);
+    while (k.hasNext())
+    {
+        GraphicsItemEdge * graphicsItemEdge = k.next();
+        if (graphicsItemEdge->m_deBruijnEdge->getGraphicsItemEdge() == graphicsItemEdge)
+            graphicsItemEdge->calculateAndSetPath();
+    }
+}
+
+
+void AssemblyGraph::applyGraphChange(const GraphChange & change, bool undo, MyGraphicsScene * scene,
+                                     QSet<DeBruijnNode *> * attachedNodes,
+                                     QSet<GraphicsItemNode *> * shownGraphicsItemNodes,
+                                     QSet<GraphicsItemEdge *> * shownGraphicsItemEdges)
+{
+    //Undoing an addition or redoing a removal takes the object out of the
+    //graph.  Undoing a removal or redoing an addition puts it back.
+    bool addition = (change.type == ADDED_NODE || change.type == ADDED_EDGE ||
+                     change.type == ADDED_GRAPHICS_ITEM_NODE || change.type == ADDED_GRAPHICS_ITEM_EDGE);
+    bool attach = (addition != undo);
+
+    switch (change.type)
+    {
+    case ADDED_NODE:
+    case REMOVED_NODE:
+        if (attach)
+        {
+            attachNode(change.node);
+            attachedNodes->insert(change.node);
+        }
+        else
+            detachNode(change.node);
+        break;
+
+    case ADDED_EDGE:
+    case REMOVED_EDGE:
+        if (attach)
+            attachEdge(change.edge);
+        else
+            detachEdge(change.edge);
+        break;
+
+    case CHANGED_DEPTH:
+        setNodeDepth(change.node, undo ? change.oldDepth : change.newDepth);
+        break;
+
+    case CHANGED_NAME:
+        renameNode(change.node, undo ? change.oldName : change.newName);
+        break;
+
+    case ADDED_GRAPHICS_ITEM_NODE:
+    case REMOVED_GRAPHICS_ITEM_NODE:
+    {
+        GraphicsItemNode * graphicsItemNode = change.graphicsItemNode;
+        DeBruijnNode * node = graphicsItemNode->m_deBruijnNode;
+        if (attach)
+        {
+            node->setGraphicsItemNode(graphicsItemNode);
+            if (scene != 0)
+                scene->addItem(graphicsItemNode);
+            shownGraphicsItemNodes->insert(graphicsItemNode);
+        }
+        else
+        {
+            if (node->getGraphicsItemNode() == graphicsItemNode)
+                node->setGraphicsItemNode(0);
+            if (scene != 0)
+                scene->removeItem(graphicsItemNode);
+            shownGraphicsItemNodes->remove(graphicsItemNode);
+        }
+        break;
+    }
+
+    case ADDED_GRAPHICS_ITEM_EDGE:
+    case REMOVED_GRAPHICS_ITEM_EDGE:
+    {
+        GraphicsItemEdge * graphicsItemEdge = change.graphicsItemEdge;
+        DeBruijnEdge * edge = graphicsItemEdge->m_deBruijnEdge;
+        if (attach)
+        {
+            edge->setGraphicsItemEdge(graphicsItemEdge);
+            if (scene != 0)
+                scene->addItem(graphicsItemEdge);
+            shownGraphicsItemEdges->insert(graphicsItemEdge);
+        }
+        else
+        {
+            if (edge->getGraphicsItemEdge() == graphicsItemEdge)
+                edge->setGraphicsItemEdge(0);
+            if (scene != 0)
+                scene->removeItem(graphicsItemEdge);
+            shownGraphicsItemEdges->remove(graphicsItemEdge);
+        }
+        break;
+    }
+
+    case MOVED_GRAPHICS_ITEM_NODE:
+        change.graphicsItemNode->setLinePoints(undo ? change.oldLinePoints : change.newLinePoints);
+        shownGraphicsItemNodes->insert(change.graphicsItemNode);
+        break;
+    }
+}
+
+
+//These functions put a node or edge back into the graph, or take it out
+//without deleting it.  They keep the indices and statistics up to date,
+//except for the sequence indexes, which applyGraphEdit clears once for the
+//whole edit.  A node's edges are put back separately, after the node.
+void AssemblyGraph::attachNode(DeBruijnNode * node)
+{
+    node->unmarkForDeletion();
+    node->clearBlastHits();
+    m_deBruijnGraphNodes.insert(node->getName(), node);
+    m_nodeNameIndex.addNode(node);
+    m_nodeDepthIndex.addNode(node);
+    m_graphStatistics.addNode(node);
+}
+
+void AssemblyGraph::detachNode(DeBruijnNode * node)
+{
+    m_nodeNameIndex.removeNode(node);
+    m_nodeDepthIndex.removeNode(node);
+    m_graphStatistics.removeNode(node);
+    m_deBruijnGraphNodes.remove(node->getName());
+}
+
+void AssemblyGraph::attachEdge(DeBruijnEdge * edge)
+{
+    DeBruijnNode * startingNode = edge->getStartingNode();
+    DeBruijnNode * endingNode = edge->getEndingNode();
+
+    edge->unmarkForDeletion();
+    m_deBruijnGraphEdges.insert(QPair<DeBruijnNode*, DeBruijnNode*>(startingNode, endingNode), edge);
+    startingNode->addEdge(edge);
+    endingNode->addEdge(edge);
+
+    m_graphStatistics.addEdge(edge);
+    m_graphStatistics.updateDeadEnds(startingNode);
+    m_graphStatistics.updateDeadEnds(endingNode);
+}
+
+void AssemblyGraph::detachEdge(DeBruijnEdge * edge)
+{
+    DeBruijnNode * startingNode = edge->getStartingNode();
+    DeBruijnNode * endingNode = edge->getEndingNode();
+
+    m_graphStatistics.removeEdge(edge);
+    m_deBruijnGraphEdges.remove(QPair<DeBruijnNode*, DeBruijnNode*>(startingNode, endingNode));
+    startingNode->removeEdge(edge);
+    endingNode->removeEdge(edge);
+
+    m_graphStatistics.updateDeadEnds(startingNode);
+    m_graphStatistics.updateDeadEnds(endingNode);
+}
+
+
+
 //This function is used when making FASTA outputs - it breaks a sequence into
 //separate lines.  The default interval is 70, as that seems to be what NCBI
 //uses.
@@ -3468,6 +3938,9 @@ QByteArray AssemblyGraph::addNewlinesToSequence(QByteArray sequence,
 //the positive node count).
 int AssemblyGraph::getDeadEndCount() const
 {
+    if (m_graphStatistics.isBuilt())
+        return m_graphStatistics.getDeadEndCount();
+
     int deadEndCount = 0;
 
     QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
@@ -3489,6 +3962,13 @@ void AssemblyGraph::getNodeStats(int * n50, int * shortestNode, int * firstQuart
     if (m_totalLength == 0.0)
         return;
 
+    if (m_graphStatistics.isBuilt())
+    {
+        m_graphStatistics.getNodeLengthStats(n50, shortestNode, firstQuartile, median,
+                                             thirdQuartile, longestNode);
+        return;
+    }
+
     std::vector<int> nodeLengths;
     QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
     while (i.hasNext())
@@ -3601,6 +4081,9 @@ double AssemblyGraph::getMedianDepthByBase() const
     if (m_totalLength == 0)
         return 0.0;
 
+    if (m_graphStatistics.isBuilt())
+        return m_graphStatistics.getMedianDepthByBase();
+
     //Make a list of all nodes.
     long long totalLength = 0;
     QList<DeBruijnNode *> nodeList;
@@ -3799,6 +4282,26 @@ bool AssemblyGraph::attemptToLoadSequencesFromFasta()
     return atLeastOneNodeSequenceLoaded;
 }
 
+//This function does the loading which DeBruijnNode::getSequence would do
+//for a node without a sequence.  That loading changes the graph, so this is
+//called before node sequences are read from several threads at once.
+void AssemblyGraph::loadMissingSequencesFromFasta()
+{
+    if (m_sequencesLoadedFromFasta != NOT_TRIED)
+        return;
+
+    QMapIterator<QString, DeBruijnNode*> i(m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        if (i.value()->sequenceIsMissing())
+        {
+            attemptToLoadSequencesFromFasta();
+            return;
+        }
+    }
+}
+
 // Returns true if every node name in the graph starts with the string.
 bool AssemblyGraph::allNodesStartWith(QString start) const
 {
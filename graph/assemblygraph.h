@@ -29,11 +29,21 @@
 #include "../program/globals.h"
 #include "../ui/mygraphicsscene.h"
 #include "path.h"
+#include "nodenameindex.h"
+#include "nodedepthindex.h"
+#include "graphstatistics.h"
+#include "grapheditjournal.h"
+#include "superbubblefinder.h"
+#include "sequenceindex.h"
+#include "translatedindex.h"
 #include <QPair>
+#include <QSet>
 
 class DeBruijnNode;
 class DeBruijnEdge;
 class MyProgressDialog;
+class GraphicsItemEdge;
+class GraphicsItemNode;
 
 class AssemblyGraph : public QObject
 {
@@ -84,6 +94,7 @@ public:
     void resetAllNodeColours();
     void clearAllBlastHitPointers();
     void determineGraphInfo();
+    void updateGraphInfo();
     void clearGraphInfo();
     void buildDeBruijnGraphFromLastGraph(QString fullFileName);
     void buildDeBruijnGraphFromGfa(QString fullFileName, bool * unsupportedCigar, bool * customLabels,
@@ -138,6 +149,9 @@ public:
     int getDrawnNodeCount() const;
     void deleteNodes(std::vector<DeBruijnNode *> * nodes);
     void deleteEdges(std::vector<DeBruijnEdge *> * edges);
+    void deleteNodesAndEdges(const std::vector<DeBruijnNode *> * nodes,
+                             const std::vector<DeBruijnEdge *> * edges);
+    int filterNodes(int minLength, double minDepth);
     void duplicateNodePair(DeBruijnNode * node, MyGraphicsScene * scene);
     bool mergeNodes(QList<DeBruijnNode *> nodes, MyGraphicsScene * scene,
                     bool recalulateDepth);
@@ -147,6 +161,10 @@ public:
     void removeGraphicsItemNodes(const std::vector<DeBruijnNode *> * nodes,
                                  bool reverseComplement,
                                  MyGraphicsScene * scene);
+    void removeGraphicsItemNodesAndEdges(const std::vector<DeBruijnNode *> * nodes,
+                                         const std::vector<DeBruijnEdge *> * edges,
+                                         bool reverseComplement,
+                                         MyGraphicsScene * scene);
     int mergeAllPossible(MyGraphicsScene * scene = 0,
                          MyProgressDialog * progressDialog = 0);
 
@@ -158,6 +176,12 @@ public:
     NodeNameStatus checkNodeNameValidity(QString nodeName);
     void changeNodeDepth(std::vector<DeBruijnNode *> * nodes,
                              double newDepth);
+    void beginEdit(QString description);
+    void endEdit();
+    bool undoEdit(MyGraphicsScene * scene = 0);
+    bool redoEdit(MyGraphicsScene * scene = 0);
+    const GraphEditJournal * getEditJournal() const {return &m_editJournal;}
+    void clearEditHistoryGraphicsItems();
 
     static QByteArray addNewlinesToSequence(QByteArray sequence, int interval = 70);
     int getDeadEndCount() const;
@@ -169,11 +193,45 @@ public:
     long long getTotalLengthMinusEdgeOverlaps() const;
     QPair<int, int> getOverlapRange() const;
     bool attemptToLoadSequencesFromFasta();
+    void loadMissingSequencesFromFasta();
     long long getTotalLengthOrphanedNodes() const;
     bool useLinearLayout() const;
+    std::vector<Superbubble> findSuperbubbles(int * truncatedSearchCount = 0) const;
+    std::vector<DeBruijnNode *> getNodesInSuperbubbles(int * truncatedSearchCount = 0) const;
+    int getTruncatedBubbleSearchCount() const {return m_truncatedBubbleSearchCount;}
+    const SequenceIndex * getSequenceIndex();
+    const TranslatedIndex * getTranslatedIndex();
+    std::vector<SequenceHit> findSequence(QByteArray sequence, int maxMismatches);
 
 
 private:
+    //This index is used for partial node name searches.  It is only built
+    //when first needed.
+    NodeNameIndex m_nodeNameIndex;
+
+    //This index is used for depth range queries.
+    NodeDepthIndex m_nodeDepthIndex;
+
+    //This is the number of bubble searches which stopped at the maximum
+    //bubble size when the bubbles scope last found its starting nodes.
+    int m_truncatedBubbleSearchCount;
+
+    //These statistics are kept up to date as the graph is edited, so the
+    //graph info can be refreshed without going over the whole graph.
+    GraphStatistics m_graphStatistics;
+
+    //This records edits so they can be undone and redone.
+    GraphEditJournal m_editJournal;
+
+    //This index is used to find sequences in the graph.  It is only built
+    //when first needed, and is cleared whenever nodes or edges change.
+    SequenceIndex m_sequenceIndex;
+
+    //This index of the nodes' translations is used to search for protein
+    //queries.  Like the sequence index, it is built when first needed and
+    //cleared whenever nodes or edges change.
+    TranslatedIndex m_translatedIndex;
+
     template<typename T> double getValueUsingFractionalIndex(std::vector<T> * v, double index) const;
     QString convertNormalNumberStringToBandageNodeName(QString number);
     void makeReverseComplementNodeIfNecessary(DeBruijnNode * node);
@@ -203,11 +261,26 @@ private:
                             DeBruijnNode * newNode, MyGraphicsScene * scene);
     bool mergeGraphicsNodes2(QList<DeBruijnNode *> * originalNodes,
                              DeBruijnNode * newNode, MyGraphicsScene * scene);
-    void removeAllGraphicsEdgesFromNode(DeBruijnNode * node,
-                                        bool reverseComplement,
-                                        MyGraphicsScene * scene);
+    void collectGraphicsItemEdge(DeBruijnEdge * edge, bool reverseComplement,
+                                 QSet<GraphicsItemEdge *> * graphicsItemEdges);
+    void markEdgeForDeletion(DeBruijnEdge * edge,
+                             std::vector<DeBruijnEdge *> * edgesToDelete);
     QString cleanNodeName(QString name);
     double findDepthAtIndex(QList<DeBruijnNode *> * nodeList, long long targetIndex) const;
+    void buildNodeDepthIndexIfNecessary();
+    void updateDepthQuantiles();
+    void setNodeDepth(DeBruijnNode * node, double newDepth);
+    void renameNode(DeBruijnNode * node, QString newName);
+    void applyGraphEdit(GraphEdit * edit, bool undo, MyGraphicsScene * scene);
+    void applyGraphChange(const GraphChange & change, bool undo, MyGraphicsScene * scene,
+                          QSet<DeBruijnNode *> * attachedNodes,
+                          QSet<GraphicsItemNode *> * shownGraphicsItemNodes,
+                          QSet<GraphicsItemEdge *> * shownGraphicsItemEdges);
+    void invalidateSequenceIndexes();
+    void attachNode(DeBruijnNode * node);
+    void detachNode(DeBruijnNode * node);
+    void attachEdge(DeBruijnEdge * edge);
+    void detachEdge(DeBruijnEdge * edge);
     bool allNodesStartWith(QString start) const;
     QString simplifyCanuNodeName(QString oldName) const;
 
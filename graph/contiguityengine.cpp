@@ -0,0 +1,314 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "contiguityengine.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include <QApplication>
+
+ContiguityEngine::ContiguityEngine(int searchSteps) :
+    m_searchSteps(searchSteps)
+{
+}
+
+
+//This function determines the contiguity of nodes relative to the starting
+//node.  It has the same two steps as the original path tracing approach:
+// -First, for each edge leaving the starting node, the neighbourhood is
+//  unrolled into layers.  Any node on a path through the layers is
+//  MAYBE_CONTIGUOUS, and nodes which every path must pass through are
+//  CONTIGUOUS.
+// -Second, for each of the MAYBE_CONTIGUOUS nodes, it checks whether they
+//  have a path that unambiguously leads to the starting node.  If so, then
+//  they are CONTIGUOUS.
+//Cycles are bounded by the step limit rather than by counting how many times
+//a node appears in a path, as that is a property of an individual path which
+//this approach does not track.
+void ContiguityEngine::determineContiguity(DeBruijnNode * startingNode)
+{
+    startingNode->upgradeContiguityStatus(STARTING);
+
+    //A set is used to store all nodes found on the paths, as the nodes
+    //that show up as MAYBE_CONTIGUOUS will have their paths checked
+    //to the starting node.
+    std::set<DeBruijnNode *> allCheckedNodes;
+
+    const std::vector<DeBruijnEdge *> * edges = startingNode->getEdgesPointer();
+    for (size_t i = 0; i < edges->size(); ++i)
+    {
+        QApplication::processEvents();
+
+        DeBruijnEdge * edge = (*edges)[i];
+        bool outgoingEdge = (startingNode == edge->getStartingNode());
+        buildLayeredGraph(edge, outgoingEdge, startingNode);
+        markStatesOnPaths();
+
+        //Set all nodes on the paths as MAYBE_CONTIGUOUS.
+        std::set<DeBruijnNode *> nodesOnPaths;
+        for (size_t j = 0; j < m_states.size(); ++j)
+        {
+            if (m_states[j].onPath)
+                nodesOnPaths.insert(m_states[j].node);
+        }
+        for (std::set<DeBruijnNode *>::iterator j = nodesOnPaths.begin(); j != nodesOnPaths.end(); ++j)
+        {
+            (*j)->upgradeContiguityStatus(MAYBE_CONTIGUOUS);
+            allCheckedNodes.insert(*j);
+        }
+
+        //A node which is on all paths when including its reverse complement
+        //is CONTIGUOUS_EITHER_STRAND.  Only those nodes can be on all paths
+        //by themselves, in which case they are CONTIGUOUS_STRAND_SPECIFIC.
+        for (std::set<DeBruijnNode *>::iterator j = nodesOnPaths.begin(); j != nodesOnPaths.end(); ++j)
+        {
+            DeBruijnNode * node = *j;
+            if (!isNodeOnAllPaths(node, true))
+                continue;
+
+            node->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
+            node->getReverseComplement()->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
+
+            if (isNodeOnAllPaths(node, false))
+                node->upgradeContiguityStatus(CONTIGUOUS_STRAND_SPECIFIC);
+        }
+    }
+
+    //For each node that was checked, then we check to see if any
+    //of its paths leads unambiguously back to the starting node.
+    for (std::set<DeBruijnNode *>::iterator i = allCheckedNodes.begin(); i != allCheckedNodes.end(); ++i)
+    {
+        QApplication::processEvents();
+        DeBruijnNode * node = *i;
+        ContiguityStatus status = node->getContiguityStatus();
+
+        //First check without reverse complement target for
+        //strand-specific contiguity.
+        if (status != CONTIGUOUS_STRAND_SPECIFIC &&
+                doesNodeLeadOnlyToTarget(node, startingNode, false))
+            node->upgradeContiguityStatus(CONTIGUOUS_STRAND_SPECIFIC);
+
+        //Now check including the reverse complement target for
+        //either strand contiguity.
+        if (status != CONTIGUOUS_STRAND_SPECIFIC &&
+                status != CONTIGUOUS_EITHER_STRAND &&
+                doesNodeLeadOnlyToTarget(node, startingNode, true))
+        {
+            node->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
+            node->getReverseComplement()->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
+        }
+    }
+
+    m_states.clear();
+}
+
+
+//This function unrolls the graph outward from the given edge.  Each state is
+//a node at a particular step, so a node reached at different steps has
+//multiple states.  A state ends a path if the step limit is reached, if
+//there is nowhere further to go, or if it leads back to the starting node.
+//States are created in step order, so successors always have a higher index.
+void ContiguityEngine::buildLayeredGraph(DeBruijnEdge * edge, bool forward,
+                                         DeBruijnNode * startingNode)
+{
+    m_states.clear();
+    QHash<QPair<DeBruijnNode *, int>, int> stateIndices;
+
+    LayeredState firstState;
+    firstState.node = getNextNode(edge, forward);
+    firstState.step = 1;
+    firstState.pathEnd = false;
+    firstState.onPath = false;
+    m_states.push_back(firstState);
+    stateIndices.insert(QPair<DeBruijnNode *, int>(firstState.node, 1), 0);
+
+    for (size_t i = 0; i < m_states.size(); ++i)
+    {
+        DeBruijnNode * node = m_states[i].node;
+        int step = m_states[i].step;
+
+        if (step >= m_searchSteps)
+        {
+            m_states[i].pathEnd = true;
+            continue;
+        }
+
+        std::vector<DeBruijnEdge *> nextEdges = getNextEdges(node, forward);
+        if (nextEdges.size() == 0)
+        {
+            m_states[i].pathEnd = true;
+            continue;
+        }
+
+        for (size_t j = 0; j < nextEdges.size(); ++j)
+        {
+            DeBruijnNode * nextNode = getNextNode(nextEdges[j], forward);
+            if (nextNode == startingNode)
+            {
+                m_states[i].pathEnd = true;
+                continue;
+            }
+
+            QPair<DeBruijnNode *, int> key(nextNode, step + 1);
+            int nextIndex;
+            if (stateIndices.contains(key))
+                nextIndex = stateIndices[key];
+            else
+            {
+                LayeredState nextState;
+                nextState.node = nextNode;
+                nextState.step = step + 1;
+                nextState.pathEnd = false;
+                nextState.onPath = false;
+                nextIndex = int(m_states.size());
+                m_states.push_back(nextState);
+                stateIndices.insert(key, nextIndex);
+            }
+            m_states[i].successors.push_back(nextIndex);
+        }
+    }
+}
+
+
+//A state is on a path if it can reach a state which ends a path.  Since
+//successors always have a higher index, a single backward sweep is enough.
+void ContiguityEngine::markStatesOnPaths()
+{
+    for (int i = int(m_states.size()) - 1; i >= 0; --i)
+    {
+        LayeredState * state = &m_states[i];
+        state->onPath = state->pathEnd;
+        for (size_t j = 0; !state->onPath && j < state->successors.size(); ++j)
+            state->onPath = m_states[state->successors[j]].onPath;
+    }
+}
+
+
+//This function checks whether every path through the layered graph passes
+//through the given node (or its reverse complement, if includeReverseComplement
+//is true).  It does this by removing all of the node's states and checking
+//whether the end of any path can still be reached.
+bool ContiguityEngine::isNodeOnAllPaths(DeBruijnNode * node, bool includeReverseComplement) const
+{
+    DeBruijnNode * reverseComplement = node->getReverseComplement();
+    std::vector<bool> visited(m_states.size(), false);
+    std::vector<int> toVisit;
+    toVisit.push_back(0);
+    visited[0] = true;
+
+    while (!toVisit.empty())
+    {
+        const LayeredState * state = &m_states[toVisit.back()];
+        toVisit.pop_back();
+
+        if (!state->onPath)
+            continue;
+        if (state->node == node ||
+                (includeReverseComplement && state->node == reverseComplement))
+            continue;
+        if (state->pathEnd)
+            return false;
+
+        for (size_t i = 0; i < state->successors.size(); ++i)
+        {
+            int nextIndex = state->successors[i];
+            if (!visited[nextIndex])
+            {
+                visited[nextIndex] = true;
+                toVisit.push_back(nextIndex);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+//This function checks whether the given node has any edge for which all
+//paths outward lead to the target.  If includeReverseComplement is true,
+//then reaching the reverse complement of the target also counts.
+bool ContiguityEngine::doesNodeLeadOnlyToTarget(DeBruijnNode * node, DeBruijnNode * target,
+                                                bool includeReverseComplement)
+{
+    m_forwardMemo.clear();
+    m_backwardMemo.clear();
+
+    const std::vector<DeBruijnEdge *> * edges = node->getEdgesPointer();
+    for (size_t i = 0; i < edges->size(); ++i)
+    {
+        DeBruijnEdge * edge = (*edges)[i];
+        bool outgoingEdge = (node == edge->getStartingNode());
+        if (leadsOnlyToTarget(getNextNode(edge, outgoingEdge), m_searchSteps, outgoingEdge,
+                              node, target, includeReverseComplement))
+            return true;
+    }
+
+    return false;
+}
+
+
+//The result for a node only depends on how many steps remain, so results are
+//remembered and each node is evaluated at most once per step count.
+bool ContiguityEngine::leadsOnlyToTarget(DeBruijnNode * node, int stepsRemaining, bool forward,
+                                         DeBruijnNode * origin, DeBruijnNode * target,
+                                         bool includeReverseComplement)
+{
+    //Landing on the node where the search began means that this could be
+    //circular DNA that does not contain the target.
+    if (node == origin)
+        return false;
+
+    if (node == target)
+        return true;
+    if (includeReverseComplement && node->getReverseComplement() == target)
+        return true;
+
+    --stepsRemaining;
+    if (stepsRemaining == 0)
+        return false;
+
+    QHash<QPair<DeBruijnNode *, int>, bool> * memo = forward ? &m_forwardMemo : &m_backwardMemo;
+    QPair<DeBruijnNode *, int> key(node, stepsRemaining);
+    if (memo->contains(key))
+        return (*memo)[key];
+
+    std::vector<DeBruijnEdge *> nextEdges = getNextEdges(node, forward);
+    bool result = (nextEdges.size() > 0);
+    for (size_t i = 0; result && i < nextEdges.size(); ++i)
+        result = leadsOnlyToTarget(getNextNode(nextEdges[i], forward), stepsRemaining, forward,
+                                   origin, target, includeReverseComplement);
+
+    memo->insert(key, result);
+    return result;
+}
+
+
+std::vector<DeBruijnEdge *> ContiguityEngine::getNextEdges(DeBruijnNode * node, bool forward)
+{
+    if (forward)
+        return node->getLeavingEdges();
+    else
+        return node->getEnteringEdges();
+}
+
+DeBruijnNode * ContiguityEngine::getNextNode(DeBruijnEdge * edge, bool forward)
+{
+    if (forward)
+        return edge->getEndingNode();
+    else
+        return edge->getStartingNode();
+}
@@ -0,0 +1,73 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef CONTIGUITYENGINE_H
+#define CONTIGUITYENGINE_H
+
+#include <vector>
+#include <set>
+#include <QHash>
+#include <QPair>
+
+class DeBruijnNode;
+class DeBruijnEdge;
+
+//This class determines the contiguity of nodes relative to a starting node.
+//Instead of tracing every path outward from the starting node (which grows
+//exponentially in tangled parts of the graph), it unrolls the neighbourhood
+//into a layered graph where each state is a node at a particular step.  The
+//classifications are then found with reachability searches over that
+//layered graph, so the work is polynomial in the size of the neighbourhood.
+class ContiguityEngine
+{
+public:
+    //CREATORS
+    ContiguityEngine(int searchSteps);
+
+    //MODIFERS
+    void determineContiguity(DeBruijnNode * startingNode);
+
+private:
+    struct LayeredState
+    {
+        DeBruijnNode * node;
+        int step;
+        std::vector<int> successors;
+        bool pathEnd;
+        bool onPath;
+    };
+
+    int m_searchSteps;
+    std::vector<LayeredState> m_states;
+    QHash<QPair<DeBruijnNode *, int>, bool> m_forwardMemo;
+    QHash<QPair<DeBruijnNode *, int>, bool> m_backwardMemo;
+
+    void buildLayeredGraph(DeBruijnEdge * edge, bool forward,
+                           DeBruijnNode * startingNode);
+    void markStatesOnPaths();
+    bool isNodeOnAllPaths(DeBruijnNode * node, bool includeReverseComplement) const;
+    bool doesNodeLeadOnlyToTarget(DeBruijnNode * node, DeBruijnNode * target,
+                                  bool includeReverseComplement);
+    bool leadsOnlyToTarget(DeBruijnNode * node, int stepsRemaining, bool forward,
+                           DeBruijnNode * origin, DeBruijnNode * target,
+                           bool includeReverseComplement);
+    static std::vector<DeBruijnEdge *> getNextEdges(DeBruijnNode * node, bool forward);
+    static DeBruijnNode * getNextNode(DeBruijnEdge * edge, bool forward);
+};
+
+#endif // CONTIGUITYENGINE_H
@@ -27,7 +27,7 @@
 
 DeBruijnEdge::DeBruijnEdge(DeBruijnNode *startingNode, DeBruijnNode *endingNode) :
     m_startingNode(startingNode), m_endingNode(endingNode), m_graphicsItemEdge(0),
-    m_drawn(false), m_overlapType(UNKNOWN_OVERLAP), m_overlap(0)
+    m_drawn(false), m_markedForDeletion(false), m_overlapType(UNKNOWN_OVERLAP), m_overlap(0)
 {
 }
 
@@ -135,196 +135,6 @@ void DeBruijnEdge::addToOgdfGraph(ogdf::Graph * ogdfGraph, ogdf::EdgeArray<doubl
 
 
 
-//This function traces all possible paths from this edge.
-//It proceeds a number of steps, as determined by a setting.
-//If forward is true, it looks in a forward direction (starting nodes to
-//ending nodes).  If forward is false, it looks in a backward direction
-//(ending nodes to starting nodes).
-void DeBruijnEdge::tracePaths(bool forward,
-                              int stepsRemaining,
-                              std::vector< std::vector <DeBruijnNode *> > * allPaths,
-                              DeBruijnNode * startingNode,
-                              std::vector<DeBruijnNode *> pathSoFar) const
-{
-    //This can go for a while, so keep the UI responsive.
-    QApplication::processEvents();
-
-    //Find the node in the direction we are tracing.
-    DeBruijnNode * nextNode;
-    if (forward)
-        nextNode = m_endingNode;
-    else
-        nextNode = m_startingNode;
-
-    //Add that node to the path so far.
-    pathSoFar.push_back(nextNode);
-
-    //If there are no steps left, then the path so far is done.
-    --stepsRemaining;
-    if (stepsRemaining == 0)
-    {
-        allPaths->push_back(pathSoFar);
-        return;
-    }
-
-    //If the code got here, then more steps remain.
-    //Find the edges that are in the correct direction.
-    std::vector<DeBruijnEdge *> nextEdges = findNextEdgesInPath(nextNode, forward);
-
-    //If there are no next edges, then we are finished with the
-    //path search, even though steps remain.
-    if (nextEdges.size() == 0)
-    {
-        allPaths->push_back(pathSoFar);
-        return;
-    }
-
-    //Call this function on all of the next edges.
-    //However, we also need to check to see if we are tracing a loop
-    //and stop if that is the case.
-    for (size_t i = 0; i < nextEdges.size(); ++i)
-    {
-        DeBruijnEdge * nextEdge = nextEdges[i];
-
-        //Determine the node that this next edge leads to.
-        DeBruijnNode * nextNextNode;
-        if (forward)
-            nextNextNode = nextEdge->m_endingNode;
-        else
-            nextNextNode = nextEdge->m_startingNode;
-
-        //If that node is the starting node, then we've made
-        //a full loop and the path should be considered complete.
-        if (nextNextNode == startingNode)
-        {
-            allPaths->push_back(pathSoFar);
-            continue;
-        }
-
-        //If that node is already in the path TWICE so far, that means
-        //we're caught in a loop, and we should throw this path out.
-        //If it appears 0 or 1 times, then continue the path search.
-        if (timesNodeInPath(nextNextNode, &pathSoFar) < 2)
-            nextEdge->tracePaths(forward, stepsRemaining, allPaths, startingNode, pathSoFar);
-    }
-}
-
-
-//This function counts how many times a node appears in a path
-int DeBruijnEdge::timesNodeInPath(DeBruijnNode * node, std::vector<DeBruijnNode *> * path) const
-{
-    int count = 0;
-    for (size_t i = 0; i < path->size(); ++i)
-    {
-        if ( (*path)[i] == node)
-            ++count;
-    }
-
-    return count;
-}
-
-
-
-bool DeBruijnEdge::leadsOnlyToNode(bool forward,
-                                   int stepsRemaining,
-                                   DeBruijnNode * target,
-                                   std::vector<DeBruijnNode *> pathSoFar,
-                                   bool includeReverseComplement) const
-{
-    //This can go for a while, so keep the UI responsive.
-    QApplication::processEvents();
-
-    //Find the node in the direction we are tracing.
-    DeBruijnNode * nextNode;
-    if (forward)
-        nextNode = m_endingNode;
-    else
-        nextNode = m_startingNode;
-
-    //Add that node to the path so far.
-    pathSoFar.push_back(nextNode);
-
-    //If this path has landed on the node from which the search began,
-    //that means we've followed a loop around.  The search has therefore
-    //failed because this path could represent circular DNA that does
-    //not contain the target.
-    if (nextNode == pathSoFar[0])
-        return false;
-
-    //If the next node is the target, the search succeeded!
-    if (nextNode == target)
-        return true;
-
-    //If we are including reverse complements and the next node is
-    //the reverse complement of the target, the search succeeded!
-    if (includeReverseComplement && nextNode->getReverseComplement() == target)
-        return true;
-
-    //If there are no steps left, then the search failed.
-    --stepsRemaining;
-    if (stepsRemaining == 0)
-        return false;
-
-    //If the code got here, then more steps remain.
-    //Find the edges that are in the correct direction.
-    std::vector<DeBruijnEdge *> nextEdges = findNextEdgesInPath(nextNode, forward);
-
-    //If there are no next edges, then the search failed, even
-    //though steps remain.
-    if (nextEdges.size() == 0)
-        return false;
-
-    //In order for the search to succeed, this function needs to return true
-    //for all of the nextEdges.
-    //However, we also need to check to see if we are tracing a loop
-    //and stop if that is the case.
-    for (size_t i = 0; i < nextEdges.size(); ++i)
-    {
-        DeBruijnEdge * nextEdge = nextEdges[i];
-
-        //Determine the node that this next edge leads to.
-        DeBruijnNode * nextNextNode;
-        if (forward)
-            nextNextNode = nextEdge->m_endingNode;
-        else
-            nextNextNode = nextEdge->m_startingNode;
-
-        //If that node is already in the path TWICE so far, that means
-        //we're caught in a loop, and we should throw this path out.
-        //If it appears 0 or 1 times, then continue the path search.
-        if (timesNodeInPath(nextNextNode, &pathSoFar) < 2)
-        {
-            if ( !nextEdge->leadsOnlyToNode(forward, stepsRemaining, target, pathSoFar, includeReverseComplement) )
-                return false;
-        }
-    }
-
-    //If the code got here, then the search succeeded!
-    return true;
-}
-
-
-std::vector<DeBruijnEdge *> DeBruijnEdge::findNextEdgesInPath(DeBruijnNode * nextNode,
-                                                              bool forward) const
-{
-    std::vector<DeBruijnEdge *> nextEdges;
-    const std::vector<DeBruijnEdge *> * nextNodeEdges = nextNode->getEdgesPointer();
-    for (size_t i = 0; i < nextNodeEdges->size(); ++i)
-    {
-        DeBruijnEdge * edge = (*nextNodeEdges)[i];
-
-        //If forward, we're looking for edges that lead away from
-        //nextNode.  If backward, we're looking for edges that lead
-        //into nextNode.
-        if ((forward && edge->m_startingNode == nextNode) ||
-                (!forward && edge->m_endingNode == nextNode))
-            nextEdges.push_back(edge);
-    }
-
-    return nextEdges;
-}
-
-
 //This function tries to automatically determine the overlap size
 //between the two nodes.  It tries each overlap size between the min
 //to the max (in settings), assigning the first one it finds.
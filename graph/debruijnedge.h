@@ -37,28 +37,22 @@ public:
     GraphicsItemEdge * getGraphicsItemEdge() const {return m_graphicsItemEdge;}
     DeBruijnEdge * getReverseComplement() const {return m_reverseComplement;}
     bool isDrawn() const {return m_drawn;}
+    bool isMarkedForDeletion() const {return m_markedForDeletion;}
     int getOverlap() const {return m_overlap;}
     EdgeOverlapType getOverlapType() const {return m_overlapType;}
     DeBruijnNode * getOtherNode(const DeBruijnNode * node) const;
     bool testExactOverlap(int overlap) const;
-    void tracePaths(bool forward,
-                    int stepsRemaining,
-                    std::vector<std::vector<DeBruijnNode *> > * allPaths,
-                    DeBruijnNode * startingNode,
-                    std::vector<DeBruijnNode *> pathSoFar = std::vector<DeBruijnNode *>()) const;
-    bool leadsOnlyToNode(bool forward,
-                         int stepsRemaining,
-                         DeBruijnNode * target,
-                         std::vector<DeBruijnNode *> pathSoFar,
-                         bool includeReverseComplement) const;
     QByteArray getGfaLinkLine() const;
     bool isPositiveEdge() const;
     bool isNegativeEdge() const {return !isPositiveEdge();}
     bool isOwnReverseComplement() const {return this == getReverseComplement();}
     static bool compareEdgePointers(DeBruijnEdge * a, DeBruijnEdge * b);
+    static bool edgeIsMarkedForDeletion(const DeBruijnEdge * edge) {return edge->m_markedForDeletion;}
 
     //MODIFERS
     void setGraphicsItemEdge(GraphicsItemEdge * gie) {m_graphicsItemEdge = gie;}
+    void markForDeletion() {m_markedForDeletion = true;}
+    void unmarkForDeletion() {m_markedForDeletion = false;}
     void setReverseComplement(DeBruijnEdge * rc) {m_reverseComplement = rc;}
     void setOverlap(int ol) {m_overlap = ol;}
     void setOverlapType(EdgeOverlapType olt) {m_overlapType = olt;}
@@ -74,13 +68,11 @@ private:
     GraphicsItemEdge * m_graphicsItemEdge;
     DeBruijnEdge * m_reverseComplement;
     bool m_drawn;
+    bool m_markedForDeletion;
     EdgeOverlapType m_overlapType;
     int m_overlap;
 
     bool edgeIsVisible() const;
-    int timesNodeInPath(DeBruijnNode * node, std::vector<DeBruijnNode *> * path) const;
-    std::vector<DeBruijnEdge *> findNextEdgesInPath(DeBruijnNode * nextNode,
-                                                    bool forward) const;
 };
 
 #endif // DEBRUIJNEDGE_H
@@ -23,8 +23,11 @@
 #include <math.h>
 #include "../blast/blasthit.h"
 #include "../blast/blastquery.h"
+#include "../blast/blastsearch.h"
 #include "assemblygraph.h"
+#include "contiguityengine.h"
 #include <set>
+#include <algorithm>
 #include <QApplication>
 #include <QSet>
 
@@ -43,7 +46,10 @@ DeBruijnNode::DeBruijnNode(QString name, double depth, QByteArray sequence, int
     m_graphicsItemNode(0),
     m_specialNode(false),
     m_drawn(false),
+    m_markedForDeletion(false),
     m_highestDistanceInNeighbourSearch(0),
+    m_blastHitsStart(0),
+    m_blastHitCount(0),
     m_csvData()
 {
     if (length > 0)
@@ -75,6 +81,16 @@ void DeBruijnNode::removeEdge(DeBruijnEdge * edge)
 }
 
 
+//This function removes all of the node's edges which have been marked for
+//deletion in a single pass, instead of searching the edge vector once per
+//removed edge.
+void DeBruijnNode::removeEdgesMarkedForDeletion()
+{
+    m_edges.erase(std::remove_if(m_edges.begin(), m_edges.end(), DeBruijnEdge::edgeIsMarkedForDeletion),
+                  m_edges.end());
+}
+
+
 //This function resets the node to the state it would be in after a graph
 //file was loaded - no contiguity status and no OGDF nodes.
 void DeBruijnNode::resetNode()
@@ -153,158 +169,12 @@ int DeBruijnNode::getNumberOfOgdfGraphEdges(double drawnNodeLength) const
 
 
 //This function determines the contiguity of nodes relative to this one.
-//It has two steps:
-// -First, for each edge leaving this node, all paths outward are found.
-//  Any nodes in any path are MAYBE_CONTIGUOUS, and nodes in all of the
-//  paths are CONTIGUOUS.
-// -Second, it is necessary to check in the opposite direction - for each
-//  of the MAYBE_CONTIGUOUS nodes, do they have a path that unambiguously
-//  leads to this node?  If so, then they are CONTIGUOUS.
+//The work is done by a ContiguityEngine, which avoids tracing every possible
+//path so that tangled regions of the graph don't take exponential time.
 void DeBruijnNode::determineContiguity()
 {
-    upgradeContiguityStatus(STARTING);
-
-    //A set is used to store all nodes found in the paths, as the nodes
-    //that show up as MAYBE_CONTIGUOUS will have their paths checked
-    //to this node.
-    std::set<DeBruijnNode *> allCheckedNodes;
-
-    //For each path leaving this node, find all possible paths
-    //outward.  Nodes in any of the paths for an edge are
-    //MAYBE_CONTIGUOUS.  Nodes in all of the paths for an edge
-    //are CONTIGUOUS.
-    for (size_t i = 0; i < m_edges.size(); ++i)
-    {
-        DeBruijnEdge * edge = m_edges[i];
-        bool outgoingEdge = (this == edge->getStartingNode());
-
-        std::vector< std::vector <DeBruijnNode *> > allPaths;
-        edge->tracePaths(outgoingEdge, g_settings->contiguitySearchSteps, &allPaths, this);
-
-        //Set all nodes in the paths as MAYBE_CONTIGUOUS
-        for (size_t j = 0; j < allPaths.size(); ++j)
-        {
-            QApplication::processEvents();
-            for (size_t k = 0; k < allPaths[j].size(); ++k)
-            {
-                DeBruijnNode * node = allPaths[j][k];
-                node->upgradeContiguityStatus(MAYBE_CONTIGUOUS);
-                allCheckedNodes.insert(node);
-            }
-        }
-
-        //Set all common nodes as CONTIGUOUS_STRAND_SPECIFIC
-        std::vector<DeBruijnNode *> commonNodesStrandSpecific = getNodesCommonToAllPaths(&allPaths, false);
-        for (size_t j = 0; j < commonNodesStrandSpecific.size(); ++j)
-            (commonNodesStrandSpecific[j])->upgradeContiguityStatus(CONTIGUOUS_STRAND_SPECIFIC);
-
-        //Set all common nodes (when including reverse complement nodes)
-        //as CONTIGUOUS_EITHER_STRAND
-        std::vector<DeBruijnNode *> commonNodesEitherStrand = getNodesCommonToAllPaths(&allPaths, true);
-        for (size_t j = 0; j < commonNodesEitherStrand.size(); ++j)
-        {
-            DeBruijnNode * node = commonNodesEitherStrand[j];
-            node->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
-            node->getReverseComplement()->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
-        }
-    }
-
-    //For each node that was checked, then we check to see if any
-    //of its paths leads unambiuously back to the starting node (this node).
-    for (std::set<DeBruijnNode *>::iterator i = allCheckedNodes.begin(); i != allCheckedNodes.end(); ++i)
-    {
-        QApplication::processEvents();
-        DeBruijnNode * node = *i;
-        ContiguityStatus status = node->getContiguityStatus();
-
-        //First check without reverse complement target for
-        //strand-specific contiguity.
-        if (status != CONTIGUOUS_STRAND_SPECIFIC &&
-                node->doesPathLeadOnlyToNode(this, false))
-            node->upgradeContiguityStatus(CONTIGUOUS_STRAND_SPECIFIC);
-
-        //Now check including the reverse complement target for
-        //either strand contiguity.
-        if (status != CONTIGUOUS_STRAND_SPECIFIC &&
-                status != CONTIGUOUS_EITHER_STRAND &&
-                node->doesPathLeadOnlyToNode(this, true))
-        {
-            node->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
-            node->getReverseComplement()->upgradeContiguityStatus(CONTIGUOUS_EITHER_STRAND);
-        }
-    }
-}
-
-
-//This function differs from the above by including all reverse complement
-//nodes in the path search.
-std::vector<DeBruijnNode *> DeBruijnNode::getNodesCommonToAllPaths(std::vector< std::vector <DeBruijnNode *> > * paths,
-                                                                   bool includeReverseComplements) const
-{
-    std::vector<DeBruijnNode *> commonNodes;
-
-    //If there are no paths, then return the empty vector.
-    if (paths->size() == 0)
-        return commonNodes;
-
-    //If there is only one path in path, then they are all common nodes
-    commonNodes = (*paths)[0];
-    if (paths->size() == 1)
-        return commonNodes;
-
-    //If there are two or more paths, it's necessary to find the intersection.
-    for (size_t i = 1; i < paths->size(); ++i)
-    {
-        QApplication::processEvents();
-        std::vector <DeBruijnNode *> * path = &((*paths)[i]);
-
-        //If we are including reverse complements in the search,
-        //then it is necessary to build a new vector that includes
-        //reverse complement nodes and then use that vector.
-        std::vector <DeBruijnNode *> pathWithReverseComplements;
-        if (includeReverseComplements)
-        {
-            for (size_t j = 0; j < path->size(); ++j)
-            {
-                DeBruijnNode * node = (*path)[j];
-                pathWithReverseComplements.push_back(node);
-                pathWithReverseComplements.push_back(node->getReverseComplement());
-            }
-            path = &pathWithReverseComplements;
-        }
-
-        //Combine the commonNodes vector with the path vector,
-        //excluding any repeats.
-        std::sort(commonNodes.begin(), commonNodes.end());
-        std::sort(path->begin(), path->end());
-        std::vector<DeBruijnNode *> newCommonNodes;
-        std::set_intersection(commonNodes.begin(), commonNodes.end(), path->begin(), path->end(), std::back_inserter(newCommonNodes));
-        commonNodes = newCommonNodes;
-    }
-
-    return commonNodes;
-}
-
-
-//This function checks whether this node has any path leading outward that
-//unambiguously leads to the given node.
-//It checks a number of steps as set by the contiguitySearchSteps setting.
-//If includeReverseComplement is true, then this function returns true if
-//all paths lead either to the node or its reverse complement node.
-bool DeBruijnNode::doesPathLeadOnlyToNode(DeBruijnNode * node, bool includeReverseComplement)
-{
-    for (size_t i = 0; i < m_edges.size(); ++i)
-    {
-        DeBruijnEdge * edge = m_edges[i];
-        bool outgoingEdge = (this == edge->getStartingNode());
-
-        std::vector<DeBruijnNode *> pathSoFar;
-        pathSoFar.push_back(this);
-        if (edge->leadsOnlyToNode(outgoingEdge, g_settings->contiguitySearchSteps, node, pathSoFar, includeReverseComplement))
-            return true;
-    }
-
-    return false;
+    ContiguityEngine engine(g_settings->contiguitySearchSteps);
+    engine.determineContiguity(this);
 }
 
 
@@ -566,11 +436,12 @@ void DeBruijnNode::labelNeighbouringNodesAsDrawn(int nodeDistance, DeBruijnNode
 
 std::vector<BlastHitPart> DeBruijnNode::getBlastHitPartsForThisNode(double scaledNodeLength) const
 {
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
     std::vector<BlastHitPart> returnVector;
 
-    for (size_t i = 0; i < m_blastHits.size(); ++i)
+    for (int i = m_blastHitsStart; i < m_blastHitsStart + m_blastHitCount; ++i)
     {
-        std::vector<BlastHitPart> hitParts = m_blastHits[i]->getBlastHitParts(false, scaledNodeLength);
+        std::vector<BlastHitPart> hitParts = hits.getNodeHit(i).getBlastHitParts(false, scaledNodeLength);
         returnVector.insert(returnVector.end(), hitParts.begin(), hitParts.end());
     }
 
@@ -587,15 +458,18 @@ std::vector<BlastHitPart> DeBruijnNode::getBlastHitPartsForThisNodeOrReverseComp
     //Look for blast hit parts on both the positive and the negative node,
     //since hits were previously filtered such that startPos < endPos,
     //hence we need to look at both positive and negative nodes to recover all hits.
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
     std::vector<BlastHitPart> returnVector;
-    for (size_t i = 0; i < positiveNode->m_blastHits.size(); ++i)
+    int positiveEnd = positiveNode->m_blastHitsStart + positiveNode->m_blastHitCount;
+    for (int i = positiveNode->m_blastHitsStart; i < positiveEnd; ++i)
     {
-        std::vector<BlastHitPart> hitParts = positiveNode->m_blastHits[i]->getBlastHitParts(false, scaledNodeLength);
+        std::vector<BlastHitPart> hitParts = hits.getNodeHit(i).getBlastHitParts(false, scaledNodeLength);
         returnVector.insert(returnVector.end(), hitParts.begin(), hitParts.end());
     }
-    for (size_t i = 0; i < negativeNode->m_blastHits.size(); ++i)
+    int negativeEnd = negativeNode->m_blastHitsStart + negativeNode->m_blastHitCount;
+    for (int i = negativeNode->m_blastHitsStart; i < negativeEnd; ++i)
     {
-        std::vector<BlastHitPart> hitParts = negativeNode->m_blastHits[i]->getBlastHitParts(true, scaledNodeLength);
+        std::vector<BlastHitPart> hitParts = hits.getNodeHit(i).getBlastHitParts(true, scaledNodeLength);
         returnVector.insert(returnVector.end(), hitParts.begin(), hitParts.end());
     }
 
@@ -31,7 +31,6 @@
 class OgdfNode;
 class DeBruijnEdge;
 class GraphicsItemNode;
-class BlastHit;
 
 class DeBruijnNode
 {
@@ -70,6 +69,7 @@ public:
     bool isDrawn() const {return m_drawn;}
     bool thisNodeOrReverseComplementIsDrawn() const {return isDrawn() || getReverseComplement()->isDrawn();}
     bool isNotDrawn() const {return !m_drawn;}
+    bool isMarkedForDeletion() const {return m_markedForDeletion;}
     QColor getCustomColour() const {return m_customColour;}
     QColor getCustomColourForDisplay() const;
     QString getCustomLabel() const {return m_customLabel;}
@@ -82,9 +82,10 @@ public:
     bool thisOrReverseComplementInOgdf() const {return (inOgdf() || getReverseComplement()->inOgdf());}
     bool thisOrReverseComplementNotInOgdf() const {return !thisOrReverseComplementInOgdf();}
     bool isNodeConnected(DeBruijnNode * node) const;
-    const std::vector<BlastHit *> * getBlastHitsPointer() const {return &m_blastHits;}
-    bool thisNodeHasBlastHits() const {return m_blastHits.size() > 0;}
-    bool thisNodeOrReverseComplementHasBlastHits() const {return m_blastHits.size() > 0 || getReverseComplement()->m_blastHits.size() > 0;}
+    int getBlastHitsStart() const {return m_blastHitsStart;}
+    int getBlastHitCount() const {return m_blastHitCount;}
+    bool thisNodeHasBlastHits() const {return m_blastHitCount > 0;}
+    bool thisNodeOrReverseComplementHasBlastHits() const {return m_blastHitCount > 0 || getReverseComplement()->m_blastHitCount > 0;}
     DeBruijnEdge * doesNodeLeadIn(DeBruijnNode * node) const;
     DeBruijnEdge * doesNodeLeadAway(DeBruijnNode * node) const;
     std::vector<BlastHitPart> getBlastHitPartsForThisNode(double scaledNodeLength) const;
@@ -111,16 +112,19 @@ public:
     void setAsNotSpecial() {m_specialNode = false;}
     void setAsDrawn() {m_drawn = true;}
     void setAsNotDrawn() {m_drawn = false;}
+    void markForDeletion() {m_markedForDeletion = true;}
+    void unmarkForDeletion() {m_markedForDeletion = false;}
     void setCustomColour(QColor newColour) {m_customColour = newColour;}
     void setCustomLabel(QString newLabel);
     void resetNode();
     void addEdge(DeBruijnEdge * edge);
     void removeEdge(DeBruijnEdge * edge);
+    void removeEdgesMarkedForDeletion();
     void addToOgdfGraph(ogdf::Graph * ogdfGraph, ogdf::GraphAttributes * graphAttributes,
                         ogdf::EdgeArray<double> * edgeArray, double xPos, double yPos);
     void determineContiguity();
-    void clearBlastHits() {m_blastHits.clear();}
-    void addBlastHit(BlastHit * newHit) {m_blastHits.push_back(newHit);}
+    void clearBlastHits() {m_blastHitsStart = 0; m_blastHitCount = 0;}
+    void setBlastHits(int start, int count) {m_blastHitsStart = start; m_blastHitCount = count;}
     void labelNeighbouringNodesAsDrawn(int nodeDistance, DeBruijnNode * callingNode);
     void setCsvData(QStringList csvData) {m_csvData = csvData;}
     void clearCsvData() {m_csvData.clear();}
@@ -140,10 +144,14 @@ private:
     std::vector<DeBruijnEdge *> m_edges;
     bool m_specialNode;
     bool m_drawn;
+    bool m_markedForDeletion;
     int m_highestDistanceInNeighbourSearch;
     QColor m_customColour;
     QString m_customLabel;
-    std::vector<BlastHit *> m_blastHits;
+    //The node's BLAST hits are a span of the hit store's node hits (see
+    //BlastHitStore::setNodeHits).
+    int m_blastHitsStart;
+    int m_blastHitCount;
     QStringList m_csvData;
     QString getNodeNameForFasta(bool sign) const;
     QByteArray getUpstreamSequence(int upstreamSequenceLength) const;
@@ -155,9 +163,6 @@ private:
     bool isNotOnlyPathInItsDirection(DeBruijnNode * connectedNode,
                                      std::vector<DeBruijnNode *> * incomingNodes,
                                      std::vector<DeBruijnNode *> * outgoingNodes) const;
-    std::vector<DeBruijnNode *> getNodesCommonToAllPaths(std::vector< std::vector <DeBruijnNode *> > * paths,
-                                                         bool includeReverseComplements) const;
-    bool doesPathLeadOnlyToNode(DeBruijnNode * node, bool includeReverseComplement);
 };
 
 #endif // DEBRUIJNNODE_H
@@ -0,0 +1,420 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "graphcleaner.h"
+#include "assemblygraph.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include "shortestpathfinder.h"
+#include <QSet>
+#include <QQueue>
+#include <algorithm>
+#include <utility>
+
+//Each node pair and each edge pair gets one index, which is used for its
+//flag in the removal arrays.
+GraphCleaner::GraphCleaner(AssemblyGraph * assemblyGraph) :
+    m_assemblyGraph(assemblyGraph)
+{
+    QMapIterator<QString, DeBruijnNode*> i(m_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        if (node->isNegativeNode())
+            continue;
+        int index = int(m_nodes.size());
+        m_nodes.push_back(node);
+        m_nodeIndices.insert(node, index);
+        m_nodeIndices.insert(node->getReverseComplement(), index);
+    }
+    m_nodeRemoved.resize(m_nodes.size(), false);
+
+    QMapIterator<QPair<DeBruijnNode*, DeBruijnNode*>, DeBruijnEdge*> j(m_assemblyGraph->m_deBruijnGraphEdges);
+    while (j.hasNext())
+    {
+        j.next();
+        DeBruijnEdge * edge = j.value();
+        if (m_edgeIndices.contains(edge))
+            continue;
+        int index = int(m_edges.size());
+        m_edges.push_back(edge);
+        m_edgeIndices.insert(edge, index);
+        m_edgeIndices.insert(edge->getReverseComplement(), index);
+    }
+    m_edgeRemoved.resize(m_edges.size(), false);
+}
+
+
+bool GraphCleaner::isNodeRemoved(DeBruijnNode * node) const
+{
+    return m_nodeRemoved[m_nodeIndices[node]];
+}
+
+
+//An edge is also removed if either of its nodes is.
+bool GraphCleaner::isEdgeRemoved(DeBruijnEdge * edge) const
+{
+    return m_edgeRemoved[m_edgeIndices[edge]] ||
+            isNodeRemoved(edge->getStartingNode()) ||
+            isNodeRemoved(edge->getEndingNode());
+}
+
+
+//This function removes tips: chains of nodes which start at a dead end and
+//lead unambiguously to a node where they join the rest of the graph.  Tips
+//are removed shortest first, and a tip is kept if the node it joins no longer
+//has another way in, so only one of two competing short tips is removed.
+void GraphCleaner::clipTips(int maxTipLength)
+{
+    int nodeCountBefore, edgeCountBefore;
+    long long totalLengthBefore;
+    getFlaggedGraphSize(&nodeCountBefore, &edgeCountBefore, &totalLengthBefore);
+
+    std::vector< std::vector<DeBruijnNode *> > tips;
+    std::vector<DeBruijnNode *> joinNodes;
+    std::vector< std::pair<long long, int> > tipOrder;
+    QMapIterator<QString, DeBruijnNode*> i(m_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        std::vector<DeBruijnNode *> tipNodes;
+        DeBruijnNode * joinNode;
+        long long tipLength;
+        if (findTip(i.value(), maxTipLength, &tipNodes, &joinNode, &tipLength))
+        {
+            tipOrder.push_back(std::pair<long long, int>(tipLength, int(tips.size())));
+            tips.push_back(tipNodes);
+            joinNodes.push_back(joinNode);
+        }
+    }
+    std::sort(tipOrder.begin(), tipOrder.end());
+
+    for (size_t j = 0; j < tipOrder.size(); ++j)
+    {
+        int tipIndex = tipOrder[j].second;
+        if (isNodeRemoved(joinNodes[tipIndex]) || getEnteringEdges(joinNodes[tipIndex]).size() < 2)
+            continue;
+        for (size_t k = 0; k < tips[tipIndex].size(); ++k)
+            m_nodeRemoved[m_nodeIndices[tips[tipIndex][k]]] = true;
+    }
+
+    int nodeCountAfter, edgeCountAfter;
+    long long totalLengthAfter;
+    getFlaggedGraphSize(&nodeCountAfter, &edgeCountAfter, &totalLengthAfter);
+    addPass("Tip clipping", nodeCountBefore, edgeCountBefore, totalLengthBefore,
+            nodeCountAfter, edgeCountAfter, totalLengthAfter);
+}
+
+
+//This function removes nodes with a depth below the given fraction of the
+//graph's median depth (by base).  It also removes edges where the depth of
+//one node is below the given fraction of the other's, weakest first, as long
+//as both nodes keep another edge on that side.
+void GraphCleaner::pruneLowDepth(double minRelativeDepth)
+{
+    int nodeCountBefore, edgeCountBefore;
+    long long totalLengthBefore;
+    getFlaggedGraphSize(&nodeCountBefore, &edgeCountBefore, &totalLengthBefore);
+
+    double minDepth = minRelativeDepth * m_assemblyGraph->getMedianDepthByBase();
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (!m_nodeRemoved[i] && m_nodes[i]->getDepth() < minDepth)
+            m_nodeRemoved[i] = true;
+    }
+
+    std::vector< std::pair<double, int> > edgeOrder;
+    for (size_t i = 0; i < m_edges.size(); ++i)
+    {
+        DeBruijnEdge * edge = m_edges[i];
+        if (isEdgeRemoved(edge) || edge->getStartingNode() == edge->getEndingNode())
+            continue;
+        double startDepth = edge->getStartingNode()->getDepth();
+        double endDepth = edge->getEndingNode()->getDepth();
+        double higherDepth = std::max(startDepth, endDepth);
+        if (higherDepth <= 0.0)
+            continue;
+        double depthRatio = std::min(startDepth, endDepth) / higherDepth;
+        if (depthRatio < minRelativeDepth)
+            edgeOrder.push_back(std::pair<double, int>(depthRatio, int(i)));
+    }
+    std::sort(edgeOrder.begin(), edgeOrder.end());
+
+    for (size_t i = 0; i < edgeOrder.size(); ++i)
+    {
+        DeBruijnEdge * edge = m_edges[edgeOrder[i].second];
+        if (getLeavingEdges(edge->getStartingNode()).size() >= 2 &&
+                getEnteringEdges(edge->getEndingNode()).size() >= 2)
+            m_edgeRemoved[edgeOrder[i].second] = true;
+    }
+
+    int nodeCountAfter, edgeCountAfter;
+    long long totalLengthAfter;
+    getFlaggedGraphSize(&nodeCountAfter, &edgeCountAfter, &totalLengthAfter);
+    addPass("Low depth pruning", nodeCountBefore, edgeCountBefore, totalLengthBefore,
+            nodeCountAfter, edgeCountAfter, totalLengthAfter);
+}
+
+
+//This function removes connected components with a total node length below
+//the given length.
+void GraphCleaner::removeSmallComponents(long long minComponentLength)
+{
+    int nodeCountBefore, edgeCountBefore;
+    long long totalLengthBefore;
+    getFlaggedGraphSize(&nodeCountBefore, &edgeCountBefore, &totalLengthBefore);
+
+    std::vector<bool> visited(m_nodes.size(), false);
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (m_nodeRemoved[i] || visited[i])
+            continue;
+
+        std::vector<int> component;
+        long long componentLength = 0;
+        QQueue<int> q;
+        q.enqueue(int(i));
+        visited[i] = true;
+
+        while (!q.isEmpty())
+        {
+            int index = q.dequeue();
+            DeBruijnNode * node = m_nodes[index];
+            component.push_back(index);
+            componentLength += node->getLength();
+
+            //Every edge of the reverse complement node has a reverse
+            //complement edge on this node, so this node's edges are enough.
+            const std::vector<DeBruijnEdge *> * edges = node->getEdgesPointer();
+            for (size_t j = 0; j < edges->size(); ++j)
+            {
+                DeBruijnEdge * edge = (*edges)[j];
+                if (isEdgeRemoved(edge))
+                    continue;
+                DeBruijnNode * otherNode = edge->getOtherNode(node);
+                int otherIndex = m_nodeIndices[otherNode];
+                if (!visited[otherIndex])
+                {
+                    visited[otherIndex] = true;
+                    q.enqueue(otherIndex);
+                }
+            }
+        }
+
+        if (componentLength < minComponentLength)
+        {
+            for (size_t j = 0; j < component.size(); ++j)
+                m_nodeRemoved[component[j]] = true;
+        }
+    }
+
+    int nodeCountAfter, edgeCountAfter;
+    long long totalLengthAfter;
+    getFlaggedGraphSize(&nodeCountAfter, &edgeCountAfter, &totalLengthAfter);
+    addPass("Small component removal", nodeCountBefore, edgeCountBefore, totalLengthBefore,
+            nodeCountAfter, edgeCountAfter, totalLengthAfter);
+}
+
+
+//This function deletes everything flagged by the earlier passes from the
+//graph in one go.  The flags refer to the deleted nodes and edges, so no
+//removal passes can be run after this.
+void GraphCleaner::deleteRemovedNodesAndEdges()
+{
+    std::vector<DeBruijnNode *> nodesToDelete;
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (m_nodeRemoved[i])
+            nodesToDelete.push_back(m_nodes[i]);
+    }
+
+    //Edges attached to a deleted node are deleted with it, so only the
+    //edges removed in their own right are needed.
+    std::vector<DeBruijnEdge *> edgesToDelete;
+    for (size_t i = 0; i < m_edges.size(); ++i)
+    {
+        DeBruijnEdge * edge = m_edges[i];
+        if (m_edgeRemoved[i] && !isNodeRemoved(edge->getStartingNode()) &&
+                !isNodeRemoved(edge->getEndingNode()))
+            edgesToDelete.push_back(edge);
+    }
+
+    m_assemblyGraph->deleteNodesAndEdges(&nodesToDelete, &edgesToDelete);
+
+    m_nodeIndices.clear();
+    m_edgeIndices.clear();
+    m_nodes.clear();
+    m_edges.clear();
+    m_nodeRemoved.clear();
+    m_edgeRemoved.clear();
+}
+
+
+void GraphCleaner::mergeUnitigs()
+{
+    int nodeCountBefore, edgeCountBefore;
+    long long totalLengthBefore;
+    getGraphSize(&nodeCountBefore, &edgeCountBefore, &totalLengthBefore);
+
+    m_assemblyGraph->mergeAllPossible();
+
+    int nodeCountAfter, edgeCountAfter;
+    long long totalLengthAfter;
+    getGraphSize(&nodeCountAfter, &edgeCountAfter, &totalLengthAfter);
+    addPass("Unitig merging", nodeCountBefore, edgeCountBefore, totalLengthBefore,
+            nodeCountAfter, edgeCountAfter, totalLengthAfter);
+}
+
+
+std::vector<DeBruijnEdge *> GraphCleaner::getLeavingEdges(DeBruijnNode * node) const
+{
+    std::vector<DeBruijnEdge *> leavingEdges;
+    const std::vector<DeBruijnEdge *> * edges = node->getEdgesPointer();
+    for (size_t i = 0; i < edges->size(); ++i)
+    {
+        DeBruijnEdge * edge = (*edges)[i];
+        if (edge->getStartingNode() == node && !isEdgeRemoved(edge))
+            leavingEdges.push_back(edge);
+    }
+    return leavingEdges;
+}
+
+
+std::vector<DeBruijnEdge *> GraphCleaner::getEnteringEdges(DeBruijnNode * node) const
+{
+    std::vector<DeBruijnEdge *> enteringEdges;
+    const std::vector<DeBruijnEdge *> * edges = node->getEdgesPointer();
+    for (size_t i = 0; i < edges->size(); ++i)
+    {
+        DeBruijnEdge * edge = (*edges)[i];
+        if (edge->getEndingNode() == node && !isEdgeRemoved(edge))
+            enteringEdges.push_back(edge);
+    }
+    return enteringEdges;
+}
+
+
+//This function checks whether the given node is the start of a tip shorter
+//than the maximum length.  Starting at a node with no way in, it follows
+//the single way out of each node until it reaches a node with more than
+//one way in, where the tip joins the graph.  It is not a tip if it comes to
+//another dead end (an isolated chain, left for the component pass), splits
+//before joining, or loops back on itself.
+bool GraphCleaner::findTip(DeBruijnNode * deadEndNode, int maxTipLength,
+                           std::vector<DeBruijnNode *> * tipNodes, DeBruijnNode ** joinNode,
+                           long long * tipLength) const
+{
+    if (isNodeRemoved(deadEndNode) || getEnteringEdges(deadEndNode).size() > 0)
+        return false;
+
+    tipNodes->clear();
+    tipNodes->push_back(deadEndNode);
+    *tipLength = deadEndNode->getLength();
+    QSet<int> tipNodeIndices;
+    tipNodeIndices.insert(m_nodeIndices[deadEndNode]);
+
+    DeBruijnNode * node = deadEndNode;
+    while (*tipLength < maxTipLength)
+    {
+        std::vector<DeBruijnEdge *> leavingEdges = getLeavingEdges(node);
+        if (leavingEdges.size() != 1)
+            return false;
+
+        DeBruijnNode * nextNode = leavingEdges[0]->getEndingNode();
+        if (tipNodeIndices.contains(m_nodeIndices[nextNode]))
+            return false;
+
+        if (getEnteringEdges(nextNode).size() > 1)
+        {
+            *joinNode = nextNode;
+            return true;
+        }
+
+        *tipLength += ShortestPathFinder::getAddedLength(leavingEdges[0]);
+        tipNodes->push_back(nextNode);
+        tipNodeIndices.insert(m_nodeIndices[nextNode]);
+        node = nextNode;
+    }
+
+    return false;
+}
+
+
+void GraphCleaner::getFlaggedGraphSize(int * nodeCount, int * edgeCount, long long * totalLength) const
+{
+    *nodeCount = 0;
+    *edgeCount = 0;
+    *totalLength = 0;
+    for (size_t i = 0; i < m_nodes.size(); ++i)
+    {
+        if (m_nodeRemoved[i])
+            continue;
+        ++(*nodeCount);
+        *totalLength += m_nodes[i]->getLength();
+    }
+    for (size_t i = 0; i < m_edges.size(); ++i)
+    {
+        if (!isEdgeRemoved(m_edges[i]))
+            ++(*edgeCount);
+    }
+}
+
+
+void GraphCleaner::getGraphSize(int * nodeCount, int * edgeCount, long long * totalLength) const
+{
+    *nodeCount = 0;
+    *edgeCount = 0;
+    *totalLength = 0;
+
+    QMapIterator<QString, DeBruijnNode*> i(m_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        if (node->isNegativeNode())
+            continue;
+        ++(*nodeCount);
+        *totalLength += node->getLength();
+    }
+
+    QSet<DeBruijnEdge *> countedEdges;
+    QMapIterator<QPair<DeBruijnNode*, DeBruijnNode*>, DeBruijnEdge*> j(m_assemblyGraph->m_deBruijnGraphEdges);
+    while (j.hasNext())
+    {
+        j.next();
+        DeBruijnEdge * edge = j.value();
+        if (countedEdges.contains(edge))
+            continue;
+        ++(*edgeCount);
+        countedEdges.insert(edge);
+        countedEdges.insert(edge->getReverseComplement());
+    }
+}
+
+
+void GraphCleaner::addPass(QString name, int nodeCountBefore, int edgeCountBefore, long long totalLengthBefore,
+                           int nodeCountAfter, int edgeCountAfter, long long totalLengthAfter)
+{
+    GraphCleaningPass pass;
+    pass.name = name;
+    pass.nodesRemoved = nodeCountBefore - nodeCountAfter;
+    pass.edgesRemoved = edgeCountBefore - edgeCountAfter;
+    pass.lengthRemoved = totalLengthBefore - totalLengthAfter;
+    m_passes.push_back(pass);
+}
@@ -0,0 +1,87 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef GRAPHCLEANER_H
+#define GRAPHCLEANER_H
+
+#include <vector>
+#include <QString>
+#include <QHash>
+
+class AssemblyGraph;
+class DeBruijnNode;
+class DeBruijnEdge;
+
+//This holds what one cleaning pass removed.  Nodes and edges are counted
+//with their reverse complements as one.
+struct GraphCleaningPass
+{
+    QString name;
+    int nodesRemoved;
+    int edgesRemoved;
+    long long lengthRemoved;
+};
+
+
+//This class cleans a graph with a series of passes.  The removal passes
+//don't change the graph: they only set flags in arrays indexed by node pair
+//and edge pair, and later passes only see what earlier passes left.  Each
+//of these passes is linear in the size of the graph (apart from sorting the
+//candidates so the weakest are removed first).  Once they are done, all
+//flagged nodes and edges are deleted from the graph at once, and then the
+//unitigs can be merged.
+class GraphCleaner
+{
+public:
+    //CREATORS
+    GraphCleaner(AssemblyGraph * assemblyGraph);
+
+    //ACCESSORS
+    std::vector<GraphCleaningPass> getPasses() const {return m_passes;}
+    bool isNodeRemoved(DeBruijnNode * node) const;
+    bool isEdgeRemoved(DeBruijnEdge * edge) const;
+
+    //MODIFERS
+    void clipTips(int maxTipLength);
+    void pruneLowDepth(double minRelativeDepth);
+    void removeSmallComponents(long long minComponentLength);
+    void deleteRemovedNodesAndEdges();
+    void mergeUnitigs();
+
+private:
+    AssemblyGraph * m_assemblyGraph;
+    QHash<DeBruijnNode *, int> m_nodeIndices;
+    QHash<DeBruijnEdge *, int> m_edgeIndices;
+    std::vector<DeBruijnNode *> m_nodes;
+    std::vector<DeBruijnEdge *> m_edges;
+    std::vector<bool> m_nodeRemoved;
+    std::vector<bool> m_edgeRemoved;
+    std::vector<GraphCleaningPass> m_passes;
+
+    std::vector<DeBruijnEdge *> getLeavingEdges(DeBruijnNode * node) const;
+    std::vector<DeBruijnEdge *> getEnteringEdges(DeBruijnNode * node) const;
+    bool findTip(DeBruijnNode * deadEndNode, int maxTipLength,
+                 std::vector<DeBruijnNode *> * tipNodes, DeBruijnNode ** joinNode,
+                 long long * tipLength) const;
+    void getFlaggedGraphSize(int * nodeCount, int * edgeCount, long long * totalLength) const;
+    void getGraphSize(int * nodeCount, int * edgeCount, long long * totalLength) const;
+    void addPass(QString name, int nodeCountBefore, int edgeCountBefore, long long totalLengthBefore,
+                 int nodeCountAfter, int edgeCountAfter, long long totalLengthAfter);
+};
+
+#endif // GRAPHCLEANER_H
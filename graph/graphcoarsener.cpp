@@ -0,0 +1,700 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "graphcoarsener.h"
+#include "assemblygraph.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include "../program/globals.h"
+#include <algorithm>
+#include <limits>
+
+GraphCoarsener::GraphCoarsener(AssemblyGraph * assemblyGraph) :
+    m_assemblyGraph(assemblyGraph), m_allLevelsBuilt(false), m_level(0),
+    m_superNodeCount(0)
+{
+    buildOriginalLevel();
+}
+
+
+
+//This function builds level 0, which has one node for each node pair in the
+//graph.
+void GraphCoarsener::buildOriginalLevel()
+{
+    std::vector<CoarseNode> nodes;
+    QMapIterator<QString, DeBruijnNode*> i(m_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        if (node->isNegativeNode())
+            continue;
+        int index = int(nodes.size());
+        m_nodeIndices.insert(node, index);
+        m_nodeIndices.insert(node->getReverseComplement(), index);
+
+        CoarseNode coarseNode;
+        coarseNode.name = node->getNameWithoutSign();
+        coarseNode.type = ORIGINAL_NODE;
+        coarseNode.length = node->getLength();
+        coarseNode.depth = node->getDepth();
+        coarseNode.originalNodeCount = 1;
+        coarseNode.originalNode = node;
+        nodes.push_back(coarseNode);
+    }
+
+    m_topLevelEdges.clear();
+    m_topLevelEdges.resize(nodes.size() * 2);
+    QMapIterator<QPair<DeBruijnNode*, DeBruijnNode*>, DeBruijnEdge*> j(m_assemblyGraph->m_deBruijnGraphEdges);
+    while (j.hasNext())
+    {
+        j.next();
+        DeBruijnNode * startingNode = j.value()->getStartingNode();
+        DeBruijnNode * endingNode = j.value()->getEndingNode();
+        int start = m_nodeIndices[startingNode] * 2 + (startingNode->isNegativeNode() ? 1 : 0);
+        int end = m_nodeIndices[endingNode] * 2 + (endingNode->isNegativeNode() ? 1 : 0);
+        m_topLevelEdges[start].push_back(end);
+    }
+
+    m_levels.push_back(nodes);
+}
+
+
+
+//This function moves to the given level, building any levels up to it which
+//don't exist yet.  If the graph can't be coarsened that far, the highest
+//level is used.  Expanded super-nodes are forgotten.
+void GraphCoarsener::setLevel(int level)
+{
+    if (level < 0)
+        level = 0;
+    while (level >= getLevelCount() && buildNextLevel())
+    {
+    }
+    m_level = std::min(level, getLevelCount() - 1);
+    m_expandedNodes.clear();
+}
+
+
+//This function marks a super-node of the current level (or below) to be
+//shown as its children.  It returns false if there is no such super-node or
+//it is already expanded.
+bool GraphCoarsener::expandNode(QString nodeName)
+{
+    if (!m_superNodes.contains(nodeName))
+        return false;
+
+    QPair<int, int> superNode = m_superNodes[nodeName];
+    if (superNode.first > m_level || m_expandedNodes.contains(superNode))
+        return false;
+
+    m_expandedNodes.insert(superNode);
+    return true;
+}
+
+
+
+//This function builds the next level up.  It returns false if there is
+//nothing left to coarsen.
+bool GraphCoarsener::buildNextLevel()
+{
+    if (m_allLevelsBuilt)
+        return false;
+
+    int level = getLevelCount();
+    std::vector<CoarseNodeGroup> groups;
+
+    if (level == 1)
+        groups = findChains(m_topLevelEdges);
+
+    //Collapsing a bubble usually makes a chain of its entrance, the bubble
+    //and its exit, and that chain may then be a branch of a bigger bubble.
+    //So bubbles and chains are collapsed in turn until no bubbles are left.
+    else if (level == 2)
+    {
+        for (size_t i = 0; i < m_levels.back().size(); ++i)
+        {
+            CoarseNodeGroup group;
+            group.members.push_back(int(i) * 2);
+            group.type = ORIGINAL_NODE;
+            groups.push_back(group);
+        }
+
+        SignedAdjacency edges = m_topLevelEdges;
+        while (true)
+        {
+            std::vector<CoarseNodeGroup> bubbles = findBubbles(edges);
+            if (!mergesAnything(bubbles))
+                break;
+            groups = composeGroups(groups, bubbles);
+            edges = getGroupEdges(edges, bubbles);
+
+            std::vector<CoarseNodeGroup> chains = findChains(edges);
+            groups = composeGroups(groups, chains);
+            edges = getGroupEdges(edges, chains);
+        }
+    }
+
+    else
+    {
+        groups = findClusters(m_topLevelEdges, m_levels.back());
+        if (!mergesAnything(groups))
+        {
+            m_allLevelsBuilt = true;
+            return false;
+        }
+    }
+
+    addLevel(groups);
+    return true;
+}
+
+
+//This function makes a new level with one node for each group of nodes in
+//the current highest level.
+void GraphCoarsener::addLevel(const std::vector<CoarseNodeGroup> & groups)
+{
+    int level = getLevelCount();
+    const std::vector<CoarseNode> & lowerNodes = m_levels.back();
+
+    std::vector<CoarseNode> nodes;
+    nodes.reserve(groups.size());
+    std::vector<int> parents(lowerNodes.size());
+    std::vector<bool> flippedInParents(lowerNodes.size());
+
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        const std::vector<int> & members = groups[i].members;
+        CoarseNode node;
+        node.length = 0;
+        node.originalNodeCount = 0;
+        node.originalNode = 0;
+        double depthTimesLength = 0.0;
+        double depthSum = 0.0;
+
+        for (size_t j = 0; j < members.size(); ++j)
+        {
+            int child = members[j] / 2;
+            bool flipped = (members[j] % 2 == 1);
+            const CoarseNode & childNode = lowerNodes[child];
+            node.children.push_back(child);
+            node.flippedChildren.push_back(flipped);
+            node.length += childNode.length;
+            node.originalNodeCount += childNode.originalNodeCount;
+            depthTimesLength += childNode.depth * childNode.length;
+            depthSum += childNode.depth;
+            parents[child] = int(i);
+            flippedInParents[child] = flipped;
+        }
+
+        //A node on its own is carried up unchanged.
+        if (members.size() == 1)
+        {
+            const CoarseNode & childNode = lowerNodes[members[0] / 2];
+            node.name = childNode.name;
+            node.type = childNode.type;
+            node.depth = childNode.depth;
+            node.originalNode = childNode.originalNode;
+        }
+        else
+        {
+            node.type = groups[i].type;
+            node.name = getNewSuperNodeName(node.type);
+            if (node.length > 0)
+                node.depth = depthTimesLength / node.length;
+            else
+                node.depth = depthSum / members.size();
+            m_superNodes.insert(node.name, QPair<int, int>(level, int(i)));
+        }
+        nodes.push_back(node);
+    }
+
+    m_topLevelEdges = getGroupEdges(m_topLevelEdges, groups);
+    m_parents.push_back(parents);
+    m_flippedInParents.push_back(flippedInParents);
+    m_levels.push_back(nodes);
+}
+
+
+//Super-node names are numbered in the order the super-nodes are made.  A
+//number is skipped if its name is already used by a node in the graph.
+QString GraphCoarsener::getNewSuperNodeName(CoarseNodeType type)
+{
+    QString prefix;
+    if (type == CHAIN_NODE)
+        prefix = "chain_";
+    else if (type == BUBBLE_NODE)
+        prefix = "bubble_";
+    else
+        prefix = "cluster_";
+
+    QString name;
+    do
+    {
+        ++m_superNodeCount;
+        name = prefix + QString::number(m_superNodeCount);
+    }
+    while (m_assemblyGraph->m_deBruijnGraphNodes.contains(name + "+"));
+    return name;
+}
+
+
+
+//This function returns the node that follows the given one if the edge
+//between them is the only way out of the first and the only way into the
+//second.  Otherwise it returns -1.
+int GraphCoarsener::getSimpleSuccessor(const SignedAdjacency & edges, int signedNode)
+{
+    if (edges[signedNode].size() != 1)
+        return -1;
+    int next = edges[signedNode][0];
+    if (next / 2 == signedNode / 2)
+        return -1;
+    if (edges[next ^ 1].size() != 1)
+        return -1;
+    return next;
+}
+
+int GraphCoarsener::getSimplePredecessor(const SignedAdjacency & edges, int signedNode)
+{
+    int previous = getSimpleSuccessor(edges, signedNode ^ 1);
+    if (previous < 0)
+        return -1;
+    return previous ^ 1;
+}
+
+
+//This function groups the nodes into maximal non-branching chains.  Each
+//chain's + strand follows the chain's direction.
+std::vector<CoarseNodeGroup> GraphCoarsener::findChains(const SignedAdjacency & edges)
+{
+    int nodeCount = int(edges.size()) / 2;
+    std::vector<bool> grouped(nodeCount, false);
+    std::vector<int> walkedFrom(nodeCount, -1);
+    std::vector<CoarseNodeGroup> groups;
+
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (grouped[i])
+            continue;
+
+        //Walk back to the start of the chain, stopping if the chain turns
+        //out to be a cycle.
+        int start = i * 2;
+        walkedFrom[i] = i;
+        while (true)
+        {
+            int previous = getSimplePredecessor(edges, start);
+            if (previous < 0 || grouped[previous / 2] || walkedFrom[previous / 2] == i)
+                break;
+            walkedFrom[previous / 2] = i;
+            start = previous;
+        }
+
+        CoarseNodeGroup group;
+        group.type = CHAIN_NODE;
+        group.members.push_back(start);
+        grouped[start / 2] = true;
+        int current = start;
+        while (true)
+        {
+            int next = getSimpleSuccessor(edges, current);
+            if (next < 0 || grouped[next / 2])
+                break;
+            group.members.push_back(next);
+            grouped[next / 2] = true;
+            current = next;
+        }
+        groups.push_back(group);
+    }
+
+    return groups;
+}
+
+
+//This function groups the branches of simple bubbles: two or more nodes
+//which each lead only from the same node and only to the same node.  Nodes
+//which aren't in a bubble are left on their own.
+std::vector<CoarseNodeGroup> GraphCoarsener::findBubbles(const SignedAdjacency & edges)
+{
+    int nodeCount = int(edges.size()) / 2;
+    std::vector<bool> grouped(nodeCount, false);
+    std::vector<CoarseNodeGroup> groups;
+
+    for (int start = 0; start < nodeCount * 2; ++start)
+    {
+        const std::vector<int> & branches = edges[start];
+        if (branches.size() < 2)
+            continue;
+
+        int end = -1;
+        bool isBubble = true;
+        for (size_t j = 0; j < branches.size() && isBubble; ++j)
+        {
+            int branch = branches[j];
+            if (grouped[branch / 2] || branch / 2 == start / 2 ||
+                    edges[branch].size() != 1 || edges[branch ^ 1].size() != 1)
+                isBubble = false;
+            else if (end == -1)
+                end = edges[branch][0];
+            else if (edges[branch][0] != end)
+                isBubble = false;
+        }
+        if (!isBubble || end / 2 == start / 2)
+            continue;
+
+        //Each branch must be a different node pair, and not the end.
+        std::vector<int> branchPairs;
+        for (size_t j = 0; j < branches.size(); ++j)
+            branchPairs.push_back(branches[j] / 2);
+        branchPairs.push_back(end / 2);
+        std::sort(branchPairs.begin(), branchPairs.end());
+        if (std::adjacent_find(branchPairs.begin(), branchPairs.end()) != branchPairs.end())
+            continue;
+
+        CoarseNodeGroup group;
+        group.type = BUBBLE_NODE;
+        group.members = branches;
+        for (size_t j = 0; j < branches.size(); ++j)
+            grouped[branches[j] / 2] = true;
+        groups.push_back(group);
+    }
+
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        if (grouped[i])
+            continue;
+        CoarseNodeGroup group;
+        group.type = ORIGINAL_NODE;
+        group.members.push_back(i * 2);
+        groups.push_back(group);
+    }
+
+    return groups;
+}
+
+
+//This function groups neighbouring nodes into clusters.  Starting with the
+//smallest, each node not yet in a cluster is paired with its smallest free
+//neighbour.  If all of its neighbours are taken, it joins the smallest of
+//their clusters, so the leaves of dense, star-like regions end up together.
+//The nodes are oriented so that the edges joining them run along the
+//cluster's + strand.
+std::vector<CoarseNodeGroup> GraphCoarsener::findClusters(const SignedAdjacency & edges,
+                                                          const std::vector<CoarseNode> & nodes)
+{
+    int nodeCount = int(nodes.size());
+    std::vector<int> order(nodeCount);
+    for (int i = 0; i < nodeCount; ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&nodes](int a, int b) {
+        if (nodes[a].originalNodeCount != nodes[b].originalNodeCount)
+            return nodes[a].originalNodeCount < nodes[b].originalNodeCount;
+        if (nodes[a].length != nodes[b].length)
+            return nodes[a].length < nodes[b].length;
+        return a < b;});
+
+    std::vector<int> groupOf(nodeCount, -1);
+    std::vector<bool> flipOf(nodeCount, false);
+    std::vector<int> groupSizes;
+    std::vector<CoarseNodeGroup> groups;
+
+    for (int i = 0; i < nodeCount; ++i)
+    {
+        int node = order[i];
+        if (groupOf[node] >= 0)
+            continue;
+
+        //Look for the best neighbour, remembering the strands of the edge
+        //which joins them.
+        int freeNeighbour = -1, freeNodeStrand = 0, freeNeighbourStrand = 0;
+        int takenNeighbour = -1, takenNodeStrand = 0, takenNeighbourStrand = 0;
+        for (int strand = 0; strand < 2; ++strand)
+        {
+            const std::vector<int> & leavingEdges = edges[node * 2 + strand];
+            for (size_t j = 0; j < leavingEdges.size(); ++j)
+            {
+                int neighbour = leavingEdges[j] / 2;
+                if (neighbour == node)
+                    continue;
+                if (groupOf[neighbour] < 0)
+                {
+                    if (freeNeighbour < 0 ||
+                            nodes[neighbour].originalNodeCount < nodes[freeNeighbour].originalNodeCount ||
+                            (nodes[neighbour].originalNodeCount == nodes[freeNeighbour].originalNodeCount &&
+                             nodes[neighbour].length < nodes[freeNeighbour].length))
+                    {
+                        freeNeighbour = neighbour;
+                        freeNodeStrand = strand;
+                        freeNeighbourStrand = leavingEdges[j] % 2;
+                    }
+                }
+                else if (takenNeighbour < 0 ||
+                         groupSizes[groupOf[neighbour]] < groupSizes[groupOf[takenNeighbour]])
+                {
+                    takenNeighbour = neighbour;
+                    takenNodeStrand = strand;
+                    takenNeighbourStrand = leavingEdges[j] % 2;
+                }
+            }
+        }
+
+        if (freeNeighbour >= 0)
+        {
+            CoarseNodeGroup group;
+            group.type = CLUSTER_NODE;
+            flipOf[node] = false;
+            flipOf[freeNeighbour] = ((freeNodeStrand ^ freeNeighbourStrand) == 1);
+            group.members.push_back(node * 2);
+            group.members.push_back(freeNeighbour * 2 + (flipOf[freeNeighbour] ? 1 : 0));
+            groupOf[node] = int(groups.size());
+            groupOf[freeNeighbour] = int(groups.size());
+            groupSizes.push_back(nodes[node].originalNodeCount + nodes[freeNeighbour].originalNodeCount);
+            groups.push_back(group);
+        }
+        else if (takenNeighbour >= 0)
+        {
+            int group = groupOf[takenNeighbour];
+            int neighbourFlip = flipOf[takenNeighbour] ? 1 : 0;
+            flipOf[node] = ((takenNodeStrand ^ takenNeighbourStrand ^ neighbourFlip) == 1);
+            groups[group].members.push_back(node * 2 + (flipOf[node] ? 1 : 0));
+            groupOf[node] = group;
+            groupSizes[group] += nodes[node].originalNodeCount;
+        }
+        else
+        {
+            CoarseNodeGroup group;
+            group.type = CLUSTER_NODE;
+            group.members.push_back(node * 2);
+            groupOf[node] = int(groups.size());
+            groupSizes.push_back(nodes[node].originalNodeCount);
+            groups.push_back(group);
+        }
+    }
+
+    return groups;
+}
+
+
+bool GraphCoarsener::mergesAnything(const std::vector<CoarseNodeGroup> & groups)
+{
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        if (groups[i].members.size() > 1)
+            return true;
+    }
+    return false;
+}
+
+
+//This function gives the edges between the groups.  Edges inside a group
+//are dropped, but a node on its own keeps any edges to itself.
+SignedAdjacency GraphCoarsener::getGroupEdges(const SignedAdjacency & edges,
+                                              const std::vector<CoarseNodeGroup> & groups)
+{
+    int nodeCount = int(edges.size()) / 2;
+    std::vector<int> groupOf(nodeCount);
+    std::vector<int> flipOf(nodeCount);
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        const std::vector<int> & members = groups[i].members;
+        for (size_t j = 0; j < members.size(); ++j)
+        {
+            groupOf[members[j] / 2] = int(i);
+            flipOf[members[j] / 2] = members[j] % 2;
+        }
+    }
+
+    SignedAdjacency groupEdges(groups.size() * 2);
+    for (int start = 0; start < nodeCount * 2; ++start)
+    {
+        int groupStart = groupOf[start / 2] * 2 + ((start % 2) ^ flipOf[start / 2]);
+        for (size_t j = 0; j < edges[start].size(); ++j)
+        {
+            int end = edges[start][j];
+            int groupEnd = groupOf[end / 2] * 2 + ((end % 2) ^ flipOf[end / 2]);
+            if (groupStart / 2 == groupEnd / 2 && groups[groupStart / 2].members.size() > 1)
+                continue;
+            groupEdges[groupStart].push_back(groupEnd);
+        }
+    }
+
+    for (size_t i = 0; i < groupEdges.size(); ++i)
+    {
+        std::vector<int> & leavingEdges = groupEdges[i];
+        std::sort(leavingEdges.begin(), leavingEdges.end());
+        leavingEdges.erase(std::unique(leavingEdges.begin(), leavingEdges.end()), leavingEdges.end());
+    }
+    return groupEdges;
+}
+
+
+//This function turns groups of groups into groups of the nodes below both,
+//so several passes can make a single level.
+std::vector<CoarseNodeGroup> GraphCoarsener::composeGroups(const std::vector<CoarseNodeGroup> & lowerGroups,
+                                                           const std::vector<CoarseNodeGroup> & upperGroups)
+{
+    std::vector<CoarseNodeGroup> groups(upperGroups.size());
+    for (size_t i = 0; i < upperGroups.size(); ++i)
+    {
+        const std::vector<int> & upperMembers = upperGroups[i].members;
+        if (upperMembers.size() > 1)
+            groups[i].type = upperGroups[i].type;
+        else
+            groups[i].type = lowerGroups[upperMembers[0] / 2].type;
+
+        for (size_t j = 0; j < upperMembers.size(); ++j)
+        {
+            const std::vector<int> & lowerMembers = lowerGroups[upperMembers[j] / 2].members;
+            int flip = upperMembers[j] % 2;
+            for (size_t k = 0; k < lowerMembers.size(); ++k)
+                groups[i].members.push_back((lowerMembers[k] / 2) * 2 + ((lowerMembers[k] % 2) ^ flip));
+        }
+    }
+    return groups;
+}
+
+
+
+//This function fills the given (empty) graph with the current level.  Each
+//of the graph's nodes is shown by its highest ancestor at or below the
+//current level which hasn't been expanded.  Nodes shown as themselves keep
+//their sequences, custom colours and labels, and super-nodes are given a
+//custom label with their node count.  The graph's edges are carried over to
+//the shown nodes, leaving out those inside a super-node.
+void GraphCoarsener::buildLevelGraph(AssemblyGraph * levelGraph) const
+{
+    int originalNodeCount = getNodeCount(0);
+    std::vector<int> shownIndices(originalNodeCount);
+    std::vector<bool> shownFlips(originalNodeCount);
+    QHash<QPair<int, int>, int> shownNodeIndices;
+    std::vector< QPair<int, int> > shownNodes;
+
+    std::vector<int> ancestors(m_level + 1);
+    std::vector<bool> ancestorFlips(m_level + 1);
+    for (int i = 0; i < originalNodeCount; ++i)
+    {
+        ancestors[0] = i;
+        ancestorFlips[0] = false;
+        for (int level = 0; level < m_level; ++level)
+        {
+            ancestors[level + 1] = m_parents[level][ancestors[level]];
+            ancestorFlips[level + 1] = (ancestorFlips[level] != m_flippedInParents[level][ancestors[level]]);
+        }
+
+        //Nodes carried up unchanged are passed through on the way down.
+        int level = m_level;
+        while (level > 0)
+        {
+            const CoarseNode & node = m_levels[level][ancestors[level]];
+            if (node.children.size() > 1 &&
+                    !m_expandedNodes.contains(QPair<int, int>(level, ancestors[level])))
+                break;
+            --level;
+        }
+
+        QPair<int, int> shownNode(level, ancestors[level]);
+        if (!shownNodeIndices.contains(shownNode))
+        {
+            shownNodeIndices.insert(shownNode, int(shownNodes.size()));
+            shownNodes.push_back(shownNode);
+        }
+        shownIndices[i] = shownNodeIndices[shownNode];
+        shownFlips[i] = ancestorFlips[level];
+    }
+
+    QStringList shownNames;
+    for (size_t i = 0; i < shownNodes.size(); ++i)
+    {
+        const CoarseNode & node = m_levels[shownNodes[i].first][shownNodes[i].second];
+        QString posNodeName = node.name + "+";
+        QString negNodeName = node.name + "-";
+        DeBruijnNode * posNode;
+        DeBruijnNode * negNode;
+
+        if (shownNodes[i].first == 0)
+        {
+            DeBruijnNode * originalPosNode = node.originalNode;
+            DeBruijnNode * originalNegNode = originalPosNode->getReverseComplement();
+            QByteArray posSequence = "*";
+            QByteArray negSequence = "*";
+            if (!originalPosNode->sequenceIsMissing())
+            {
+                posSequence = originalPosNode->getSequence();
+                negSequence = originalNegNode->getSequence();
+            }
+            posNode = new DeBruijnNode(posNodeName, originalPosNode->getDepth(), posSequence, originalPosNode->getLength());
+            negNode = new DeBruijnNode(negNodeName, originalNegNode->getDepth(), negSequence, originalNegNode->getLength());
+            posNode->setCustomColour(originalPosNode->getCustomColour());
+            negNode->setCustomColour(originalNegNode->getCustomColour());
+            posNode->setCustomLabel(originalPosNode->getCustomLabel());
+            negNode->setCustomLabel(originalNegNode->getCustomLabel());
+        }
+
+        //Super-nodes have no sequence, and their length is capped at what a
+        //node can hold.
+        else
+        {
+            int length = int(std::min(node.length, (long long)(std::numeric_limits<int>::max())));
+            posNode = new DeBruijnNode(posNodeName, node.depth, "*", length);
+            negNode = new DeBruijnNode(negNodeName, node.depth, "*", length);
+            QString label = formatIntForDisplay(node.originalNodeCount) + " nodes";
+            posNode->setCustomLabel(label);
+            negNode->setCustomLabel(label);
+        }
+
+        posNode->setReverseComplement(negNode);
+        negNode->setReverseComplement(posNode);
+        levelGraph->m_deBruijnGraphNodes.insert(posNodeName, posNode);
+        levelGraph->m_deBruijnGraphNodes.insert(negNodeName, negNode);
+        shownNames.push_back(node.name);
+    }
+
+    QSet<QPair<int, int> > addedEdges;
+    QMapIterator<QPair<DeBruijnNode*, DeBruijnNode*>, DeBruijnEdge*> j(m_assemblyGraph->m_deBruijnGraphEdges);
+    while (j.hasNext())
+    {
+        j.next();
+        DeBruijnEdge * edge = j.value();
+        DeBruijnNode * startingNode = edge->getStartingNode();
+        DeBruijnNode * endingNode = edge->getEndingNode();
+        int startingIndex = m_nodeIndices[startingNode];
+        int endingIndex = m_nodeIndices[endingNode];
+        int start = shownIndices[startingIndex] * 2 + (startingNode->isNegativeNode() != shownFlips[startingIndex] ? 1 : 0);
+        int end = shownIndices[endingIndex] * 2 + (endingNode->isNegativeNode() != shownFlips[endingIndex] ? 1 : 0);
+
+        if (start / 2 == end / 2 && shownNodes[start / 2].first > 0)
+            continue;
+        if (addedEdges.contains(QPair<int, int>(start, end)))
+            continue;
+        addedEdges.insert(QPair<int, int>(start, end));
+        addedEdges.insert(QPair<int, int>(end ^ 1, start ^ 1));
+
+        QString startName = shownNames[start / 2] + (start % 2 == 0 ? "+" : "-");
+        QString endName = shownNames[end / 2] + (end % 2 == 0 ? "+" : "-");
+        levelGraph->createDeBruijnEdge(startName, endName, edge->getOverlap(), edge->getOverlapType());
+    }
+
+    levelGraph->m_graphFileType = m_assemblyGraph->m_graphFileType;
+    levelGraph->m_kmer = m_assemblyGraph->m_kmer;
+    levelGraph->m_filename = m_assemblyGraph->m_filename;
+    levelGraph->m_depthTag = m_assemblyGraph->m_depthTag;
+    levelGraph->determineGraphInfo();
+}
@@ -0,0 +1,121 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef GRAPHCOARSENER_H
+#define GRAPHCOARSENER_H
+
+#include <vector>
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+
+class AssemblyGraph;
+class DeBruijnNode;
+
+enum CoarseNodeType {ORIGINAL_NODE, CHAIN_NODE, BUBBLE_NODE, CLUSTER_NODE};
+
+//This is one node at one level of the coarsening hierarchy.  Like the graph's
+//nodes, it stands for a node pair.  Its children are nodes of the level
+//below, and a flipped child is included by its - strand.  A node with only
+//one child is that child carried up unchanged to the next level.
+struct CoarseNode
+{
+    QString name;
+    CoarseNodeType type;
+    long long length;
+    double depth;
+    int originalNodeCount;
+    std::vector<int> children;
+    std::vector<bool> flippedChildren;
+    DeBruijnNode * originalNode;
+};
+
+//While the levels are built, each level's graph is held as lists of leaving
+//edges for signed node indices: index * 2 for the + strand and index * 2 + 1
+//for the - strand.  Edges are stored on both strands, like the graph's.
+typedef std::vector< std::vector<int> > SignedAdjacency;
+
+//This is a group of nodes which one coarsening pass makes into one node.
+//The members are signed node indices.
+struct CoarseNodeGroup
+{
+    std::vector<int> members;
+    CoarseNodeType type;
+};
+
+
+//This class builds a multilevel summary of the graph so that huge graphs can
+//be drawn as an overview.  Level 0 is the graph itself.  Level 1 collapses
+//each non-branching chain of nodes into one node.  Level 2 also collapses
+//simple bubbles (and then the chains these make).  Each level above that
+//joins neighbouring nodes into clusters, roughly halving the node count.
+//Super-nodes have the total length of their nodes and their length-weighted
+//mean depth.  Each level is built only when it is first asked for, and each
+//takes time linear in the size of the level below.
+//A level is drawn by building a separate AssemblyGraph for it, in which any
+//super-node which has been expanded is shown as its children instead.
+class GraphCoarsener
+{
+public:
+    //CREATORS
+    GraphCoarsener(AssemblyGraph * assemblyGraph);
+
+    //ACCESSORS
+    int getLevel() const {return m_level;}
+    int getLevelCount() const {return int(m_levels.size());}
+    int getNodeCount(int level) const {return int(m_levels[level].size());}
+    bool isSuperNode(QString nodeName) const {return m_superNodes.contains(nodeName);}
+    void buildLevelGraph(AssemblyGraph * levelGraph) const;
+
+    //MODIFERS
+    void setLevel(int level);
+    bool expandNode(QString nodeName);
+
+private:
+    AssemblyGraph * m_assemblyGraph;
+    QHash<DeBruijnNode *, int> m_nodeIndices;
+    std::vector< std::vector<CoarseNode> > m_levels;
+    std::vector< std::vector<int> > m_parents;
+    std::vector< std::vector<bool> > m_flippedInParents;
+    SignedAdjacency m_topLevelEdges;
+    bool m_allLevelsBuilt;
+    int m_level;
+    int m_superNodeCount;
+    QHash<QString, QPair<int, int> > m_superNodes;
+    QSet<QPair<int, int> > m_expandedNodes;
+
+    void buildOriginalLevel();
+    bool buildNextLevel();
+    void addLevel(const std::vector<CoarseNodeGroup> & groups);
+    QString getNewSuperNodeName(CoarseNodeType type);
+
+    static std::vector<CoarseNodeGroup> findChains(const SignedAdjacency & edges);
+    static std::vector<CoarseNodeGroup> findBubbles(const SignedAdjacency & edges);
+    static std::vector<CoarseNodeGroup> findClusters(const SignedAdjacency & edges,
+                                                     const std::vector<CoarseNode> & nodes);
+    static int getSimpleSuccessor(const SignedAdjacency & edges, int signedNode);
+    static int getSimplePredecessor(const SignedAdjacency & edges, int signedNode);
+    static bool mergesAnything(const std::vector<CoarseNodeGroup> & groups);
+    static SignedAdjacency getGroupEdges(const SignedAdjacency & edges,
+                                         const std::vector<CoarseNodeGroup> & groups);
+    static std::vector<CoarseNodeGroup> composeGroups(const std::vector<CoarseNodeGroup> & lowerGroups,
+                                                      const std::vector<CoarseNodeGroup> & upperGroups);
+};
+
+#endif // GRAPHCOARSENER_H
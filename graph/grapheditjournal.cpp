@@ -0,0 +1,398 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "grapheditjournal.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include "graphicsitemnode.h"
+#include "graphicsitemedge.h"
+
+GraphEditJournal::GraphEditJournal() :
+    m_recordingDepth(0), m_applyingEdit(false), m_currentEdit(0)
+{
+}
+
+GraphEditJournal::~GraphEditJournal()
+{
+    clear();
+}
+
+
+QString GraphEditJournal::getUndoDescription() const
+{
+    if (m_undoStack.empty())
+        return "";
+    return m_undoStack.back()->description;
+}
+
+QString GraphEditJournal::getRedoDescription() const
+{
+    if (m_redoStack.empty())
+        return "";
+    return m_redoStack.back()->description;
+}
+
+
+long long GraphEditJournal::getMemoryUsed() const
+{
+    long long memory = 0;
+    for (size_t i = 0; i < m_undoStack.size(); ++i)
+        memory += m_undoStack[i]->memory;
+    for (size_t i = 0; i < m_redoStack.size(); ++i)
+        memory += m_redoStack[i]->memory;
+    return memory;
+}
+
+
+
+//Edits can be nested (e.g. a merge inside a bigger edit), in which case only
+//the outermost one is recorded.
+void GraphEditJournal::beginEdit(QString description)
+{
+    ++m_recordingDepth;
+    if (m_recordingDepth > 1)
+        return;
+
+    m_currentEdit = new GraphEdit;
+    m_currentEdit->description = description;
+    m_currentEdit->memory = 0;
+}
+
+
+//This function finishes the current edit and puts it on the undo stack.  If
+//the edit did anything, the redo stack no longer applies and is cleared.
+//Then the oldest edits are forgotten until the history fits in the budget.
+void GraphEditJournal::endEdit(long long memoryBudget)
+{
+    if (m_recordingDepth == 0)
+        return;
+    --m_recordingDepth;
+    if (m_recordingDepth > 0)
+        return;
+
+    GraphEdit * edit = m_currentEdit;
+    m_currentEdit = 0;
+    if (edit->changes.empty())
+    {
+        delete edit;
+        return;
+    }
+
+    clearRedoStack();
+    m_undoStack.push_back(edit);
+
+    while (!m_undoStack.empty() && getMemoryUsed() > memoryBudget)
+    {
+        deleteEdit(m_undoStack.front(), true);
+        m_undoStack.pop_front();
+    }
+}
+
+
+void GraphEditJournal::recordAddedNode(DeBruijnNode * node)
+{
+    GraphChange change;
+    change.type = ADDED_NODE;
+    change.node = node;
+    addChange(change);
+}
+
+void GraphEditJournal::recordRemovedNode(DeBruijnNode * node)
+{
+    GraphChange change;
+    change.type = REMOVED_NODE;
+    change.node = node;
+    addChange(change);
+}
+
+void GraphEditJournal::recordAddedEdge(DeBruijnEdge * edge)
+{
+    GraphChange change;
+    change.type = ADDED_EDGE;
+    change.edge = edge;
+    addChange(change);
+}
+
+void GraphEditJournal::recordRemovedEdge(DeBruijnEdge * edge)
+{
+    GraphChange change;
+    change.type = REMOVED_EDGE;
+    change.edge = edge;
+    addChange(change);
+}
+
+void GraphEditJournal::recordChangedDepth(DeBruijnNode * node, double oldDepth, double newDepth)
+{
+    GraphChange change;
+    change.type = CHANGED_DEPTH;
+    change.node = node;
+    change.oldDepth = oldDepth;
+    change.newDepth = newDepth;
+    addChange(change);
+}
+
+void GraphEditJournal::recordChangedName(DeBruijnNode * node, QString oldName, QString newName)
+{
+    GraphChange change;
+    change.type = CHANGED_NAME;
+    change.node = node;
+    change.oldName = oldName;
+    change.newName = newName;
+    addChange(change);
+}
+
+void GraphEditJournal::recordAddedGraphicsItemNode(GraphicsItemNode * graphicsItemNode)
+{
+    GraphChange change;
+    change.type = ADDED_GRAPHICS_ITEM_NODE;
+    change.graphicsItemNode = graphicsItemNode;
+    addChange(change);
+}
+
+void GraphEditJournal::recordRemovedGraphicsItemNode(GraphicsItemNode * graphicsItemNode)
+{
+    GraphChange change;
+    change.type = REMOVED_GRAPHICS_ITEM_NODE;
+    change.graphicsItemNode = graphicsItemNode;
+    addChange(change);
+}
+
+void GraphEditJournal::recordAddedGraphicsItemEdge(GraphicsItemEdge * graphicsItemEdge)
+{
+    GraphChange change;
+    change.type = ADDED_GRAPHICS_ITEM_EDGE;
+    change.graphicsItemEdge = graphicsItemEdge;
+    addChange(change);
+}
+
+void GraphEditJournal::recordRemovedGraphicsItemEdge(GraphicsItemEdge * graphicsItemEdge)
+{
+    GraphChange change;
+    change.type = REMOVED_GRAPHICS_ITEM_EDGE;
+    change.graphicsItemEdge = graphicsItemEdge;
+    addChange(change);
+}
+
+void GraphEditJournal::recordMovedGraphicsItemNode(GraphicsItemNode * graphicsItemNode,
+                                                   std::vector<QPointF> oldLinePoints,
+                                                   std::vector<QPointF> newLinePoints)
+{
+    GraphChange change;
+    change.type = MOVED_GRAPHICS_ITEM_NODE;
+    change.graphicsItemNode = graphicsItemNode;
+    change.oldLinePoints = oldLinePoints;
+    change.newLinePoints = newLinePoints;
+    addChange(change);
+}
+
+
+
+//These functions give the edit that would be undone or redone next, or null
+//if there isn't one.  AssemblyGraph calls beginApplyingEdit before applying
+//it, so the changes it makes then aren't taken for unrecorded ones, and
+//finishUndo or finishRedo after, to move the edit to the other stack.
+GraphEdit * GraphEditJournal::getEditToUndo()
+{
+    if (m_undoStack.empty())
+        return 0;
+    return m_undoStack.back();
+}
+
+GraphEdit * GraphEditJournal::getEditToRedo()
+{
+    if (m_redoStack.empty())
+        return 0;
+    return m_redoStack.back();
+}
+
+void GraphEditJournal::beginApplyingEdit()
+{
+    m_applyingEdit = true;
+}
+
+void GraphEditJournal::finishUndo()
+{
+    m_applyingEdit = false;
+    if (m_undoStack.empty())
+        return;
+    m_redoStack.push_back(m_undoStack.back());
+    m_undoStack.pop_back();
+}
+
+void GraphEditJournal::finishRedo()
+{
+    m_applyingEdit = false;
+    if (m_redoStack.empty())
+        return;
+    m_undoStack.push_back(m_redoStack.back());
+    m_redoStack.pop_back();
+}
+
+
+//This function must be called when the graphics scene is replaced (e.g. when
+//the graph is redrawn), as the graphics items in the history then no longer
+//belong to anything.  The graph changes are kept, so the edits can still be
+//undone and redone, but without their graphics.
+void GraphEditJournal::clearGraphicsItems()
+{
+    for (int stack = 0; stack < 2; ++stack)
+    {
+        bool applied = (stack == 0);
+        std::deque<GraphEdit *> * edits = applied ? &m_undoStack : &m_redoStack;
+        for (size_t i = 0; i < edits->size(); ++i)
+        {
+            GraphEdit * edit = (*edits)[i];
+            deleteDetachedGraphicsItems(edit, applied);
+
+            std::vector<GraphChange> graphChanges;
+            edit->memory = 0;
+            for (size_t j = 0; j < edit->changes.size(); ++j)
+            {
+                const GraphChange & change = edit->changes[j];
+                if (change.type == ADDED_GRAPHICS_ITEM_NODE || change.type == REMOVED_GRAPHICS_ITEM_NODE ||
+                        change.type == ADDED_GRAPHICS_ITEM_EDGE || change.type == REMOVED_GRAPHICS_ITEM_EDGE ||
+                        change.type == MOVED_GRAPHICS_ITEM_NODE)
+                    continue;
+                graphChanges.push_back(change);
+                edit->memory += getChangeMemory(change);
+            }
+            edit->changes.swap(graphChanges);
+        }
+    }
+}
+
+
+void GraphEditJournal::clear()
+{
+    clearRedoStack();
+    for (size_t i = 0; i < m_undoStack.size(); ++i)
+        deleteEdit(m_undoStack[i], true);
+    m_undoStack.clear();
+
+    if (m_currentEdit != 0)
+        delete m_currentEdit;
+    m_currentEdit = 0;
+    m_recordingDepth = 0;
+    m_applyingEdit = false;
+}
+
+
+
+//A change made outside of any edit can't be undone, and the edits before it
+//may no longer apply to the graph (or may refer to objects it deleted), so
+//the history is forgotten.
+void GraphEditJournal::addChange(GraphChange change)
+{
+    if (m_applyingEdit)
+        return;
+    if (m_currentEdit == 0)
+    {
+        if (canUndo() || canRedo())
+            clear();
+        return;
+    }
+    m_currentEdit->memory += getChangeMemory(change);
+    m_currentEdit->changes.push_back(change);
+}
+
+
+//This function estimates the memory held by a change: the change itself,
+//plus any object it may have to keep alive while detached.
+long long GraphEditJournal::getChangeMemory(const GraphChange & change)
+{
+    long long memory = sizeof(GraphChange);
+    switch (change.type)
+    {
+    case ADDED_NODE:
+    case REMOVED_NODE:
+        memory += sizeof(DeBruijnNode) + change.node->getLength() +
+                change.node->getEdgesPointer()->size() * sizeof(DeBruijnEdge *);
+        break;
+    case ADDED_EDGE:
+    case REMOVED_EDGE:
+        memory += sizeof(DeBruijnEdge);
+        break;
+    case CHANGED_DEPTH:
+        break;
+    case CHANGED_NAME:
+        memory += (change.oldName.length() + change.newName.length()) * sizeof(QChar);
+        break;
+    case ADDED_GRAPHICS_ITEM_NODE:
+    case REMOVED_GRAPHICS_ITEM_NODE:
+        memory += sizeof(GraphicsItemNode) +
+                change.graphicsItemNode->m_linePoints.size() * sizeof(QPointF);
+        break;
+    case ADDED_GRAPHICS_ITEM_EDGE:
+    case REMOVED_GRAPHICS_ITEM_EDGE:
+        memory += sizeof(GraphicsItemEdge);
+        break;
+    case MOVED_GRAPHICS_ITEM_NODE:
+        memory += (change.oldLinePoints.size() + change.newLinePoints.size()) * sizeof(QPointF);
+        break;
+    }
+    return memory;
+}
+
+
+//This function deletes an edit along with the detached objects it owns.  An
+//applied edit (on the undo stack) owns what it removed, and an edit which
+//has been undone (on the redo stack) owns what it added.
+void GraphEditJournal::deleteEdit(GraphEdit * edit, bool applied)
+{
+    deleteDetachedGraphicsItems(edit, applied);
+
+    GraphChangeType detachedNodeType = applied ? REMOVED_NODE : ADDED_NODE;
+    GraphChangeType detachedEdgeType = applied ? REMOVED_EDGE : ADDED_EDGE;
+    for (size_t i = 0; i < edit->changes.size(); ++i)
+    {
+        const GraphChange & change = edit->changes[i];
+        if (change.type == detachedEdgeType)
+            delete change.edge;
+    }
+    for (size_t i = 0; i < edit->changes.size(); ++i)
+    {
+        const GraphChange & change = edit->changes[i];
+        if (change.type == detachedNodeType)
+            delete change.node;
+    }
+
+    delete edit;
+}
+
+
+void GraphEditJournal::deleteDetachedGraphicsItems(GraphEdit * edit, bool applied)
+{
+    GraphChangeType detachedNodeType = applied ? REMOVED_GRAPHICS_ITEM_NODE : ADDED_GRAPHICS_ITEM_NODE;
+    GraphChangeType detachedEdgeType = applied ? REMOVED_GRAPHICS_ITEM_EDGE : ADDED_GRAPHICS_ITEM_EDGE;
+    for (size_t i = 0; i < edit->changes.size(); ++i)
+    {
+        const GraphChange & change = edit->changes[i];
+        if (change.type == detachedNodeType)
+            delete change.graphicsItemNode;
+        else if (change.type == detachedEdgeType)
+            delete change.graphicsItemEdge;
+    }
+}
+
+
+void GraphEditJournal::clearRedoStack()
+{
+    for (size_t i = 0; i < m_redoStack.size(); ++i)
+        deleteEdit(m_redoStack[i], false);
+    m_redoStack.clear();
+}
@@ -0,0 +1,136 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef GRAPHEDITJOURNAL_H
+#define GRAPHEDITJOURNAL_H
+
+#include <vector>
+#include <deque>
+#include <QString>
+#include <QPointF>
+
+class DeBruijnNode;
+class DeBruijnEdge;
+class GraphicsItemNode;
+class GraphicsItemEdge;
+
+enum GraphChangeType {ADDED_NODE, REMOVED_NODE, ADDED_EDGE, REMOVED_EDGE,
+                      CHANGED_DEPTH, CHANGED_NAME,
+                      ADDED_GRAPHICS_ITEM_NODE, REMOVED_GRAPHICS_ITEM_NODE,
+                      ADDED_GRAPHICS_ITEM_EDGE, REMOVED_GRAPHICS_ITEM_EDGE,
+                      MOVED_GRAPHICS_ITEM_NODE};
+
+//This is one small change to the graph or its graphics items.  Only the
+//members relevant to the type are used.
+struct GraphChange
+{
+    GraphChangeType type;
+    DeBruijnNode * node;
+    DeBruijnEdge * edge;
+    GraphicsItemNode * graphicsItemNode;
+    GraphicsItemEdge * graphicsItemEdge;
+    double oldDepth;
+    double newDepth;
+    QString oldName;
+    QString newName;
+    std::vector<QPointF> oldLinePoints;
+    std::vector<QPointF> newLinePoints;
+};
+
+//This is one user-level edit (e.g. 'Merge all possible nodes'), made up of
+//all the changes it caused, in the order they happened.
+struct GraphEdit
+{
+    QString description;
+    std::vector<GraphChange> changes;
+    long long memory;
+};
+
+
+//This class records graph edits so they can be undone and redone.  Nodes,
+//edges and graphics items removed by an edit are not deleted but kept here,
+//detached from the graph, and new ones are only noted.  Undoing an edit
+//reattaches the removed objects and detaches the new ones (and redoing it
+//does the opposite), so both cost only the size of the edit, not the graph.
+//Each detached object is owned by exactly one edit: a removed object by the
+//edit on the undo stack which removed it, and an added object by the edit on
+//the redo stack which added it.  Objects are deleted when their edit is
+//forgotten, which happens when a new edit clears the redo stack or when the
+//history goes over its memory budget (oldest edits first).
+//The history holds pointers to the graph's objects, so it is only valid while
+//every change to the graph is recorded.  A change reported while no edit is
+//being recorded (e.g. a depth change on loading, or a deletion by a command
+//line tool) makes the journal forget its whole history, as does cleaning up
+//the graph.
+//The applying of changes is done by AssemblyGraph, which owns the graph.
+class GraphEditJournal
+{
+public:
+    //CREATORS
+    GraphEditJournal();
+    ~GraphEditJournal();
+
+    //ACCESSORS
+    bool isRecording() const {return m_recordingDepth > 0;}
+    bool canUndo() const {return !m_undoStack.empty();}
+    bool canRedo() const {return !m_redoStack.empty();}
+    int getUndoCount() const {return int(m_undoStack.size());}
+    int getRedoCount() const {return int(m_redoStack.size());}
+    QString getUndoDescription() const;
+    QString getRedoDescription() const;
+    long long getMemoryUsed() const;
+
+    //MODIFERS
+    void beginEdit(QString description);
+    void endEdit(long long memoryBudget);
+    void recordAddedNode(DeBruijnNode * node);
+    void recordRemovedNode(DeBruijnNode * node);
+    void recordAddedEdge(DeBruijnEdge * edge);
+    void recordRemovedEdge(DeBruijnEdge * edge);
+    void recordChangedDepth(DeBruijnNode * node, double oldDepth, double newDepth);
+    void recordChangedName(DeBruijnNode * node, QString oldName, QString newName);
+    void recordAddedGraphicsItemNode(GraphicsItemNode * graphicsItemNode);
+    void recordRemovedGraphicsItemNode(GraphicsItemNode * graphicsItemNode);
+    void recordAddedGraphicsItemEdge(GraphicsItemEdge * graphicsItemEdge);
+    void recordRemovedGraphicsItemEdge(GraphicsItemEdge * graphicsItemEdge);
+    void recordMovedGraphicsItemNode(GraphicsItemNode * graphicsItemNode,
+                                     std::vector<QPointF> oldLinePoints,
+                                     std::vector<QPointF> newLinePoints);
+    GraphEdit * getEditToUndo();
+    GraphEdit * getEditToRedo();
+    void beginApplyingEdit();
+    void finishUndo();
+    void finishRedo();
+    void clearGraphicsItems();
+    void clear();
+
+private:
+    int m_recordingDepth;
+    bool m_applyingEdit;
+    GraphEdit * m_currentEdit;
+    std::deque<GraphEdit *> m_undoStack;
+    std::deque<GraphEdit *> m_redoStack;
+
+    void addChange(GraphChange change);
+    static long long getChangeMemory(const GraphChange & change);
+    static void deleteEdit(GraphEdit * edit, bool applied);
+    static void deleteDetachedGraphicsItems(GraphEdit * edit, bool applied);
+    void clearRedoStack();
+};
+
+#endif // GRAPHEDITJOURNAL_H
@@ -37,8 +37,10 @@
 #include <set>
 #include "../ui/mygraphicsview.h"
 #include <QTransform>
+#include <QLinearGradient>
 #include "../blast/blasthit.h"
 #include "../blast/blastquery.h"
+#include "../blast/blastsearch.h"
 #include "../blast/blasthitpart.h"
 #include "assemblygraph.h"
 #include <math.h>
@@ -136,24 +138,9 @@ void GraphicsItemNode::paint(QPainter * painter, const QStyleOptionGraphicsItem
     if (nodeHasBlastHits && (g_settings->nodeColourScheme == BLAST_HITS_RAINBOW_COLOUR ||
             g_settings->nodeColourScheme == BLAST_HITS_SOLID_COLOUR))
     {
-        std::vector<BlastHitPart> parts;
-
-        //The scaled node length is passed to the function which makes the
-        //BlastHitPart objects, because we don't want those parts to be much
-        //less than 1 pixel in size, which isn't necessary and can cause weird
-        //visual artefacts.
-        double scaledNodeLength = getNodePathLength() * g_absoluteZoom;
-
-        if (g_settings->doubleMode)
-        {
-            if (m_deBruijnNode->thisNodeHasBlastHits())
-                parts = m_deBruijnNode->getBlastHitPartsForThisNode(scaledNodeLength);
-        }
-        else
-        {
-            if (m_deBruijnNode->thisNodeOrReverseComplementHasBlastHits())
-                parts = m_deBruijnNode->getBlastHitPartsForThisNodeOrReverseComplement(scaledNodeLength);
-        }
+        int zoomLevel = getBlastHitPartsZoomLevel();
+        if (!m_blastHitPartsCached || zoomLevel != m_blastHitPartsZoomLevel)
+            makeBlastHitPartsCache(zoomLevel);
 
         QPen partPen;
         partPen.setWidthF(m_width);
@@ -166,13 +153,11 @@ void GraphicsItemNode::paint(QPainter * painter, const QStyleOptionGraphicsItem
         if (m_hasArrow)
             painter->setClipPath(outlinePath);
 
-        for (size_t i = 0; i < parts.size(); ++i)
+        for (size_t i = 0; i < m_blastHitPartPaths.size(); ++i)
         {
-            partPen.setColor(parts[i].m_colour);
+            partPen.setBrush(m_blastHitPartBrushes[i]);
             painter->setPen(partPen);
-
-            painter->drawPath(makePartialPath(parts[i].m_nodeFractionStart,
-                                              parts[i].m_nodeFractionEnd));
+            painter->drawPath(m_blastHitPartPaths[i]);
         }
         painter->setClipping(false);
     }
@@ -260,6 +245,81 @@ void GraphicsItemNode::paint(QPainter * painter, const QStyleOptionGraphicsItem
 }
 
 
+//Zoom levels are spaced by this much: the zoom doubles every two levels.
+static const int BLAST_HIT_ZOOM_LEVELS_PER_DOUBLING = 2;
+
+//Rainbow gradients get this many colour stops, as the hue doesn't change
+//evenly between two stops.
+static const int RAINBOW_GRADIENT_STOPS = 8;
+
+int GraphicsItemNode::getBlastHitPartsZoomLevel()
+{
+    return int(floor(log2(g_absoluteZoom) * BLAST_HIT_ZOOM_LEVELS_PER_DOUBLING));
+}
+
+
+//This function makes the paths and colours of the node's BLAST hit parts for
+//the given zoom level.
+void GraphicsItemNode::makeBlastHitPartsCache(int zoomLevel)
+{
+    m_blastHitPartPaths.clear();
+    m_blastHitPartBrushes.clear();
+    m_blastHitPartsCached = true;
+    m_blastHitPartsZoomLevel = zoomLevel;
+
+    //The scaled node length is passed to the function which makes the
+    //BlastHitPart objects, because we don't want those parts to be much
+    //less than 1 pixel in size, which isn't necessary and can cause weird
+    //visual artefacts.  The lowest zoom of the level is used, so the parts
+    //are the same throughout the level.
+    double levelZoom = pow(2.0, double(zoomLevel) / BLAST_HIT_ZOOM_LEVELS_PER_DOUBLING);
+    double scaledNodeLength = getNodePathLength() * levelZoom;
+
+    std::vector<BlastHitPart> parts;
+    if (g_settings->doubleMode)
+    {
+        if (m_deBruijnNode->thisNodeHasBlastHits())
+            parts = m_deBruijnNode->getBlastHitPartsForThisNode(scaledNodeLength);
+    }
+    else
+    {
+        if (m_deBruijnNode->thisNodeOrReverseComplementHasBlastHits())
+            parts = m_deBruijnNode->getBlastHitPartsForThisNodeOrReverseComplement(scaledNodeLength);
+    }
+
+    for (size_t i = 0; i < parts.size(); ++i)
+    {
+        const BlastHitPart & part = parts[i];
+        m_blastHitPartPaths.push_back(makePartialPath(part.m_nodeFractionStart, part.m_nodeFractionEnd));
+
+        if (!part.m_rainbowGradient)
+        {
+            m_blastHitPartBrushes.push_back(QBrush(part.m_colour));
+            continue;
+        }
+
+        //A gradient part is coloured in a straight line from its start to its
+        //end, which is close enough for a part this small on screen.
+        QPointF start = findLocationOnPath(part.m_nodeFractionStart);
+        QPointF end = findLocationOnPath(part.m_nodeFractionEnd);
+        double queryFractionRange = part.m_queryFractionEnd - part.m_queryFractionStart;
+        if (start == end)
+        {
+            double queryFractionMiddle = part.m_queryFractionStart + queryFractionRange / 2.0;
+            m_blastHitPartBrushes.push_back(QBrush(BlastHit::getRainbowColour(queryFractionMiddle)));
+            continue;
+        }
+        QLinearGradient gradient(start, end);
+        for (int j = 0; j < RAINBOW_GRADIENT_STOPS; ++j)
+        {
+            double position = double(j) / (RAINBOW_GRADIENT_STOPS - 1);
+            gradient.setColorAt(position, BlastHit::getRainbowColour(part.m_queryFractionStart + position * queryFractionRange));
+        }
+        m_blastHitPartBrushes.push_back(QBrush(gradient));
+    }
+}
+
+
 void GraphicsItemNode::drawTextPathAtLocation(QPainter * painter, QPainterPath textPath, QPointF centre)
 {
     QRectF textBoundingRect = textPath.boundingRect();
@@ -299,6 +359,8 @@ void GraphicsItemNode::drawTextPathAtLocation(QPainter * painter, QPainterPath t
 
 void GraphicsItemNode::setNodeColour()
 {
+    clearBlastHitPartsCache();
+
     switch (g_settings->nodeColourScheme)
     {
     case UNIFORM_COLOURS:
@@ -587,6 +649,8 @@ void GraphicsItemNode::shiftPoints(QPointF difference)
 
 void GraphicsItemNode::remakePath()
 {
+    clearBlastHitPartsCache();
+
     QPainterPath path;
 
     path.moveTo(m_linePoints[0]);
@@ -996,15 +1060,29 @@ void GraphicsItemNode::shiftPointSideways(bool left)
 }
 
 
+//This function replaces the node's line points, e.g. to put back the shape it
+//had before an edit was undone.
+void GraphicsItemNode::setLinePoints(std::vector<QPointF> linePoints)
+{
+    if (linePoints.size() < 2)
+        return;
+
+    prepareGeometryChange();
+    m_linePoints = linePoints;
+    remakePath();
+}
+
+
 void GraphicsItemNode::getBlastHitsTextAndLocationThisNode(std::vector<QString> * blastHitText,
                                                        std::vector<QPointF> * blastHitLocation)
 {
-    const std::vector<BlastHit *> * blastHits = m_deBruijnNode->getBlastHitsPointer();
-    for (size_t i = 0; i < blastHits->size(); ++i)
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
+    int start = m_deBruijnNode->getBlastHitsStart();
+    for (int i = start; i < start + m_deBruijnNode->getBlastHitCount(); ++i)
     {
-        BlastHit * hit = (*blastHits)[i];
-        blastHitText->push_back(hit->m_query->getName());
-        blastHitLocation->push_back(findLocationOnPath(hit->getNodeCentreFraction()));
+        BlastHit hit = hits.getNodeHit(i);
+        blastHitText->push_back(hit.m_query->getName());
+        blastHitLocation->push_back(findLocationOnPath(hit.getNodeCentreFraction()));
     }
 }
 
@@ -1013,12 +1091,14 @@ void GraphicsItemNode::getBlastHitsTextAndLocationThisNodeOrReverseComplement(st
 {
     getBlastHitsTextAndLocationThisNode(blastHitText, blastHitLocation);
 
-    const std::vector<BlastHit *> * blastHits = m_deBruijnNode->getReverseComplement()->getBlastHitsPointer();
-    for (size_t i = 0; i < blastHits->size(); ++i)
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
+    DeBruijnNode * reverseComplement = m_deBruijnNode->getReverseComplement();
+    int start = reverseComplement->getBlastHitsStart();
+    for (int i = start; i < start + reverseComplement->getBlastHitCount(); ++i)
     {
-        BlastHit * hit = (*blastHits)[i];
-        blastHitText->push_back(hit->m_query->getName());
-        blastHitLocation->push_back(findLocationOnPath(1.0 - hit->getNodeCentreFraction()));
+        BlastHit hit = hits.getNodeHit(i);
+        blastHitText->push_back(hit.m_query->getName());
+        blastHitLocation->push_back(findLocationOnPath(1.0 - hit.getNodeCentreFraction()));
     }
 }
 
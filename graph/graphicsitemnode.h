@@ -29,6 +29,7 @@
 #include <QString>
 #include <QPainterPath>
 #include <QStringList>
+#include <QBrush>
 
 class DeBruijnNode;
 class Path;
@@ -85,14 +86,29 @@ public:
                                double averageNodeWidth);
     void shiftPointsLeft();
     void shiftPointsRight();
+    void setLinePoints(std::vector<QPointF> linePoints);
     void getBlastHitsTextAndLocationThisNode(std::vector<QString> * blastHitText,
                                              std::vector<QPointF> * blastHitLocation);
     void getBlastHitsTextAndLocationThisNodeOrReverseComplement(std::vector<QString> * blastHitText,
                                                                 std::vector<QPointF> * blastHitLocation);
     void drawTextPathAtLocation(QPainter *painter, QPainterPath textPath, QPointF centre);
     void fixEdgePaths(std::vector<GraphicsItemNode *> * nodes = 0);
+    void clearBlastHitPartsCache() {m_blastHitPartsCached = false;}
 
 private:
+    //The BLAST hit parts are slow to make, so their paths and colours are
+    //kept between repaints.  They depend on the zoom (which sets how many
+    //rainbow parts a hit gets), so they are made for a zoom level: a range of
+    //zooms, within which they don't change.  They are made again when the
+    //zoom moves to another level, and cleared when the node's path, its hits
+    //or the colours change.
+    std::vector<QPainterPath> m_blastHitPartPaths;
+    std::vector<QBrush> m_blastHitPartBrushes;
+    bool m_blastHitPartsCached;
+    int m_blastHitPartsZoomLevel;
+
+    void makeBlastHitPartsCache(int zoomLevel);
+    static int getBlastHitPartsZoomLevel();
     void exactPathHighlightNode(QPainter * painter);
     void queryPathHighlightNode(QPainter * painter);
     void pathHighlightNode2(QPainter * painter, DeBruijnNode * node, bool reverse, Path * path);
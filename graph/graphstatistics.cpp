@@ -0,0 +1,210 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "graphstatistics.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include <math.h>
+
+GraphStatistics::GraphStatistics() :
+    m_built(false), m_edgeCount(0), m_deadEndCount(0), m_allNodesLength(0),
+    m_allNodesDepthSum(0.0)
+{
+}
+
+
+long long GraphStatistics::getShortestNodeLength() const
+{
+    return (long long)m_nodeLengths.getValueAtIndex(0);
+}
+
+long long GraphStatistics::getLongestNodeLength() const
+{
+    return (long long)m_nodeLengths.getValueAtIndex(m_nodeLengths.getCount() - 1);
+}
+
+
+//This function gives the same result as AssemblyGraph::getMeanDepth: the
+//mean depth of all nodes, weighted by length.
+double GraphStatistics::getMeanDepth() const
+{
+    if (m_allNodesLength == 0)
+        return 0.0;
+    return m_allNodesDepthSum / m_allNodesLength;
+}
+
+
+//This function returns the median depth of the positive nodes' bases.  When
+//the total length is even, it is the mean of the two middle bases' depths.
+double GraphStatistics::getMedianDepthByBase() const
+{
+    long long totalLength = m_nodeDepthsByBase.getTotalWeight();
+    if (totalLength == 0)
+        return 0.0;
+
+    if (m_nodeDepthsByBase.getCount() == 1)
+        return m_nodeDepthsByBase.getValueAtIndex(0);
+
+    if (totalLength % 2 == 0)
+    {
+        long long medianIndex2 = totalLength / 2;
+        long long medianIndex1 = medianIndex2 - 1;
+        double depth1 = m_nodeDepthsByBase.getValueAtWeightIndex(medianIndex1);
+        double depth2 = m_nodeDepthsByBase.getValueAtWeightIndex(medianIndex2);
+        return (depth1 + depth2) / 2.0;
+    }
+    else
+        return m_nodeDepthsByBase.getValueAtWeightIndex((totalLength - 1) / 2);
+}
+
+
+//The N50 is the length of the node which holds the middle base when the
+//positive nodes are sorted by length.
+void GraphStatistics::getNodeLengthStats(int * n50, int * shortestNode, int * firstQuartile, int * median,
+                                         int * thirdQuartile, int * longestNode) const
+{
+    long long totalLength = getTotalLength();
+    if (totalLength == 0 || getNodeCount() == 0)
+        return;
+
+    *shortestNode = int(getShortestNodeLength());
+    *longestNode = int(getLongestNodeLength());
+    *firstQuartile = round(m_nodeLengths.getQuantile(0.25));
+    *median = round(m_nodeLengths.getQuantile(0.5));
+    *thirdQuartile = round(m_nodeLengths.getQuantile(0.75));
+    *n50 = int(m_nodeLengths.getValueAtWeightIndex(totalLength / 2));
+}
+
+
+
+void GraphStatistics::build(const QMap<QString, DeBruijnNode *> & nodes,
+                            const QMap<QPair<DeBruijnNode *, DeBruijnNode *>, DeBruijnEdge *> & edges)
+{
+    clear();
+    m_built = true;
+
+    QMapIterator<QString, DeBruijnNode*> i(nodes);
+    while (i.hasNext())
+    {
+        i.next();
+        addNode(i.value());
+    }
+
+    QMapIterator<QPair<DeBruijnNode*, DeBruijnNode*>, DeBruijnEdge*> j(edges);
+    while (j.hasNext())
+    {
+        j.next();
+        addEdge(j.value());
+    }
+}
+
+
+void GraphStatistics::clear()
+{
+    m_built = false;
+    m_edgeCount = 0;
+    m_deadEndCount = 0;
+    m_allNodesLength = 0;
+    m_allNodesDepthSum = 0.0;
+    m_nodeLengths.clear();
+    m_nodeDepths.clear();
+    m_nodeDepthsByBase.clear();
+    m_nodeDeadEnds.clear();
+}
+
+
+//This function must be called for a node (either strand) once it is in the
+//graph.  It is also used after a node's depth has changed.
+void GraphStatistics::addNode(DeBruijnNode * node)
+{
+    if (!m_built)
+        return;
+
+    long long length = node->getLength();
+    double depth = node->getDepth();
+    m_allNodesLength += length;
+    m_allNodesDepthSum += length * depth;
+    m_nodeDepths.insert(depth, 1);
+
+    if (node->isPositiveNode())
+    {
+        m_nodeLengths.insert(length, length);
+        m_nodeDepthsByBase.insert(depth, length);
+        int deadEnds = node->getDeadEndCount();
+        m_nodeDeadEnds[node] = deadEnds;
+        m_deadEndCount += deadEnds;
+    }
+}
+
+
+//This function must be called for a node before it is deleted or has its
+//depth changed, as it looks up the node's current values.
+void GraphStatistics::removeNode(DeBruijnNode * node)
+{
+    if (!m_built)
+        return;
+
+    long long length = node->getLength();
+    double depth = node->getDepth();
+    m_allNodesLength -= length;
+    m_allNodesDepthSum -= length * depth;
+    m_nodeDepths.remove(depth, 1);
+
+    if (node->isPositiveNode())
+    {
+        m_nodeLengths.remove(length, length);
+        m_nodeDepthsByBase.remove(depth, length);
+        m_deadEndCount -= m_nodeDeadEnds.value(node, 0);
+        m_nodeDeadEnds.remove(node);
+    }
+}
+
+
+//Only positive edges are counted, so this function and removeEdge must be
+//given every edge in the graph, including reverse complements.
+void GraphStatistics::addEdge(DeBruijnEdge * edge)
+{
+    if (m_built && edge->isPositiveEdge())
+        ++m_edgeCount;
+}
+
+//This function must be called before either of the edge's nodes is deleted.
+void GraphStatistics::removeEdge(DeBruijnEdge * edge)
+{
+    if (m_built && edge->isPositiveEdge())
+        --m_edgeCount;
+}
+
+
+//This function must be called for each node whose edges have changed.  The
+//dead ends are counted on the positive node of each pair, so either strand
+//can be given.
+void GraphStatistics::updateDeadEnds(DeBruijnNode * node)
+{
+    if (!m_built)
+        return;
+
+    if (node->isNegativeNode())
+        node = node->getReverseComplement();
+    if (!m_nodeDeadEnds.contains(node))
+        return;
+
+    int deadEnds = node->getDeadEndCount();
+    m_deadEndCount += deadEnds - m_nodeDeadEnds[node];
+    m_nodeDeadEnds[node] = deadEnds;
+}
@@ -0,0 +1,88 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef GRAPHSTATISTICS_H
+#define GRAPHSTATISTICS_H
+
+#include <QString>
+#include <QMap>
+#include <QHash>
+#include <QPair>
+#include "orderstatistictree.h"
+
+class DeBruijnNode;
+class DeBruijnEdge;
+
+//This class holds the graph's summary statistics (counts, lengths, depths and
+//dead ends) and keeps them up to date as the graph is edited, so they don't
+//have to be recalculated from the whole graph after each edit.  The node
+//lengths and depths are held in order statistic trees, so each node or edge
+//added or removed costs O(log n).
+//Like the other graph indices, it must be told about every change to the
+//graph.  Until it is built, it ignores all changes.
+class GraphStatistics
+{
+public:
+    //CREATORS
+    GraphStatistics();
+
+    //ACCESSORS
+    bool isBuilt() const {return m_built;}
+    int getNodeCount() const {return m_nodeLengths.getCount();}
+    int getEdgeCount() const {return m_edgeCount;}
+    long long getTotalLength() const {return m_nodeLengths.getTotalWeight();}
+    int getDeadEndCount() const {return m_deadEndCount;}
+    long long getShortestNodeLength() const;
+    long long getLongestNodeLength() const;
+    double getMeanDepth() const;
+    double getDepthQuantile(double fraction) const {return m_nodeDepths.getQuantile(fraction);}
+    double getMedianDepthByBase() const;
+    void getNodeLengthStats(int * n50, int * shortestNode, int * firstQuartile, int * median,
+                            int * thirdQuartile, int * longestNode) const;
+
+    //MODIFERS
+    void build(const QMap<QString, DeBruijnNode *> & nodes,
+               const QMap<QPair<DeBruijnNode *, DeBruijnNode *>, DeBruijnEdge *> & edges);
+    void clear();
+    void addNode(DeBruijnNode * node);
+    void removeNode(DeBruijnNode * node);
+    void addEdge(DeBruijnEdge * edge);
+    void removeEdge(DeBruijnEdge * edge);
+    void updateDeadEnds(DeBruijnNode * node);
+
+private:
+    bool m_built;
+    int m_edgeCount;
+    int m_deadEndCount;
+    long long m_allNodesLength;
+    long double m_allNodesDepthSum;
+
+    //Lengths of positive nodes, weighted by length.
+    OrderStatisticTree m_nodeLengths;
+
+    //Depths of all nodes (both strands), unweighted.
+    OrderStatisticTree m_nodeDepths;
+
+    //Depths of positive nodes, weighted by length.
+    OrderStatisticTree m_nodeDepthsByBase;
+
+    //The dead end count of each positive node.
+    QHash<DeBruijnNode *, int> m_nodeDeadEnds;
+};
+
+#endif // GRAPHSTATISTICS_H
@@ -0,0 +1,132 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "nodedepthindex.h"
+#include "debruijnnode.h"
+#include <algorithm>
+
+NodeDepthIndex::NodeDepthIndex() :
+    m_built(false)
+{
+}
+
+
+void NodeDepthIndex::build(const QMap<QString, DeBruijnNode *> & nodes)
+{
+    m_entries.clear();
+    m_entries.reserve(nodes.size());
+
+    QMapIterator<QString, DeBruijnNode*> i(nodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DepthEntry entry;
+        entry.depth = i.value()->getDepth();
+        entry.node = i.value();
+        m_entries.push_back(entry);
+    }
+
+    std::stable_sort(m_entries.begin(), m_entries.end(), compareEntries);
+    m_built = true;
+}
+
+
+void NodeDepthIndex::clear()
+{
+    m_entries.clear();
+    m_built = false;
+}
+
+
+//Adding and removing nodes does nothing if the index hasn't been built yet,
+//as the whole graph will be indexed when it is first needed.
+void NodeDepthIndex::addNode(DeBruijnNode * node)
+{
+    if (!m_built)
+        return;
+
+    DepthEntry entry;
+    entry.depth = node->getDepth();
+    entry.node = node;
+    std::vector<DepthEntry>::iterator position = std::upper_bound(m_entries.begin(), m_entries.end(),
+                                                                  entry.depth, compareDepthToEntry);
+    m_entries.insert(position, entry);
+}
+
+
+//This function must be called before a node's depth is changed or the node
+//is deleted, as it uses the node's current depth to find its entry.
+void NodeDepthIndex::removeNode(DeBruijnNode * node)
+{
+    if (!m_built)
+        return;
+
+    double depth = node->getDepth();
+    std::vector<DepthEntry>::iterator i = std::lower_bound(m_entries.begin(), m_entries.end(),
+                                                           depth, compareEntryToDepth);
+    for (; i != m_entries.end() && i->depth == depth; ++i)
+    {
+        if (i->node == node)
+        {
+            m_entries.erase(i);
+            return;
+        }
+    }
+}
+
+
+//This function returns the nodes with a depth in the given range (inclusive),
+//sorted by name to match the order of the graph's node map.
+std::vector<DeBruijnNode *> NodeDepthIndex::getNodesInRange(double min, double max) const
+{
+    std::vector<DeBruijnNode *> nodes;
+    std::vector<DepthEntry>::const_iterator first = lowerBound(min);
+    std::vector<DepthEntry>::const_iterator last = upperBound(max);
+    for (std::vector<DepthEntry>::const_iterator i = first; i < last; ++i)
+        nodes.push_back(i->node);
+
+    std::sort(nodes.begin(), nodes.end(), compareNodeNames);
+    return nodes;
+}
+
+
+int NodeDepthIndex::getNodeCountInRange(double min, double max) const
+{
+    std::vector<DepthEntry>::const_iterator first = lowerBound(min);
+    std::vector<DepthEntry>::const_iterator last = upperBound(max);
+    if (last <= first)
+        return 0;
+    return int(last - first);
+}
+
+
+std::vector<NodeDepthIndex::DepthEntry>::const_iterator NodeDepthIndex::lowerBound(double depth) const
+{
+    return std::lower_bound(m_entries.begin(), m_entries.end(), depth, compareEntryToDepth);
+}
+
+std::vector<NodeDepthIndex::DepthEntry>::const_iterator NodeDepthIndex::upperBound(double depth) const
+{
+    return std::upper_bound(m_entries.begin(), m_entries.end(), depth, compareDepthToEntry);
+}
+
+
+bool NodeDepthIndex::compareNodeNames(DeBruijnNode * a, DeBruijnNode * b)
+{
+    return a->getName() < b->getName();
+}
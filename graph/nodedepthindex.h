@@ -0,0 +1,68 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef NODEDEPTHINDEX_H
+#define NODEDEPTHINDEX_H
+
+#include <vector>
+#include <QString>
+#include <QMap>
+
+class DeBruijnNode;
+
+//This class holds all of the graph's nodes sorted by depth, so depth range
+//queries can be answered with a binary search.  Like the node name index, it
+//must be told about any nodes which are added, removed or have their depth
+//changed.
+class NodeDepthIndex
+{
+public:
+    //CREATORS
+    NodeDepthIndex();
+
+    //ACCESSORS
+    bool isBuilt() const {return m_built;}
+    int getNodeCount() const {return int(m_entries.size());}
+    std::vector<DeBruijnNode *> getNodesInRange(double min, double max) const;
+    int getNodeCountInRange(double min, double max) const;
+
+    //MODIFERS
+    void build(const QMap<QString, DeBruijnNode *> & nodes);
+    void clear();
+    void addNode(DeBruijnNode * node);
+    void removeNode(DeBruijnNode * node);
+
+private:
+    struct DepthEntry
+    {
+        double depth;
+        DeBruijnNode * node;
+    };
+
+    bool m_built;
+    std::vector<DepthEntry> m_entries;
+
+    std::vector<DepthEntry>::const_iterator lowerBound(double depth) const;
+    std::vector<DepthEntry>::const_iterator upperBound(double depth) const;
+    static bool compareEntryToDepth(const DepthEntry & entry, double depth) {return entry.depth < depth;}
+    static bool compareDepthToEntry(double depth, const DepthEntry & entry) {return depth < entry.depth;}
+    static bool compareEntries(const DepthEntry & a, const DepthEntry & b) {return a.depth < b.depth;}
+    static bool compareNodeNames(DeBruijnNode * a, DeBruijnNode * b);
+};
+
+#endif // NODEDEPTHINDEX_H
@@ -0,0 +1,205 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "nodenameindex.h"
+#include "debruijnnode.h"
+#include <algorithm>
+
+//Names are indexed by all substrings up to this length.
+static const int MAX_GRAM_LENGTH = 3;
+
+NodeNameIndex::NodeNameIndex() :
+    m_built(false), m_nodeCount(0)
+{
+}
+
+
+void NodeNameIndex::build(const QMap<QString, DeBruijnNode *> & nodes)
+{
+    clear();
+    m_built = true;
+
+    QMapIterator<QString, DeBruijnNode*> i(nodes);
+    while (i.hasNext())
+    {
+        i.next();
+        addNode(i.value());
+    }
+}
+
+
+void NodeNameIndex::clear()
+{
+    m_grams.clear();
+    m_nodeIds.clear();
+    std::vector<DeBruijnNode *>().swap(m_nodes);
+    m_built = false;
+    m_nodeCount = 0;
+}
+
+
+//Adding and removing nodes does nothing if the index hasn't been built yet,
+//as the whole graph will be indexed when it is first needed.  A new node's
+//ID is higher than any before it, so adding it to the end of each of its
+//grams' postings keeps them sorted.
+void NodeNameIndex::addNode(DeBruijnNode * node)
+{
+    if (!m_built || m_nodeIds.contains(node))
+        return;
+
+    int id = int(m_nodes.size());
+    m_nodes.push_back(node);
+    m_nodeIds.insert(node, id);
+
+    QSet<QString> grams = getGrams(node->getName());
+    QSetIterator<QString> i(grams);
+    while (i.hasNext())
+        m_grams[i.next()].push_back(id);
+    ++m_nodeCount;
+}
+
+
+//This function must be called before a node is renamed or deleted, as it
+//uses the node's current name to find its entries.  The node's ID isn't
+//used again, so a renamed node is added back with a new one.
+void NodeNameIndex::removeNode(DeBruijnNode * node)
+{
+    if (!m_built)
+        return;
+
+    QHash<DeBruijnNode *, int>::iterator nodeId = m_nodeIds.find(node);
+    if (nodeId == m_nodeIds.end())
+        return;
+    int id = nodeId.value();
+    m_nodeIds.erase(nodeId);
+    m_nodes[id] = 0;
+
+    QSet<QString> grams = getGrams(node->getName());
+    QSetIterator<QString> i(grams);
+    while (i.hasNext())
+    {
+        QString gram = i.next();
+        QHash<QString, std::vector<int> >::iterator postings = m_grams.find(gram);
+        if (postings == m_grams.end())
+            continue;
+        std::vector<int> & ids = postings.value();
+        std::vector<int>::iterator position = std::lower_bound(ids.begin(), ids.end(), id);
+        if (position != ids.end() && *position == id)
+            ids.erase(position);
+        if (ids.empty())
+            m_grams.erase(postings);
+    }
+    --m_nodeCount;
+}
+
+
+//This function returns all nodes whose name contains the query, sorted by
+//name to match the order of the graph's node map.
+std::vector<DeBruijnNode *> NodeNameIndex::findNodes(QString query) const
+{
+    std::vector<DeBruijnNode *> matches;
+    if (query.isEmpty())
+        return matches;
+
+    //Short queries are themselves grams, so their postings are exactly the
+    //matching nodes.
+    std::vector<int> ids;
+    if (query.length() <= MAX_GRAM_LENGTH)
+    {
+        QHash<QString, std::vector<int> >::const_iterator postings = m_grams.find(query);
+        if (postings == m_grams.end())
+            return matches;
+        ids = postings.value();
+        for (size_t i = 0; i < ids.size(); ++i)
+            matches.push_back(m_nodes[ids[i]]);
+    }
+
+    //Longer queries intersect their grams' postings, rarest first, and then
+    //check each node left against the whole query, as having all of its
+    //grams doesn't mean a name contains it.
+    else
+    {
+        std::vector<const std::vector<int> *> gramPostings;
+        for (int i = 0; i + MAX_GRAM_LENGTH <= query.length(); ++i)
+        {
+            QHash<QString, std::vector<int> >::const_iterator postings = m_grams.find(query.mid(i, MAX_GRAM_LENGTH));
+            if (postings == m_grams.end())
+                return matches;
+            gramPostings.push_back(&postings.value());
+        }
+        std::sort(gramPostings.begin(), gramPostings.end(), postingsAreSmaller);
+
+        ids = *gramPostings[0];
+        for (size_t i = 1; i < gramPostings.size() && !ids.empty(); ++i)
+            intersectPostings(&ids, *gramPostings[i]);
+
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            DeBruijnNode * node = m_nodes[ids[i]];
+            if (node->getName().contains(query))
+                matches.push_back(node);
+        }
+    }
+
+    std::sort(matches.begin(), matches.end(), compareNodeNames);
+    return matches;
+}
+
+
+QSet<QString> NodeNameIndex::getGrams(QString name)
+{
+    QSet<QString> grams;
+    for (int i = 0; i < name.length(); ++i)
+    {
+        for (int length = 1; length <= MAX_GRAM_LENGTH && i + length <= name.length(); ++length)
+            grams.insert(name.mid(i, length));
+    }
+    return grams;
+}
+
+
+//This function keeps only the IDs which are also in the postings.  The IDs
+//are never more than the postings, so each is looked up by binary search
+//rather than walking the postings.
+void NodeNameIndex::intersectPostings(std::vector<int> * ids, const std::vector<int> & postings)
+{
+    size_t kept = 0;
+    std::vector<int>::const_iterator searchStart = postings.begin();
+    for (size_t i = 0; i < ids->size(); ++i)
+    {
+        int id = (*ids)[i];
+        searchStart = std::lower_bound(searchStart, postings.end(), id);
+        if (searchStart == postings.end())
+            break;
+        if (*searchStart == id)
+            (*ids)[kept++] = id;
+    }
+    ids->resize(kept);
+}
+
+
+bool NodeNameIndex::postingsAreSmaller(const std::vector<int> * a, const std::vector<int> * b)
+{
+    return a->size() < b->size();
+}
+
+
+bool NodeNameIndex::compareNodeNames(DeBruijnNode * a, DeBruijnNode * b)
+{
+    return a->getName() < b->getName();
+}
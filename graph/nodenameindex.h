@@ -0,0 +1,70 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef NODENAMEINDEX_H
+#define NODENAMEINDEX_H
+
+#include <vector>
+#include <QString>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+
+class DeBruijnNode;
+
+//This class is an n-gram index of node names, used for partial node name
+//matching.  Every substring of a name up to the maximum gram length is
+//indexed, so a query that short can be answered directly from the index.
+//Longer queries intersect the postings of their grams, starting from the
+//rarest, and the few candidates left are checked against the full query.
+//Each node is given an ID when it is added, and each gram's postings are a
+//sorted vector of IDs, so intersecting costs about the size of the rarest
+//gram's postings rather than the commonest's.
+//The index is built lazily, as it is only needed for partial searches, and
+//must be told about any nodes which are added, removed or renamed.
+class NodeNameIndex
+{
+public:
+    //CREATORS
+    NodeNameIndex();
+
+    //ACCESSORS
+    bool isBuilt() const {return m_built;}
+    int getNodeCount() const {return m_nodeCount;}
+    std::vector<DeBruijnNode *> findNodes(QString query) const;
+
+    //MODIFERS
+    void build(const QMap<QString, DeBruijnNode *> & nodes);
+    void clear();
+    void addNode(DeBruijnNode * node);
+    void removeNode(DeBruijnNode * node);
+
+private:
+    bool m_built;
+    int m_nodeCount;
+    std::vector<DeBruijnNode *> m_nodes;
+    QHash<DeBruijnNode *, int> m_nodeIds;
+    QHash<QString, std::vector<int> > m_grams;
+
+    static QSet<QString> getGrams(QString name);
+    static void intersectPostings(std::vector<int> * ids, const std::vector<int> & postings);
+    static bool postingsAreSmaller(const std::vector<int> * a, const std::vector<int> * b);
+    static bool compareNodeNames(DeBruijnNode * a, DeBruijnNode * b);
+};
+
+#endif // NODENAMEINDEX_H
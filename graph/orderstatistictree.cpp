@@ -0,0 +1,295 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "orderstatistictree.h"
+#include <math.h>
+
+OrderStatisticTree::OrderStatisticTree() :
+    m_root(0), m_randomState(12345)
+{
+}
+
+OrderStatisticTree::~OrderStatisticTree()
+{
+    clear();
+}
+
+
+int OrderStatisticTree::getCount() const
+{
+    if (m_root == 0)
+        return 0;
+    return m_root->subtreeCount;
+}
+
+long long OrderStatisticTree::getTotalWeight() const
+{
+    if (m_root == 0)
+        return 0;
+    return m_root->subtreeWeight;
+}
+
+
+//This function returns the value at the given position (zero-based) in the
+//sorted values, or 0.0 if the position is out of range.
+double OrderStatisticTree::getValueAtIndex(int index) const
+{
+    TreeNode * node = m_root;
+    while (node != 0)
+    {
+        int leftCount = 0;
+        if (node->left != 0)
+            leftCount = node->left->subtreeCount;
+
+        if (index < leftCount)
+            node = node->left;
+        else if (index < leftCount + node->count)
+            return node->value;
+        else
+        {
+            index -= leftCount + node->count;
+            node = node->right;
+        }
+    }
+    return 0.0;
+}
+
+
+//This function treats each value as being repeated by its weight (e.g. one
+//depth per base) and returns the value at the given position (zero-based) in
+//that expanded list, or 0.0 if the position is out of range.
+double OrderStatisticTree::getValueAtWeightIndex(long long weightIndex) const
+{
+    TreeNode * node = m_root;
+    while (node != 0)
+    {
+        long long leftWeight = 0;
+        if (node->left != 0)
+            leftWeight = node->left->subtreeWeight;
+
+        if (weightIndex < leftWeight)
+            node = node->left;
+        else if (weightIndex < leftWeight + node->weight)
+            return node->value;
+        else
+        {
+            weightIndex -= leftWeight + node->weight;
+            node = node->right;
+        }
+    }
+    return 0.0;
+}
+
+
+//This function returns the value at the given fraction (0 to 1) of the way
+//through the sorted values, interpolating between neighbouring values.
+double OrderStatisticTree::getQuantile(double fraction) const
+{
+    int count = getCount();
+    if (count == 0)
+        return 0.0;
+    if (count == 1)
+        return m_root->value;
+
+    double index = (count - 1) * fraction;
+    int wholePart = floor(index);
+
+    if (wholePart < 0)
+        return getValueAtIndex(0);
+    if (wholePart >= count - 1)
+        return getValueAtIndex(count - 1);
+
+    double fractionalPart = index - wholePart;
+
+    double piece1 = getValueAtIndex(wholePart);
+    double piece2 = getValueAtIndex(wholePart + 1);
+
+    return piece1 * (1.0 - fractionalPart) + piece2 * fractionalPart;
+}
+
+
+
+void OrderStatisticTree::insert(double value, long long weight)
+{
+    TreeNode * lower;
+    TreeNode * equal;
+    TreeNode * higher;
+    splitBefore(m_root, value, &lower, &higher);
+    splitAfter(higher, value, &equal, &higher);
+
+    if (equal == 0)
+    {
+        equal = new TreeNode;
+        equal->value = value;
+        equal->count = 0;
+        equal->weight = 0;
+        equal->priority = getNextPriority();
+        equal->left = 0;
+        equal->right = 0;
+    }
+    ++equal->count;
+    equal->weight += weight;
+    update(equal);
+
+    m_root = merge(merge(lower, equal), higher);
+}
+
+
+//This function removes one copy of the value with the given weight.  It does
+//nothing if the value isn't in the tree.
+void OrderStatisticTree::remove(double value, long long weight)
+{
+    TreeNode * lower;
+    TreeNode * equal;
+    TreeNode * higher;
+    splitBefore(m_root, value, &lower, &higher);
+    splitAfter(higher, value, &equal, &higher);
+
+    if (equal != 0)
+    {
+        --equal->count;
+        equal->weight -= weight;
+        if (equal->count <= 0)
+        {
+            delete equal;
+            equal = 0;
+        }
+        else
+            update(equal);
+    }
+
+    m_root = merge(merge(lower, equal), higher);
+}
+
+
+void OrderStatisticTree::clear()
+{
+    deleteSubtree(m_root);
+    m_root = 0;
+}
+
+
+
+//The priorities only need to look random, so a simple linear congruential
+//generator is used.  This keeps the tree's shape the same from run to run.
+unsigned int OrderStatisticTree::getNextPriority()
+{
+    m_randomState = m_randomState * 1103515245u + 12345u;
+    return m_randomState;
+}
+
+
+void OrderStatisticTree::update(TreeNode * node)
+{
+    node->subtreeCount = node->count;
+    node->subtreeWeight = node->weight;
+    if (node->left != 0)
+    {
+        node->subtreeCount += node->left->subtreeCount;
+        node->subtreeWeight += node->left->subtreeWeight;
+    }
+    if (node->right != 0)
+    {
+        node->subtreeCount += node->right->subtreeCount;
+        node->subtreeWeight += node->right->subtreeWeight;
+    }
+}
+
+
+//This function joins two trees, where all values in the first are lower than
+//all values in the second.
+OrderStatisticTree::TreeNode * OrderStatisticTree::merge(TreeNode * a, TreeNode * b)
+{
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+
+    if (a->priority > b->priority)
+    {
+        a->right = merge(a->right, b);
+        update(a);
+        return a;
+    }
+    else
+    {
+        b->left = merge(a, b->left);
+        update(b);
+        return b;
+    }
+}
+
+
+//This function splits a tree into values lower than the given value and
+//values at or above it.
+void OrderStatisticTree::splitBefore(TreeNode * node, double value, TreeNode ** left, TreeNode ** right)
+{
+    if (node == 0)
+    {
+        *left = 0;
+        *right = 0;
+        return;
+    }
+
+    if (node->value < value)
+    {
+        splitBefore(node->right, value, &node->right, right);
+        *left = node;
+    }
+    else
+    {
+        splitBefore(node->left, value, left, &node->left);
+        *right = node;
+    }
+    update(node);
+}
+
+
+//This function splits a tree into values at or below the given value and
+//values above it.
+void OrderStatisticTree::splitAfter(TreeNode * node, double value, TreeNode ** left, TreeNode ** right)
+{
+    if (node == 0)
+    {
+        *left = 0;
+        *right = 0;
+        return;
+    }
+
+    if (node->value <= value)
+    {
+        splitAfter(node->right, value, &node->right, right);
+        *left = node;
+    }
+    else
+    {
+        splitAfter(node->left, value, left, &node->left);
+        *right = node;
+    }
+    update(node);
+}
+
+
+void OrderStatisticTree::deleteSubtree(TreeNode * node)
+{
+    if (node == 0)
+        return;
+    deleteSubtree(node->left);
+    deleteSubtree(node->right);
+    delete node;
+}
@@ -0,0 +1,74 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef ORDERSTATISTICTREE_H
+#define ORDERSTATISTICTREE_H
+
+//This class holds a sorted multiset of values, each with a weight (e.g. a
+//node depth weighted by the node's length).  It is a treap where each tree
+//node holds one distinct value and knows the count and weight of its
+//subtree, so values can be added, removed and looked up by rank or by
+//cumulative weight in O(log n) expected time.
+class OrderStatisticTree
+{
+public:
+    //CREATORS
+    OrderStatisticTree();
+    ~OrderStatisticTree();
+
+    //ACCESSORS
+    int getCount() const;
+    long long getTotalWeight() const;
+    double getValueAtIndex(int index) const;
+    double getValueAtWeightIndex(long long weightIndex) const;
+    double getQuantile(double fraction) const;
+
+    //MODIFERS
+    void insert(double value, long long weight);
+    void remove(double value, long long weight);
+    void clear();
+
+private:
+    struct TreeNode
+    {
+        double value;
+        int count;
+        long long weight;
+        int subtreeCount;
+        long long subtreeWeight;
+        unsigned int priority;
+        TreeNode * left;
+        TreeNode * right;
+    };
+
+    TreeNode * m_root;
+    unsigned int m_randomState;
+
+    //The tree owns its nodes, so it can't be copied.
+    OrderStatisticTree(const OrderStatisticTree &);
+    OrderStatisticTree & operator=(const OrderStatisticTree &);
+
+    unsigned int getNextPriority();
+    static void update(TreeNode * node);
+    static TreeNode * merge(TreeNode * a, TreeNode * b);
+    static void splitBefore(TreeNode * node, double value, TreeNode ** left, TreeNode ** right);
+    static void splitAfter(TreeNode * node, double value, TreeNode ** left, TreeNode ** right);
+    static void deleteSubtree(TreeNode * node);
+};
+
+#endif // ORDERSTATISTICTREE_H
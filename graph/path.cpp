@@ -23,9 +23,14 @@
 #include "../blast/blastquery.h"
 #include <QRegularExpression>
 #include "assemblygraph.h"
+#include "pathenumerator.h"
 #include <QStringList>
 #include <QApplication>
 #include <limits>
+#include <map>
+#include <algorithm>
+#include <QHash>
+#include <QPair>
 
 
 
@@ -114,6 +119,22 @@ Path Path::makeFromOrderedNodes(QList<DeBruijnNode *> nodes, bool circular)
 }
 
 
+//This function makes a linear path which starts and ends part way through
+//its first and last nodes.
+Path Path::makeFromOrderedNodes(QList<DeBruijnNode *> nodes,
+                                GraphLocation startLocation,
+                                GraphLocation endLocation)
+{
+    Path path = makeFromOrderedNodes(nodes, false);
+    if (path.m_nodes.empty())
+        return path;
+
+    path.m_startLocation = startLocation;
+    path.m_endLocation = endLocation;
+    return path;
+}
+
+
 
 Path Path::makeFromString(QString pathString, bool circular,
                           QString * pathStringFailure)
@@ -672,53 +693,113 @@ QList<Path> Path::getAllPossiblePaths(GraphLocation startLocation,
                                       int nodeSearchDepth,
                                       int minDistance, int maxDistance)
 {
-    QList<Path> finishedPaths;
-    QList<Path> unfinishedPaths;
+    PathEnumerator pathEnumerator(startLocation, endLocation, nodeSearchDepth,
+                                  minDistance, maxDistance);
+    return pathEnumerator.getAllPaths();
+}
+
+
+//This function finds which paths in the list are sub-paths of another path in
+//the list, i.e. for each path it gives the same result as calling
+//hasNodeSubset against every other path.  Instead of comparing all pairs of
+//paths, it uses rolling hashes: for each node count that occurs in the list,
+//every window of that many nodes in the longer paths is hashed.  A path then
+//only needs to be compared with the windows that have the same hash.
+std::vector<bool> Path::findPathsWithNodeSubsets(const QList<Path> & paths)
+{
+    std::vector<bool> nodeSubsets(paths.size(), false);
+
+    //Give each node a number, so the hashes don't depend on pointer values.
+    QHash<DeBruijnNode *, quint64> nodeNumbers;
+    std::vector<std::vector<quint64> > nodeNumberLists(paths.size());
+    std::map<int, std::vector<int> > pathsByNodeCount;
+    int maxNodeCount = 0;
+    for (int i = 0; i < paths.size(); ++i)
+    {
+        const QList<DeBruijnNode *> & nodes = paths[i].m_nodes;
+        for (int j = 0; j < nodes.size(); ++j)
+        {
+            if (!nodeNumbers.contains(nodes[j]))
+                nodeNumbers.insert(nodes[j], quint64(nodeNumbers.size() + 1));
+            nodeNumberLists[i].push_back(nodeNumbers[nodes[j]]);
+        }
+        pathsByNodeCount[nodes.size()].push_back(i);
+        maxNodeCount = std::max(maxNodeCount, int(nodes.size()));
+    }
 
-    Path startPath;
-    startPath.addNode(startLocation.getNode(), true, false);
-    startPath.m_startLocation = startLocation;
-    startPath.m_endLocation = GraphLocation::endOfNode(startLocation.getNode());
-    unfinishedPaths.push_back(startPath);
+    //The hash of the nodes in [start, end) of a path is
+    //prefixHashes[end] - prefixHashes[start] * powers[end - start].
+    //Arithmetic is modulo 2^64, which happens naturally with overflow.
+    const quint64 base = 1000003;
+    std::vector<quint64> powers(maxNodeCount + 1, 1);
+    for (int i = 1; i <= maxNodeCount; ++i)
+        powers[i] = powers[i-1] * base;
+    std::vector<std::vector<quint64> > prefixHashes(paths.size());
+    for (int i = 0; i < paths.size(); ++i)
+    {
+        const std::vector<quint64> & numbers = nodeNumberLists[i];
+        prefixHashes[i].resize(numbers.size() + 1, 0);
+        for (size_t j = 0; j < numbers.size(); ++j)
+            prefixHashes[i][j+1] = prefixHashes[i][j] * base + numbers[j];
+    }
 
-    for (int i = 0; i <= nodeSearchDepth; ++i)
+    for (std::map<int, std::vector<int> >::const_iterator i = pathsByNodeCount.begin(); i != pathsByNodeCount.end(); ++i)
     {
-        QApplication::processEvents();
+        int nodeCount = i->first;
+        const std::vector<int> & shortPaths = i->second;
 
-        //Look at each of the unfinished paths to see if they end with the end
-        //node.  If so, see if it has the appropriate length.
-        //If it does, it will go into the final returned list.
-        //If it doesn't and it's over length, then it will be removed.
-        QList<Path>::iterator j = unfinishedPaths.begin();
-        while (j != unfinishedPaths.end())
+        //An empty path is a sub-path of any path with nodes.
+        if (nodeCount == 0)
         {
-            DeBruijnNode * lastNode = (*j).m_nodes.back();
-            if (lastNode == endLocation.getNode())
+            if (pathsByNodeCount.upper_bound(0) != pathsByNodeCount.end())
             {
-                Path potentialFinishedPath = *j;
-                potentialFinishedPath.m_endLocation = endLocation;
-                int length = potentialFinishedPath.getLength();
-                if (length >= minDistance && length <= maxDistance)
-                    finishedPaths.push_back(potentialFinishedPath);
-                ++j;
+                for (size_t j = 0; j < shortPaths.size(); ++j)
+                    nodeSubsets[shortPaths[j]] = true;
             }
-            else
+            continue;
+        }
+
+        //Hash every window of this size in every path with more nodes.
+        QHash<quint64, QList<QPair<int, int> > > windows;
+        for (std::map<int, std::vector<int> >::const_iterator j = pathsByNodeCount.upper_bound(nodeCount); j != pathsByNodeCount.end(); ++j)
+        {
+            const std::vector<int> & longPaths = j->second;
+            for (size_t k = 0; k < longPaths.size(); ++k)
             {
-                if ((*j).getLength() > maxDistance)
-                    j = unfinishedPaths.erase(j);
-                else
-                    ++j;
+                int longPath = longPaths[k];
+                const std::vector<quint64> & hashes = prefixHashes[longPath];
+                for (int start = 0; start + nodeCount <= j->first; ++start)
+                {
+                    quint64 hash = hashes[start + nodeCount] - hashes[start] * powers[nodeCount];
+                    windows[hash].push_back(QPair<int, int>(longPath, start));
+                }
             }
         }
+        if (windows.isEmpty())
+            continue;
 
-        //Make new unfinished paths by extending each of the paths.
-        QList<Path> newUnfinishedPaths;
-        for (int j = 0; j < unfinishedPaths.size(); ++j)
-            newUnfinishedPaths.append(unfinishedPaths[j].extendPathInAllPossibleWays());
-        unfinishedPaths = newUnfinishedPaths;
+        //Check each path of this size against the windows with a matching
+        //hash.  The nodes are compared directly, so a hash collision can't
+        //cause a wrong result.
+        for (size_t j = 0; j < shortPaths.size(); ++j)
+        {
+            int shortPath = shortPaths[j];
+            quint64 hash = prefixHashes[shortPath][nodeCount];
+            if (!windows.contains(hash))
+                continue;
+
+            const std::vector<quint64> & shortNumbers = nodeNumberLists[shortPath];
+            const QList<QPair<int, int> > & matches = windows[hash];
+            for (int k = 0; k < matches.size() && !nodeSubsets[shortPath]; ++k)
+            {
+                const std::vector<quint64> & longNumbers = nodeNumberLists[matches[k].first];
+                nodeSubsets[shortPath] = std::equal(shortNumbers.begin(), shortNumbers.end(),
+                                                    longNumbers.begin() + matches[k].second);
+            }
+        }
     }
 
-    return finishedPaths;
+    return nodeSubsets;
 }
 
 
@@ -32,6 +32,8 @@ class DeBruijnEdge;
 
 class Path
 {
+    friend class PathEnumerator;
+
 public:
     //CREATORS
     Path() {}
@@ -41,6 +43,9 @@ public:
                                        bool strandSpecific);
     static Path makeFromOrderedNodes(QList<DeBruijnNode *> nodes,
                                      bool circular);
+    static Path makeFromOrderedNodes(QList<DeBruijnNode *> nodes,
+                                     GraphLocation startLocation,
+                                     GraphLocation endLocation);
     static Path makeFromString(QString pathString, bool circular,
                                QString * pathStringFailure);
 
@@ -81,6 +86,7 @@ public:
                                            GraphLocation endLocation,
                                            int nodeSearchDepth,
                                            int minDistance, int maxDistance);
+    static std::vector<bool> findPathsWithNodeSubsets(const QList<Path> & paths);
 
 private:
     GraphLocation m_startLocation;
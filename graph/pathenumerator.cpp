@@ -0,0 +1,240 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "pathenumerator.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include "shortestpathfinder.h"
+#include <QApplication>
+#include <QThread>
+#include <QQueue>
+#include <algorithm>
+
+PathEnumerator::PathEnumerator(GraphLocation startLocation, GraphLocation endLocation,
+                               int nodeSearchDepth, int minDistance, int maxDistance) :
+    m_startLocation(startLocation), m_endLocation(endLocation),
+    m_nodeSearchDepth(nodeSearchDepth), m_minDistance(minDistance),
+    m_maxDistance(maxDistance), m_useLengthToEnd(false)
+{
+    DeBruijnNode * endNode = m_endLocation.getNode();
+    m_endTrim = endNode->getLength() - m_endLocation.getPosition();
+}
+
+
+//This function returns the same paths, in the same order, as a breadth-first
+//search which extends every path by one node at a time: paths with fewer
+//nodes come first and paths with the same number of nodes are ordered by the
+//edges they take.  A path is abandoned if it goes over the maximum length
+//before it reaches the end node.
+QList<Path> PathEnumerator::getAllPaths()
+{
+    QList<Path> finishedPaths;
+    if (m_nodeSearchDepth < 0)
+        return finishedPaths;
+
+    DeBruijnNode * startNode = m_startLocation.getNode();
+    DeBruijnNode * endNode = m_endLocation.getNode();
+    long long startLength = startNode->getLength() - (m_startLocation.getPosition() - 1);
+
+    findStepsToEnd();
+    if (!m_stepsToEnd.contains(startNode))
+        return finishedPaths;
+    findLengthToEnd(startLength);
+
+    std::vector<std::vector<int> > finishedStepsByDepth(m_nodeSearchDepth + 1);
+
+    m_steps.clear();
+    PathStep firstStep;
+    firstStep.parent = -1;
+    firstStep.edge = 0;
+    firstStep.node = startNode;
+    firstStep.length = startLength;
+    firstStep.depth = 0;
+    m_steps.push_back(firstStep);
+
+    std::vector<int> stepsToVisit;
+    stepsToVisit.push_back(0);
+    int visitCount = 0;
+    bool onMainThread = (QCoreApplication::instance() != 0 &&
+                         QThread::currentThread() == QCoreApplication::instance()->thread());
+
+    while (!stepsToVisit.empty())
+    {
+        int stepIndex = stepsToVisit.back();
+        stepsToVisit.pop_back();
+        PathStep step = m_steps[stepIndex];
+
+        //This can go for a while, so keep the UI responsive.  Searches run
+        //in a thread pool have no UI to keep responsive.
+        if (++visitCount % 1000 == 0 && onMainThread)
+            QApplication::processEvents();
+
+        if (step.node == endNode)
+        {
+            long long length = step.length - m_endTrim;
+            if (length >= m_minDistance && length <= m_maxDistance)
+                finishedStepsByDepth[step.depth].push_back(stepIndex);
+        }
+        else if (step.length > m_maxDistance)
+            continue;
+
+        if (step.depth >= m_nodeSearchDepth)
+            continue;
+
+        //The next steps are added in reverse so they are visited in the
+        //order of the node's edges.
+        std::vector<DeBruijnEdge *> nextEdges = step.node->getLeavingEdges();
+        std::vector<int> nextSteps;
+        for (size_t i = 0; i < nextEdges.size(); ++i)
+        {
+            DeBruijnEdge * nextEdge = nextEdges[i];
+            DeBruijnNode * nextNode = nextEdge->getEndingNode();
+            long long nextLength = step.length + getAddedLength(nextEdge);
+            if (!canReachEnd(nextNode, nextLength, step.depth + 1))
+                continue;
+
+            PathStep nextStep;
+            nextStep.parent = stepIndex;
+            nextStep.edge = nextEdge;
+            nextStep.node = nextNode;
+            nextStep.length = nextLength;
+            nextStep.depth = step.depth + 1;
+            m_steps.push_back(nextStep);
+            nextSteps.push_back(int(m_steps.size()) - 1);
+        }
+        for (int i = int(nextSteps.size()) - 1; i >= 0; --i)
+            stepsToVisit.push_back(nextSteps[i]);
+    }
+
+    for (size_t i = 0; i < finishedStepsByDepth.size(); ++i)
+    {
+        for (size_t j = 0; j < finishedStepsByDepth[i].size(); ++j)
+            finishedPaths.push_back(buildPath(finishedStepsByDepth[i][j]));
+    }
+
+    m_steps.clear();
+    return finishedPaths;
+}
+
+
+//This function does a backward breadth-first search from the end node to
+//find the fewest steps needed to reach the end node from each node.  Nodes
+//which are too many steps away are not included.
+void PathEnumerator::findStepsToEnd()
+{
+    m_stepsToEnd.clear();
+
+    DeBruijnNode * endNode = m_endLocation.getNode();
+    m_stepsToEnd.insert(endNode, 0);
+    QQueue<DeBruijnNode *> queue;
+    queue.enqueue(endNode);
+
+    while (!queue.isEmpty())
+    {
+        DeBruijnNode * node = queue.dequeue();
+        int steps = m_stepsToEnd[node];
+        if (steps >= m_nodeSearchDepth)
+            continue;
+
+        std::vector<DeBruijnEdge *> enteringEdges = node->getEnteringEdges();
+        for (size_t i = 0; i < enteringEdges.size(); ++i)
+        {
+            DeBruijnNode * previousNode = enteringEdges[i]->getStartingNode();
+            if (!m_stepsToEnd.contains(previousNode))
+            {
+                m_stepsToEnd.insert(previousNode, steps + 1);
+                queue.enqueue(previousNode);
+            }
+        }
+    }
+}
+
+
+//This function does a backward Dijkstra search from the end node to find the
+//minimum length that must be added to reach the end node from each node.
+//It only works if adding a node can never shorten a path, so if any edge has
+//an overlap larger than its ending node, the length bound is not used.
+//The search stops once the added length alone would put even the shortest
+//possible path over the maximum distance.
+void PathEnumerator::findLengthToEnd(long long startLength)
+{
+    m_lengthToEnd.clear();
+    m_useLengthToEnd = false;
+
+    for (QHash<DeBruijnNode *, int>::const_iterator i = m_stepsToEnd.constBegin(); i != m_stepsToEnd.constEnd(); ++i)
+    {
+        std::vector<DeBruijnEdge *> enteringEdges = i.key()->getEnteringEdges();
+        for (size_t j = 0; j < enteringEdges.size(); ++j)
+        {
+            if (m_stepsToEnd.contains(enteringEdges[j]->getStartingNode()) &&
+                    getAddedLength(enteringEdges[j]) < 0)
+                return;
+        }
+    }
+    m_useLengthToEnd = true;
+
+    long long lengthLimit = m_maxDistance + m_endTrim - startLength;
+    m_lengthToEnd = ShortestPathFinder::getAddedLengthsToNode(m_endLocation.getNode(), lengthLimit,
+                                                              &m_stepsToEnd);
+}
+
+
+//This function checks whether a path which has just reached the given node
+//could possibly be extended to a path that ends at the end location within
+//the limits.
+bool PathEnumerator::canReachEnd(DeBruijnNode * node, long long length, int depth) const
+{
+    if (!m_stepsToEnd.contains(node))
+        return false;
+    if (m_stepsToEnd[node] > m_nodeSearchDepth - depth)
+        return false;
+
+    if (m_useLengthToEnd)
+    {
+        if (!m_lengthToEnd.contains(node))
+            return false;
+        if (length + m_lengthToEnd[node] - m_endTrim > m_maxDistance)
+            return false;
+    }
+
+    return true;
+}
+
+
+//This function follows the parent steps back to the start to build a path.
+Path PathEnumerator::buildPath(int stepIndex) const
+{
+    Path path;
+    for (int i = stepIndex; i >= 0; i = m_steps[i].parent)
+    {
+        path.m_nodes.push_front(m_steps[i].node);
+        if (m_steps[i].edge != 0)
+            path.m_edges.push_front(m_steps[i].edge);
+    }
+    path.m_startLocation = m_startLocation;
+    path.m_endLocation = m_endLocation;
+    return path;
+}
+
+
+//This is the amount a path's length changes when it is extended by the
+//given edge.
+long long PathEnumerator::getAddedLength(DeBruijnEdge * edge)
+{
+    return ShortestPathFinder::getAddedLength(edge);
+}
@@ -0,0 +1,78 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef PATHENUMERATOR_H
+#define PATHENUMERATOR_H
+
+#include <QList>
+#include <QHash>
+#include <vector>
+#include "graphlocation.h"
+#include "path.h"
+
+class DeBruijnNode;
+class DeBruijnEdge;
+
+//This class finds all paths between two graph locations, within limits on
+//the number of nodes and the path length.  It does a depth-first search and
+//skips any branch which cannot reach the end location within the limits,
+//using the minimum number of steps and minimum added length from each nearby
+//node to the end node.  Partial paths are stored as steps which point to
+//their parent step, so paths with a common start share that part of their
+//storage.
+class PathEnumerator
+{
+public:
+    //CREATORS
+    PathEnumerator(GraphLocation startLocation, GraphLocation endLocation,
+                   int nodeSearchDepth, int minDistance, int maxDistance);
+
+    //ACCESSORS
+    QList<Path> getAllPaths();
+
+private:
+    struct PathStep
+    {
+        int parent;
+        DeBruijnEdge * edge;
+        DeBruijnNode * node;
+        long long length;
+        int depth;
+    };
+
+    GraphLocation m_startLocation;
+    GraphLocation m_endLocation;
+    int m_nodeSearchDepth;
+    int m_minDistance;
+    int m_maxDistance;
+    long long m_endTrim;
+
+    QHash<DeBruijnNode *, int> m_stepsToEnd;
+    QHash<DeBruijnNode *, long long> m_lengthToEnd;
+    bool m_useLengthToEnd;
+
+    std::vector<PathStep> m_steps;
+
+    void findStepsToEnd();
+    void findLengthToEnd(long long startLength);
+    bool canReachEnd(DeBruijnNode * node, long long length, int depth) const;
+    Path buildPath(int stepIndex) const;
+    static long long getAddedLength(DeBruijnEdge * edge);
+};
+
+#endif // PATHENUMERATOR_H
@@ -0,0 +1,677 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "sequenceindex.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include "../program/runjobs.h"
+#include <QList>
+#include <QMapIterator>
+#include <QSharedPointer>
+#include <algorithm>
+
+//This is the most paths through the following nodes that are indexed for
+//the end of any one node, which keeps tangled regions of short nodes cheap.
+//Junctions with more paths than this are counted, as an exact occurrence
+//which runs over one of them may not be found.
+static const int MAX_JUNCTION_PATHS = 64;
+
+SequenceIndex::SequenceIndex() :
+    m_built(false), m_kmerSize(0), m_windowSize(0), m_truncatedJunctionCount(0)
+{
+}
+
+
+//This function builds the index for the given nodes.  The sequences and
+//edges are gathered first, as getting a node's sequence may load it from a
+//file, which can't be done from several threads.  The minimizers are then
+//found in blocks of nodes, in a thread pool if more than one thread is to be
+//used, and sorted by hash.
+void SequenceIndex::build(const QMap<QString, DeBruijnNode *> & nodes, int kmerSize, int windowSize, int threads)
+{
+    clear();
+    m_kmerSize = kmerSize;
+    m_windowSize = windowSize;
+
+    QHash<DeBruijnNode *, int> nodeIndices;
+    QMapIterator<QString, DeBruijnNode*> i(nodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        nodeIndices.insert(node, int(m_nodes.size()));
+        m_nodes.push_back(node);
+
+        QByteArray sequence = node->getSequence();
+        if (node->sequenceIsMissing())
+            sequence = QByteArray();
+        m_sequences.push_back(sequence.toUpper());
+    }
+
+    m_successors.resize(m_nodes.size());
+    m_predecessors.resize(m_nodes.size());
+    for (size_t j = 0; j < m_nodes.size(); ++j)
+    {
+        const std::vector<DeBruijnEdge *> * edges = m_nodes[j]->getEdgesPointer();
+        for (size_t k = 0; k < edges->size(); ++k)
+        {
+            DeBruijnEdge * edge = (*edges)[k];
+            if (!nodeIndices.contains(edge->getStartingNode()) || !nodeIndices.contains(edge->getEndingNode()))
+                continue;
+            if (edge->getStartingNode() == m_nodes[j])
+                m_successors[j].push_back(QPair<int, int>(nodeIndices[edge->getEndingNode()], edge->getOverlap()));
+            if (edge->getEndingNode() == m_nodes[j])
+                m_predecessors[j].push_back(QPair<int, int>(nodeIndices[edge->getStartingNode()], edge->getOverlap()));
+        }
+    }
+
+    int nodeCount = int(m_nodes.size());
+    int blockCount = std::max(1, std::min(nodeCount, threads * 4));
+    QList< QSharedPointer<SequenceIndexBuildJob> > jobs;
+    for (int j = 0; j < blockCount; ++j)
+    {
+        int firstNode = int((long long)(nodeCount) * j / blockCount);
+        int lastNode = int((long long)(nodeCount) * (j + 1) / blockCount) - 1;
+        jobs.push_back(QSharedPointer<SequenceIndexBuildJob>(new SequenceIndexBuildJob(this, firstNode, lastNode)));
+    }
+
+    runJobs(jobs, threads);
+
+    size_t entryCount = 0;
+    for (int j = 0; j < jobs.size(); ++j)
+    {
+        entryCount += jobs[j]->getEntries()->size();
+        m_truncatedJunctionCount += jobs[j]->getTruncatedJunctionCount();
+    }
+    m_entries.reserve(entryCount);
+    for (int j = 0; j < jobs.size(); ++j)
+        m_entries.insert(m_entries.end(), jobs[j]->getEntries()->begin(), jobs[j]->getEntries()->end());
+    jobs.clear();
+
+    //A minimizer near the end of a node is also found from the windows which
+    //run into the next node, so duplicates are removed.
+    sortEntries(&m_entries);
+
+    m_built = true;
+}
+
+
+void SequenceIndex::clear()
+{
+    m_built = false;
+    m_truncatedJunctionCount = 0;
+    std::vector<DeBruijnNode *>().swap(m_nodes);
+    std::vector<QByteArray>().swap(m_sequences);
+    std::vector< std::vector< QPair<int, int> > >().swap(m_successors);
+    std::vector< std::vector< QPair<int, int> > >().swap(m_predecessors);
+    std::vector<MinimizerEntry>().swap(m_entries);
+}
+
+
+
+//This function finds the minimizers for the windows inside each of the given
+//nodes and for the windows which run off their ends.
+std::vector<MinimizerEntry> SequenceIndex::getNodeMinimizers(int firstNode, int lastNode,
+                                                             int * truncatedJunctionCount) const
+{
+    std::vector<MinimizerEntry> entries;
+    std::vector< QPair<quint64, int> > minimizers;
+    int span = m_kmerSize + m_windowSize - 1;
+    for (int i = firstNode; i <= lastNode; ++i)
+    {
+        minimizers.clear();
+        getMinimizers(m_sequences[i], m_kmerSize, m_windowSize, 0, m_sequences[i].length() - span, &minimizers);
+        for (size_t j = 0; j < minimizers.size(); ++j)
+        {
+            MinimizerEntry entry = {minimizers[j].first, i, minimizers[j].second};
+            entries.push_back(entry);
+        }
+        addJunctionMinimizers(i, &entries, truncatedJunctionCount);
+    }
+    return entries;
+}
+
+
+//This function indexes the windows which start in the given node and run
+//over an edge into the following nodes.  Windows which start in an edge
+//overlap are left to the next node, as that is where they start too.  Each
+//minimizer is recorded in the node where its k-mer starts.  If there are
+//too many paths through the following nodes to index them all, the given
+//count of truncated junctions is increased.
+void SequenceIndex::addJunctionMinimizers(int node, std::vector<MinimizerEntry> * entries,
+                                          int * truncatedJunctionCount) const
+{
+    const QByteArray & sequence = m_sequences[node];
+    int length = sequence.length();
+    if (length == 0)
+        return;
+
+    int span = m_kmerSize + m_windowSize - 1;
+    int start = std::max(0, length - span + 1);
+    QByteArray nodeEnd = sequence.mid(start);
+
+    std::vector< QPair<quint64, int> > minimizers;
+    for (size_t i = 0; i < m_successors[node].size(); ++i)
+    {
+        int nextNode = m_successors[node][i].first;
+        int overlap = m_successors[node][i].second;
+        int lastWindow = length - overlap - 1 - start;
+        int extensionLength = span - 1 - overlap;
+        if (lastWindow < 0 || extensionLength <= 0)
+            continue;
+
+        std::vector<QByteArray> extensions;
+        std::vector< std::vector< QPair<int, int> > > extensionSegments;
+        bool truncated = false;
+        getExtensions(nextNode, overlap, extensionLength, QByteArray(), std::vector< QPair<int, int> >(),
+                      &extensions, &extensionSegments, &truncated);
+        if (truncated)
+            ++(*truncatedJunctionCount);
+
+        for (size_t j = 0; j < extensions.size(); ++j)
+        {
+            QByteArray junctionSequence = nodeEnd + extensions[j];
+            minimizers.clear();
+            getMinimizers(junctionSequence, m_kmerSize, m_windowSize, 0, lastWindow, &minimizers);
+            for (size_t k = 0; k < minimizers.size(); ++k)
+            {
+                MinimizerEntry entry = {minimizers[k].first, node, start + minimizers[k].second};
+                int extensionPosition = minimizers[k].second - nodeEnd.length();
+                for (size_t l = 0; extensionPosition >= 0 && l < extensionSegments[j].size(); ++l)
+                {
+                    if (extensionPosition >= extensionSegments[j][l].second)
+                    {
+                        entry.node = extensionSegments[j][l].first;
+                        entry.position = extensionPosition - extensionSegments[j][l].second;
+                    }
+                }
+                entries->push_back(entry);
+            }
+        }
+    }
+}
+
+
+//This function gives the sequences which can follow a node's end, up to the
+//given length, with the edge overlaps removed.  For each one, the segments
+//give the nodes it passes through, with the offset which converts a position
+//in the sequence to a position in the node.  If there are more paths than
+//can be indexed, the later ones are left out and truncated is set.
+void SequenceIndex::getExtensions(int node, int overlap, int length, QByteArray extension,
+                                  std::vector< QPair<int, int> > segments,
+                                  std::vector<QByteArray> * extensions,
+                                  std::vector< std::vector< QPair<int, int> > > * extensionSegments,
+                                  bool * truncated) const
+{
+    if (int(extensions->size()) >= MAX_JUNCTION_PATHS)
+    {
+        *truncated = true;
+        return;
+    }
+
+    const QByteArray & sequence = m_sequences[node];
+    int available = sequence.length() - overlap;
+    if (available <= 0)
+        return;
+
+    segments.push_back(QPair<int, int>(node, extension.length() - overlap));
+    if (available >= length || m_successors[node].empty())
+    {
+        extensions->push_back(extension + sequence.mid(overlap, std::min(available, length)));
+        extensionSegments->push_back(segments);
+        return;
+    }
+
+    extension += sequence.mid(overlap);
+    for (size_t i = 0; i < m_successors[node].size(); ++i)
+        getExtensions(m_successors[node][i].first, m_successors[node][i].second, length - available,
+                      extension, segments, extensions, extensionSegments, truncated);
+}
+
+
+
+//This function finds the places in the graph where the query occurs with no
+//more than the given number of mismatches.  The hits are sorted by start.
+std::vector<SequenceHit> SequenceIndex::findSequence(QByteArray query, int maxMismatches) const
+{
+    std::vector<SequenceHit> hits;
+    query = query.toUpper();
+    if (!m_built || query.length() < m_kmerSize)
+        return hits;
+
+    std::vector< QPair<quint64, int> > minimizers;
+    getQueryMinimizers(query, &minimizers);
+
+    QSet< QPair<int, int> > candidates;
+    for (size_t i = 0; i < minimizers.size(); ++i)
+    {
+        MinimizerEntry key = {minimizers[i].first, 0, 0};
+        std::vector<MinimizerEntry>::const_iterator first = std::lower_bound(m_entries.begin(), m_entries.end(),
+                                                                             key, entryHashIsBefore);
+        std::vector<MinimizerEntry>::const_iterator last = std::upper_bound(first, m_entries.end(),
+                                                                            key, entryHashIsBefore);
+        for (std::vector<MinimizerEntry>::const_iterator j = first; j != last; ++j)
+            addCandidateStarts(j->node, j->position - minimizers[i].second, query.length(), 0, &candidates);
+    }
+
+    std::vector<int> path;
+    QSetIterator< QPair<int, int> > i(candidates);
+    while (i.hasNext())
+    {
+        QPair<int, int> candidate = i.next();
+        matchForward(query, candidate.first, candidate.second, 0, 0, maxMismatches, &path,
+                     candidate.second, &hits);
+    }
+
+    std::sort(hits.begin(), hits.end(), hitIsBefore);
+    return hits;
+}
+
+
+//This function gives the k-mers which the query shares with the nodes, as
+//found from its minimizers.  Minimizers which occur more than the given
+//number of times in the graph (e.g. in repeats) are skipped, as they say
+//little about where the query is.
+std::vector<SequenceSeed> SequenceIndex::findSeeds(QByteArray query, int maxOccurrences) const
+{
+    std::vector<SequenceSeed> seeds;
+    query = query.toUpper();
+    if (!m_built || query.length() < m_kmerSize)
+        return seeds;
+
+    std::vector< QPair<quint64, int> > minimizers;
+    getQueryMinimizers(query, &minimizers);
+    findMinimizerSeeds(m_entries, minimizers, maxOccurrences, &seeds);
+    return seeds;
+}
+
+
+//A query shorter than a window is given a smaller window so it still has
+//minimizers, though these may not have been indexed.
+void SequenceIndex::getQueryMinimizers(const QByteArray & query, std::vector< QPair<quint64, int> > * minimizers) const
+{
+    int windowSize = std::min(m_windowSize, query.length() - m_kmerSize + 1);
+    getMinimizers(query, m_kmerSize, windowSize, 0, query.length() - (m_kmerSize + windowSize - 1), minimizers);
+}
+
+
+//This function finds many queries, in a thread pool if more than one thread
+//is to be used.  The results are in the same order as the queries.
+std::vector< std::vector<SequenceHit> > SequenceIndex::findSequences(const std::vector<QByteArray> & queries,
+                                                                     int maxMismatches, int threads) const
+{
+    std::vector< std::vector<SequenceHit> > results(queries.size());
+    int queryCount = int(queries.size());
+    int blockCount = std::max(1, std::min(queryCount, threads * 4));
+    QList< QSharedPointer<SequenceFindJob> > jobs;
+    for (int i = 0; i < blockCount; ++i)
+    {
+        int firstQuery = int((long long)(queryCount) * i / blockCount);
+        int lastQuery = int((long long)(queryCount) * (i + 1) / blockCount) - 1;
+        jobs.push_back(QSharedPointer<SequenceFindJob>(new SequenceFindJob(this, &queries, firstQuery, lastQuery,
+                                                                           maxMismatches, &results)));
+    }
+
+    runJobs(jobs, threads);
+
+    return results;
+}
+
+
+//This function turns a seed's implied query start into candidate starts.  A
+//start before the beginning of its node is moved back into the preceding
+//nodes.  A start in the overlap at the end of a node, for a query which runs
+//on past the node, also gives a start in each following node, as that is
+//where such a match is reported.
+void SequenceIndex::addCandidateStarts(int node, int position, int queryLength, int depth,
+                                       QSet< QPair<int, int> > * candidates) const
+{
+    if (depth > queryLength)
+        return;
+
+    int length = m_sequences[node].length();
+    if (position < 0)
+    {
+        for (size_t i = 0; i < m_predecessors[node].size(); ++i)
+        {
+            int previousNode = m_predecessors[node][i].first;
+            int previousLength = m_sequences[previousNode].length() - m_predecessors[node][i].second;
+            if (previousLength > 0)
+                addCandidateStarts(previousNode, previousLength + position, queryLength, depth + 1, candidates);
+        }
+        return;
+    }
+    if (position >= length)
+        return;
+
+    candidates->insert(QPair<int, int>(node, position));
+    if (position + queryLength <= length)
+        return;
+    for (size_t i = 0; i < m_successors[node].size(); ++i)
+    {
+        int overlap = m_successors[node][i].second;
+        if (position >= length - overlap)
+            addCandidateStarts(m_successors[node][i].first, position - length + overlap, queryLength, depth + 1, candidates);
+    }
+}
+
+
+//This function checks whether the rest of the query matches the graph from
+//the given position, following every edge out of a node the query runs past.
+void SequenceIndex::matchForward(const QByteArray & query, int node, int position, int queryOffset,
+                                 int mismatches, int maxMismatches, std::vector<int> * path,
+                                 int startPosition, std::vector<SequenceHit> * hits) const
+{
+    const QByteArray & sequence = m_sequences[node];
+    int length = sequence.length();
+    while (position < length && queryOffset < query.length())
+    {
+        if (sequence.at(position) != query.at(queryOffset))
+        {
+            ++mismatches;
+            if (mismatches > maxMismatches)
+                return;
+        }
+        ++position;
+        ++queryOffset;
+    }
+
+    path->push_back(node);
+    if (queryOffset == query.length())
+    {
+        SequenceHit hit;
+        for (size_t i = 0; i < path->size(); ++i)
+            hit.nodes.push_back(m_nodes[(*path)[i]]);
+        hit.startPosition = startPosition + 1;
+        hit.endPosition = position;
+        hit.mismatches = mismatches;
+        hits->push_back(hit);
+    }
+    else
+    {
+        for (size_t i = 0; i < m_successors[node].size(); ++i)
+        {
+            int nextNode = m_successors[node][i].first;
+            int overlap = m_successors[node][i].second;
+
+            //A match which starts in the overlap is reported from the next
+            //node, so it is only found once.
+            if (path->size() == 1 && startPosition >= length - overlap)
+                continue;
+            if (overlap >= m_sequences[nextNode].length())
+                continue;
+            matchForward(query, nextNode, overlap, queryOffset, mismatches, maxMismatches, path,
+                         startPosition, hits);
+        }
+    }
+    path->pop_back();
+}
+
+
+
+//This function finds the minimizers of the windows of the sequence which
+//start from firstWindow to lastWindow.  Each window is w consecutive k-mers,
+//and its minimizer is the k-mer with the smallest hash (the leftmost one if
+//there is a tie).  K-mers containing anything other than ACGT are skipped.
+//Neighbouring windows usually share a minimizer, so each is given once,
+//along with its position in the sequence.
+void SequenceIndex::getMinimizers(const QByteArray & sequence, int kmerSize, int windowSize,
+                                  int firstWindow, int lastWindow,
+                                  std::vector< QPair<quint64, int> > * minimizers)
+{
+    findMinimizers<2, getBaseCode>(sequence, kmerSize, windowSize, firstWindow, lastWindow, minimizers);
+}
+
+
+//This function does the same for a peptide sequence.  K-mers containing
+//anything other than the 20 standard amino acids (e.g. stops) are skipped.
+void SequenceIndex::getPeptideMinimizers(const QByteArray & peptide, int kmerSize, int windowSize,
+                                         int firstWindow, int lastWindow,
+                                         std::vector< QPair<quint64, int> > * minimizers)
+{
+    findMinimizers<5, getAminoAcidCode>(peptide, kmerSize, windowSize, firstWindow, lastWindow, minimizers);
+}
+
+
+//The minimizers are found the same way for any alphabet.  Each character is
+//given a code of the given number of bits (or -1 if it can't be in a k-mer),
+//so a k-mer must fit in 64 bits.
+template<int bitsPerCode, int (*getCode)(char)>
+void SequenceIndex::findMinimizers(const QByteArray & sequence, int kmerSize, int windowSize,
+                                   int firstWindow, int lastWindow,
+                                   std::vector< QPair<quint64, int> > * minimizers)
+{
+    if (kmerSize < 1 || windowSize < 1 || kmerSize * bitsPerCode > 64)
+        return;
+    firstWindow = std::max(firstWindow, 0);
+    lastWindow = std::min(lastWindow, sequence.length() - (kmerSize + windowSize - 1));
+    if (lastWindow < firstWindow)
+        return;
+
+    int kmerCount = lastWindow - firstWindow + windowSize;
+    std::vector<quint64> hashes(kmerCount);
+    std::vector<bool> valid(kmerCount);
+    quint64 mask = (kmerSize * bitsPerCode < 64) ? ((quint64(1) << (bitsPerCode * kmerSize)) - 1) : ~quint64(0);
+    quint64 kmer = 0;
+    int validLength = 0;
+    int end = firstWindow + kmerCount + kmerSize - 1;
+    for (int i = firstWindow; i < end; ++i)
+    {
+        int code = getCode(sequence.at(i));
+        if (code < 0)
+        {
+            kmer = 0;
+            validLength = 0;
+        }
+        else
+        {
+            kmer = ((kmer << bitsPerCode) | quint64(code)) & mask;
+            ++validLength;
+        }
+
+        int kmerIndex = i - kmerSize + 1 - firstWindow;
+        if (kmerIndex >= 0)
+        {
+            hashes[kmerIndex] = hashKmer(kmer, mask);
+            valid[kmerIndex] = (validLength >= kmerSize);
+        }
+    }
+
+    //The window's minimizer only needs to be searched for again when the
+    //last one has slid out of the window.
+    int windowCount = lastWindow - firstWindow + 1;
+    int minimum = -1;
+    int lastAdded = -1;
+    for (int i = 0; i < windowCount; ++i)
+    {
+        int windowEnd = i + windowSize - 1;
+        if (minimum < i)
+        {
+            minimum = -1;
+            for (int j = i; j <= windowEnd; ++j)
+            {
+                if (valid[j] && (minimum < 0 || hashes[j] < hashes[minimum]))
+                    minimum = j;
+            }
+        }
+        else if (valid[windowEnd] && hashes[windowEnd] < hashes[minimum])
+            minimum = windowEnd;
+
+        if (minimum >= 0 && minimum != lastAdded)
+        {
+            minimizers->push_back(QPair<quint64, int>(hashes[minimum], firstWindow + minimum));
+            lastAdded = minimum;
+        }
+    }
+}
+
+
+//This function sorts index entries by hash (then by place) and removes any
+//duplicates, which windows that share a minimizer give.
+void SequenceIndex::sortEntries(std::vector<MinimizerEntry> * entries)
+{
+    std::sort(entries->begin(), entries->end(), entryIsBefore);
+    entries->erase(std::unique(entries->begin(), entries->end(), entriesAreEqual), entries->end());
+}
+
+
+//This function looks up each of a query's minimizers in sorted index entries
+//and gives a seed for each place it occurs.  Minimizers which occur more than
+//the given number of times are skipped.
+void SequenceIndex::findMinimizerSeeds(const std::vector<MinimizerEntry> & entries,
+                                       const std::vector< QPair<quint64, int> > & minimizers,
+                                       int maxOccurrences, std::vector<SequenceSeed> * seeds)
+{
+    for (size_t i = 0; i < minimizers.size(); ++i)
+    {
+        MinimizerEntry key = {minimizers[i].first, 0, 0};
+        std::vector<MinimizerEntry>::const_iterator first = std::lower_bound(entries.begin(), entries.end(),
+                                                                             key, entryHashIsBefore);
+        std::vector<MinimizerEntry>::const_iterator last = std::upper_bound(first, entries.end(),
+                                                                            key, entryHashIsBefore);
+        if (last - first > maxOccurrences)
+            continue;
+        for (std::vector<MinimizerEntry>::const_iterator j = first; j != last; ++j)
+        {
+            SequenceSeed seed = {minimizers[i].second, j->node, j->position};
+            seeds->push_back(seed);
+        }
+    }
+}
+
+
+//This is an invertible integer hash, so k-mers are ordered randomly rather
+//than alphabetically (which would make poly-A k-mers the minimizers).
+quint64 SequenceIndex::hashKmer(quint64 kmer, quint64 mask)
+{
+    kmer = (~kmer + (kmer << 21)) & mask;
+    kmer = kmer ^ (kmer >> 24);
+    kmer = ((kmer + (kmer << 3)) + (kmer << 8)) & mask;
+    kmer = kmer ^ (kmer >> 14);
+    kmer = ((kmer + (kmer << 2)) + (kmer << 4)) & mask;
+    kmer = kmer ^ (kmer >> 28);
+    kmer = (kmer + (kmer << 31)) & mask;
+    return kmer;
+}
+
+
+int SequenceIndex::getBaseCode(char base)
+{
+    switch (base)
+    {
+    case 'A': case 'a': return 0;
+    case 'C': case 'c': return 1;
+    case 'G': case 'g': return 2;
+    case 'T': case 't': return 3;
+    default: return -1;
+    }
+}
+
+int SequenceIndex::getAminoAcidCode(char aminoAcid)
+{
+    switch (aminoAcid)
+    {
+    case 'A': case 'a': return 0;
+    case 'C': case 'c': return 1;
+    case 'D': case 'd': return 2;
+    case 'E': case 'e': return 3;
+    case 'F': case 'f': return 4;
+    case 'G': case 'g': return 5;
+    case 'H': case 'h': return 6;
+    case 'I': case 'i': return 7;
+    case 'K': case 'k': return 8;
+    case 'L': case 'l': return 9;
+    case 'M': case 'm': return 10;
+    case 'N': case 'n': return 11;
+    case 'P': case 'p': return 12;
+    case 'Q': case 'q': return 13;
+    case 'R': case 'r': return 14;
+    case 'S': case 's': return 15;
+    case 'T': case 't': return 16;
+    case 'V': case 'v': return 17;
+    case 'W': case 'w': return 18;
+    case 'Y': case 'y': return 19;
+    default: return -1;
+    }
+}
+
+
+bool SequenceIndex::entryIsBefore(const MinimizerEntry & a, const MinimizerEntry & b)
+{
+    if (a.hash != b.hash)
+        return a.hash < b.hash;
+    if (a.node != b.node)
+        return a.node < b.node;
+    return a.position < b.position;
+}
+
+bool SequenceIndex::entriesAreEqual(const MinimizerEntry & a, const MinimizerEntry & b)
+{
+    return a.hash == b.hash && a.node == b.node && a.position == b.position;
+}
+
+bool SequenceIndex::entryHashIsBefore(const MinimizerEntry & a, const MinimizerEntry & b)
+{
+    return a.hash < b.hash;
+}
+
+bool SequenceIndex::hitIsBefore(const SequenceHit & a, const SequenceHit & b)
+{
+    if (a.nodes[0] != b.nodes[0])
+        return a.nodes[0]->getName() < b.nodes[0]->getName();
+    if (a.startPosition != b.startPosition)
+        return a.startPosition < b.startPosition;
+    if (a.nodes.size() != b.nodes.size())
+        return a.nodes.size() < b.nodes.size();
+    for (size_t i = 1; i < a.nodes.size(); ++i)
+    {
+        if (a.nodes[i] != b.nodes[i])
+            return a.nodes[i]->getName() < b.nodes[i]->getName();
+    }
+    return false;
+}
+
+
+
+SequenceIndexBuildJob::SequenceIndexBuildJob(const SequenceIndex * index, int firstNode, int lastNode) :
+    m_index(index), m_firstNode(firstNode), m_lastNode(lastNode), m_truncatedJunctionCount(0)
+{
+}
+
+
+void SequenceIndexBuildJob::run()
+{
+    m_entries = m_index->getNodeMinimizers(m_firstNode, m_lastNode, &m_truncatedJunctionCount);
+}
+
+
+
+SequenceFindJob::SequenceFindJob(const SequenceIndex * index, const std::vector<QByteArray> * queries,
+                                 int firstQuery, int lastQuery, int maxMismatches,
+                                 std::vector< std::vector<SequenceHit> > * results) :
+    m_index(index), m_queries(queries), m_firstQuery(firstQuery), m_lastQuery(lastQuery),
+    m_maxMismatches(maxMismatches), m_results(results)
+{
+}
+
+
+void SequenceFindJob::run()
+{
+    for (int i = m_firstQuery; i <= m_lastQuery; ++i)
+        (*m_results)[i] = m_index->findSequence((*m_queries)[i], m_maxMismatches);
+}
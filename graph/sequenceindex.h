@@ -0,0 +1,203 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SEQUENCEINDEX_H
+#define SEQUENCEINDEX_H
+
+#include <vector>
+#include <QByteArray>
+#include <QString>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QPair>
+#include <QRunnable>
+
+class DeBruijnNode;
+
+//This is one place where a query sequence was found in the graph.  It starts
+//in the first node and ends in the last node, and the positions are 1-based,
+//like those of a GraphLocation.
+struct SequenceHit
+{
+    std::vector<DeBruijnNode *> nodes;
+    int startPosition;
+    int endPosition;
+    int mismatches;
+};
+
+//This is one indexed minimizer: its hash and where its k-mer starts.  The
+//k-mer may run off the end of its node and into the next one.
+struct MinimizerEntry
+{
+    quint64 hash;
+    int node;
+    int position;
+};
+
+//This is one k-mer shared by a query and a node, found by looking up one of
+//the query's minimizers.  Positions are the 0-based starts of the k-mer, and
+//the node is given by its index.
+struct SequenceSeed
+{
+    int queryPosition;
+    int node;
+    int nodePosition;
+};
+
+
+//This class is an in-memory minimizer index of the node sequences, used to
+//find which nodes contain a sequence without running BLAST.  For every window
+//of w consecutive k-mers in a node, the k-mer with the smallest hash (the
+//minimizer) is indexed.  Windows which run over an edge into the next nodes
+//are indexed too, with the edge overlap removed, so sequences which span
+//nodes can be found.  Both strands are indexed, so queries are only looked
+//up as given.
+//To find a query, its own minimizers are looked up to give candidate start
+//positions, and each candidate is checked by walking the query through the
+//graph, allowing up to a given number of mismatches (no indels).  A query of
+//at least k + w - 1 bases is found if it occurs exactly, and a near-exact
+//match is found if any one of its windows has no mismatches.  The exception
+//is in tangled regions: only so many paths are indexed past the end of any
+//one node, so an occurrence which runs over a truncated junction may be
+//missed.  The number of such junctions is kept so this can be reported.
+//The index is built in parallel, one block of nodes per thread, and must be
+//cleared whenever the graph's nodes or edges change.
+class SequenceIndex
+{
+public:
+    //CREATORS
+    SequenceIndex();
+
+    //ACCESSORS
+    bool isBuilt() const {return m_built;}
+    int getKmerSize() const {return m_kmerSize;}
+    int getWindowSize() const {return m_windowSize;}
+    long long getMinimizerCount() const {return (long long)(m_entries.size());}
+    int getTruncatedJunctionCount() const {return m_truncatedJunctionCount;}
+    int getNodeCount() const {return int(m_nodes.size());}
+    DeBruijnNode * getNode(int node) const {return m_nodes[node];}
+    const QByteArray & getNodeSequence(int node) const {return m_sequences[node];}
+    const std::vector< QPair<int, int> > & getSuccessors(int node) const {return m_successors[node];}
+    std::vector<SequenceHit> findSequence(QByteArray query, int maxMismatches) const;
+    std::vector< std::vector<SequenceHit> > findSequences(const std::vector<QByteArray> & queries,
+                                                          int maxMismatches, int threads) const;
+    std::vector<MinimizerEntry> getNodeMinimizers(int firstNode, int lastNode, int * truncatedJunctionCount) const;
+    std::vector<SequenceSeed> findSeeds(QByteArray query, int maxOccurrences) const;
+
+    //MODIFERS
+    void build(const QMap<QString, DeBruijnNode *> & nodes, int kmerSize, int windowSize, int threads);
+    void clear();
+
+    //STATIC
+    static void getMinimizers(const QByteArray & sequence, int kmerSize, int windowSize,
+                              int firstWindow, int lastWindow,
+                              std::vector< QPair<quint64, int> > * minimizers);
+    static void getPeptideMinimizers(const QByteArray & peptide, int kmerSize, int windowSize,
+                                     int firstWindow, int lastWindow,
+                                     std::vector< QPair<quint64, int> > * minimizers);
+    static void sortEntries(std::vector<MinimizerEntry> * entries);
+    static void findMinimizerSeeds(const std::vector<MinimizerEntry> & entries,
+                                   const std::vector< QPair<quint64, int> > & minimizers,
+                                   int maxOccurrences, std::vector<SequenceSeed> * seeds);
+
+private:
+    bool m_built;
+    int m_kmerSize;
+    int m_windowSize;
+    int m_truncatedJunctionCount;
+    std::vector<DeBruijnNode *> m_nodes;
+    std::vector<QByteArray> m_sequences;
+    std::vector< std::vector< QPair<int, int> > > m_successors;
+    std::vector< std::vector< QPair<int, int> > > m_predecessors;
+    std::vector<MinimizerEntry> m_entries;
+
+    void getQueryMinimizers(const QByteArray & query, std::vector< QPair<quint64, int> > * minimizers) const;
+    void addJunctionMinimizers(int node, std::vector<MinimizerEntry> * entries, int * truncatedJunctionCount) const;
+    void getExtensions(int node, int overlap, int length, QByteArray extension,
+                       std::vector< QPair<int, int> > segments,
+                       std::vector<QByteArray> * extensions,
+                       std::vector< std::vector< QPair<int, int> > > * extensionSegments,
+                       bool * truncated) const;
+    void addCandidateStarts(int node, int position, int queryLength, int depth,
+                            QSet< QPair<int, int> > * candidates) const;
+    void matchForward(const QByteArray & query, int node, int position, int queryOffset,
+                      int mismatches, int maxMismatches, std::vector<int> * path,
+                      int startPosition, std::vector<SequenceHit> * hits) const;
+
+    template<int bitsPerCode, int (*getCode)(char)>
+    static void findMinimizers(const QByteArray & sequence, int kmerSize, int windowSize,
+                               int firstWindow, int lastWindow,
+                               std::vector< QPair<quint64, int> > * minimizers);
+    static quint64 hashKmer(quint64 kmer, quint64 mask);
+    static int getBaseCode(char base);
+    static int getAminoAcidCode(char aminoAcid);
+    static bool entryIsBefore(const MinimizerEntry & a, const MinimizerEntry & b);
+    static bool entriesAreEqual(const MinimizerEntry & a, const MinimizerEntry & b);
+    static bool entryHashIsBefore(const MinimizerEntry & a, const MinimizerEntry & b);
+    static bool hitIsBefore(const SequenceHit & a, const SequenceHit & b);
+};
+
+
+//This class finds the minimizers of one block of nodes, so the blocks can be
+//spread over a thread pool.
+class SequenceIndexBuildJob : public QRunnable
+{
+public:
+    //CREATORS
+    SequenceIndexBuildJob(const SequenceIndex * index, int firstNode, int lastNode);
+
+    //ACCESSORS
+    const std::vector<MinimizerEntry> * getEntries() const {return &m_entries;}
+    int getTruncatedJunctionCount() const {return m_truncatedJunctionCount;}
+
+    //MODIFERS
+    void run();
+
+private:
+    const SequenceIndex * m_index;
+    int m_firstNode;
+    int m_lastNode;
+    std::vector<MinimizerEntry> m_entries;
+    int m_truncatedJunctionCount;
+};
+
+
+//This class finds one block of queries, so the blocks can be spread over a
+//thread pool.  Each query's hits go in its own place in the results.
+class SequenceFindJob : public QRunnable
+{
+public:
+    //CREATORS
+    SequenceFindJob(const SequenceIndex * index, const std::vector<QByteArray> * queries,
+                    int firstQuery, int lastQuery, int maxMismatches,
+                    std::vector< std::vector<SequenceHit> > * results);
+
+    //MODIFERS
+    void run();
+
+private:
+    const SequenceIndex * m_index;
+    const std::vector<QByteArray> * m_queries;
+    int m_firstQuery;
+    int m_lastQuery;
+    int m_maxMismatches;
+    std::vector< std::vector<SequenceHit> > * m_results;
+};
+
+#endif // SEQUENCEINDEX_H
@@ -0,0 +1,271 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "shortestpathfinder.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include <queue>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+ShortestPathFinder::ShortestPathFinder(DeBruijnNode * startNode, DeBruijnNode * endNode) :
+    m_startNode(startNode), m_endNode(endNode)
+{
+}
+
+
+//This function returns the shortest path from the start node to the end node,
+//or an empty path if the end node can't be reached.
+Path ShortestPathFinder::getShortestPath() const
+{
+    QList<Path> paths = getShortestPaths(1);
+    if (paths.isEmpty())
+        return Path();
+    return paths.front();
+}
+
+
+//This function returns up to the given number of paths from the start node to
+//the end node, shortest first, using Yen's algorithm.  Each path after the
+//first is found by taking a prefix (the root) of a path already found and
+//searching for a new way to the end node from the root's last node (the spur
+//node), with the next steps of the found paths sharing that root banned.
+QList<Path> ShortestPathFinder::getShortestPaths(int pathCount) const
+{
+    QList<Path> paths;
+    if (pathCount < 1 || m_startNode == 0 || m_endNode == 0)
+        return paths;
+
+    if (m_startNode == m_endNode)
+    {
+        QList<DeBruijnNode *> nodes;
+        nodes.push_back(m_startNode);
+        paths.push_back(Path::makeFromOrderedNodes(nodes, false));
+        return paths;
+    }
+
+    CandidatePath firstPath;
+    if (!findPathToEnd(m_startNode, QSet<DeBruijnNode *>(), QSet<DeBruijnEdge *>(), &firstPath))
+        return paths;
+
+    QList<CandidatePath> foundPaths;
+    QList<CandidatePath> candidatePaths;
+    foundPaths.push_back(firstPath);
+
+    while (foundPaths.size() < pathCount)
+    {
+        const CandidatePath & previousPath = foundPaths.back();
+        long long rootLength = 0;
+
+        for (int i = 0; i < previousPath.nodes.size() - 1; ++i)
+        {
+            DeBruijnNode * spurNode = previousPath.nodes[i];
+            QList<DeBruijnNode *> rootNodes = previousPath.nodes.mid(0, i + 1);
+
+            QSet<DeBruijnEdge *> bannedEdges;
+            for (int j = 0; j < foundPaths.size(); ++j)
+            {
+                const QList<DeBruijnNode *> & foundNodes = foundPaths[j].nodes;
+                if (foundNodes.size() > i + 1 && foundNodes.mid(0, i + 1) == rootNodes)
+                    bannedEdges.insert(getEdgeBetween(foundNodes[i], foundNodes[i + 1]));
+            }
+
+            QSet<DeBruijnNode *> bannedNodes;
+            for (int j = 0; j < i; ++j)
+                bannedNodes.insert(rootNodes[j]);
+
+            CandidatePath spurPath;
+            if (findPathToEnd(spurNode, bannedNodes, bannedEdges, &spurPath))
+            {
+                CandidatePath candidate;
+                candidate.nodes = rootNodes.mid(0, i) + spurPath.nodes;
+                candidate.addedLength = rootLength + spurPath.addedLength;
+
+                bool alreadyFound = false;
+                for (int j = 0; j < candidatePaths.size() && !alreadyFound; ++j)
+                    alreadyFound = (candidatePaths[j].nodes == candidate.nodes);
+                if (!alreadyFound)
+                    candidatePaths.push_back(candidate);
+            }
+
+            rootLength += getRankingLength(getEdgeBetween(previousPath.nodes[i], previousPath.nodes[i + 1]));
+        }
+
+        if (candidatePaths.isEmpty())
+            break;
+
+        //The shortest candidate becomes the next path.  Ties go to the
+        //candidate found first, so the results are deterministic.
+        int shortestIndex = 0;
+        for (int i = 1; i < candidatePaths.size(); ++i)
+        {
+            if (candidatePaths[i].addedLength < candidatePaths[shortestIndex].addedLength)
+                shortestIndex = i;
+        }
+        foundPaths.push_back(candidatePaths.takeAt(shortestIndex));
+    }
+
+    for (int i = 0; i < foundPaths.size(); ++i)
+        paths.push_back(Path::makeFromOrderedNodes(foundPaths[i].nodes, false));
+    return paths;
+}
+
+
+//This function does a Dijkstra search from the given node to the end node,
+//avoiding the banned nodes and edges.  Nodes waiting in the queue are ordered
+//by length and then by when they were added, so ties are broken the same way
+//every time.
+bool ShortestPathFinder::findPathToEnd(DeBruijnNode * fromNode,
+                                       const QSet<DeBruijnNode *> & bannedNodes,
+                                       const QSet<DeBruijnEdge *> & bannedEdges,
+                                       CandidatePath * path) const
+{
+    typedef std::pair<std::pair<long long, int>, DeBruijnNode *> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+    QHash<DeBruijnNode *, long long> tentativeLengths;
+    QHash<DeBruijnNode *, DeBruijnEdge *> previousEdges;
+    QSet<DeBruijnNode *> finishedNodes;
+    int order = 0;
+
+    tentativeLengths.insert(fromNode, 0);
+    queue.push(QueueEntry(std::make_pair(0LL, order++), fromNode));
+
+    while (!queue.empty())
+    {
+        long long length = queue.top().first.first;
+        DeBruijnNode * node = queue.top().second;
+        queue.pop();
+
+        if (finishedNodes.contains(node))
+            continue;
+        finishedNodes.insert(node);
+
+        if (node == m_endNode)
+        {
+            path->nodes.clear();
+            path->addedLength = length;
+            for (DeBruijnNode * pathNode = node; pathNode != fromNode;
+                 pathNode = previousEdges[pathNode]->getStartingNode())
+                path->nodes.push_front(pathNode);
+            path->nodes.push_front(fromNode);
+            return true;
+        }
+
+        const std::vector<DeBruijnEdge *> * edges = node->getEdgesPointer();
+        for (size_t i = 0; i < edges->size(); ++i)
+        {
+            DeBruijnEdge * edge = (*edges)[i];
+            if (edge->getStartingNode() != node || bannedEdges.contains(edge))
+                continue;
+
+            DeBruijnNode * nextNode = edge->getEndingNode();
+            if (nextNode == fromNode || finishedNodes.contains(nextNode) || bannedNodes.contains(nextNode))
+                continue;
+
+            long long newLength = length + getRankingLength(edge);
+            if (!tentativeLengths.contains(nextNode) || newLength < tentativeLengths[nextNode])
+            {
+                tentativeLengths[nextNode] = newLength;
+                previousEdges[nextNode] = edge;
+                queue.push(QueueEntry(std::make_pair(newLength, order++), nextNode));
+            }
+        }
+    }
+
+    return false;
+}
+
+
+//This function does a backward Dijkstra search from the end node to find the
+//minimum length that must be added to reach the end node from each node.  If
+//allowedNodes is given, the search is limited to those nodes.  The search
+//stops once the added length goes over the maximum.  The added lengths are
+//only minimums if no edge has an overlap larger than its ending node, so
+//callers must check that themselves.
+QHash<DeBruijnNode *, long long> ShortestPathFinder::getAddedLengthsToNode(DeBruijnNode * endNode,
+                                                                           long long maxAddedLength,
+                                                                           const QHash<DeBruijnNode *, int> * allowedNodes)
+{
+    QHash<DeBruijnNode *, long long> addedLengths;
+
+    typedef std::pair<long long, DeBruijnNode *> LengthAndNode;
+    std::priority_queue<LengthAndNode, std::vector<LengthAndNode>, std::greater<LengthAndNode> > queue;
+    QHash<DeBruijnNode *, long long> tentativeLengths;
+
+    tentativeLengths.insert(endNode, 0);
+    queue.push(LengthAndNode(0, endNode));
+
+    while (!queue.empty())
+    {
+        long long length = queue.top().first;
+        DeBruijnNode * node = queue.top().second;
+        queue.pop();
+
+        if (length > maxAddedLength)
+            break;
+        if (addedLengths.contains(node))
+            continue;
+        addedLengths.insert(node, length);
+
+        std::vector<DeBruijnEdge *> enteringEdges = node->getEnteringEdges();
+        for (size_t i = 0; i < enteringEdges.size(); ++i)
+        {
+            DeBruijnEdge * edge = enteringEdges[i];
+            DeBruijnNode * previousNode = edge->getStartingNode();
+            if (allowedNodes != 0 && !allowedNodes->contains(previousNode))
+                continue;
+            if (addedLengths.contains(previousNode))
+                continue;
+
+            long long newLength = length + getAddedLength(edge);
+            if (!tentativeLengths.contains(previousNode) || newLength < tentativeLengths[previousNode])
+            {
+                tentativeLengths[previousNode] = newLength;
+                queue.push(LengthAndNode(newLength, previousNode));
+            }
+        }
+    }
+
+    return addedLengths;
+}
+
+
+long long ShortestPathFinder::getAddedLength(DeBruijnEdge * edge)
+{
+    return edge->getEndingNode()->getLength() - edge->getOverlap();
+}
+
+
+long long ShortestPathFinder::getRankingLength(DeBruijnEdge * edge)
+{
+    return std::max(0LL, getAddedLength(edge));
+}
+
+
+DeBruijnEdge * ShortestPathFinder::getEdgeBetween(DeBruijnNode * startingNode, DeBruijnNode * endingNode)
+{
+    const std::vector<DeBruijnEdge *> * edges = startingNode->getEdgesPointer();
+    for (size_t i = 0; i < edges->size(); ++i)
+    {
+        DeBruijnEdge * edge = (*edges)[i];
+        if (edge->getStartingNode() == startingNode && edge->getEndingNode() == endingNode)
+            return edge;
+    }
+    return 0;
+}
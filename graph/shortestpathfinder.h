@@ -0,0 +1,73 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SHORTESTPATHFINDER_H
+#define SHORTESTPATHFINDER_H
+
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include "path.h"
+
+class DeBruijnNode;
+class DeBruijnEdge;
+
+//This class finds the shortest paths between two nodes, where the length
+//added by each step is the length of the next node minus the overlap of the
+//edge to it.  The shortest path comes from a Dijkstra search that stops as
+//soon as the end node is reached, so the work depends on the size of the
+//neighbourhood between the nodes, not the size of the graph.  Further paths
+//(in order of length, without repeated nodes) come from Yen's algorithm.
+//An overlap larger than its node would make a step shorten the path, which
+//Dijkstra's algorithm can't handle, so such steps are counted as adding no
+//length when ranking paths.
+class ShortestPathFinder
+{
+public:
+    //CREATORS
+    ShortestPathFinder(DeBruijnNode * startNode, DeBruijnNode * endNode);
+
+    //ACCESSORS
+    Path getShortestPath() const;
+    QList<Path> getShortestPaths(int pathCount) const;
+
+    //STATIC
+    static QHash<DeBruijnNode *, long long> getAddedLengthsToNode(DeBruijnNode * endNode,
+                                                                  long long maxAddedLength,
+                                                                  const QHash<DeBruijnNode *, int> * allowedNodes);
+    static long long getAddedLength(DeBruijnEdge * edge);
+
+private:
+    struct CandidatePath
+    {
+        QList<DeBruijnNode *> nodes;
+        long long addedLength;
+    };
+
+    DeBruijnNode * m_startNode;
+    DeBruijnNode * m_endNode;
+
+    bool findPathToEnd(DeBruijnNode * fromNode,
+                       const QSet<DeBruijnNode *> & bannedNodes,
+                       const QSet<DeBruijnEdge *> & bannedEdges,
+                       CandidatePath * path) const;
+    static DeBruijnEdge * getEdgeBetween(DeBruijnNode * startingNode, DeBruijnNode * endingNode);
+    static long long getRankingLength(DeBruijnEdge * edge);
+};
+
+#endif // SHORTESTPATHFINDER_H
@@ -0,0 +1,267 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "superbubblefinder.h"
+#include "debruijnnode.h"
+#include "debruijnedge.h"
+#include "shortestpathfinder.h"
+#include "../program/runjobs.h"
+#include <QSet>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QSharedPointer>
+#include <algorithm>
+
+SuperbubbleFinder::SuperbubbleFinder(int maxBubbleNodes) :
+    m_maxBubbleNodes(maxBubbleNodes)
+{
+}
+
+
+//This function finds all superbubbles in the graph.  The connected components
+//are independent of each other, so if more than one thread is to be used,
+//they are searched in a thread pool.  The results are sorted by entrance and
+//exit so they are the same regardless of the number of threads.  The number
+//of searches which stopped at the maximum bubble size is also given, as any
+//bubbles larger than that are missing from the results.
+std::vector<Superbubble> SuperbubbleFinder::findSuperbubbles(const QMap<QString, DeBruijnNode*> * nodes,
+                                                             int threads, int * truncatedSearchCount) const
+{
+    std::vector< std::vector<DeBruijnNode *> > components = getConnectedComponents(nodes);
+
+    QList< QSharedPointer<SuperbubbleComponentSearch> > searches;
+    for (size_t i = 0; i < components.size(); ++i)
+        searches.push_back(QSharedPointer<SuperbubbleComponentSearch>(new SuperbubbleComponentSearch(this, &components[i])));
+
+    runJobs(searches, threads);
+
+    std::vector<Superbubble> superbubbles;
+    *truncatedSearchCount = 0;
+    for (int i = 0; i < searches.size(); ++i)
+    {
+        *truncatedSearchCount += searches[i]->getTruncatedSearchCount();
+        std::vector<Superbubble> componentSuperbubbles = searches[i]->getSuperbubbles();
+        superbubbles.insert(superbubbles.end(), componentSuperbubbles.begin(), componentSuperbubbles.end());
+    }
+    std::sort(superbubbles.begin(), superbubbles.end(), superbubbleIsBefore);
+
+    return superbubbles;
+}
+
+
+std::vector<Superbubble> SuperbubbleFinder::findSuperbubblesInComponent(const std::vector<DeBruijnNode *> * component,
+                                                                        int * truncatedSearchCount) const
+{
+    std::vector<Superbubble> superbubbles;
+    for (size_t i = 0; i < component->size(); ++i)
+    {
+        Superbubble superbubble;
+        bool truncated = false;
+        if (findSuperbubbleFromEntrance((*component)[i], &superbubble, &truncated) &&
+                isPreferredStrand(&superbubble))
+            superbubbles.push_back(superbubble);
+        if (truncated)
+            ++(*truncatedSearchCount);
+    }
+    return superbubbles;
+}
+
+
+//This function checks whether the given node is the entrance of a
+//superbubble and, if so, fills in the details of the smallest one.  Nodes
+//are visited in topological order: a node is only visited once all of its
+//upstream nodes have been.  The search fails if it finds a dead end, a cycle
+//or more nodes than the maximum bubble size (in which case truncated is
+//set).  It succeeds when the only node left to visit is also the only node
+//which has been reached but not visited, as every path from the entrance
+//must then pass through it.
+bool SuperbubbleFinder::findSuperbubbleFromEntrance(DeBruijnNode * entrance, Superbubble * superbubble,
+                                                    bool * truncated) const
+{
+    //Entrances with a single downstream node only give trivial superbubbles
+    //without any branching, so they aren't reported.
+    if (entrance->getDownstreamNodes().size() < 2)
+        return false;
+
+    QSet<DeBruijnNode *> visited;
+    QSet<DeBruijnNode *> reached;
+    std::vector<DeBruijnNode *> visitOrder;
+    std::vector<DeBruijnNode *> toVisit;
+    toVisit.push_back(entrance);
+    reached.insert(entrance);
+
+    while (!toVisit.empty())
+    {
+        DeBruijnNode * node = toVisit.back();
+        toVisit.pop_back();
+        visited.insert(node);
+        reached.remove(node);
+        visitOrder.push_back(node);
+        if (int(visitOrder.size()) > m_maxBubbleNodes)
+        {
+            *truncated = true;
+            return false;
+        }
+
+        std::vector<DeBruijnNode *> downstreamNodes = node->getDownstreamNodes();
+        if (downstreamNodes.size() == 0)
+            return false;
+
+        for (size_t i = 0; i < downstreamNodes.size(); ++i)
+        {
+            DeBruijnNode * downstreamNode = downstreamNodes[i];
+            if (downstreamNode == entrance || visited.contains(downstreamNode))
+                return false;
+            reached.insert(downstreamNode);
+
+            std::vector<DeBruijnNode *> upstreamNodes = downstreamNode->getUpstreamNodes();
+            bool allUpstreamVisited = true;
+            for (size_t j = 0; allUpstreamVisited && j < upstreamNodes.size(); ++j)
+                allUpstreamVisited = visited.contains(upstreamNodes[j]);
+            if (allUpstreamVisited)
+                toVisit.push_back(downstreamNode);
+        }
+
+        if (toVisit.size() == 1 && reached.size() == 1)
+        {
+            DeBruijnNode * exit = toVisit.back();
+            std::vector<DeBruijnNode *> exitDownstreamNodes = exit->getDownstreamNodes();
+            if (std::find(exitDownstreamNodes.begin(), exitDownstreamNodes.end(), entrance) != exitDownstreamNodes.end())
+                return false;
+
+            superbubble->entrance = entrance;
+            superbubble->exit = exit;
+            superbubble->internalNodes.assign(visitOrder.begin() + 1, visitOrder.end());
+
+            //Since the nodes were visited in topological order, the shortest
+            //and longest path lengths can be found in one pass over them.
+            QHash<DeBruijnNode *, long long> shortest;
+            QHash<DeBruijnNode *, long long> longest;
+            shortest[entrance] = entrance->getLength();
+            longest[entrance] = entrance->getLength();
+            for (size_t i = 0; i < visitOrder.size(); ++i)
+            {
+                DeBruijnNode * pathNode = visitOrder[i];
+                std::vector<DeBruijnEdge *> leavingEdges = pathNode->getLeavingEdges();
+                for (size_t j = 0; j < leavingEdges.size(); ++j)
+                {
+                    DeBruijnNode * nextNode = leavingEdges[j]->getEndingNode();
+                    long long addedLength = ShortestPathFinder::getAddedLength(leavingEdges[j]);
+                    long long shortestLength = shortest[pathNode] + addedLength;
+                    long long longestLength = longest[pathNode] + addedLength;
+                    if (!shortest.contains(nextNode) || shortestLength < shortest[nextNode])
+                        shortest[nextNode] = shortestLength;
+                    if (!longest.contains(nextNode) || longestLength > longest[nextNode])
+                        longest[nextNode] = longestLength;
+                }
+            }
+            superbubble->shortestPathLength = shortest[exit];
+            superbubble->longestPathLength = longest[exit];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+//This function groups all nodes (both strands) into weakly connected
+//components, in the order the components are first found in the node map.
+std::vector< std::vector<DeBruijnNode *> > SuperbubbleFinder::getConnectedComponents(const QMap<QString, DeBruijnNode*> * nodes)
+{
+    std::vector< std::vector<DeBruijnNode *> > components;
+    QSet<DeBruijnNode *> visitedNodes;
+
+    QMapIterator<QString, DeBruijnNode*> i(*nodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        if (visitedNodes.contains(node))
+            continue;
+
+        std::vector<DeBruijnNode *> component;
+        QQueue<DeBruijnNode *> q;
+        q.enqueue(node);
+        visitedNodes.insert(node);
+
+        while (!q.isEmpty())
+        {
+            DeBruijnNode * w = q.dequeue();
+            component.push_back(w);
+
+            std::vector<DeBruijnNode *> connectedNodes = w->getDownstreamNodes();
+            std::vector<DeBruijnNode *> upstreamNodes = w->getUpstreamNodes();
+            connectedNodes.insert(connectedNodes.end(), upstreamNodes.begin(), upstreamNodes.end());
+            for (size_t j = 0; j < connectedNodes.size(); ++j)
+            {
+                DeBruijnNode * k = connectedNodes[j];
+                if (!visitedNodes.contains(k))
+                {
+                    visitedNodes.insert(k);
+                    q.enqueue(k);
+                }
+            }
+        }
+
+        components.push_back(component);
+    }
+
+    return components;
+}
+
+
+//Each superbubble has a reverse complement twin on the other strand, going
+//from the reverse complement of the exit to the reverse complement of the
+//entrance.  Of the two, the one with the lower entrance (then exit) name is
+//reported.  A superbubble which is its own reverse complement is kept.
+bool SuperbubbleFinder::isPreferredStrand(const Superbubble * superbubble)
+{
+    QString entranceName = superbubble->entrance->getName();
+    QString exitName = superbubble->exit->getName();
+    QString rcEntranceName = superbubble->exit->getReverseComplement()->getName();
+    QString rcExitName = superbubble->entrance->getReverseComplement()->getName();
+
+    if (entranceName != rcEntranceName)
+        return entranceName < rcEntranceName;
+    return exitName <= rcExitName;
+}
+
+
+bool SuperbubbleFinder::superbubbleIsBefore(const Superbubble & a, const Superbubble & b)
+{
+    if (a.entrance->getName() != b.entrance->getName())
+        return a.entrance->getName() < b.entrance->getName();
+    return a.exit->getName() < b.exit->getName();
+}
+
+
+
+
+SuperbubbleComponentSearch::SuperbubbleComponentSearch(const SuperbubbleFinder * finder,
+                                                       const std::vector<DeBruijnNode *> * component) :
+    m_finder(finder), m_component(component), m_truncatedSearchCount(0)
+{
+}
+
+
+void SuperbubbleComponentSearch::run()
+{
+    m_superbubbles = m_finder->findSuperbubblesInComponent(m_component, &m_truncatedSearchCount);
+}
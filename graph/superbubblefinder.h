@@ -0,0 +1,101 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef SUPERBUBBLEFINDER_H
+#define SUPERBUBBLEFINDER_H
+
+#include <vector>
+#include <QMap>
+#include <QString>
+#include <QRunnable>
+
+class DeBruijnNode;
+
+//A superbubble is a part of the graph that is entered through a single node
+//and left through a single node, with no cycles and no dead ends inside.
+//Simple bubbles (e.g. a heterozygous SNP with two branches) are the most
+//common case.  The path lengths include the entrance and exit nodes.
+struct Superbubble
+{
+    DeBruijnNode * entrance;
+    DeBruijnNode * exit;
+    std::vector<DeBruijnNode *> internalNodes;
+    long long shortestPathLength;
+    long long longestPathLength;
+};
+
+
+//This class finds the superbubbles in the graph.  Each node is tried as an
+//entrance with the superbubble check of Onodera et al. (2013), which walks
+//forward from the entrance in topological order until the region closes at a
+//single exit.  Each walk stops once it has taken in more than the maximum
+//bubble size, so the total work is O(n * maxBubbleNodes) for n nodes: linear
+//in the size of the graph only for a fixed maximum bubble size.  Bubbles
+//larger than the maximum are not found, so the searches which stop there are
+//counted for the caller to report.
+//The +/- strand nodes form one directed graph, so each superbubble is found
+//on both strands and only one of the pair is reported.
+class SuperbubbleFinder
+{
+public:
+    //CREATORS
+    SuperbubbleFinder(int maxBubbleNodes);
+
+    //ACCESSORS
+    std::vector<Superbubble> findSuperbubbles(const QMap<QString, DeBruijnNode*> * nodes,
+                                              int threads, int * truncatedSearchCount) const;
+    std::vector<Superbubble> findSuperbubblesInComponent(const std::vector<DeBruijnNode *> * component,
+                                                         int * truncatedSearchCount) const;
+    bool findSuperbubbleFromEntrance(DeBruijnNode * entrance, Superbubble * superbubble,
+                                     bool * truncated) const;
+
+    //STATIC
+    static std::vector< std::vector<DeBruijnNode *> > getConnectedComponents(const QMap<QString, DeBruijnNode*> * nodes);
+
+private:
+    int m_maxBubbleNodes;
+
+    static bool isPreferredStrand(const Superbubble * superbubble);
+    static bool superbubbleIsBefore(const Superbubble & a, const Superbubble & b);
+};
+
+
+//This class finds the superbubbles in one connected component, so the
+//components can be spread over a thread pool.
+class SuperbubbleComponentSearch : public QRunnable
+{
+public:
+    //CREATORS
+    SuperbubbleComponentSearch(const SuperbubbleFinder * finder,
+                               const std::vector<DeBruijnNode *> * component);
+
+    //ACCESSORS
+    std::vector<Superbubble> getSuperbubbles() const {return m_superbubbles;}
+    int getTruncatedSearchCount() const {return m_truncatedSearchCount;}
+
+    //MODIFERS
+    void run();
+
+private:
+    const SuperbubbleFinder * m_finder;
+    const std::vector<DeBruijnNode *> * m_component;
+    std::vector<Superbubble> m_superbubbles;
+    int m_truncatedSearchCount;
+};
+
+#endif // SUPERBUBBLEFINDER_H
@@ -0,0 +1,252 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "translatedindex.h"
+#include "../program/runjobs.h"
+#include <QList>
+#include <QSharedPointer>
+#include <algorithm>
+
+//Peptide k-mers are much more specific than nucleotide ones, so they can be
+//shorter, and the windows are kept small so diverged proteins still share
+//some minimizers.
+static const int PEPTIDE_KMER_SIZE = 5;
+static const int PEPTIDE_WINDOW_SIZE = 3;
+
+//This is the standard genetic code, for codons in TCAG order.
+static const char GENETIC_CODE[] = "FFLLSSSSYY**CC*WLLLLPPPPHHQQRRRRIIIMTTTTNNKKSSRRVVVVAAAADDEEGGGG";
+
+TranslatedIndex::TranslatedIndex() :
+    m_built(false), m_sequenceIndex(0)
+{
+}
+
+
+int TranslatedIndex::getKmerSize() const
+{
+    return PEPTIDE_KMER_SIZE;
+}
+
+int TranslatedIndex::getWindowSize() const
+{
+    return PEPTIDE_WINDOW_SIZE;
+}
+
+
+//This function builds the index from a built sequence index.  The nodes are
+//translated and their minimizers found in blocks, in a thread pool if more
+//than one thread is to be used, and the minimizers are then sorted by hash.
+void TranslatedIndex::build(const SequenceIndex * sequenceIndex, int threads)
+{
+    clear();
+    m_sequenceIndex = sequenceIndex;
+    int nodeCount = sequenceIndex->getNodeCount();
+    m_peptides.resize(size_t(nodeCount) * 3);
+
+    int blockCount = std::max(1, std::min(nodeCount, threads * 4));
+    QList< QSharedPointer<TranslatedIndexBuildJob> > jobs;
+    for (int i = 0; i < blockCount; ++i)
+    {
+        int firstNode = int((long long)(nodeCount) * i / blockCount);
+        int lastNode = int((long long)(nodeCount) * (i + 1) / blockCount) - 1;
+        jobs.push_back(QSharedPointer<TranslatedIndexBuildJob>(new TranslatedIndexBuildJob(this, firstNode, lastNode)));
+    }
+
+    runJobs(jobs, threads);
+
+    size_t entryCount = 0;
+    for (int i = 0; i < jobs.size(); ++i)
+        entryCount += jobs[i]->getEntries()->size();
+    m_entries.reserve(entryCount);
+    for (int i = 0; i < jobs.size(); ++i)
+        m_entries.insert(m_entries.end(), jobs[i]->getEntries()->begin(), jobs[i]->getEntries()->end());
+    jobs.clear();
+
+    SequenceIndex::sortEntries(&m_entries);
+
+    m_built = true;
+}
+
+
+void TranslatedIndex::clear()
+{
+    m_built = false;
+    m_sequenceIndex = 0;
+    std::vector<QByteArray>().swap(m_peptides);
+    std::vector<MinimizerEntry>().swap(m_entries);
+}
+
+
+
+//This function translates each of the given nodes in its three frames and
+//finds the minimizers of the windows inside them and of the windows which
+//run off their ends.
+std::vector<MinimizerEntry> TranslatedIndex::translateNodes(int firstNode, int lastNode)
+{
+    std::vector<MinimizerEntry> entries;
+    std::vector< QPair<quint64, int> > minimizers;
+    int span = PEPTIDE_KMER_SIZE + PEPTIDE_WINDOW_SIZE - 1;
+    for (int i = firstNode; i <= lastNode; ++i)
+    {
+        const QByteArray & sequence = m_sequenceIndex->getNodeSequence(i);
+        for (int frame = 0; frame < 3; ++frame)
+        {
+            QByteArray & peptide = m_peptides[size_t(i) * 3 + frame];
+            if (sequence.length() > frame)
+                peptide = translate(sequence.constData() + frame, sequence.length() - frame);
+
+            minimizers.clear();
+            SequenceIndex::getPeptideMinimizers(peptide, PEPTIDE_KMER_SIZE, PEPTIDE_WINDOW_SIZE,
+                                                0, peptide.length() - span, &minimizers);
+            for (size_t j = 0; j < minimizers.size(); ++j)
+            {
+                MinimizerEntry entry = {minimizers[j].first, i, frame + 3 * minimizers[j].second};
+                entries.push_back(entry);
+            }
+        }
+        addJunctionMinimizers(i, &entries);
+    }
+    return entries;
+}
+
+
+//This function indexes the windows which start in the given node and run
+//over an edge into a following node, in each frame.  The junction is
+//translated from the first window which didn't fit in the node.  Windows
+//which start in the edge overlap are left to the next node, as they are in
+//its translation too.  Each minimizer is recorded in the node where its
+//k-mer starts: a window's minimizer can be up to w - 1 k-mers after the
+//window's start, so where the edge overlap is only a few bases, the last
+//windows' minimizers can start in the next node.
+void TranslatedIndex::addJunctionMinimizers(int node, std::vector<MinimizerEntry> * entries) const
+{
+    const QByteArray & sequence = m_sequenceIndex->getNodeSequence(node);
+    const std::vector< QPair<int, int> > & successors = m_sequenceIndex->getSuccessors(node);
+    int length = sequence.length();
+    if (length == 0 || successors.empty())
+        return;
+
+    int span = PEPTIDE_KMER_SIZE + PEPTIDE_WINDOW_SIZE - 1;
+    std::vector< QPair<quint64, int> > minimizers;
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        int peptideLength = std::max(0, (length - frame) / 3);
+        int start = frame + 3 * std::max(0, peptideLength - span + 1);
+        if (start >= length)
+            continue;
+        QByteArray nodeEnd = sequence.mid(start);
+
+        for (size_t i = 0; i < successors.size(); ++i)
+        {
+            int nextNode = successors[i].first;
+            int overlap = successors[i].second;
+            int lastWindowBase = length - overlap - 1 - start;
+            if (lastWindowBase < 0)
+                continue;
+
+            QByteArray junction = nodeEnd + m_sequenceIndex->getNodeSequence(nextNode).mid(overlap, 3 * span);
+            QByteArray peptide = translate(junction.constData(), junction.length());
+            minimizers.clear();
+            SequenceIndex::getPeptideMinimizers(peptide, PEPTIDE_KMER_SIZE, PEPTIDE_WINDOW_SIZE,
+                                                0, lastWindowBase / 3, &minimizers);
+            for (size_t j = 0; j < minimizers.size(); ++j)
+            {
+                MinimizerEntry entry = {minimizers[j].first, node, start + 3 * minimizers[j].second};
+                if (entry.position >= length)
+                {
+                    entry.node = nextNode;
+                    entry.position = entry.position - length + overlap;
+                }
+                entries->push_back(entry);
+            }
+        }
+    }
+}
+
+
+
+//This function gives the peptide k-mers which the query shares with the
+//translated nodes, as found from its minimizers.  Minimizers which occur
+//more than the given number of times in the graph are skipped.
+std::vector<SequenceSeed> TranslatedIndex::findSeeds(QByteArray query, int maxOccurrences) const
+{
+    std::vector<SequenceSeed> seeds;
+    query = query.toUpper();
+    if (!m_built || query.length() < PEPTIDE_KMER_SIZE)
+        return seeds;
+
+    //A query shorter than a window is given a smaller window so it still has
+    //minimizers, though these may not have been indexed.
+    int windowSize = std::min(PEPTIDE_WINDOW_SIZE, query.length() - PEPTIDE_KMER_SIZE + 1);
+    std::vector< QPair<quint64, int> > minimizers;
+    SequenceIndex::getPeptideMinimizers(query, PEPTIDE_KMER_SIZE, windowSize, 0,
+                                        query.length() - (PEPTIDE_KMER_SIZE + windowSize - 1), &minimizers);
+    SequenceIndex::findMinimizerSeeds(m_entries, minimizers, maxOccurrences, &seeds);
+    return seeds;
+}
+
+
+
+//This function translates a nucleotide sequence from its first base.  Any
+//bases left over after the last whole codon are ignored, and codons with
+//anything other than ACGT are translated as X.
+QByteArray TranslatedIndex::translate(const char * sequence, int length)
+{
+    int codonCount = std::max(0, length / 3);
+    QByteArray peptide(codonCount, 'X');
+    char * aminoAcids = peptide.data();
+    for (int i = 0; i < codonCount; ++i)
+    {
+        int code = getCodonCode(sequence + 3 * i);
+        if (code >= 0)
+            aminoAcids[i] = GENETIC_CODE[code];
+    }
+    return peptide;
+}
+
+
+int TranslatedIndex::getCodonCode(const char * codon)
+{
+    int code = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        int baseCode;
+        switch (codon[i])
+        {
+        case 'T': case 't': baseCode = 0; break;
+        case 'C': case 'c': baseCode = 1; break;
+        case 'A': case 'a': baseCode = 2; break;
+        case 'G': case 'g': baseCode = 3; break;
+        default: return -1;
+        }
+        code = code * 4 + baseCode;
+    }
+    return code;
+}
+
+
+TranslatedIndexBuildJob::TranslatedIndexBuildJob(TranslatedIndex * index, int firstNode, int lastNode) :
+    m_index(index), m_firstNode(firstNode), m_lastNode(lastNode)
+{
+}
+
+
+void TranslatedIndexBuildJob::run()
+{
+    m_entries = m_index->translateNodes(m_firstNode, m_lastNode);
+}
@@ -0,0 +1,100 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef TRANSLATEDINDEX_H
+#define TRANSLATEDINDEX_H
+
+#include <vector>
+#include <QByteArray>
+#include <QRunnable>
+#include "sequenceindex.h"
+
+
+//This class is a minimizer index of the six-frame translation of the node
+//sequences, used to seed protein queries without running tblastn.  Each node
+//is translated in its three forward frames, which for a node and its reverse
+//complement gives all six frames.  The translations are kept, so a protein
+//search can align to them without translating again.  Like the nucleotide
+//index, windows which run over an edge are indexed too: the next node's
+//sequence after the edge overlap is translated on from the node's end, so
+//codons split over the junction are included.  Only one node is followed
+//past a junction.
+//Seeds give the query position in amino acids and the node position in
+//bases (the start of the k-mer's first codon), so a seed's reading frame is
+//its node position mod 3.
+//The index is built from the sequence index (whose node numbers it shares),
+//in parallel, one block of nodes per thread.  It must be cleared whenever
+//the sequence index is.
+class TranslatedIndex
+{
+public:
+    //CREATORS
+    TranslatedIndex();
+
+    //ACCESSORS
+    bool isBuilt() const {return m_built;}
+    int getKmerSize() const;
+    int getWindowSize() const;
+    long long getMinimizerCount() const {return (long long)(m_entries.size());}
+    const SequenceIndex * getSequenceIndex() const {return m_sequenceIndex;}
+    const QByteArray & getNodePeptide(int node, int frame) const {return m_peptides[node * 3 + frame];}
+    std::vector<SequenceSeed> findSeeds(QByteArray query, int maxOccurrences) const;
+
+    //MODIFERS
+    void build(const SequenceIndex * sequenceIndex, int threads);
+    void clear();
+    std::vector<MinimizerEntry> translateNodes(int firstNode, int lastNode);
+
+    //STATIC
+    static QByteArray translate(const char * sequence, int length);
+
+private:
+    bool m_built;
+    const SequenceIndex * m_sequenceIndex;
+    std::vector<QByteArray> m_peptides;
+    std::vector<MinimizerEntry> m_entries;
+
+    void addJunctionMinimizers(int node, std::vector<MinimizerEntry> * entries) const;
+
+    static int getCodonCode(const char * codon);
+};
+
+
+//This class translates and indexes one block of nodes, so the blocks can be
+//spread over a thread pool.  Each block writes only its own nodes'
+//translations.
+class TranslatedIndexBuildJob : public QRunnable
+{
+public:
+    //CREATORS
+    TranslatedIndexBuildJob(TranslatedIndex * index, int firstNode, int lastNode);
+
+    //ACCESSORS
+    const std::vector<MinimizerEntry> * getEntries() const {return &m_entries;}
+
+    //MODIFERS
+    void run();
+
+private:
+    TranslatedIndex * m_index;
+    int m_firstNode;
+    int m_lastNode;
+    std::vector<MinimizerEntry> m_entries;
+};
+
+#endif // TRANSLATEDINDEX_H
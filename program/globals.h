@@ -34,7 +34,7 @@ class AssemblyGraph;
 enum NodeColourScheme {UNIFORM_COLOURS, RANDOM_COLOURS, DEPTH_COLOUR,
                        BLAST_HITS_RAINBOW_COLOUR, BLAST_HITS_SOLID_COLOUR,
                        CONTIGUITY_COLOUR, CUSTOM_COLOURS};
-enum GraphScope {WHOLE_GRAPH, AROUND_NODE, AROUND_BLAST_HITS, DEPTH_RANGE};
+enum GraphScope {WHOLE_GRAPH, AROUND_NODE, AROUND_BLAST_HITS, DEPTH_RANGE, BUBBLES};
 enum ContiguityStatus {STARTING, CONTIGUOUS_STRAND_SPECIFIC,
                        CONTIGUOUS_EITHER_STRAND, MAYBE_CONTIGUOUS,
                        NOT_CONTIGUOUS};
@@ -49,8 +49,12 @@ enum BlastUiState {BLAST_DB_NOT_YET_BUILT, BLAST_DB_BUILD_IN_PROGRESS,
                    BLAST_DB_BUILT_BUT_NO_QUERIES,
                    READY_FOR_BLAST_SEARCH, BLAST_SEARCH_IN_PROGRESS,
                    BLAST_SEARCH_COMPLETE};
+enum BlastAligner {BLAST_PROGRAMS, BUILT_IN_ALIGNER};
 enum CommandLineCommand {NO_COMMAND, BANDAGE_LOAD, BANDAGE_INFO, BANDAGE_IMAGE,
-                         BANDAGE_DISTANCE, BANDAGE_QUERY_PATHS, BANDAGE_REDUCE};
+                         BANDAGE_DISTANCE, BANDAGE_QUERY_PATHS, BANDAGE_REDUCE,
+                         BANDAGE_CONTIGUITY, BANDAGE_FILTER,
+                         BANDAGE_SHORTEST_PATH, BANDAGE_BUBBLES,
+                         BANDAGE_CLEAN, BANDAGE_FIND, BANDAGE_QUERY_BATCH};
 enum EdgeOverlapType {UNKNOWN_OVERLAP, EXACT_OVERLAP,
                       AUTO_DETERMINED_EXACT_OVERLAP};
 enum NodeNameStatus {NODE_NAME_OKAY, NODE_NAME_TAKEN, NODE_NAME_CONTAINS_TAB,
@@ -26,7 +26,14 @@
 #include "../command_line/info.h"
 #include "../command_line/image.h"
 #include "../command_line/querypaths.h"
+#include "../command_line/querybatch.h"
 #include "../command_line/reduce.h"
+#include "../command_line/contiguity.h"
+#include "../command_line/filter.h"
+#include "../command_line/shortestpath.h"
+#include "../command_line/bubbles.h"
+#include "../command_line/clean.h"
+#include "../command_line/find.h"
 #include "../command_line/commoncommandlinefunctions.h"
 #include "../program/settings.h"
 #include "../program/memory.h"
@@ -51,7 +58,14 @@ void printUsage(QTextStream * out, bool all)
     text << "info         Display information about a graph";
     text << "image        Generate an image file of a graph";
     text << "querypaths   Output graph paths for BLAST queries";
+    text << "querybatch   Output graph paths for BLAST queries in many graphs";
     text << "reduce       Save a subgraph of a larger graph";
+    text << "contiguity   Determine node contiguity relative to starting nodes";
+    text << "filter       Save a graph with short or low depth nodes removed";
+    text << "shortestpath Find the shortest paths between two nodes";
+    text << "bubbles      Find the bubbles in a graph";
+    text << "clean        Save a graph with tips, low depth parts and small components removed";
+    text << "find         Find where sequences occur in a graph, without BLAST";
     text << "";
     text << "Options:  --help       View this help message";
     text << "--helpall    View all command line settings";
@@ -150,12 +164,54 @@ int main(int argc, char *argv[])
             g_memory->commandLineCommand = BANDAGE_QUERY_PATHS;
             return bandageQueryPaths(arguments);
         }
+        else if (first.toLower() == "querybatch")
+        {
+            arguments.pop_front();
+            g_memory->commandLineCommand = BANDAGE_QUERY_BATCH;
+            return bandageQueryBatch(arguments);
+        }
         else if (first.toLower() == "reduce")
         {
             arguments.pop_front();
             g_memory->commandLineCommand = BANDAGE_REDUCE;
             return bandageReduce(arguments);
         }
+        else if (first.toLower() == "contiguity")
+        {
+            arguments.pop_front();
+            g_memory->commandLineCommand = BANDAGE_CONTIGUITY;
+            return bandageContiguity(arguments);
+        }
+        else if (first.toLower() == "filter")
+        {
+            arguments.pop_front();
+            g_memory->commandLineCommand = BANDAGE_FILTER;
+            return bandageFilter(arguments);
+        }
+        else if (first.toLower() == "shortestpath")
+        {
+            arguments.pop_front();
+            g_memory->commandLineCommand = BANDAGE_SHORTEST_PATH;
+            return bandageShortestPath(arguments);
+        }
+        else if (first.toLower() == "bubbles")
+        {
+            arguments.pop_front();
+            g_memory->commandLineCommand = BANDAGE_BUBBLES;
+            return bandageBubbles(arguments);
+        }
+        else if (first.toLower() == "clean")
+        {
+            arguments.pop_front();
+            g_memory->commandLineCommand = BANDAGE_CLEAN;
+            return bandageClean(arguments);
+        }
+        else if (first.toLower() == "find")
+        {
+            arguments.pop_front();
+            g_memory->commandLineCommand = BANDAGE_FIND;
+            return bandageFind(arguments);
+        }
 
         //Since a recognised command was not seen, we now check to see if the user
         //was looking for help information.
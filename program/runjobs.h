@@ -0,0 +1,50 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef RUNJOBS_H
+#define RUNJOBS_H
+
+#include <QList>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+//This function runs the given jobs and returns when they are all done.  If
+//more than one thread is to be used, the jobs are spread over a thread pool,
+//otherwise they are just run in order.  Jobs are held by the caller's list,
+//so the pool must not delete them.
+template<typename Job>
+void runJobs(const QList< QSharedPointer<Job> > & jobs, int threads)
+{
+    if (threads <= 1)
+    {
+        for (int i = 0; i < jobs.size(); ++i)
+            jobs[i]->run();
+        return;
+    }
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threads);
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+        jobs[i]->setAutoDelete(false);
+        threadPool.start(jobs[i].data());
+    }
+    threadPool.waitForDone();
+}
+
+#endif // RUNJOBS_H
@@ -18,6 +18,8 @@
 
 #include "settings.h"
 #include <QDir>
+#include <QThread>
+#include <algorithm>
 
 Settings::Settings()
 {
@@ -131,7 +133,29 @@ Settings::Settings()
     minLengthBaseDiscrepancy = IntSetting(-100, -1000000, 1000000, false);
     maxLengthBaseDiscrepancy = IntSetting(100, -1000000, 1000000, false);
 
+    threads = IntSetting(std::max(1, QThread::idealThreadCount()), 1, 256);
+
+    filterMinNodeLength = IntSetting(0, 0, 1000000000);
+    filterMinNodeDepth = FloatSetting(0.0, 0.0, 1000000.0);
+
+    shortestPathCount = IntSetting(1, 1, 1000);
+
+    maxBubbleNodes = IntSetting(1000, 2, 1000000);
+
+    cleanMaxTipLength = IntSetting(100, 0, 1000000000);
+    cleanMinRelativeDepth = FloatSetting(0.1, 0.0, 1.0);
+    cleanMinComponentLength = IntSetting(1000, 0, 1000000000);
+    cleanMergeUnitigs = true;
+
+    sequenceIndexKmerSize = IntSetting(15, 5, 31);
+    sequenceIndexWindowSize = IntSetting(10, 1, 100);
+    findMaxMismatches = IntSetting(0, 0, 100);
+
+    editHistoryMemory = IntSetting(500, 0, 1000000);
+
     blastSearchParameters = "";
+    blastAligner = BLAST_PROGRAMS;
+    blastDatabaseCacheDirectory = "";
 
     blastAlignmentLengthFilter = IntSetting(100, 1, 1000000, false);
     blastQueryCoverageFilter = FloatSetting(50.0, 0.0, 100.0, false);
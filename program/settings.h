@@ -187,10 +187,56 @@ public:
     IntSetting minLengthBaseDiscrepancy;
     IntSetting maxLengthBaseDiscrepancy;
 
+    //This is the number of threads used for work that can be split up, such
+    //as searching for BLAST query paths.
+    IntSetting threads;
+
+    //These are the thresholds used by Bandage filter: nodes shorter or with a
+    //lower depth than these are removed from the graph.
+    IntSetting filterMinNodeLength;
+    FloatSetting filterMinNodeDepth;
+
+    //This is the number of paths given by Bandage shortestpath.
+    IntSetting shortestPathCount;
+
+    //This is the largest superbubble (in nodes) that will be found, for the
+    //'Bubbles' graph scope and Bandage bubbles.
+    IntSetting maxBubbleNodes;
+
+    //These control the passes of Bandage clean.  A value of zero turns the
+    //pass off.
+    IntSetting cleanMaxTipLength;
+    FloatSetting cleanMinRelativeDepth;
+    IntSetting cleanMinComponentLength;
+    bool cleanMergeUnitigs;
+
+    //These control the index used to find sequences in the graph: the k-mer
+    //size and the number of k-mers in each minimizer window.  A query must be
+    //at least k + w - 1 bases long to be sure of being found.
+    IntSetting sequenceIndexKmerSize;
+    IntSetting sequenceIndexWindowSize;
+
+    //This is the number of mismatches allowed when finding a sequence.
+    IntSetting findMaxMismatches;
+
+    //This is the most memory (in megabytes) that the undo/redo history of
+    //graph edits can use.  Past this, the oldest edits are forgotten.
+    IntSetting editHistoryMemory;
+
     //This holds the BLAST search parameters that a user can change before
     //running a BLAST search.
     QString blastSearchParameters;
 
+    //This is what does the BLAST search: blastn/tblastn or Bandage's own
+    //aligner, which needs no BLAST install and aligns protein queries to a
+    //six-frame translation of the graph.
+    BlastAligner blastAligner;
+
+    //If this is set, BLAST databases are kept in this directory, under a hash
+    //of the graph's node names and sequences, so later searches on the same
+    //graph (in this run or another) reuse them instead of rebuilding.
+    QString blastDatabaseCacheDirectory;
+
     //These are the optional BLAST hit filters: whether or not they are used and
     //what their values are.
     IntSetting blastAlignmentLengthFilter;
@@ -17,18 +17,30 @@
 
 
 #include <QtTest/QtTest>
+#include <locale.h>
 #include <QDebug>
 #include "ogdf/basic/Graph.h"
 #include "ogdf/basic/GraphAttributes.h"
 #include "../graph/assemblygraph.h"
 #include "../program/settings.h"
 #include "../blast/blastsearch.h"
+#include "../blast/runblastsearchworker.h"
+#include "../blast/blasthitpart.h"
 #include "../ui/mygraphicsview.h"
+#include "../ui/blasthitstablemodel.h"
+#include "../ui/blastqueriestablemodel.h"
 #include "../program/memory.h"
 #include "../graph/debruijnnode.h"
 #include "../graph/debruijnedge.h"
+#include "../graph/shortestpathfinder.h"
+#include "../graph/graphcleaner.h"
+#include "../graph/graphstatistics.h"
+#include "../graph/graphcoarsener.h"
+#include "../graph/sequenceindex.h"
+#include "../graph/translatedindex.h"
 #include "../program/globals.h"
 #include "../command_line/commoncommandlinefunctions.h"
+#include "../command_line/querybatch.h"
 
 class BandageTests : public QObject
 {
@@ -47,6 +59,14 @@ private slots:
     void loadCsvDataTrinity();
     void blastSearch();
     void blastSearchFilters();
+    void blastHitRefilter();
+    void blastDatabaseCache();
+    void blastSearchShards();
+    void blastLineParsing();
+    void blastQueryLookup();
+    void blastHitStore();
+    void blastTableModels();
+    void blastHitRainbowParts();
     void graphScope();
     void commandLineSettings();
     void sciNotComparisons();
@@ -58,6 +78,22 @@ private slots:
     void changeNodeDepths();
     void blastQueryPaths();
     void bandageInfo();
+    void determineContiguity();
+    void allPossiblePaths();
+    void pathNodeSubsets();
+    void filterNodes();
+    void partialNodeNameSearch();
+    void depthRangeIndex();
+    void shortestPaths();
+    void superbubbles();
+    void graphCleaning();
+    void incrementalGraphStatistics();
+    void graphEditUndoRedo();
+    void graphCoarsening();
+    void sequenceIndexFind();
+    void builtInAligner();
+    void queryBatch();
+    void builtInAlignerProtein();
 
 
 private:
@@ -68,6 +104,7 @@ private:
     DeBruijnEdge * getEdgeFromNodeNames(QString startingNodeName,
                                         QString endingNodeName);
     bool doCircularSequencesMatch(QByteArray s1, QByteArray s2);
+    bool doGraphStatisticsMatchFreshBuild();
 };
 
 
@@ -441,24 +478,24 @@ void BandageTests::blastSearch()
     QCOMPARE(one_insertion->getLength(), 101);
     QCOMPARE(one_deletion->getLength(), 99);
 
-    QSharedPointer<BlastHit> exactHit = exact->getHits().at(0);
-    QSharedPointer<BlastHit> one_mismatchHit = one_mismatch->getHits().at(0);
-    QSharedPointer<BlastHit> one_insertionHit = one_insertion->getHits().at(0);
-    QSharedPointer<BlastHit> one_deletionHit = one_deletion->getHits().at(0);
-
-    QCOMPARE(exactHit->m_numberMismatches, 0);
-    QCOMPARE(exactHit->m_numberGapOpens, 0);
-    QCOMPARE(one_mismatchHit->m_numberMismatches, 1);
-    QCOMPARE(one_mismatchHit->m_numberGapOpens, 0);
-    QCOMPARE(one_insertionHit->m_numberMismatches, 0);
-    QCOMPARE(one_insertionHit->m_numberGapOpens, 1);
-    QCOMPARE(one_deletionHit->m_numberMismatches, 0);
-    QCOMPARE(one_deletionHit->m_numberGapOpens, 1);
-
-    QCOMPARE(exactHit->m_percentIdentity < 100.0, false);
-    QCOMPARE(one_mismatchHit->m_percentIdentity < 100.0, true);
-    QCOMPARE(one_insertionHit->m_percentIdentity < 100.0, true);
-    QCOMPARE(one_deletionHit->m_percentIdentity < 100.0, true);
+    BlastHit exactHit = exact->getHit(0);
+    BlastHit one_mismatchHit = one_mismatch->getHit(0);
+    BlastHit one_insertionHit = one_insertion->getHit(0);
+    BlastHit one_deletionHit = one_deletion->getHit(0);
+
+    QCOMPARE(exactHit.m_numberMismatches, 0);
+    QCOMPARE(exactHit.m_numberGapOpens, 0);
+    QCOMPARE(one_mismatchHit.m_numberMismatches, 1);
+    QCOMPARE(one_mismatchHit.m_numberGapOpens, 0);
+    QCOMPARE(one_insertionHit.m_numberMismatches, 0);
+    QCOMPARE(one_insertionHit.m_numberGapOpens, 1);
+    QCOMPARE(one_deletionHit.m_numberMismatches, 0);
+    QCOMPARE(one_deletionHit.m_numberGapOpens, 1);
+
+    QCOMPARE(exactHit.m_percentIdentity < 100.0, false);
+    QCOMPARE(one_mismatchHit.m_percentIdentity < 100.0, true);
+    QCOMPARE(one_insertionHit.m_percentIdentity < 100.0, true);
+    QCOMPARE(one_deletionHit.m_percentIdentity < 100.0, true);
 
     deleteBlastTempDirectory();
 }
@@ -512,6 +549,459 @@ void BandageTests::blastSearchFilters()
 
 
 
+//Filtering the hits of a search again should give the same hits as searching
+//again with the new filters.
+void BandageTests::blastHitRefilter()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_settings->blastQueryFilename = getTestDirectory() + "test_queries2.fasta";
+    createBlastTempDirectory();
+
+    g_blastSearch->doAutoBlastSearch();
+    int unfilteredHitCount = g_blastSearch->m_allHits.size();
+    QCOMPARE(g_blastSearch->m_allHits.getUnfilteredCount(), unfilteredHitCount);
+
+    g_settings->blastEValueFilter.on = true;
+    g_settings->blastEValueFilter = SciNot(1.0, -5);
+    g_blastSearch->applyHitFilters();
+    QCOMPARE(g_blastSearch->m_allHits.size(), 14);
+    QCOMPARE(g_blastSearch->m_allHits.getUnfilteredCount(), unfilteredHitCount);
+
+    g_settings->blastBitScoreFilter.on = true;
+    g_settings->blastBitScoreFilter = 100.0;
+    g_settings->blastAlignmentLengthFilter.on = true;
+    g_settings->blastAlignmentLengthFilter = 100;
+    g_settings->blastIdentityFilter.on = true;
+    g_settings->blastIdentityFilter = 50.0;
+    g_settings->blastQueryCoverageFilter.on = true;
+    g_settings->blastQueryCoverageFilter = 90.0;
+    g_blastSearch->applyHitFilters();
+    QCOMPARE(g_blastSearch->m_allHits.size(), 5);
+
+    //The queries' hits and paths should match a search done with the same
+    //filters.
+    QStringList refilteredHits;
+    QList<int> refilteredPathCounts;
+    for (size_t i = 0; i < g_blastSearch->m_blastQueries.m_queries.size(); ++i)
+    {
+        BlastQuery * query = g_blastSearch->m_blastQueries.m_queries[i];
+        refilteredPathCounts.push_back(query->getPathCount());
+        for (int j = 0; j < query->hitCount(); ++j)
+        {
+            BlastHit hit = query->getHit(j);
+            refilteredHits << query->getName() + " " + hit.m_node->getName() + " " + QString::number(hit.m_queryStart);
+        }
+    }
+    g_blastSearch->doAutoBlastSearch();
+    QStringList searchedHits;
+    QList<int> searchedPathCounts;
+    for (size_t i = 0; i < g_blastSearch->m_blastQueries.m_queries.size(); ++i)
+    {
+        BlastQuery * query = g_blastSearch->m_blastQueries.m_queries[i];
+        searchedPathCounts.push_back(query->getPathCount());
+        for (int j = 0; j < query->hitCount(); ++j)
+        {
+            BlastHit hit = query->getHit(j);
+            searchedHits << query->getName() + " " + hit.m_node->getName() + " " + QString::number(hit.m_queryStart);
+        }
+    }
+    QCOMPARE(refilteredHits, searchedHits);
+    QCOMPARE(refilteredPathCounts, searchedPathCounts);
+
+    //Turning the filters off again brings back all of the hits.
+    g_settings->blastEValueFilter.on = false;
+    g_settings->blastBitScoreFilter.on = false;
+    g_settings->blastAlignmentLengthFilter.on = false;
+    g_settings->blastIdentityFilter.on = false;
+    g_settings->blastQueryCoverageFilter.on = false;
+    g_blastSearch->applyHitFilters();
+    QCOMPARE(g_blastSearch->m_allHits.size(), unfilteredHitCount);
+
+    deleteBlastTempDirectory();
+}
+
+
+
+//A BLAST database kept in the cache directory should be reused by later
+//searches on the same graph, and a different graph should get its own.
+void BandageTests::blastDatabaseCache()
+{
+    createGlobals();
+    QString cacheDirectory = "bandage_temp-dbcache-" + QString::number(QApplication::applicationPid());
+    g_settings->blastDatabaseCacheDirectory = cacheDirectory;
+    g_settings->blastQueryFilename = getTestDirectory() + "test_queries1.fasta";
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    createBlastTempDirectory();
+
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+    QString database = g_blastSearch->m_blastDatabase;
+    int hitCount = g_blastSearch->m_allHits.size();
+    QCOMPARE(hitCount > 0, true);
+    QCOMPARE(database.startsWith(QDir(cacheDirectory).absolutePath()), true);
+    QCOMPARE(QDir(cacheDirectory).entryList(QDir::Dirs | QDir::NoDotAndDotDot).size(), 1);
+    QFileInfo completeFile(QFileInfo(database).absolutePath() + "/complete");
+    QCOMPARE(completeFile.exists(), true);
+    QDateTime buildTime = completeFile.lastModified();
+
+    //Searching the same graph again uses the same database, unchanged.
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+    QCOMPARE(g_blastSearch->m_blastDatabase, database);
+    QCOMPARE(g_blastSearch->m_allHits.size(), hitCount);
+    QCOMPARE(QDir(cacheDirectory).entryList(QDir::Dirs | QDir::NoDotAndDotDot).size(), 1);
+    QCOMPARE(QFileInfo(QFileInfo(database).absolutePath() + "/complete").lastModified(), buildTime);
+
+    //So does the same graph loaded again.
+    g_blastSearch->cleanUp();
+    g_assemblyGraph->cleanUp();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+    QCOMPARE(g_blastSearch->m_blastDatabase, database);
+
+    //A different graph gets a new database.
+    g_blastSearch->cleanUp();
+    g_assemblyGraph->cleanUp();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.LastGraph");
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+    QCOMPARE(g_blastSearch->m_blastDatabase == database, false);
+    QCOMPARE(QDir(cacheDirectory).entryList(QDir::Dirs | QDir::NoDotAndDotDot).size(), 2);
+
+    deleteBlastTempDirectory();
+    QDir(cacheDirectory).removeRecursively();
+}
+
+
+
+//A BLAST search split into shards should give exactly the same hits (in the
+//same order) as one done in a single process.
+void BandageTests::blastSearchShards()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_settings->blastQueryFilename = getTestDirectory() + "test_queries2.fasta";
+    createBlastTempDirectory();
+
+    auto describeHits = []()
+    {
+        QStringList hits;
+        for (int i = 0; i < g_blastSearch->m_allHits.size(); ++i)
+        {
+            BlastHit hit = g_blastSearch->m_allHits.getHit(g_blastSearch->m_allHits.getHitId(i));
+            hits << hit.m_query->getName() + " " + hit.m_node->getName() + " " +
+                    QString::number(hit.m_queryStart) + " " + QString::number(hit.m_nodeStart) + " " +
+                    QString::number(hit.m_bitScore);
+        }
+        return hits;
+    };
+
+    g_settings->threads = 1;
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+    QStringList singleHits = describeHits();
+    QCOMPARE(singleHits.size() > 0, true);
+
+    g_settings->threads = 4;
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+    QStringList shardedHits = describeHits();
+    QCOMPARE(shardedHits, singleHits);
+
+    //The shards' files are removed once the search is done.
+    QDir tempDirectory(g_blastSearch->m_tempDirectory);
+    QCOMPARE(tempDirectory.entryList(QStringList() << "*shard*").size(), 0);
+
+    //An empty query (here the last one) has no hits and isn't put in any
+    //shard.
+    QString emptyQueryFilename = g_blastSearch->m_tempDirectory + "empty_query_test.fasta";
+    QFile emptyQueryFile(emptyQueryFilename);
+    emptyQueryFile.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream emptyQueryOut(&emptyQueryFile);
+    emptyQueryOut << ">q1\n" << g_assemblyGraph->m_deBruijnGraphNodes["1+"]->getSequence().mid(100, 500) << "\n";
+    emptyQueryOut << ">q2\n";
+    emptyQueryOut.flush();
+    emptyQueryFile.close();
+    g_settings->blastQueryFilename = emptyQueryFilename;
+    for (int threads = 1; threads <= 2; ++threads)
+    {
+        g_settings->threads = threads;
+        QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+        QCOMPARE(g_blastSearch->m_blastQueries.getQueryCount(), 2);
+        QCOMPARE(g_blastSearch->m_blastQueries.getQueryFromName("q1")->hitCount() > 0, true);
+        QCOMPARE(g_blastSearch->m_blastQueries.getQueryFromName("q2")->hitCount(), 0);
+    }
+
+    deleteBlastTempDirectory();
+}
+
+
+//BLAST writes decimals with a point, whatever the locale, so hits must be
+//parsed the same way when the C library uses a comma.
+void BandageTests::blastLineParsing()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_blastSearch->loadBlastQueriesFromFastaFile(getTestDirectory() + "test_queries1.fasta");
+
+    QByteArray line = "test_query_exact\tNODE_1+_length_6070_cov_1.5\t98.75\t80\t1\t0\t1\t80\t11\t90\t1e-30\t142.5";
+    BlastHit hit;
+    QCOMPARE(g_blastSearch->makeHitFromBlastLine(line.constData(), line.size(), &hit), true);
+    QCOMPARE(hit.m_percentIdentity, 98.75);
+    QCOMPARE(hit.m_bitScore, 142.5);
+
+    QByteArray oldLocale = setlocale(LC_NUMERIC, 0);
+    if (setlocale(LC_NUMERIC, "de_DE.UTF-8") == 0 && setlocale(LC_NUMERIC, "de_DE") == 0)
+        QSKIP("No locale with a decimal comma is installed");
+    BlastHit localeHit;
+    bool parsed = g_blastSearch->makeHitFromBlastLine(line.constData(), line.size(), &localeHit);
+    setlocale(LC_NUMERIC, oldLocale.constData());
+    QCOMPARE(parsed, true);
+    QCOMPARE(localeHit.m_percentIdentity, 98.75);
+    QCOMPARE(localeHit.m_bitScore, 142.5);
+    QCOMPARE(localeHit.m_nodeStart, 11);
+    QCOMPARE(localeHit.m_nodeEnd, 90);
+}
+
+
+
+//Queries should be found by name after being added, renamed and removed.
+void BandageTests::blastQueryLookup()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_settings->blastQueryFilename = getTestDirectory() + "test_queries1.fasta";
+    createBlastTempDirectory();
+
+    BlastQueries * queries = &(g_blastSearch->m_blastQueries);
+    BlastQuery * a = new BlastQuery("a", "ACGTACGTACGT");
+    BlastQuery * b = new BlastQuery("b", "TTTTGGGGCCCC");
+    BlastQuery * c = new BlastQuery("a", "GATTACAGATTACA");
+    queries->addQuery(a);
+    queries->addQuery(b);
+    queries->addQuery(c);
+    QCOMPARE(c->getName(), QString("a_2"));
+    QCOMPARE(queries->getQueryFromName("a"), a);
+    QCOMPARE(queries->getQueryFromName("b"), b);
+    QCOMPARE(queries->getQueryFromName("a_2"), c);
+
+    QCOMPARE(queries->renameQuery(b, "c"), QString("c"));
+    QCOMPARE(queries->getQueryFromName("b") == 0, true);
+    QCOMPARE(queries->getQueryFromName("c"), b);
+
+    std::vector<BlastQuery *> queriesToRemove;
+    queriesToRemove.push_back(a);
+    g_blastSearch->clearSomeQueries(queriesToRemove);
+    QCOMPARE(queries->getQueryFromName("a") == 0, true);
+    QCOMPARE(queries->getQueryFromName("a_2"), c);
+    QCOMPARE(queries->getQueryCount(), 2);
+
+    queries->clearAllQueries();
+    QCOMPARE(queries->getQueryFromName("c") == 0, true);
+
+    //After a search, each query's own hits are the same (and in the same
+    //order) as its hits among all of the hits.
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+    BlastQuery * exact = queries->getQueryFromName("test_query_exact");
+    QList<int> expectedHits;
+    for (int i = 0; i < g_blastSearch->m_allHits.size(); ++i)
+    {
+        int hitId = g_blastSearch->m_allHits.getHitId(i);
+        if (g_blastSearch->m_allHits.getQuery(hitId) == exact)
+            expectedHits.push_back(hitId);
+    }
+    QCOMPARE(expectedHits.size() > 0, true);
+    QCOMPARE(exact->getHitIds() == expectedHits, true);
+
+    deleteBlastTempDirectory();
+}
+
+
+
+//Hits in the store should keep their IDs as more hits are added, and
+//removing a query's hits should keep the others in order.  The shown hits
+//are grouped into a span for each node.
+void BandageTests::blastHitStore()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    createBlastTempDirectory();
+
+    BlastQuery * query1 = new BlastQuery("query1", "ACGTACGTACGTACGTACGT");
+    BlastQuery * query2 = new BlastQuery("query2", "TTTTGGGGCCCCAAAATTTT");
+    g_blastSearch->m_blastQueries.addQuery(query1);
+    g_blastSearch->m_blastQueries.addQuery(query2);
+    DeBruijnNode * node = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+
+    std::vector<int> storedHits;
+    for (int i = 0; i < 10000; ++i)
+    {
+        BlastQuery * query = (i % 3 == 0) ? query2 : query1;
+        BlastHit hit(query, node, 100.0, 10, 0, 0, 1, 10, i + 1, i + 10, SciNot(1.0, -5), 20.0);
+        storedHits.push_back(g_blastSearch->addHit(hit));
+    }
+    QCOMPARE(g_blastSearch->m_allHits.size(), 10000);
+    QCOMPARE(query1->hitCount() + query2->hitCount(), 10000);
+    bool hitsUnmoved = true;
+    for (int i = 0; i < 10000; ++i)
+    {
+        if (g_blastSearch->m_allHits.getHitId(i) != storedHits[i] ||
+                g_blastSearch->m_allHits.getNodeStart(storedHits[i]) != i + 1)
+            hitsUnmoved = false;
+    }
+    QCOMPARE(hitsUnmoved, true);
+    QCOMPARE(g_blastSearch->m_allHits.getQueryCount(), 2);
+    QCOMPARE(g_blastSearch->m_allHits.getNodeCount(), 1);
+
+    std::vector<BlastQuery *> queriesToRemove;
+    queriesToRemove.push_back(query2);
+    g_blastSearch->clearSomeQueries(queriesToRemove);
+    QCOMPARE(g_blastSearch->m_allHits.size(), query1->hitCount());
+    QCOMPARE(g_blastSearch->m_allHits.findQueryId(query2), -1);
+    bool hitsInOrder = true;
+    for (int i = 0; i < g_blastSearch->m_allHits.size(); ++i)
+    {
+        int hitId = g_blastSearch->m_allHits.getHitId(i);
+        if (g_blastSearch->m_allHits.getQuery(hitId) != query1 ||
+                (i > 0 && g_blastSearch->m_allHits.getNodeStart(hitId) <=
+                 g_blastSearch->m_allHits.getNodeStart(g_blastSearch->m_allHits.getHitId(i - 1))))
+            hitsInOrder = false;
+    }
+    QCOMPARE(hitsInOrder, true);
+
+    g_blastSearch->blastQueryChanged("all");
+    QCOMPARE(node->getBlastHitCount(), query1->hitCount());
+    QCOMPARE(node->getReverseComplement()->thisNodeHasBlastHits(), false);
+    BlastHit firstNodeHit = g_blastSearch->m_allHits.getNodeHit(node->getBlastHitsStart());
+    QCOMPARE(firstNodeHit.m_query, query1);
+    QCOMPARE(firstNodeHit.m_node, node);
+    QCOMPARE(firstNodeHit.m_nodeStart, query1->getHit(0).m_nodeStart);
+
+    g_blastSearch->clearBlastHits();
+    QCOMPARE(g_blastSearch->m_allHits.size(), 0);
+    QCOMPARE(query1->hitCount(), 0);
+
+    deleteBlastTempDirectory();
+}
+
+
+
+//The BLAST tables' models should show the search's hits and queries, and
+//sorting should only change the order of the rows.
+void BandageTests::blastTableModels()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_settings->blastQueryFilename = getTestDirectory() + "test_queries1.fasta";
+    createBlastTempDirectory();
+    g_blastSearch->doAutoBlastSearch();
+
+    BlastHitsTableModel hitsModel;
+    hitsModel.update();
+    int hitCount = g_blastSearch->m_allHits.size();
+    QCOMPARE(hitsModel.rowCount(), hitCount);
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
+    QCOMPARE(hitsModel.getHitId(0), hits.getHitId(0));
+    QCOMPARE(hitsModel.data(hitsModel.index(0, 1)).toString(), hits.getQuery(hits.getHitId(0))->getName());
+
+    hitsModel.sort(13, Qt::DescendingOrder);
+    bool sortedByBitScore = true;
+    for (int i = 1; i < hitCount; ++i)
+    {
+        if (hits.getBitScore(hitsModel.getHitId(i)) > hits.getBitScore(hitsModel.getHitId(i - 1)))
+            sortedByBitScore = false;
+    }
+    QCOMPARE(sortedByBitScore, true);
+
+    //Names and e-values are sorted through ranks and logarithms.
+    hitsModel.sort(2, Qt::AscendingOrder);
+    bool sortedByNodeName = true;
+    for (int i = 1; i < hitCount; ++i)
+    {
+        if (hits.getNode(hitsModel.getHitId(i))->getName() < hits.getNode(hitsModel.getHitId(i - 1))->getName())
+            sortedByNodeName = false;
+    }
+    QCOMPARE(sortedByNodeName, true);
+    hitsModel.sort(12, Qt::AscendingOrder);
+    bool sortedByEValue = true;
+    for (int i = 1; i < hitCount; ++i)
+    {
+        if (hits.getEValue(hitsModel.getHitId(i)) < hits.getEValue(hitsModel.getHitId(i - 1)))
+            sortedByEValue = false;
+    }
+    QCOMPARE(sortedByEValue, true);
+    hitsModel.sort(13, Qt::DescendingOrder);
+
+    //Updating the model keeps the sort, and sorting by no column gives the
+    //store's order again.
+    hitsModel.update();
+    QCOMPARE(hits.getBitScore(hitsModel.getHitId(0)) >= hits.getBitScore(hitsModel.getHitId(hitCount - 1)), true);
+    hitsModel.sort(-1);
+    bool inStoreOrder = true;
+    for (int i = 0; i < hitCount; ++i)
+    {
+        if (hitsModel.getHitId(i) != hits.getHitId(i))
+            inStoreOrder = false;
+    }
+    QCOMPARE(inStoreOrder, true);
+
+    BlastQueriesTableModel queriesModel;
+    queriesModel.update();
+    int queryCount = g_blastSearch->m_blastQueries.getQueryCount();
+    QCOMPARE(queriesModel.rowCount(), queryCount);
+    queriesModel.sort(5, Qt::DescendingOrder);
+    BlastQuery * mostHitsQuery = queriesModel.getQuery(0);
+    QCOMPARE(queriesModel.data(queriesModel.index(0, 5)).toString(), formatIntForDisplay(mostHitsQuery->hitCount()));
+    for (int i = 0; i < queryCount; ++i)
+        QCOMPARE(queriesModel.getQuery(i)->hitCount() <= mostHitsQuery->hitCount(), true);
+
+    //Renaming a query in the table renames it in the search.
+    QCOMPARE(queriesModel.setData(queriesModel.index(0, 2), "renamed_query"), true);
+    QCOMPARE(mostHitsQuery->getName(), QString("renamed_query"));
+    QCOMPARE(g_blastSearch->m_blastQueries.getQueryFromName("renamed_query"), mostHitsQuery);
+
+    deleteBlastTempDirectory();
+}
+
+
+
+//A rainbow hit is made of many parts when they are at least a pixel long on
+//screen, but of one gradient part when they would be smaller.
+void BandageTests::blastHitRainbowParts()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_settings->nodeColourScheme = BLAST_HITS_RAINBOW_COLOUR;
+    g_settings->blastRainbowPartsPerQuery = 100;
+
+    BlastQuery * query = new BlastQuery("query", QString(1000, 'A'));
+    g_blastSearch->m_blastQueries.addQuery(query);
+    DeBruijnNode * node = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+    BlastHit hit(query, node, 100.0, node->getLength(), 0, 0, 1, 1000, 1, node->getLength(), SciNot(1.0, -5), 20.0);
+
+    std::vector<BlastHitPart> parts = hit.getBlastHitParts(false, 10000.0);
+    QCOMPARE(int(parts.size()), 100);
+    QCOMPARE(parts[0].m_rainbowGradient, false);
+    QCOMPARE(parts[0].m_colour, BlastHit::getRainbowColour(0.0));
+
+    parts = hit.getBlastHitParts(false, 50.0);
+    QCOMPARE(int(parts.size()), 1);
+    QCOMPARE(parts[0].m_rainbowGradient, true);
+    QCOMPARE(parts[0].m_queryFractionStart, 0.0);
+    QCOMPARE(parts[0].m_queryFractionEnd, 1.0);
+    QCOMPARE(parts[0].m_nodeFractionStart, 0.0);
+    QCOMPARE(parts[0].m_nodeFractionEnd, 1.0);
+
+    parts = hit.getBlastHitParts(true, 50.0);
+    QCOMPARE(parts[0].m_nodeFractionStart, 1.0);
+    QCOMPARE(parts[0].m_nodeFractionEnd, 0.0);
+
+    //The solid colour scheme always makes one part in the query's colour.
+    g_settings->nodeColourScheme = BLAST_HITS_SOLID_COLOUR;
+    parts = hit.getBlastHitParts(false, 50.0);
+    QCOMPARE(int(parts.size()), 1);
+    QCOMPARE(parts[0].m_rainbowGradient, false);
+    QCOMPARE(parts[0].m_colour, query->getColour());
+}
+
+
+
 void BandageTests::graphScope()
 {
     createGlobals();
@@ -1428,6 +1918,30 @@ void BandageTests::blastQueryPaths()
     query7Paths = g_blastSearch->m_blastQueries.m_queries[6]->getPaths();
     QCOMPARE(query6Paths.size(), 1);
     QCOMPARE(query7Paths.size(), 1);
+
+    //The query paths should be the same (and in the same order) regardless of
+    //how many threads are used to find them.
+    *g_settings = defaultSettings;
+    g_settings->maxQueryPathNodes = 10;
+    g_settings->threads = 1;
+    g_blastSearch->doAutoBlastSearch();
+    QStringList singleThreadPaths;
+    for (size_t i = 0; i < g_blastSearch->m_blastQueries.m_queries.size(); ++i)
+    {
+        QList<BlastQueryPath> paths = g_blastSearch->m_blastQueries.m_queries[i]->getPaths();
+        for (int j = 0; j < paths.size(); ++j)
+            singleThreadPaths << QString::number(i) + ": " + paths[j].getPath().getString(true);
+    }
+    g_settings->threads = 4;
+    g_blastSearch->findQueryPaths();
+    QStringList multiThreadPaths;
+    for (size_t i = 0; i < g_blastSearch->m_blastQueries.m_queries.size(); ++i)
+    {
+        QList<BlastQueryPath> paths = g_blastSearch->m_blastQueries.m_queries[i]->getPaths();
+        for (int j = 0; j < paths.size(); ++j)
+            multiThreadPaths << QString::number(i) + ": " + paths[j].getPath().getString(true);
+    }
+    QCOMPARE(multiThreadPaths, singleThreadPaths);
 }
 
 
@@ -1482,6 +1996,961 @@ void BandageTests::bandageInfo()
 
 
 
+void BandageTests::determineContiguity()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_assemblyGraph->resetNodeContiguityStatus();
+
+    DeBruijnNode * node1 = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+    node1->determineContiguity();
+    QCOMPARE(node1->getContiguityStatus(), STARTING);
+
+    //The node on the other side of each of the starting node's edges must be
+    //on every path that goes through that edge.
+    const std::vector<DeBruijnEdge *> * edges = node1->getEdgesPointer();
+    QVERIFY(edges->size() > 0);
+    for (size_t i = 0; i < edges->size(); ++i)
+    {
+        DeBruijnNode * otherNode = (*edges)[i]->getOtherNode(node1);
+        if (otherNode != node1)
+            QCOMPARE(otherNode->getContiguityStatus(), CONTIGUOUS_STRAND_SPECIFIC);
+    }
+
+    //With only one search step, only the starting node's neighbours (and
+    //their reverse complements) are given a contiguity status.
+    g_assemblyGraph->resetNodeContiguityStatus();
+    g_settings->contiguitySearchSteps = 1;
+    node1->determineContiguity();
+    QCOMPARE(node1->getContiguityStatus(), STARTING);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["12-"]->getContiguityStatus(), CONTIGUOUS_STRAND_SPECIFIC);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["4-"]->getContiguityStatus(), CONTIGUOUS_STRAND_SPECIFIC);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["12+"]->getContiguityStatus(), CONTIGUOUS_EITHER_STRAND);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["4+"]->getContiguityStatus(), CONTIGUOUS_EITHER_STRAND);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["1-"]->getContiguityStatus(), NOT_CONTIGUOUS);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["10+"]->getContiguityStatus(), NOT_CONTIGUOUS);
+    int contiguousCount = 0;
+    QMapIterator<QString, DeBruijnNode*> j(g_assemblyGraph->m_deBruijnGraphNodes);
+    while (j.hasNext())
+    {
+        j.next();
+        if (j.value()->getContiguityStatus() != NOT_CONTIGUOUS)
+            ++contiguousCount;
+    }
+    QCOMPARE(contiguousCount, 5);
+
+    //With three steps, 29- is reached past the branches after 12- but leads
+    //only back to the starting node, 33 is on every path from 4- when either
+    //strand counts, and the branches themselves are only maybe contiguous.
+    g_assemblyGraph->resetNodeContiguityStatus();
+    g_settings->contiguitySearchSteps = 3;
+    node1->determineContiguity();
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["29-"]->getContiguityStatus(), CONTIGUOUS_STRAND_SPECIFIC);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["29+"]->getContiguityStatus(), CONTIGUOUS_EITHER_STRAND);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["33-"]->getContiguityStatus(), CONTIGUOUS_EITHER_STRAND);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["10+"]->getContiguityStatus(), MAYBE_CONTIGUOUS);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["34-"]->getContiguityStatus(), MAYBE_CONTIGUOUS);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["35+"]->getContiguityStatus(), MAYBE_CONTIGUOUS);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["2+"]->getContiguityStatus(), NOT_CONTIGUOUS);
+}
+
+
+void BandageTests::allPossiblePaths()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+
+    DeBruijnNode * node1 = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+    std::vector<DeBruijnNode *> downstreamNodes = node1->getDownstreamNodes();
+    QVERIFY(downstreamNodes.size() > 0);
+    DeBruijnNode * endNode = downstreamNodes[0];
+
+    GraphLocation startLocation(node1, 100);
+    GraphLocation endLocation(endNode, 50);
+    QList<Path> paths = Path::getAllPossiblePaths(startLocation, endLocation, 5, 0, 20000);
+
+    //The direct path between the two nodes must be found, and it must come
+    //first because paths with fewer nodes are returned first.
+    QVERIFY(paths.size() > 0);
+    QCOMPARE(paths[0].getNodeCount(), 2);
+    QCOMPARE(paths[0].getNodes()[0], node1);
+    QCOMPARE(paths[0].getNodes()[1], endNode);
+
+    int previousNodeCount = 0;
+    for (int i = 0; i < paths.size(); ++i)
+    {
+        Path path = paths[i];
+        QVERIFY(path.getNodeCount() >= previousNodeCount);
+        QVERIFY(path.getNodeCount() <= 6);
+        QVERIFY(path.getStartLocation() == startLocation);
+        QVERIFY(path.getEndLocation() == endLocation);
+        QVERIFY(path.getLength() >= 0 && path.getLength() <= 20000);
+        previousNodeCount = path.getNodeCount();
+    }
+
+    //A maximum length shorter than the direct path means no paths at all.
+    int directLength = paths[0].getLength();
+    QCOMPARE(Path::getAllPossiblePaths(startLocation, endLocation, 5, 0, directLength - 1).size(), 0);
+}
+
+
+
+void BandageTests::pathNodeSubsets()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+
+    DeBruijnNode * node1 = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+    DeBruijnNode * endNode = node1->getDownstreamNodes()[0];
+    QList<Path> longPaths = Path::getAllPossiblePaths(GraphLocation::startOfNode(node1),
+                                                      GraphLocation::endOfNode(endNode),
+                                                      6, 0, 1000000);
+
+    //Add pieces of the found paths to the list, so there are plenty of paths
+    //which are sub-paths of others.
+    QList<Path> paths = longPaths;
+    for (int i = 0; i < longPaths.size(); ++i)
+    {
+        QList<DeBruijnNode *> nodes = longPaths[i].getNodes();
+        for (int j = 1; j < nodes.size(); ++j)
+            paths.push_back(Path::makeFromOrderedNodes(nodes.mid(j), false));
+        paths.push_back(Path::makeFromOrderedNodes(nodes.mid(0, nodes.size() - 1), false));
+    }
+
+    //The indexed search must agree with comparing every pair of paths.
+    std::vector<bool> nodeSubsets = Path::findPathsWithNodeSubsets(paths);
+    QCOMPARE(int(nodeSubsets.size()), paths.size());
+    for (int i = 0; i < paths.size(); ++i)
+    {
+        bool hasNodeSubset = false;
+        for (int j = 0; j < paths.size() && !hasNodeSubset; ++j)
+        {
+            if (i != j)
+                hasNodeSubset = paths[i].hasNodeSubset(paths[j]);
+        }
+        QCOMPARE(bool(nodeSubsets[i]), hasNodeSubset);
+    }
+}
+
+
+
+//This test checks that filtering removes exactly the short and low depth nodes
+//and leaves no edges pointing to deleted nodes.
+void BandageTests::filterNodes()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+
+    int minLength = 200;
+    double minDepth = 10.0;
+
+    int expectedRemaining = 0;
+    QMapIterator<QString, DeBruijnNode*> i(g_assemblyGraph->m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        DeBruijnNode * node = i.value();
+        if (node->getLength() >= minLength && node->getDepth() >= minDepth)
+            ++expectedRemaining;
+    }
+
+    int removed = g_assemblyGraph->filterNodes(minLength, minDepth);
+    QCOMPARE(removed > 0, true);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.size(), expectedRemaining);
+
+    //Every remaining edge should connect two remaining nodes, and every edge
+    //on a remaining node should still be in the graph.
+    QMapIterator<QPair<DeBruijnNode*, DeBruijnNode*>, DeBruijnEdge*> j(g_assemblyGraph->m_deBruijnGraphEdges);
+    while (j.hasNext())
+    {
+        j.next();
+        DeBruijnEdge * edge = j.value();
+        QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.contains(edge->getStartingNode()->getName()), true);
+        QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.contains(edge->getEndingNode()->getName()), true);
+    }
+    QMapIterator<QString, DeBruijnNode*> k(g_assemblyGraph->m_deBruijnGraphNodes);
+    while (k.hasNext())
+    {
+        k.next();
+        const std::vector<DeBruijnEdge *> * edges = k.value()->getEdgesPointer();
+        for (size_t l = 0; l < edges->size(); ++l)
+        {
+            DeBruijnEdge * edge = (*edges)[l];
+            QPair<DeBruijnNode*, DeBruijnNode*> key(edge->getStartingNode(), edge->getEndingNode());
+            QCOMPARE(g_assemblyGraph->m_deBruijnGraphEdges.value(key), edge);
+        }
+    }
+}
+
+
+
+//This test checks that partial node name searches (which use the node name
+//index) match a simple search through all node names, including after nodes
+//are renamed and deleted.
+void BandageTests::partialNodeNameSearch()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+
+    QStringList queries;
+    queries << "1" << "2" << "4-" << "13" << "28+" << "1234" << "zzz";
+
+    g_assemblyGraph->changeNodeName("6", "abc6xyz");
+    std::vector<DeBruijnNode*> nodesToDelete;
+    nodesToDelete.push_back(g_assemblyGraph->m_deBruijnGraphNodes["17+"]);
+    g_assemblyGraph->deleteNodes(&nodesToDelete);
+
+    for (int round = 0; round < 2; ++round)
+    {
+        for (int i = 0; i < queries.size(); ++i)
+        {
+            std::vector<DeBruijnNode *> expected;
+            QMapIterator<QString, DeBruijnNode*> j(g_assemblyGraph->m_deBruijnGraphNodes);
+            while (j.hasNext())
+            {
+                j.next();
+                if (j.value()->getName().contains(queries[i]))
+                    expected.push_back(j.value());
+            }
+
+            std::vector<QString> nodesNotInGraph;
+            std::vector<DeBruijnNode *> found = g_assemblyGraph->getNodesFromString(queries[i], false, &nodesNotInGraph);
+            QCOMPARE(found == expected, true);
+            QCOMPARE(nodesNotInGraph.size() == 0, expected.size() > 0);
+        }
+
+        //The second round happens after changes to an index that has
+        //already been built.
+        g_assemblyGraph->changeNodeName("28", "abc28");
+        nodesToDelete.clear();
+        nodesToDelete.push_back(g_assemblyGraph->m_deBruijnGraphNodes["43+"]);
+        g_assemblyGraph->deleteNodes(&nodesToDelete);
+        queries << "abc";
+    }
+
+    std::vector<DeBruijnNode *> renamed = g_assemblyGraph->getNodesFromString("c6x", false);
+    QCOMPARE(int(renamed.size()), 2);
+}
+
+
+
+//This test checks that depth range queries and depth quartiles (which use the
+//depth index) match simple calculations over all nodes, including after node
+//depths are changed.
+void BandageTests::depthRangeIndex()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_assemblyGraph->determineGraphInfo();
+    g_settings->graphScope = DEPTH_RANGE;
+
+    QList<QPair<double, double> > ranges;
+    ranges << QPair<double, double>(0.0, 211.0) << QPair<double, double>(40.0, 211.0)
+           << QPair<double, double>(211.0, 1000.0) << QPair<double, double>(42.3615, 42.3615)
+           << QPair<double, double>(5000.0, 6000.0);
+
+    for (int round = 0; round < 2; ++round)
+    {
+        for (int i = 0; i < ranges.size(); ++i)
+        {
+            g_settings->minDepthRange = ranges[i].first;
+            g_settings->maxDepthRange = ranges[i].second;
+
+            std::vector<DeBruijnNode *> expected;
+            QMapIterator<QString, DeBruijnNode*> j(g_assemblyGraph->m_deBruijnGraphNodes);
+            while (j.hasNext())
+            {
+                j.next();
+                if (j.value()->isInDepthRange(ranges[i].first, ranges[i].second))
+                    expected.push_back(j.value());
+            }
+
+            QString errorTitle;
+            QString errorMessage;
+            std::vector<DeBruijnNode *> found = g_assemblyGraph->getStartingNodes(&errorTitle, &errorMessage, true, "", "");
+            QCOMPARE(found == expected, true);
+            QCOMPARE(errorMessage.isEmpty(), expected.size() > 0);
+        }
+
+        std::vector<double> depths;
+        QMapIterator<QString, DeBruijnNode*> k(g_assemblyGraph->m_deBruijnGraphNodes);
+        while (k.hasNext())
+        {
+            k.next();
+            depths.push_back(k.value()->getDepth());
+        }
+        std::sort(depths.begin(), depths.end());
+        double medianIndex = (depths.size() - 1) / 2.0;
+        double expectedMedian = (depths[floor(medianIndex)] + depths[ceil(medianIndex)]) / 2.0;
+        QCOMPARE(g_assemblyGraph->m_medianDepth, expectedMedian);
+
+        //The second round happens after depth changes to an index that has
+        //already been built.
+        std::vector<DeBruijnNode *> nodesToChange;
+        nodesToChange.push_back(g_assemblyGraph->m_deBruijnGraphNodes["6+"]);
+        nodesToChange.push_back(g_assemblyGraph->m_deBruijnGraphNodes["13+"]);
+        g_assemblyGraph->changeNodeDepth(&nodesToChange, 5500.0);
+    }
+}
+
+
+
+//This test checks the shortest path search against the exhaustive path
+//search, and checks that further paths come in order of length.
+void BandageTests::shortestPaths()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+
+    //There are two paths from 1+ to 38-, which differ only in whether they
+    //pass through 11+ (146 bp) or 10+ (211 bp).  The edges overlap by 77 bp.
+    DeBruijnNode * startNode = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+    DeBruijnNode * endNode = g_assemblyGraph->m_deBruijnGraphNodes["38-"];
+    ShortestPathFinder shortestPathFinder(startNode, endNode);
+    Path shortestPath = shortestPathFinder.getShortestPath();
+    QCOMPARE(shortestPath.getString(false), QString("1+,12-,11+,29-,38-"));
+    QCOMPARE(shortestPath.getLength(), 7290);
+
+    //The exhaustive search should agree.
+    QList<Path> allPaths = Path::getAllPossiblePaths(GraphLocation::startOfNode(startNode),
+                                                     GraphLocation::endOfNode(endNode),
+                                                     6, 0, 1000000);
+    QCOMPARE(allPaths.size(), 2);
+    int shortestLength = std::min(allPaths[0].getLength(), allPaths[1].getLength());
+    QCOMPARE(shortestPath.getLength(), shortestLength);
+
+    //Only the two paths exist, so asking for more gives just those.
+    QList<Path> paths = shortestPathFinder.getShortestPaths(5);
+    QCOMPARE(paths.size(), 2);
+    QCOMPARE(paths.front() == shortestPath, true);
+    QCOMPARE(paths[1].getString(false), QString("1+,12-,10+,29-,38-"));
+    QCOMPARE(paths[1].getLength(), 7355);
+    for (int i = 0; i < paths.size(); ++i)
+    {
+        QList<DeBruijnNode *> nodes = paths[i].getNodes();
+        QCOMPARE(nodes.front(), startNode);
+        QCOMPARE(nodes.back(), endNode);
+        QSet<DeBruijnNode *> uniqueNodes;
+        for (int j = 0; j < nodes.size(); ++j)
+            uniqueNodes.insert(nodes[j]);
+        QCOMPARE(uniqueNodes.size(), nodes.size());
+        if (i > 0)
+        {
+            QVERIFY(paths[i].getLength() >= paths[i - 1].getLength());
+            QCOMPARE(paths[i] == paths[i - 1], false);
+        }
+    }
+
+    //Once the edges into the end node are removed, there is no path to it.
+    std::vector<DeBruijnEdge *> enteringEdges = endNode->getEnteringEdges();
+    QCOMPARE(enteringEdges.empty(), false);
+    g_assemblyGraph->deleteEdges(&enteringEdges);
+    QCOMPARE(ShortestPathFinder(startNode, endNode).getShortestPaths(3).size(), 0);
+}
+
+
+
+//This test checks the superbubbles found in a small graph, and that they
+//don't depend on the number of threads.
+void BandageTests::superbubbles()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+
+    g_settings->threads = 1;
+    std::vector<Superbubble> superbubbles = g_assemblyGraph->findSuperbubbles();
+    QCOMPARE(int(superbubbles.size()), 4);
+
+    //Each superbubble is only reported for one strand, and those which are
+    //their own reverse complement (like 44- to 44+) are reported once.
+    QCOMPARE(superbubbles[0].entrance->getName(), QString("12-"));
+    QCOMPARE(superbubbles[0].exit->getName(), QString("29-"));
+    QCOMPARE(superbubbles[1].entrance->getName(), QString("27+"));
+    QCOMPARE(superbubbles[1].exit->getName(), QString("28-"));
+    QCOMPARE(superbubbles[2].entrance->getName(), QString("30+"));
+    QCOMPARE(superbubbles[2].exit->getName(), QString("30-"));
+    QCOMPARE(superbubbles[3].entrance->getName(), QString("44-"));
+    QCOMPARE(superbubbles[3].exit->getName(), QString("44+"));
+
+    QSet<QString> internalNodeNames;
+    for (size_t i = 0; i < superbubbles[0].internalNodes.size(); ++i)
+        internalNodeNames.insert(superbubbles[0].internalNodes[i]->getName());
+    QCOMPARE(internalNodeNames.size(), 2);
+    QCOMPARE(internalNodeNames.contains("10+"), true);
+    QCOMPARE(internalNodeNames.contains("11+"), true);
+    QCOMPARE(int(superbubbles[3].internalNodes.size()), 8);
+
+    for (size_t i = 0; i < superbubbles.size(); ++i)
+        QVERIFY(superbubbles[i].shortestPathLength <= superbubbles[i].longestPathLength);
+
+    //A maximum bubble size smaller than the big bubble excludes it, and the
+    //searches which stopped at that size are counted.
+    int truncatedSearchCount = -1;
+    g_assemblyGraph->findSuperbubbles(&truncatedSearchCount);
+    QCOMPARE(truncatedSearchCount, 0);
+    g_settings->maxBubbleNodes = 5;
+    QCOMPARE(int(g_assemblyGraph->findSuperbubbles(&truncatedSearchCount).size()), 3);
+    QCOMPARE(truncatedSearchCount > 0, true);
+    g_settings->maxBubbleNodes = 1000;
+
+    g_settings->threads = 4;
+    std::vector<Superbubble> threadedSuperbubbles = g_assemblyGraph->findSuperbubbles();
+    QCOMPARE(threadedSuperbubbles.size(), superbubbles.size());
+    for (size_t i = 0; i < superbubbles.size(); ++i)
+    {
+        QCOMPARE(threadedSuperbubbles[i].entrance, superbubbles[i].entrance);
+        QCOMPARE(threadedSuperbubbles[i].exit, superbubbles[i].exit);
+        QCOMPARE(threadedSuperbubbles[i].shortestPathLength, superbubbles[i].shortestPathLength);
+        QCOMPARE(threadedSuperbubbles[i].longestPathLength, superbubbles[i].longestPathLength);
+    }
+
+    //The bubbles graph scope uses the nodes from both strands.  The 27+ to
+    //28- bubble is inside the 44- to 44+ bubble, so those share nodes.
+    std::vector<DeBruijnNode *> nodesInBubbles = g_assemblyGraph->getNodesInSuperbubbles();
+    QCOMPARE(int(nodesInBubbles.size()), 22);
+}
+
+
+
+//This test checks each of the graph cleaning passes.  The test graph has a
+//10 kbp node and seven 1 kbp nodes, all with the same depth, and five dead
+//end nodes (2, 3, 5, 7 and 8) which could be tips.
+void BandageTests::graphCleaning()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test_query_paths.gfa");
+
+    //Tips must be shorter than the maximum length to be clipped.
+    GraphCleaner unchangedCleaner(g_assemblyGraph);
+    unchangedCleaner.clipTips(1000);
+    unchangedCleaner.pruneLowDepth(0.5);
+    unchangedCleaner.removeSmallComponents(17000);
+    std::vector<GraphCleaningPass> passes = unchangedCleaner.getPasses();
+    QCOMPARE(int(passes.size()), 3);
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        QCOMPARE(passes[i].nodesRemoved, 0);
+        QCOMPARE(passes[i].edgesRemoved, 0);
+    }
+
+    //Nodes 7 and 8 are competing tips on node 6, so only one of them is
+    //clipped.  That leaves a single unitig to merge.
+    GraphCleaner tipCleaner(g_assemblyGraph);
+    tipCleaner.clipTips(1001);
+    QCOMPARE(tipCleaner.isNodeRemoved(g_assemblyGraph->m_deBruijnGraphNodes["2+"]), true);
+    QCOMPARE(tipCleaner.isNodeRemoved(g_assemblyGraph->m_deBruijnGraphNodes["3-"]), true);
+    QCOMPARE(tipCleaner.isNodeRemoved(g_assemblyGraph->m_deBruijnGraphNodes["5+"]), true);
+    QCOMPARE(tipCleaner.isNodeRemoved(g_assemblyGraph->m_deBruijnGraphNodes["7+"]), true);
+    QCOMPARE(tipCleaner.isNodeRemoved(g_assemblyGraph->m_deBruijnGraphNodes["8+"]), false);
+    tipCleaner.deleteRemovedNodesAndEdges();
+    tipCleaner.mergeUnitigs();
+    passes = tipCleaner.getPasses();
+    QCOMPARE(passes[0].nodesRemoved, 4);
+    QCOMPARE(passes[0].edgesRemoved, 4);
+    QCOMPARE(passes[0].lengthRemoved, 4000LL);
+    QCOMPARE(passes[1].nodesRemoved, 3);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.size(), 2);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.first()->getLength(), 13000);
+
+    //A node with a low depth relative to the rest is pruned, along with its
+    //edge.
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test_query_paths.gfa");
+    std::vector<DeBruijnNode *> lowDepthNodes;
+    lowDepthNodes.push_back(g_assemblyGraph->m_deBruijnGraphNodes["5+"]);
+    g_assemblyGraph->changeNodeDepth(&lowDepthNodes, 0.5);
+    GraphCleaner depthCleaner(g_assemblyGraph);
+    depthCleaner.pruneLowDepth(0.1);
+    passes = depthCleaner.getPasses();
+    QCOMPARE(passes[0].nodesRemoved, 1);
+    QCOMPARE(passes[0].edgesRemoved, 1);
+
+    //The whole graph is a single 17 kbp component.
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test_query_paths.gfa");
+    GraphCleaner componentCleaner(g_assemblyGraph);
+    componentCleaner.removeSmallComponents(17001);
+    componentCleaner.deleteRemovedNodesAndEdges();
+    QCOMPARE(componentCleaner.getPasses()[0].nodesRemoved, 8);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.size(), 0);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphEdges.size(), 0);
+}
+
+
+//The graph statistics are updated with each edit, and they should always
+//match statistics built from scratch.
+void BandageTests::incrementalGraphStatistics()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+    QCOMPARE(g_assemblyGraph->m_nodeCount, 44);
+
+    g_assemblyGraph->duplicateNodePair(g_assemblyGraph->m_deBruijnGraphNodes["26+"], 0);
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+    QCOMPARE(g_assemblyGraph->m_nodeCount, 45);
+
+    std::vector<DeBruijnEdge *> edgesToRemove;
+    edgesToRemove.push_back(getEdgeFromNodeNames("26_copy+", "24+"));
+    edgesToRemove.push_back(getEdgeFromNodeNames("6+", "26+"));
+    edgesToRemove.push_back(getEdgeFromNodeNames("26+", "23+"));
+    edgesToRemove.push_back(getEdgeFromNodeNames("23+", "26_copy+"));
+    g_assemblyGraph->deleteEdges(&edgesToRemove);
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+
+    g_assemblyGraph->mergeAllPossible();
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+
+    std::vector<DeBruijnNode *> nodes;
+    nodes.push_back(g_assemblyGraph->m_deBruijnGraphNodes["6_26_copy_23_26_24+"]);
+    nodes.push_back(g_assemblyGraph->m_deBruijnGraphNodes.first());
+    g_assemblyGraph->changeNodeDepth(&nodes, 123.4);
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+
+    std::vector<DeBruijnNode *> nodesToDelete;
+    nodesToDelete.push_back(g_assemblyGraph->m_deBruijnGraphNodes.first());
+    nodesToDelete.push_back(g_assemblyGraph->m_deBruijnGraphNodes.last());
+    g_assemblyGraph->deleteNodes(&nodesToDelete);
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+    QCOMPARE(g_assemblyGraph->m_nodeCount, int(g_assemblyGraph->m_deBruijnGraphNodes.size()) / 2);
+}
+
+
+//A whole series of edits, recorded as one, should be fully undone and redone,
+//with the graph statistics following along.
+void BandageTests::graphEditUndoRedo()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    int nodeCount = g_assemblyGraph->m_deBruijnGraphNodes.size();
+    int edgeCount = g_assemblyGraph->m_deBruijnGraphEdges.size();
+    double depth6 = g_assemblyGraph->m_deBruijnGraphNodes["6+"]->getDepth();
+    QCOMPARE(g_assemblyGraph->getEditJournal()->canUndo(), false);
+
+    g_assemblyGraph->beginEdit("Test edit");
+    g_assemblyGraph->duplicateNodePair(g_assemblyGraph->m_deBruijnGraphNodes["26+"], 0);
+    std::vector<DeBruijnEdge *> edgesToRemove;
+    edgesToRemove.push_back(getEdgeFromNodeNames("26_copy+", "24+"));
+    edgesToRemove.push_back(getEdgeFromNodeNames("6+", "26+"));
+    edgesToRemove.push_back(getEdgeFromNodeNames("26+", "23+"));
+    edgesToRemove.push_back(getEdgeFromNodeNames("23+", "26_copy+"));
+    g_assemblyGraph->deleteEdges(&edgesToRemove);
+    g_assemblyGraph->mergeAllPossible();
+    std::vector<DeBruijnNode *> nodes;
+    nodes.push_back(g_assemblyGraph->m_deBruijnGraphNodes["6_26_copy_23_26_24+"]);
+    g_assemblyGraph->changeNodeDepth(&nodes, 123.4);
+    g_assemblyGraph->changeNodeName("6_26_copy_23_26_24", "merged");
+    g_assemblyGraph->endEdit();
+
+    int editedNodeCount = g_assemblyGraph->m_deBruijnGraphNodes.size();
+    int editedEdgeCount = g_assemblyGraph->m_deBruijnGraphEdges.size();
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.contains("merged+"), true);
+    QCOMPARE(g_assemblyGraph->getEditJournal()->getUndoCount(), 1);
+    QCOMPARE(g_assemblyGraph->getEditJournal()->getUndoDescription(), QString("Test edit"));
+
+    QCOMPARE(g_assemblyGraph->undoEdit(), true);
+    QCOMPARE(int(g_assemblyGraph->m_deBruijnGraphNodes.size()), nodeCount);
+    QCOMPARE(int(g_assemblyGraph->m_deBruijnGraphEdges.size()), edgeCount);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.contains("merged+"), false);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.contains("26_copy+"), false);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["6+"]->getDepth(), depth6);
+    QCOMPARE(getEdgeFromNodeNames("6+", "26+") != 0, true);
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+    QCOMPARE(g_assemblyGraph->undoEdit(), false);
+
+    QCOMPARE(g_assemblyGraph->redoEdit(), true);
+    QCOMPARE(int(g_assemblyGraph->m_deBruijnGraphNodes.size()), editedNodeCount);
+    QCOMPARE(int(g_assemblyGraph->m_deBruijnGraphEdges.size()), editedEdgeCount);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["merged+"]->getDepth(), 123.4);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes["merged-"]->getDepth(), 123.4);
+    QCOMPARE(doGraphStatisticsMatchFreshBuild(), true);
+
+    //A new edit after an undo makes the redo history obsolete.
+    g_assemblyGraph->undoEdit();
+    QCOMPARE(g_assemblyGraph->getEditJournal()->canRedo(), true);
+    g_assemblyGraph->beginEdit("Second edit");
+    nodes.clear();
+    nodes.push_back(g_assemblyGraph->m_deBruijnGraphNodes["6+"]);
+    g_assemblyGraph->changeNodeDepth(&nodes, 5.0);
+    g_assemblyGraph->endEdit();
+    QCOMPARE(g_assemblyGraph->getEditJournal()->canRedo(), false);
+    QCOMPARE(g_assemblyGraph->getEditJournal()->getUndoCount(), 1);
+
+    //A change made outside of an edit makes the whole history obsolete, as
+    //it may refer to what the change deleted.
+    edgesToRemove.clear();
+    edgesToRemove.push_back(getEdgeFromNodeNames("6+", "26+"));
+    g_assemblyGraph->deleteEdges(&edgesToRemove);
+    QCOMPARE(g_assemblyGraph->getEditJournal()->canUndo(), false);
+    QCOMPARE(g_assemblyGraph->undoEdit(), false);
+    g_assemblyGraph->beginEdit("Depth edit");
+    g_assemblyGraph->changeNodeDepth(&nodes, 5.5);
+    g_assemblyGraph->endEdit();
+    g_assemblyGraph->changeNodeDepth(&nodes, 7.0);
+    QCOMPARE(g_assemblyGraph->getEditJournal()->canUndo(), false);
+
+    //An edit which doesn't fit in the memory budget isn't kept.
+    g_settings->editHistoryMemory = 0;
+    g_assemblyGraph->beginEdit("Third edit");
+    g_assemblyGraph->changeNodeDepth(&nodes, 6.0);
+    g_assemblyGraph->endEdit();
+    QCOMPARE(g_assemblyGraph->getEditJournal()->canUndo(), false);
+    QCOMPARE(g_assemblyGraph->getEditJournal()->getMemoryUsed(), 0LL);
+}
+
+
+
+void BandageTests::graphCoarsening()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    int nodeCount = g_assemblyGraph->m_deBruijnGraphNodes.size() / 2;
+    long long totalLength = g_assemblyGraph->m_totalLength;
+
+    GraphCoarsener graphCoarsener(g_assemblyGraph.data());
+    graphCoarsener.setLevel(20);
+    QCOMPARE(graphCoarsener.getNodeCount(0), nodeCount);
+    QCOMPARE(graphCoarsener.getNodeCount(1) < nodeCount, true);
+    for (int i = 1; i < graphCoarsener.getLevelCount(); ++i)
+        QCOMPARE(graphCoarsener.getNodeCount(i) <= graphCoarsener.getNodeCount(i - 1), true);
+
+    //Each level's graph has one node pair per node at that level, and the
+    //super-nodes hold the length of the nodes they replace.
+    for (int level = 0; level < graphCoarsener.getLevelCount(); ++level)
+    {
+        graphCoarsener.setLevel(level);
+        AssemblyGraph levelGraph;
+        graphCoarsener.buildLevelGraph(&levelGraph);
+        QCOMPARE(levelGraph.m_deBruijnGraphNodes.size() / 2, graphCoarsener.getNodeCount(level));
+        QCOMPARE(levelGraph.m_totalLength, totalLength);
+        levelGraph.cleanUp();
+    }
+
+    //Expanding a super-node shows its children in its place.
+    graphCoarsener.setLevel(1);
+    AssemblyGraph chainGraph;
+    graphCoarsener.buildLevelGraph(&chainGraph);
+    QString superNodeName;
+    QMapIterator<QString, DeBruijnNode*> i(chainGraph.m_deBruijnGraphNodes);
+    while (i.hasNext())
+    {
+        i.next();
+        QString nodeName = i.value()->getNameWithoutSign();
+        if (graphCoarsener.isSuperNode(nodeName))
+            superNodeName = nodeName;
+    }
+    QCOMPARE(superNodeName.isEmpty(), false);
+    QCOMPARE(graphCoarsener.expandNode(superNodeName), true);
+    QCOMPARE(graphCoarsener.expandNode(superNodeName), false);
+    AssemblyGraph expandedGraph;
+    graphCoarsener.buildLevelGraph(&expandedGraph);
+    QCOMPARE(expandedGraph.m_deBruijnGraphNodes.size() > chainGraph.m_deBruijnGraphNodes.size(), true);
+    QCOMPARE(expandedGraph.m_totalLength, totalLength);
+    chainGraph.cleanUp();
+    expandedGraph.cleanUp();
+}
+
+
+
+void BandageTests::sequenceIndexFind()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    DeBruijnNode * node1 = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+
+    //A sequence from inside a node is found in that node, on that strand.
+    QByteArray sequence = node1->getSequence().mid(100, 50);
+    std::vector<SequenceHit> hits = g_assemblyGraph->findSequence(sequence, 0);
+    bool foundInNode = false;
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        if (hits[i].nodes.size() == 1 && hits[i].nodes[0] == node1 &&
+                hits[i].startPosition == 101 && hits[i].endPosition == 150)
+            foundInNode = true;
+        QCOMPARE(hits[i].mismatches, 0);
+    }
+    QCOMPARE(foundInNode, true);
+    QCOMPARE(g_assemblyGraph->getSequenceIndex()->isBuilt(), true);
+
+    //A sequence which runs over an edge is found as a path of both nodes.
+    DeBruijnEdge * edge = node1->getLeavingEdges()[0];
+    DeBruijnNode * nextNode = edge->getEndingNode();
+    int overlap = edge->getOverlap();
+    QByteArray spanningSequence = node1->getSequence().right(overlap + 20) + nextNode->getSequence().mid(overlap, 20);
+    hits = g_assemblyGraph->findSequence(spanningSequence, 0);
+    bool foundOverEdge = false;
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        if (hits[i].nodes.size() == 2 && hits[i].nodes[0] == node1 && hits[i].nodes[1] == nextNode &&
+                hits[i].startPosition == node1->getLength() - overlap - 19 &&
+                hits[i].endPosition == overlap + 20)
+            foundOverEdge = true;
+    }
+    QCOMPARE(foundOverEdge, true);
+
+    //A mismatch is only allowed for if asked for.
+    QByteArray mismatchSequence = sequence;
+    mismatchSequence[25] = (mismatchSequence[25] == 'A') ? 'C' : 'A';
+    QCOMPARE(g_assemblyGraph->findSequence(mismatchSequence, 0).size(), size_t(0));
+    hits = g_assemblyGraph->findSequence(mismatchSequence, 1);
+    QCOMPARE(hits.size() > 0, true);
+    QCOMPARE(hits[0].mismatches, 1);
+
+    //The index is rebuilt when the graph changes.
+    std::vector<DeBruijnEdge *> edgesToRemove;
+    edgesToRemove.push_back(edge);
+    g_assemblyGraph->deleteEdges(&edgesToRemove);
+    hits = g_assemblyGraph->findSequence(spanningSequence, 0);
+    for (size_t i = 0; i < hits.size(); ++i)
+        QCOMPARE(hits[i].nodes.size() == 2 && hits[i].nodes[0] == node1 && hits[i].nodes[1] == nextNode, false);
+
+    //No junction in this graph has too many paths to index.
+    QCOMPARE(g_assemblyGraph->getSequenceIndex()->getTruncatedJunctionCount(), 0);
+
+    //Here a node is followed by eight layers of two one-base nodes, which is
+    //256 paths from its end, so its junction can't be fully indexed and this
+    //is counted.
+    QString tangleFilename = "bandage_temp-tangle-" + QString::number(QApplication::applicationPid()) + ".gfa";
+    QFile tangleFile(tangleFilename);
+    tangleFile.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream tangleOut(&tangleFile);
+    tangleOut << "S\t1\tGAGCCGAGGGGTAACCACGATGCCGCTAAGAACCTCTCGGTCGACGCAAGCGATTACACT\n";
+    tangleOut << "S\t18\tCCTGTCACATCATAATCGTTTGCTATTCAGGGGTTGACCAACACCGGAAAACTTTTCACT\n";
+    for (int i = 0; i < 8; ++i)
+    {
+        tangleOut << "S\t" << 2 + 2 * i << "\tA\n";
+        tangleOut << "S\t" << 3 + 2 * i << "\tC\n";
+        for (int j = 0; j < 2; ++j)
+        {
+            QString previous = (i == 0) ? "1" : QString::number(2 * i + j);
+            tangleOut << "L\t" << previous << "\t+\t" << 2 + 2 * i << "\t+\t0M\n";
+            tangleOut << "L\t" << previous << "\t+\t" << 3 + 2 * i << "\t+\t0M\n";
+            if (i == 0)
+                break;
+        }
+    }
+    tangleOut << "L\t16\t+\t18\t+\t0M\n";
+    tangleOut << "L\t17\t+\t18\t+\t0M\n";
+    tangleOut.flush();
+    tangleFile.close();
+
+    g_assemblyGraph->loadGraphFromFile(tangleFilename);
+    QFile::remove(tangleFilename);
+    QCOMPARE(g_assemblyGraph->m_deBruijnGraphNodes.size(), 36);
+    QCOMPARE(g_assemblyGraph->getSequenceIndex()->getTruncatedJunctionCount() > 0, true);
+}
+
+
+//The built-in aligner should find the same differences as BLAST, and give
+//the path of a query which runs over an edge without a path search.
+void BandageTests::builtInAligner()
+{
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_settings->blastQueryFilename = getTestDirectory() + "test_queries1.fasta";
+    g_settings->blastAligner = BUILT_IN_ALIGNER;
+    createBlastTempDirectory();
+
+    QCOMPARE(g_blastSearch->doAutoBlastSearch(), QString(""));
+
+    BlastQuery * exact = g_blastSearch->m_blastQueries.getQueryFromName("test_query_exact");
+    BlastQuery * one_mismatch = g_blastSearch->m_blastQueries.getQueryFromName("test_query_one_mismatch");
+    BlastQuery * one_insertion = g_blastSearch->m_blastQueries.getQueryFromName("test_query_one_insertion");
+    BlastQuery * one_deletion = g_blastSearch->m_blastQueries.getQueryFromName("test_query_one_deletion");
+
+    BlastHit exactHit = exact->getHit(0);
+    BlastHit one_mismatchHit = one_mismatch->getHit(0);
+    BlastHit one_insertionHit = one_insertion->getHit(0);
+    BlastHit one_deletionHit = one_deletion->getHit(0);
+
+    QCOMPARE(exactHit.m_node->getName(), QString("2+"));
+    QCOMPARE(exactHit.m_nodeStart, 3557);
+    QCOMPARE(exactHit.m_nodeEnd, 3656);
+    QCOMPARE(exactHit.m_queryStart, 1);
+    QCOMPARE(exactHit.m_queryEnd, 100);
+    QCOMPARE(exactHit.m_numberMismatches, 0);
+    QCOMPARE(exactHit.m_numberGapOpens, 0);
+    QCOMPARE(one_mismatchHit.m_numberMismatches, 1);
+    QCOMPARE(one_mismatchHit.m_numberGapOpens, 0);
+    QCOMPARE(one_insertionHit.m_numberMismatches, 0);
+    QCOMPARE(one_insertionHit.m_numberGapOpens, 1);
+    QCOMPARE(one_deletionHit.m_numberMismatches, 0);
+    QCOMPARE(one_deletionHit.m_numberGapOpens, 1);
+    QCOMPARE(exactHit.m_bitScore > one_mismatchHit.m_bitScore, true);
+    QCOMPARE(exactHit.m_eValue < one_mismatchHit.m_eValue, true);
+
+    //A query with a mismatch and an insertion, which runs from the end of one
+    //node into the next, gives a path through both nodes.
+    DeBruijnNode * node1 = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+    DeBruijnEdge * edge = node1->getLeavingEdges()[0];
+    DeBruijnNode * nextNode = edge->getEndingNode();
+    QByteArray firstPart = node1->getSequence().right(200);
+    firstPart[50] = (firstPart[50] == 'A') ? 'C' : 'A';
+    firstPart.insert(120, 'T');
+    QByteArray secondPart = nextNode->getSequence().mid(edge->getOverlap(), 150);
+    g_blastSearch->m_blastQueries.addQuery(new BlastQuery("spanning", QString::fromLatin1(firstPart + secondPart)));
+
+    g_blastSearch->clearBlastHits();
+    RunBlastSearchWorker runBlastSearchWorker("", "", "");
+    runBlastSearchWorker.runBlastSearch();
+    QCOMPARE(runBlastSearchWorker.m_error, QString(""));
+
+    BlastQuery * spanning = g_blastSearch->m_blastQueries.getQueryFromName("spanning");
+    QCOMPARE(spanning->getPathCount() > 0, true);
+    Path path = spanning->getPaths().at(0).getPath();
+    QCOMPARE(path.getNodes().size(), 2);
+    QCOMPARE(path.getNodes().at(0), node1);
+    QCOMPARE(path.getNodes().at(1), nextNode);
+    QCOMPARE(path.getStartLocation().getPosition(), node1->getLength() - 199);
+
+    deleteBlastTempDirectory();
+}
+
+
+void BandageTests::queryBatch()
+{
+    createGlobals();
+    g_settings->blastAligner = BUILT_IN_ALIGNER;
+    createBlastTempDirectory();
+    QString batchDirectory = "bandage_temp-querybatch-" + QString::number(QApplication::applicationPid());
+    QDir().mkdir(batchDirectory);
+
+    QString manifestFilename = batchDirectory + "/manifest.tsv";
+    QFile manifestFile(manifestFilename);
+    manifestFile.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream manifestOut(&manifestFile);
+    manifestOut << "#graph\tqueries\tname\n";
+    manifestOut << getTestDirectory() << "test.fastg\t" << getTestDirectory() << "test_queries1.fasta\n";
+    manifestOut << "\n";
+    manifestOut << getTestDirectory() << "test_query_paths.gfa\t" << getTestDirectory() << "test_query_paths.fasta\tpaths\n";
+    manifestOut << getTestDirectory() << "test.LastGraph\t" << getTestDirectory() << "test_queries1.fasta\tlastgraph\n";
+    manifestOut.flush();
+    manifestFile.close();
+
+    std::vector<QueryBatchEntry> entries;
+    QCOMPARE(loadQueryBatchManifest(manifestFilename, &entries), QString(""));
+    QCOMPARE(int(entries.size()), 3);
+    QCOMPARE(entries[0].graphName, getTestDirectory() + "test.fastg");
+    QCOMPARE(entries[1].graphName, QString("paths"));
+    QCOMPARE(entries[2].graphName, QString("lastgraph"));
+    QCOMPARE(entries[0].queriesFilename, entries[2].queriesFilename);
+
+    //Each graph's query paths go in a table which starts with a graph column.
+    QueryBatchQueryCache queryCache;
+    QString tableFilename = batchDirectory + "/0.tsv";
+    QCOMPARE(runQueryBatchEntry(entries[0], &queryCache, tableFilename), QString(""));
+    int pathCount = g_blastSearch->m_blastQueries.getQueryPathCount();
+    QCOMPARE(pathCount > 0, true);
+    QFile tableFile(tableFilename);
+    tableFile.open(QIODevice::ReadOnly | QIODevice::Text);
+    QStringList lines = QString(tableFile.readAll()).split("\n", Qt::SkipEmptyParts);
+    tableFile.close();
+    QCOMPARE(lines.size(), pathCount + 1);
+    QCOMPARE(lines[0].startsWith("Graph\tQuery\tPath\t"), true);
+    QCOMPARE(lines[1].startsWith(entries[0].graphName + "\ttest_query_"), true);
+
+    //The graphs are searched one after another in the same process, and a
+    //queries file used for two graphs is only read once.
+    QCOMPARE(runQueryBatchEntry(entries[1], &queryCache, batchDirectory + "/1.tsv"), QString(""));
+    QCOMPARE(g_assemblyGraph->m_filename.endsWith("test_query_paths.gfa"), true);
+    QCOMPARE(runQueryBatchEntry(entries[2], &queryCache, batchDirectory + "/2.tsv"), QString(""));
+    QCOMPARE(queryCache.size(), 2);
+    QCOMPARE(int(g_blastSearch->m_blastQueries.m_queries.size()), 4);
+
+    //A line without a queries file or a repeated line is an error.
+    QString badManifestFilename = batchDirectory + "/bad_manifest.tsv";
+    QFile badManifestFile(badManifestFilename);
+    badManifestFile.open(QIODevice::WriteOnly | QIODevice::Text);
+    QTextStream badManifestOut(&badManifestFile);
+    badManifestOut << getTestDirectory() << "test.fastg\n";
+    badManifestOut.flush();
+    badManifestFile.close();
+    QCOMPARE(loadQueryBatchManifest(badManifestFilename, &entries).startsWith("line 1 "), true);
+
+    badManifestFile.open(QIODevice::WriteOnly | QIODevice::Text);
+    badManifestOut << getTestDirectory() << "test.fastg\t" << getTestDirectory() << "test_queries1.fasta\n";
+    badManifestOut << getTestDirectory() << "test.fastg\t" << getTestDirectory() << "test_queries1.fasta\tagain\n";
+    badManifestOut.flush();
+    badManifestFile.close();
+    QCOMPARE(loadQueryBatchManifest(badManifestFilename, &entries).startsWith("line 2 "), true);
+
+    QDir(batchDirectory).removeRecursively();
+    deleteBlastTempDirectory();
+}
+
+
+//The built-in aligner should find protein queries in the graph's six-frame
+//translation, giving hits in bases and a path over an edge.
+void BandageTests::builtInAlignerProtein()
+{
+    QCOMPARE(TranslatedIndex::translate("ATGGCCTAA", 9), QByteArray("MA*"));
+    QCOMPARE(TranslatedIndex::translate("ATGNNNTAC", 8), QByteArray("MX"));
+
+    createGlobals();
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test.fastg");
+    g_settings->blastAligner = BUILT_IN_ALIGNER;
+    createBlastTempDirectory();
+
+    //The query is the translation of a sequence which runs from the end of
+    //one node into the next, with the junction between two codons.
+    DeBruijnNode * node1 = g_assemblyGraph->m_deBruijnGraphNodes["1+"];
+    DeBruijnEdge * edge = node1->getLeavingEdges()[0];
+    DeBruijnNode * nextNode = edge->getEndingNode();
+    QByteArray sequence = node1->getSequence().right(300) + nextNode->getSequence().mid(edge->getOverlap(), 150);
+    QByteArray peptide = TranslatedIndex::translate(sequence.constData(), sequence.length());
+    g_blastSearch->m_blastQueries.addQuery(new BlastQuery("protein", QString::fromLatin1(peptide)));
+
+    RunBlastSearchWorker runBlastSearchWorker("", "", "");
+    runBlastSearchWorker.runBlastSearch();
+    QCOMPARE(runBlastSearchWorker.m_error, QString(""));
+
+    BlastQuery * protein = g_blastSearch->m_blastQueries.getQueryFromName("protein");
+    QCOMPARE(protein->getSequenceType(), PROTEIN);
+    QCOMPARE(g_assemblyGraph->getTranslatedIndex()->isBuilt(), true);
+
+    bool foundNode1Hit = false;
+    for (int i = 0; i < protein->hitCount(); ++i)
+    {
+        BlastHit hit = protein->getHit(i);
+        if (hit.m_node == node1 && hit.m_queryStart == 1)
+        {
+            QCOMPARE(hit.m_nodeStart, node1->getLength() - 299);
+            QCOMPARE(hit.m_nodeEnd, node1->getLength());
+            QCOMPARE(hit.m_queryEnd, 100);
+            foundNode1Hit = true;
+        }
+    }
+    QCOMPARE(foundNode1Hit, true);
+
+    QCOMPARE(protein->getPathCount() > 0, true);
+    Path path = protein->getPaths().at(0).getPath();
+    QCOMPARE(path.getNodes().size(), 2);
+    QCOMPARE(path.getNodes().at(0), node1);
+    QCOMPARE(path.getNodes().at(1), nextNode);
+    QCOMPARE(path.getStartLocation().getPosition(), node1->getLength() - 299);
+
+    deleteBlastTempDirectory();
+
+    //This graph's edges have no overlap, so some windows at the end of a node
+    //have their minimizer in the next node.  Every minimizer should still be
+    //recorded inside the node where its k-mer starts.
+    g_assemblyGraph->loadGraphFromFile(getTestDirectory() + "test_query_paths.gfa");
+    const SequenceIndex * sequenceIndex = g_assemblyGraph->getSequenceIndex();
+    TranslatedIndex translatedIndex;
+    translatedIndex.build(sequenceIndex, 1);
+    std::vector<MinimizerEntry> entries = translatedIndex.translateNodes(0, sequenceIndex->getNodeCount() - 1);
+    QCOMPARE(entries.empty(), false);
+    bool allEntriesInNodes = true;
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        if (entries[i].position < 0 || entries[i].position >= sequenceIndex->getNodeSequence(entries[i].node).length())
+            allEntriesInNodes = false;
+    }
+    QCOMPARE(allEntriesInNodes, true);
+}
+
+
+
 
 
 
@@ -1584,6 +3053,33 @@ bool BandageTests::doCircularSequencesMatch(QByteArray s1, QByteArray s2)
 }
 
 
+//This function refreshes the graph info from the incrementally updated
+//statistics and checks it against statistics built from the whole graph.
+bool BandageTests::doGraphStatisticsMatchFreshBuild()
+{
+    g_assemblyGraph->updateGraphInfo();
+
+    GraphStatistics fresh;
+    fresh.build(g_assemblyGraph->m_deBruijnGraphNodes, g_assemblyGraph->m_deBruijnGraphEdges);
+
+    int n50 = 0, shortestNode = 0, firstQuartile = 0, median = 0, thirdQuartile = 0, longestNode = 0;
+    g_assemblyGraph->getNodeStats(&n50, &shortestNode, &firstQuartile, &median, &thirdQuartile, &longestNode);
+    int freshN50 = 0, freshShortestNode = 0, freshFirstQuartile = 0, freshMedian = 0, freshThirdQuartile = 0, freshLongestNode = 0;
+    fresh.getNodeLengthStats(&freshN50, &freshShortestNode, &freshFirstQuartile, &freshMedian, &freshThirdQuartile, &freshLongestNode);
+
+    return g_assemblyGraph->m_nodeCount == fresh.getNodeCount() &&
+            g_assemblyGraph->m_edgeCount == fresh.getEdgeCount() &&
+            g_assemblyGraph->m_totalLength == fresh.getTotalLength() &&
+            g_assemblyGraph->getDeadEndCount() == fresh.getDeadEndCount() &&
+            n50 == freshN50 && shortestNode == freshShortestNode &&
+            firstQuartile == freshFirstQuartile && median == freshMedian &&
+            thirdQuartile == freshThirdQuartile && longestNode == freshLongestNode &&
+            g_assemblyGraph->getMedianDepthByBase() == fresh.getMedianDepthByBase() &&
+            g_assemblyGraph->m_medianDepth == fresh.getDepthQuantile(0.5) &&
+            qAbs(g_assemblyGraph->m_meanDepth - fresh.getMeanDepth()) < 0.000001;
+}
+
+
 
 QTEST_MAIN(BandageTests)
 #include "bandagetests.moc"
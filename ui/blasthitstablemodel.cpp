@@ -0,0 +1,284 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "blasthitstablemodel.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <QColor>
+#include "../blast/blastsearch.h"
+#include "../blast/blasthit.h"
+#include "../blast/blastquery.h"
+#include "../graph/debruijnnode.h"
+#include "../program/globals.h"
+
+static const int HIT_COLUMN_COUNT = 14;
+
+BlastHitsTableModel::BlastHitsTableModel(QObject * parent) :
+    QAbstractTableModel(parent), m_sortColumn(-1), m_sortOrder(Qt::AscendingOrder)
+{
+}
+
+
+int BlastHitsTableModel::rowCount(const QModelIndex & parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return int(m_rowOrder.size());
+}
+
+int BlastHitsTableModel::columnCount(const QModelIndex & parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return HIT_COLUMN_COUNT;
+}
+
+
+int BlastHitsTableModel::getHitId(int row) const
+{
+    if (row < 0 || row >= int(m_rowOrder.size()))
+        return -1;
+    return g_blastSearch->m_allHits.getHitId(m_rowOrder[row]);
+}
+
+
+//The cells' text is only made here, when the view asks for it.
+QVariant BlastHitsTableModel::data(const QModelIndex & index, int role) const
+{
+    int hitId = getHitId(index.row());
+    if (hitId < 0)
+        return QVariant();
+    BlastHit hit = g_blastSearch->m_allHits.getHit(hitId);
+    BlastQuery * hitQuery = hit.m_query;
+    int column = index.column();
+
+    if (role == Qt::BackgroundRole && column == 0)
+        return hitQuery->getColour();
+
+    if (role == Qt::ForegroundRole && column > 0 && hitQuery->isHidden())
+        return QColor(150, 150, 150);
+
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (column)
+    {
+    case 1: return hitQuery->getName();
+    case 2: return hit.m_node->getName();
+    case 3: return formatDoubleForDisplay(hit.m_percentIdentity, 2) + "%";
+    case 4: return formatIntForDisplay(hit.m_alignmentLength);
+    case 5: return formatDoubleForDisplay(100.0 * hit.getQueryCoverageFraction(), 2) + "%";
+    case 6: return formatIntForDisplay(hit.m_numberMismatches);
+    case 7: return formatIntForDisplay(hit.m_numberGapOpens);
+    case 8: return formatIntForDisplay(hit.m_queryStart);
+    case 9: return formatIntForDisplay(hit.m_queryEnd);
+    case 10: return formatIntForDisplay(hit.m_nodeStart);
+    case 11: return formatIntForDisplay(hit.m_nodeEnd);
+    case 12: return hit.m_eValue.asString(false);
+    case 13: return QString::number(hit.m_bitScore);
+    }
+    return QVariant();
+}
+
+
+QVariant BlastHitsTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (section)
+    {
+    case 0: return "";
+    case 1: return "Query\nname";
+    case 2: return "Node\nname";
+    case 3: return "Percent\nidentity";
+    case 4: return "Alignment\nlength";
+    case 5: return "Query\ncover";
+    case 6: return "Mis-\nmatches";
+    case 7: return "Gap\nopens";
+    case 8: return "Query\nstart";
+    case 9: return "Query\nend";
+    case 10: return "Node\nstart";
+    case 11: return "Node\nend";
+    case 12: return "E-\nvalue";
+    case 13: return "Bit\nscore";
+    }
+    return QVariant();
+}
+
+
+Qt::ItemFlags BlastHitsTableModel::flags(const QModelIndex & index) const
+{
+    if (index.column() == 0)
+        return Qt::ItemIsEnabled;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+
+
+//This function makes the rows again from the hit store, keeping the current
+//sort.  It must be called after the store's hits change.
+void BlastHitsTableModel::update()
+{
+    beginResetModel();
+    int hitCount = g_blastSearch->m_allHits.size();
+    m_rowOrder.resize(hitCount);
+    for (int i = 0; i < hitCount; ++i)
+        m_rowOrder[i] = i;
+    sortRowOrder();
+    endResetModel();
+}
+
+
+//This function is called when a query's name, colour or shown status has
+//changed.  The rows are the same, but their cells need drawing again.
+void BlastHitsTableModel::queriesChanged()
+{
+    if (m_rowOrder.empty())
+        return;
+    emit dataChanged(index(0, 0), index(rowCount() - 1, HIT_COLUMN_COUNT - 1));
+
+    //The order may depend on the queries' names or colours.
+    if (m_sortColumn == 0 || m_sortColumn == 1)
+        sort(m_sortColumn, m_sortOrder);
+}
+
+
+//A column of -1 puts the hits back in the store's order.
+void BlastHitsTableModel::sort(int column, Qt::SortOrder order)
+{
+    m_sortColumn = column;
+    m_sortOrder = order;
+
+    emit layoutAboutToBeChanged();
+
+    //The view's persistent indices (e.g. the selection) follow their hits.
+    QModelIndexList oldIndices = persistentIndexList();
+    std::vector<int> oldHitIds;
+    for (int i = 0; i < oldIndices.size(); ++i)
+        oldHitIds.push_back(m_rowOrder[oldIndices[i].row()]);
+
+    sortRowOrder();
+
+    std::vector<int> newRows(m_rowOrder.size());
+    for (size_t i = 0; i < m_rowOrder.size(); ++i)
+        newRows[m_rowOrder[i]] = int(i);
+    QModelIndexList newIndices;
+    for (int i = 0; i < oldIndices.size(); ++i)
+        newIndices.push_back(index(newRows[oldHitIds[i]], oldIndices[i].column()));
+    changePersistentIndexList(oldIndices, newIndices);
+
+    emit layoutChanged();
+}
+
+
+void BlastHitsTableModel::sortRowOrder()
+{
+    if (m_sortColumn < 0 || m_sortColumn >= HIT_COLUMN_COUNT)
+    {
+        std::sort(m_rowOrder.begin(), m_rowOrder.end());
+        return;
+    }
+
+    std::vector<double> keys = getSortKeys(m_sortColumn);
+    if (m_sortOrder == Qt::AscendingOrder)
+        std::stable_sort(m_rowOrder.begin(), m_rowOrder.end(),
+                         [&keys](int a, int b) {return keys[a] < keys[b];});
+    else
+        std::stable_sort(m_rowOrder.begin(), m_rowOrder.end(),
+                         [&keys](int a, int b) {return keys[b] < keys[a];});
+}
+
+
+//This function gives each hit (by its place in the store's order) a number
+//which sorts the same way as the column.  The names and colours are ranked
+//once per query or node, not compared for every pair of hits.  E-values are
+//compared by their logarithms, as they can be too small for a double.
+std::vector<double> BlastHitsTableModel::getSortKeys(int column) const
+{
+    const BlastHitStore & hits = g_blastSearch->m_allHits;
+    int hitCount = hits.size();
+    std::vector<double> keys(hitCount);
+
+    if (column == 0 || column == 1)
+    {
+        std::vector<int> queryIds;
+        for (int i = 0; i < hits.getQueryCount(); ++i)
+        {
+            if (hits.getQueryFromId(i) != 0)
+                queryIds.push_back(i);
+        }
+        if (column == 0)
+            std::sort(queryIds.begin(), queryIds.end(), [&hits](int a, int b)
+                      {return hits.getQueryFromId(a)->getColour().rgba() < hits.getQueryFromId(b)->getColour().rgba();});
+        else
+            std::sort(queryIds.begin(), queryIds.end(), [&hits](int a, int b)
+                      {return hits.getQueryFromId(a)->getName() < hits.getQueryFromId(b)->getName();});
+        std::vector<double> queryRanks(hits.getQueryCount(), 0.0);
+        for (size_t i = 0; i < queryIds.size(); ++i)
+            queryRanks[queryIds[i]] = double(i);
+        for (int i = 0; i < hitCount; ++i)
+            keys[i] = queryRanks[hits.getQueryId(hits.getHitId(i))];
+        return keys;
+    }
+
+    if (column == 2)
+    {
+        std::vector<int> nodeIds(hits.getNodeCount());
+        for (int i = 0; i < hits.getNodeCount(); ++i)
+            nodeIds[i] = i;
+        std::sort(nodeIds.begin(), nodeIds.end(), [&hits](int a, int b)
+                  {return hits.getNodeFromId(a)->getName() < hits.getNodeFromId(b)->getName();});
+        std::vector<double> nodeRanks(hits.getNodeCount());
+        for (size_t i = 0; i < nodeIds.size(); ++i)
+            nodeRanks[nodeIds[i]] = double(i);
+        for (int i = 0; i < hitCount; ++i)
+            keys[i] = nodeRanks[hits.getNodeId(hits.getHitId(i))];
+        return keys;
+    }
+
+    for (int i = 0; i < hitCount; ++i)
+    {
+        int hitId = hits.getHitId(i);
+        switch (column)
+        {
+        case 3: keys[i] = hits.getPercentIdentity(hitId); break;
+        case 4: keys[i] = hits.getAlignmentLength(hitId); break;
+        case 5: keys[i] = hits.getQueryCoverageFraction(hitId); break;
+        case 6: keys[i] = hits.getNumberMismatches(hitId); break;
+        case 7: keys[i] = hits.getNumberGapOpens(hitId); break;
+        case 8: keys[i] = hits.getQueryStart(hitId); break;
+        case 9: keys[i] = hits.getQueryEnd(hitId); break;
+        case 10: keys[i] = hits.getNodeStart(hitId); break;
+        case 11: keys[i] = hits.getNodeEnd(hitId); break;
+        case 12:
+        {
+            SciNot eValue = hits.getEValue(hitId);
+            if (eValue.isZero())
+                keys[i] = -std::numeric_limits<double>::infinity();
+            else
+                keys[i] = eValue.getExponent() + log10(eValue.getCoefficient());
+            break;
+        }
+        case 13: keys[i] = hits.getBitScore(hitId); break;
+        }
+    }
+    return keys;
+}
@@ -0,0 +1,62 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BLASTHITSTABLEMODEL_H
+#define BLASTHITSTABLEMODEL_H
+
+#include <vector>
+#include <QAbstractTableModel>
+
+//This model shows the BLAST search's hits in the BLAST search dialog.  It
+//reads the hits straight from the search's hit store and only formats the
+//cells the view asks for (i.e. the visible rows), so a search with millions
+//of hits costs the table no more than one int per hit: the hit's place in
+//the store's order.  Sorting only reorders these ints, comparing one key per
+//hit taken from the store's column for the sorted field.
+//The model must be updated whenever the store changes.
+class BlastHitsTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    //CREATORS
+    explicit BlastHitsTableModel(QObject * parent = 0);
+
+    //ACCESSORS
+    int rowCount(const QModelIndex & parent = QModelIndex()) const;
+    int columnCount(const QModelIndex & parent = QModelIndex()) const;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex & index) const;
+    int getHitId(int row) const;
+
+    //MODIFERS
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+    void update();
+    void queriesChanged();
+
+private:
+    std::vector<int> m_rowOrder;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+
+    void sortRowOrder();
+    std::vector<double> getSortKeys(int column) const;
+};
+
+#endif // BLASTHITSTABLEMODEL_H
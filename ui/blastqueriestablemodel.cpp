@@ -0,0 +1,272 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "blastqueriestablemodel.h"
+
+#include <algorithm>
+#include <QColor>
+#include <QFont>
+#include "../blast/blastsearch.h"
+#include "../blast/blastquery.h"
+#include "../program/globals.h"
+
+static const int QUERY_COLUMN_COUNT = 8;
+
+BlastQueriesTableModel::BlastQueriesTableModel(QObject * parent) :
+    QAbstractTableModel(parent), m_sortColumn(-1), m_sortOrder(Qt::AscendingOrder)
+{
+}
+
+
+int BlastQueriesTableModel::rowCount(const QModelIndex & parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return int(m_rowOrder.size());
+}
+
+int BlastQueriesTableModel::columnCount(const QModelIndex & parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return QUERY_COLUMN_COUNT;
+}
+
+
+BlastQuery * BlastQueriesTableModel::getQuery(int row) const
+{
+    if (row < 0 || row >= int(m_rowOrder.size()))
+        return 0;
+    return g_blastSearch->m_blastQueries.m_queries[m_rowOrder[row]];
+}
+
+
+//If the search hasn't yet been run, some of the columns will just have a
+//dash.  The path count is shown in a cell which can be clicked to bring up a
+//separate dialog showing a table of the paths.
+QVariant BlastQueriesTableModel::data(const QModelIndex & index, int role) const
+{
+    BlastQuery * query = getQuery(index.row());
+    if (query == 0)
+        return QVariant();
+    const QuerySearchResults & results = m_searchResults[m_rowOrder[index.row()]];
+    int column = index.column();
+
+    if (role == Qt::BackgroundRole && column == 0)
+        return query->getColour();
+
+    if (role == Qt::CheckStateRole && column == 1)
+        return query->isShown() ? Qt::Checked : Qt::Unchecked;
+
+    if (role == Qt::ForegroundRole && column > 1 && query->isHidden())
+        return QColor(150, 150, 150);
+
+    if (column == 7 && results.pathCount > 0)
+    {
+        if (role == Qt::ToolTipRole)
+            return "Click to view the query paths";
+        if (role == Qt::FontRole)
+        {
+            QFont font;
+            font.setUnderline(true);
+            return font;
+        }
+    }
+
+    if (role == Qt::EditRole && column == 2)
+        return query->getName();
+
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (column)
+    {
+    case 2: return query->getName();
+    case 3: return query->getTypeString();
+    case 4: return formatIntForDisplay(query->getLength());
+    case 5: return results.searchedFor ? formatIntForDisplay(results.hitCount) : "-";
+    case 6: return results.searchedFor ? formatDoubleForDisplay(100.0 * results.queryCover, 2) + "%" : "-";
+    case 7: return results.searchedFor ? formatIntForDisplay(results.pathCount) : "-";
+    }
+    return QVariant();
+}
+
+
+QVariant BlastQueriesTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+        return QVariant();
+
+    switch (section)
+    {
+    case 0: return "";
+    case 1: return "Show";
+    case 2: return "Query name";
+    case 3: return "Type";
+    case 4: return "Length";
+    case 5: return "Hits";
+    case 6: return "Query cover";
+    case 7: return "Paths";
+    }
+    return QVariant();
+}
+
+
+Qt::ItemFlags BlastQueriesTableModel::flags(const QModelIndex & index) const
+{
+    switch (index.column())
+    {
+    case 0: return Qt::ItemIsEnabled;
+    case 1: return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+    case 2: return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+
+
+//Editing a query name renames the query.  It's possible that the user gave
+//the query a non-unique name, in which case the cell will show the adjusted
+//name.
+bool BlastQueriesTableModel::setData(const QModelIndex & index, const QVariant & value, int role)
+{
+    BlastQuery * query = getQuery(index.row());
+    if (query == 0)
+        return false;
+
+    if (index.column() == 1 && role == Qt::CheckStateRole)
+        query->setShown(value.toInt() == Qt::Checked);
+    else if (index.column() == 2 && role == Qt::EditRole)
+    {
+        QString newName = value.toString();
+        if (newName == query->getName())
+            return false;
+        g_blastSearch->m_blastQueries.renameQuery(query, newName);
+    }
+    else
+        return false;
+
+    emit dataChanged(this->index(index.row(), 0), this->index(index.row(), QUERY_COLUMN_COUNT - 1));
+    emit queryEdited();
+    return true;
+}
+
+
+
+//This function makes the rows again from the search's queries, keeping the
+//current sort.
+void BlastQueriesTableModel::update()
+{
+    beginResetModel();
+    const std::vector<BlastQuery *> & queries = g_blastSearch->m_blastQueries.m_queries;
+    int queryCount = int(queries.size());
+    m_rowOrder.resize(queryCount);
+    m_searchResults.resize(queryCount);
+    for (int i = 0; i < queryCount; ++i)
+    {
+        m_rowOrder[i] = i;
+        QuerySearchResults & results = m_searchResults[i];
+        results.searchedFor = queries[i]->wasSearchedFor();
+        results.hitCount = results.searchedFor ? queries[i]->hitCount() : 0;
+        results.queryCover = results.searchedFor ? queries[i]->fractionCoveredByHits() : 0.0;
+        results.pathCount = results.searchedFor ? queries[i]->getPathCount() : 0;
+    }
+    sortRowOrder();
+    endResetModel();
+}
+
+
+//This function is called when a query's colour has been changed outside of
+//the model.
+void BlastQueriesTableModel::queriesChanged()
+{
+    if (m_rowOrder.empty())
+        return;
+    emit dataChanged(index(0, 0), index(rowCount() - 1, QUERY_COLUMN_COUNT - 1));
+}
+
+
+//A column of -1 puts the queries back in the search's order.
+void BlastQueriesTableModel::sort(int column, Qt::SortOrder order)
+{
+    m_sortColumn = column;
+    m_sortOrder = order;
+
+    emit layoutAboutToBeChanged();
+
+    //The view's persistent indices (e.g. the selection) follow their queries.
+    QModelIndexList oldIndices = persistentIndexList();
+    std::vector<int> oldQueryIds;
+    for (int i = 0; i < oldIndices.size(); ++i)
+        oldQueryIds.push_back(m_rowOrder[oldIndices[i].row()]);
+
+    sortRowOrder();
+
+    std::vector<int> newRows(m_rowOrder.size());
+    for (size_t i = 0; i < m_rowOrder.size(); ++i)
+        newRows[m_rowOrder[i]] = int(i);
+    QModelIndexList newIndices;
+    for (int i = 0; i < oldIndices.size(); ++i)
+        newIndices.push_back(index(newRows[oldQueryIds[i]], oldIndices[i].column()));
+    changePersistentIndexList(oldIndices, newIndices);
+
+    emit layoutChanged();
+}
+
+
+void BlastQueriesTableModel::sortRowOrder()
+{
+    if (m_sortColumn < 0 || m_sortColumn >= QUERY_COLUMN_COUNT)
+    {
+        std::sort(m_rowOrder.begin(), m_rowOrder.end());
+        return;
+    }
+
+    int column = m_sortColumn;
+    if (m_sortOrder == Qt::AscendingOrder)
+        std::stable_sort(m_rowOrder.begin(), m_rowOrder.end(),
+                         [this, column](int a, int b) {return queryLessThan(a, b, column);});
+    else
+        std::stable_sort(m_rowOrder.begin(), m_rowOrder.end(),
+                         [this, column](int a, int b) {return queryLessThan(b, a, column);});
+}
+
+
+//Queries which haven't been searched for sort before those which have.
+bool BlastQueriesTableModel::queryLessThan(int a, int b, int column) const
+{
+    BlastQuery * queryA = g_blastSearch->m_blastQueries.m_queries[a];
+    BlastQuery * queryB = g_blastSearch->m_blastQueries.m_queries[b];
+    const QuerySearchResults & resultsA = m_searchResults[a];
+    const QuerySearchResults & resultsB = m_searchResults[b];
+    if (column >= 5 && resultsA.searchedFor != resultsB.searchedFor)
+        return !resultsA.searchedFor;
+
+    switch (column)
+    {
+    case 0: return queryA->getColour().rgba() < queryB->getColour().rgba();
+    case 1: return queryA->isHidden() && queryB->isShown();
+    case 2: return queryA->getName() < queryB->getName();
+    case 3: return queryA->getTypeString() < queryB->getTypeString();
+    case 4: return queryA->getLength() < queryB->getLength();
+    case 5: return resultsA.hitCount < resultsB.hitCount;
+    case 6: return resultsA.queryCover < resultsB.queryCover;
+    case 7: return resultsA.pathCount < resultsB.pathCount;
+    }
+    return false;
+}
@@ -0,0 +1,79 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef BLASTQUERIESTABLEMODEL_H
+#define BLASTQUERIESTABLEMODEL_H
+
+#include <vector>
+#include <QAbstractTableModel>
+
+class BlastQuery;
+
+//These are a query's search results as the table shows them.  They are taken
+//when the model is updated, so a search running in another thread can't
+//change them under the view.
+struct QuerySearchResults
+{
+    bool searchedFor;
+    int hitCount;
+    double queryCover;
+    int pathCount;
+};
+
+//This model shows the BLAST queries in the BLAST search dialog.  Like
+//BlastHitsTableModel, it reads the queries straight from the search and only
+//formats the visible cells, and it sorts by reordering the queries' places in
+//the search.  The query name and 'Show' cells can be edited in the table.
+//The model must be updated whenever queries are added or removed, or after a
+//search or hit filtering.
+class BlastQueriesTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    //CREATORS
+    explicit BlastQueriesTableModel(QObject * parent = 0);
+
+    //ACCESSORS
+    int rowCount(const QModelIndex & parent = QModelIndex()) const;
+    int columnCount(const QModelIndex & parent = QModelIndex()) const;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    Qt::ItemFlags flags(const QModelIndex & index) const;
+    BlastQuery * getQuery(int row) const;
+
+    //MODIFERS
+    bool setData(const QModelIndex & index, const QVariant & value, int role = Qt::EditRole);
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+    void update();
+    void queriesChanged();
+
+private:
+    std::vector<int> m_rowOrder;
+    std::vector<QuerySearchResults> m_searchResults;
+    int m_sortColumn;
+    Qt::SortOrder m_sortOrder;
+
+    void sortRowOrder();
+    bool queryLessThan(int a, int b, int column) const;
+
+signals:
+    void queryEdited();
+};
+
+#endif // BLASTQUERIESTABLEMODEL_H
@@ -41,15 +41,12 @@
 #include "../blast/buildblastdatabaseworker.h"
 #include "../blast/runblastsearchworker.h"
 #include "myprogressdialog.h"
-#include "colourbutton.h"
 #include <QSet>
-#include "tablewidgetitemname.h"
-#include "tablewidgetitemint.h"
-#include "tablewidgetitemdouble.h"
-#include "tablewidgetitemshown.h"
-#include <QCheckBox>
-#include "querypathspushbutton.h"
+#include <QColorDialog>
+#include <QHeaderView>
 #include "querypathsdialog.h"
+#include "blasthitstablemodel.h"
+#include "blastqueriestablemodel.h"
 #include "blasthitfiltersdialog.h"
 
 BlastSearchDialog::BlastSearchDialog(QWidget *parent, QString autoQuery) :
@@ -62,14 +59,20 @@ BlastSearchDialog::BlastSearchDialog(QWidget *parent, QString autoQuery) :
 
     setWindowFlags(windowFlags() | Qt::Tool);
 
-    ui->blastHitsTableWidget->m_smallFirstColumn = true;
-    ui->blastQueriesTableWidget->m_smallFirstColumn = true;
-    ui->blastQueriesTableWidget->m_smallSecondColumn = true;
+    m_hitsModel = new BlastHitsTableModel(this);
+    m_queriesModel = new BlastQueriesTableModel(this);
+    ui->blastHitsTableView->setModel(m_hitsModel);
+    ui->blastQueriesTableView->setModel(m_queriesModel);
+
+    ui->blastHitsTableView->m_smallFirstColumn = true;
+    ui->blastQueriesTableView->m_smallFirstColumn = true;
+    ui->blastQueriesTableView->m_smallSecondColumn = true;
 
     setFilterText();
 
     //Load any previous parameters the user might have entered when previously using this dialog.
     ui->parametersLineEdit->setText(g_settings->blastSearchParameters);
+    ui->alignerComboBox->setCurrentIndex(usingBuiltInAligner() ? 1 : 0);
 
     //If the dialog is given an autoQuery parameter, then it will
     //carry out the entire process on its own.
@@ -83,20 +86,21 @@ BlastSearchDialog::BlastSearchDialog(QWidget *parent, QString autoQuery) :
         return;
     }
 
-    //Prepare the query and hits tables
-    ui->blastHitsTableWidget->setHorizontalHeaderLabels(QStringList() << "" << "Query\nname" << "Node\nname" <<
-                                                        "Percent\nidentity" << "Alignment\nlength" << "Query\ncover" << "Mis-\nmatches" <<
-                                                        "Gap\nopens" << "Query\nstart" << "Query\nend" << "Node\nstart" <<
-                                                        "Node\nend" <<"E-\nvalue" << "Bit\nscore");
-    QFont font = ui->blastQueriesTableWidget->horizontalHeader()->font();
+    //Prepare the query and hits tables.  They start in the search's order,
+    //not sorted by any column.
+    ui->blastQueriesTableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    ui->blastHitsTableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    ui->blastQueriesTableView->setSortingEnabled(true);
+    ui->blastHitsTableView->setSortingEnabled(true);
+    QFont font = ui->blastQueriesTableView->horizontalHeader()->font();
     font.setBold(true);
-    ui->blastQueriesTableWidget->horizontalHeader()->setFont(font);
-    ui->blastHitsTableWidget->horizontalHeader()->setFont(font);
+    ui->blastQueriesTableView->horizontalHeader()->setFont(font);
+    ui->blastHitsTableView->horizontalHeader()->setFont(font);
 
 
-    //If a BLAST database already exists, move to step 2.
-    QFile databaseFile(g_blastSearch->m_tempDirectory + "all_nodes.fasta");
-    if (databaseFile.exists())
+    //If a BLAST database already exists, move to step 2.  The built-in aligner
+    //doesn't need one.
+    if (g_blastSearch->m_blastDatabase != "" || usingBuiltInAligner())
         setUiStep(BLAST_DB_BUILT_BUT_NO_QUERIES);
 
     //If there isn't a BLAST database, clear the entire temporary directory
@@ -121,10 +125,6 @@ BlastSearchDialog::BlastSearchDialog(QWidget *parent, QString autoQuery) :
         setUiStep(BLAST_SEARCH_COMPLETE);
     }
 
-    //Call this function to disable rows in either table that are for queries
-    //the user has hidden.
-    queryShownChanged();
-
     setInfoTexts();
 
     connect(ui->buildBlastDatabaseButton, SIGNAL(clicked()), this, SLOT(buildBlastDatabaseInThread()));
@@ -133,9 +133,11 @@ BlastSearchDialog::BlastSearchDialog(QWidget *parent, QString autoQuery) :
     connect(ui->clearAllQueriesButton, SIGNAL(clicked()), this, SLOT(clearAllQueries()));
     connect(ui->clearSelectedQueriesButton, SIGNAL(clicked(bool)), this, SLOT(clearSelectedQueries()));
     connect(ui->runBlastSearchButton, SIGNAL(clicked()), this, SLOT(runBlastSearchesInThread()));
-    connect(ui->blastQueriesTableWidget, SIGNAL(cellChanged(int,int)), this, SLOT(queryCellChanged(int,int)));
-    connect(ui->blastQueriesTableWidget, SIGNAL(itemSelectionChanged()), this, SLOT(queryTableSelectionChanged()));
+    connect(m_queriesModel, SIGNAL(queryEdited()), this, SLOT(queryEdited()));
+    connect(ui->blastQueriesTableView, SIGNAL(clicked(QModelIndex)), this, SLOT(queryTableClicked(QModelIndex)));
+    connect(ui->blastQueriesTableView->selectionModel(), SIGNAL(selectionChanged(QItemSelection,QItemSelection)), this, SLOT(queryTableSelectionChanged()));
     connect(ui->blastFiltersButton, SIGNAL(clicked(bool)), this, SLOT(openFiltersDialog()));
+    connect(ui->alignerComboBox, SIGNAL(currentIndexChanged(int)), this, SLOT(alignerChanged()));
 }
 
 BlastSearchDialog::~BlastSearchDialog()
@@ -148,17 +150,15 @@ BlastSearchDialog::~BlastSearchDialog()
 
 void BlastSearchDialog::afterWindowShow()
 {
-    ui->blastQueriesTableWidget->resizeColumns();
-    ui->blastHitsTableWidget->resizeColumns();
+    ui->blastQueriesTableView->resizeColumns();
+    ui->blastHitsTableView->resizeColumns();
 }
 
 void BlastSearchDialog::clearBlastHits()
 {
     g_blastSearch->clearBlastHits();
     deleteQueryPathsDialog();
-    ui->blastHitsTableWidget->clearContents();
-    while (ui->blastHitsTableWidget->rowCount() > 0)
-        ui->blastHitsTableWidget->removeRow(0);
+    m_hitsModel->update();
     g_assemblyGraph->clearAllBlastHitPointers();
 }
 
@@ -172,195 +172,20 @@ void BlastSearchDialog::fillTablesAfterBlastSearch()
 }
 
 
+//The tables' models read the queries and hits straight from the search, so
+//filling a table only makes its rows again.
 void BlastSearchDialog::fillQueriesTable()
 {
-    //Turn off table widget signals for this function so the
-    //queryCellChanged slot doesn't get called.
-    ui->blastQueriesTableWidget->blockSignals(true);
-    ui->blastQueriesTableWidget->setSortingEnabled(false);
-
-    ui->blastQueriesTableWidget->clearContents();
-
-    int queryCount = int(g_blastSearch->m_blastQueries.m_queries.size());
-    if (queryCount == 0)
-        return;
-
-    ui->blastQueriesTableWidget->setRowCount(queryCount);
-
-    for (int i = 0; i < queryCount; ++i)
-        makeQueryRow(i);
-
-    ui->blastQueriesTableWidget->resizeColumns();
-    ui->blastQueriesTableWidget->setSortingEnabled(true);
-
-    ui->blastQueriesTableWidget->setSortingEnabled(true);
-    ui->blastQueriesTableWidget->blockSignals(false);
-}
-
-void BlastSearchDialog::makeQueryRow(int row)
-{
-    if (row >= int(g_blastSearch->m_blastQueries.m_queries.size()))
-        return;
-
-    BlastQuery * query = g_blastSearch->m_blastQueries.m_queries[row];
-
-    TableWidgetItemName * name = new TableWidgetItemName(query);
-    name->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable);
-
-    QTableWidgetItem * type = new QTableWidgetItem(query->getTypeString());
-    type->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-    int queryLength = query->getLength();
-    TableWidgetItemInt * length = new TableWidgetItemInt(formatIntForDisplay(queryLength), queryLength);
-    length->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-    //If the search hasn't yet been run, some of the columns will just have
-    //a dash.
-    TableWidgetItemInt * hits;
-    TableWidgetItemDouble * percent;
-    QTableWidgetItem * paths;
-
-    QueryPathsPushButton * pathsButton = 0;
-    if (query->wasSearchedFor())
-    {
-        int hitCount = query->hitCount();
-        hits = new TableWidgetItemInt(formatIntForDisplay(hitCount), hitCount);
-        percent = new TableWidgetItemDouble(formatDoubleForDisplay(100.0 * query->fractionCoveredByHits(), 2) + "%", query->fractionCoveredByHits());
-
-        //The path count isn't displayed in the TableWidgetItem because it will
-        //be shown in a button which will bring up a separate dialog showing a
-        //table of the paths.
-        int pathCount = query->getPathCount();
-        paths = new TableWidgetItemInt("", pathCount);
-        paths->setFlags(Qt::ItemIsEnabled);
-        pathsButton = new QueryPathsPushButton(pathCount, query);
-        connect(pathsButton, SIGNAL(showPathsDialog(BlastQuery*)), this, SLOT(showPathsDialog(BlastQuery*)));
-    }
-    else
-    {
-        hits = new TableWidgetItemInt("-", 0);
-        percent = new TableWidgetItemDouble("-", 0.0);
-        paths = new QTableWidgetItem("-");
-    }
-
-    hits->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-    percent->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-    paths->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-    QTableWidgetItem * colour = new QTableWidgetItem(query->getColour().name());
-    ColourButton * colourButton = new ColourButton();
-    colourButton->setColour(query->getColour());
-    connect(colourButton, SIGNAL(colourChosen(QColor)), query, SLOT(setColour(QColor)));
-    connect(colourButton, SIGNAL(colourChosen(QColor)), this, SLOT(fillHitsTable()));
-
-    QWidget * showCheckBoxWidget = new QWidget;
-    QCheckBox * showCheckBox = new QCheckBox();
-    QHBoxLayout * layout = new QHBoxLayout(showCheckBoxWidget);
-    layout->addWidget(showCheckBox);
-    layout->setAlignment(Qt::AlignCenter);
-    layout->setContentsMargins(0, 0, 0, 0);
-    showCheckBoxWidget->setLayout(layout);
-    bool queryShown = query->isShown();
-    showCheckBox->setChecked(queryShown);
-    QTableWidgetItem * show = new TableWidgetItemShown(queryShown);
-    show->setFlags(Qt::ItemIsEnabled);
-    connect(showCheckBox, SIGNAL(toggled(bool)), query, SLOT(setShown(bool)));
-    connect(showCheckBox, SIGNAL(toggled(bool)), this, SLOT(queryShownChanged()));
-
-    ui->blastQueriesTableWidget->setCellWidget(row, 0, colourButton);
-    ui->blastQueriesTableWidget->setCellWidget(row, 1, showCheckBoxWidget);
-    ui->blastQueriesTableWidget->setItem(row, 0, colour);
-    ui->blastQueriesTableWidget->setItem(row, 1, show);
-    ui->blastQueriesTableWidget->setItem(row, 2, name);
-    ui->blastQueriesTableWidget->setItem(row, 3, type);
-    ui->blastQueriesTableWidget->setItem(row, 4, length);
-    ui->blastQueriesTableWidget->setItem(row, 5, hits);
-    ui->blastQueriesTableWidget->setItem(row, 6, percent);
-    ui->blastQueriesTableWidget->setItem(row, 7, paths);
-    if (pathsButton != 0)
-        ui->blastQueriesTableWidget->setCellWidget(row, 7, pathsButton);
+    m_queriesModel->update();
+    ui->blastQueriesTableView->resizeColumns();
 }
 
 
 void BlastSearchDialog::fillHitsTable()
 {
-    ui->blastHitsTableWidget->clearContents();
-    ui->blastHitsTableWidget->setSortingEnabled(false);
-
-    int hitCount = g_blastSearch->m_allHits.size();
-    ui->blastHitsTableWidget->setRowCount(hitCount);
-
-    if (hitCount == 0)
-        return;
-
-    for (int i = 0; i < hitCount; ++i)
-    {
-        BlastHit * hit = g_blastSearch->m_allHits[i].data();
-        BlastQuery * hitQuery = hit->m_query;
-
-        QTableWidgetItem * queryColour = new QTableWidgetItem(hitQuery->getColour().name());
-        queryColour->setFlags(Qt::ItemIsEnabled);
-        queryColour->setBackground(hitQuery->getColour());
-
-        QTableWidgetItem * queryName = new QTableWidgetItem(hitQuery->getName());
-        queryName->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        QTableWidgetItem * nodeName = new QTableWidgetItem(hit->m_node->getName());
-        nodeName->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemDouble * percentIdentity = new TableWidgetItemDouble(formatDoubleForDisplay(hit->m_percentIdentity, 2) + "%", hit->m_percentIdentity);
-        percentIdentity->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemInt * alignmentLength = new TableWidgetItemInt(formatIntForDisplay(hit->m_alignmentLength), hit->m_alignmentLength);
-        alignmentLength->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        double queryCoverPercent = 100.0 * hit->getQueryCoverageFraction();
-        TableWidgetItemDouble * queryCover = new TableWidgetItemDouble(formatDoubleForDisplay(queryCoverPercent, 2) + "%", queryCoverPercent);
-        queryCover->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemInt * numberMismatches = new TableWidgetItemInt(formatIntForDisplay(hit->m_numberMismatches), hit->m_numberMismatches);
-        numberMismatches->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemInt * numberGapOpens = new TableWidgetItemInt(formatIntForDisplay(hit->m_numberGapOpens), hit->m_numberGapOpens);
-        numberGapOpens->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemInt * queryStart = new TableWidgetItemInt(formatIntForDisplay(hit->m_queryStart), hit->m_queryStart);
-        queryStart->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemInt * queryEnd = new TableWidgetItemInt(formatIntForDisplay(hit->m_queryEnd), hit->m_queryEnd);
-        queryEnd->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemInt * nodeStart = new TableWidgetItemInt(formatIntForDisplay(hit->m_nodeStart), hit->m_nodeStart);
-        nodeStart->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemInt * nodeEnd = new TableWidgetItemInt(formatIntForDisplay(hit->m_nodeEnd), hit->m_nodeEnd);
-        nodeEnd->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemDouble * eValue = new TableWidgetItemDouble(hit->m_eValue.asString(false), hit->m_eValue.toDouble());
-        eValue->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        TableWidgetItemDouble * bitScore = new TableWidgetItemDouble(QString::number(hit->m_bitScore), hit->m_bitScore);
-        bitScore->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable);
-
-        ui->blastHitsTableWidget->setItem(i, 0, queryColour);
-        ui->blastHitsTableWidget->setItem(i, 1, queryName);
-        ui->blastHitsTableWidget->setItem(i, 2, nodeName);
-        ui->blastHitsTableWidget->setItem(i, 3, percentIdentity);
-        ui->blastHitsTableWidget->setItem(i, 4, alignmentLength);
-        ui->blastHitsTableWidget->setItem(i, 5, queryCover);
-        ui->blastHitsTableWidget->setItem(i, 6, numberMismatches);
-        ui->blastHitsTableWidget->setItem(i, 7, numberGapOpens);
-        ui->blastHitsTableWidget->setItem(i, 8, queryStart);
-        ui->blastHitsTableWidget->setItem(i, 9, queryEnd);
-        ui->blastHitsTableWidget->setItem(i, 10, nodeStart);
-        ui->blastHitsTableWidget->setItem(i, 11, nodeEnd);
-        ui->blastHitsTableWidget->setItem(i, 12, eValue);
-        ui->blastHitsTableWidget->setItem(i, 13, bitScore);
-    }
-
-    ui->blastHitsTableWidget->resizeColumns();
-    ui->blastHitsTableWidget->setEnabled(true);
-    ui->blastHitsTableWidget->setSortingEnabled(true);
+    m_hitsModel->update();
+    ui->blastHitsTableView->resizeColumns();
+    ui->blastHitsTableView->setEnabled(true);
 }
 
 void BlastSearchDialog::buildBlastDatabaseInThread()
@@ -370,6 +195,12 @@ void BlastSearchDialog::buildBlastDatabaseInThread()
 
 void BlastSearchDialog::buildBlastDatabase(bool separateThread)
 {
+    if (usingBuiltInAligner())
+    {
+        setUiStep(BLAST_DB_BUILT_BUT_NO_QUERIES);
+        return;
+    }
+
     setUiStep(BLAST_DB_BUILD_IN_PROGRESS);
 
     if (!g_blastSearch->findProgram("makeblastdb", &m_makeblastdbCommand))
@@ -490,12 +321,9 @@ void BlastSearchDialog::enterQueryManually()
 void BlastSearchDialog::clearAllQueries()
 {
     g_blastSearch->m_blastQueries.clearAllQueries();
-    ui->blastQueriesTableWidget->clearContents();
+    m_queriesModel->update();
     ui->clearAllQueriesButton->setEnabled(false);
 
-    while (ui->blastQueriesTableWidget->rowCount() > 0)
-        ui->blastQueriesTableWidget->removeRow(0);
-
     clearBlastHits();
     setUiStep(BLAST_DB_BUILT_BUT_NO_QUERIES);
     emit blastChanged();
@@ -505,22 +333,17 @@ void BlastSearchDialog::clearAllQueries()
 void BlastSearchDialog::clearSelectedQueries()
 {
     //Use the table selection to figure out which queries are to be removed.
-    //The table cell containing the query name also has a pointer to the
-    //actual query, and that's what we use.
     std::vector<BlastQuery *> queriesToRemove;
-    QItemSelectionModel * select = ui->blastQueriesTableWidget->selectionModel();
+    QItemSelectionModel * select = ui->blastQueriesTableView->selectionModel();
     QModelIndexList selection = select->selectedIndexes();
     QSet<int> rowsWithSelectionSet;
     for (int i = 0; i < selection.size(); ++i)
         rowsWithSelectionSet.insert(selection[i].row());
     for (QSet<int>::const_iterator i = rowsWithSelectionSet.constBegin(); i != rowsWithSelectionSet.constEnd(); ++i)
     {
-        int row = *i;
-        QTableWidgetItem * tableWidgetItem = ui->blastQueriesTableWidget->item(row, 2);
-        TableWidgetItemName * queryNameItem = dynamic_cast<TableWidgetItemName *>(tableWidgetItem);
-        if (queryNameItem == 0)
+        BlastQuery * query = m_queriesModel->getQuery(*i);
+        if (query == 0)
             continue;
-        BlastQuery * query = queryNameItem->getQuery();
         queriesToRemove.push_back(query);
     }
 
@@ -547,13 +370,13 @@ void BlastSearchDialog::runBlastSearches(bool separateThread)
 {
     setUiStep(BLAST_SEARCH_IN_PROGRESS);
 
-    if (!g_blastSearch->findProgram("blastn", &m_blastnCommand))
+    if (!usingBuiltInAligner() && !g_blastSearch->findProgram("blastn", &m_blastnCommand))
     {
         QMessageBox::warning(this, "Error", "The program blastn was not found.  Please install NCBI BLAST to use this feature.");
         setUiStep(READY_FOR_BLAST_SEARCH);
         return;
     }
-    if (!g_blastSearch->findProgram("tblastn", &m_tblastnCommand))
+    if (!usingBuiltInAligner() && !g_blastSearch->findProgram("tblastn", &m_tblastnCommand))
     {
         QMessageBox::warning(this, "Error", "The program tblastn was not found.  Please install NCBI BLAST to use this feature.");
         setUiStep(READY_FOR_BLAST_SEARCH);
@@ -562,7 +385,20 @@ void BlastSearchDialog::runBlastSearches(bool separateThread)
 
     clearBlastHits();
 
-    MyProgressDialog * progress = new MyProgressDialog(this, "Running BLAST search...", separateThread, "Cancel search", "Cancelling search...",
+    //The built-in aligner's indexes belong to the graph, so they are built
+    //here rather than in the search's thread.  This can't be cancelled.
+    if (usingBuiltInAligner())
+    {
+        MyProgressDialog * indexProgress = new MyProgressDialog(this, "Indexing graph...", false);
+        indexProgress->setWindowModality(Qt::WindowModal);
+        indexProgress->show();
+        g_blastSearch->buildGraphAlignerIndexes();
+        indexProgress->close();
+        delete indexProgress;
+    }
+
+    QString progressText = usingBuiltInAligner() ? "Aligning queries..." : "Running BLAST search...";
+    MyProgressDialog * progress = new MyProgressDialog(this, progressText, separateThread, "Cancel search", "Cancelling search...",
                                                        "Clicking this button will stop the BLAST search.");
     progress->setWindowModality(Qt::WindowModal);
     progress->show();
@@ -574,6 +410,9 @@ void BlastSearchDialog::runBlastSearches(bool separateThread)
         runBlastSearchWorker->moveToThread(m_blastSearchThread);
 
         connect(progress, SIGNAL(halt()), this, SLOT(runBlastSearchCancelled()));
+        connect(runBlastSearchWorker, SIGNAL(setShardCount(int)), progress, SLOT(setMaxValue(int)));
+        connect(runBlastSearchWorker, SIGNAL(setFinishedShardCount(int)), progress, SLOT(setValue(int)));
+        connect(runBlastSearchWorker, SIGNAL(setProgressMessage(QString)), progress, SLOT(setMessage(QString)));
         connect(m_blastSearchThread, SIGNAL(started()), runBlastSearchWorker, SLOT(runBlastSearch()));
         connect(runBlastSearchWorker, SIGNAL(finishedSearch(QString)), m_blastSearchThread, SLOT(quit()));
         connect(runBlastSearchWorker, SIGNAL(finishedSearch(QString)), runBlastSearchWorker, SLOT(deleteLater()));
@@ -615,46 +454,48 @@ void BlastSearchDialog::runBlastSearchFinished(QString error)
 
 void BlastSearchDialog::runBlastSearchCancelled()
 {
+    //The worker kills the running BLAST processes when it sees this.
     g_blastSearch->m_cancelRunBlastSearch = true;
-    if (g_blastSearch->m_blast != 0)
-        g_blastSearch->m_blast->kill();
 }
 
 
 
-void BlastSearchDialog::queryCellChanged(int row, int column)
+//This function is called when the user renames a query or changes its 'Show'
+//tick box in the queries table.
+void BlastSearchDialog::queryEdited()
 {
-    //Suspend signals for this function, as it is might change
-    //the cell value again if the new name isn't unique.
-    ui->blastQueriesTableWidget->blockSignals(true);
-
-    //If a query name was changed, then we adjust that query name elsewhere.
-    if (column == 2)
-    {
-        QString newName = ui->blastQueriesTableWidget->item(row, column)->text();
-        BlastQuery * query = g_blastSearch->m_blastQueries.m_queries[row];
+    //Resize the query table columns, as the name new might take up more or less space.
+    ui->blastQueriesTableView->resizeColumns();
 
-        if (newName != query->getName())
-        {
-            QString uniqueName = g_blastSearch->m_blastQueries.renameQuery(query, newName);
+    //The hits table shows the queries' names and greys out the hits of
+    //hidden queries.
+    m_hitsModel->queriesChanged();
 
-            //It's possible that the user gave the query a non-unique name, in which
-            //case we now have to adjust it.
-            if (uniqueName != newName)
-                ui->blastQueriesTableWidget->item(row, column)->setText(uniqueName);
+    emit blastChanged();
+}
 
-            //Resize the query table columns, as the name new might take up more or less space.
-            ui->blastQueriesTableWidget->resizeColumns();
 
-            //Rebuild the hits table, if necessary, to show the new name.
-            if (query->hasHits())
-                fillHitsTable();
+//Clicking a query's colour cell lets the user choose a new colour, and
+//clicking its paths cell shows its paths.
+void BlastSearchDialog::queryTableClicked(const QModelIndex & index)
+{
+    BlastQuery * query = m_queriesModel->getQuery(index.row());
+    if (query == 0)
+        return;
 
-            emit blastChanged();
-        }
+    if (index.column() == 0)
+    {
+        QColor chosenColour = QColorDialog::getColor(query->getColour(), this, query->getName(), QColorDialog::ShowAlphaChannel);
+        if (!chosenColour.isValid())
+            return;
+        query->setColour(chosenColour);
+        m_queriesModel->queriesChanged();
+        m_hitsModel->queriesChanged();
+        emit blastChanged();
     }
 
-    ui->blastQueriesTableWidget->blockSignals(false);
+    else if (index.column() == 7 && query->wasSearchedFor() && query->getPathCount() > 0)
+        showPathsDialog(query);
 }
 
 
@@ -662,7 +503,7 @@ void BlastSearchDialog::queryTableSelectionChanged()
 {
     //If there are any selected items, then the 'Clear selected' button
     //should be enabled.
-    QItemSelectionModel * select = ui->blastQueriesTableWidget->selectionModel();
+    QItemSelectionModel * select = ui->blastQueriesTableView->selectionModel();
     bool hasSelection = select->hasSelection();
 
     ui->clearSelectedQueriesButton->setEnabled(hasSelection);
@@ -683,7 +524,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->step2Label->setEnabled(false);
         ui->loadQueriesFromFastaButton->setEnabled(false);
         ui->enterQueryManuallyButton->setEnabled(false);
-        ui->blastQueriesTableWidget->setEnabled(false);
+        ui->blastQueriesTableView->setEnabled(false);
         ui->blastQueriesTableInfoText->setEnabled(false);
         ui->step3Label->setEnabled(false);
         ui->parametersLabel->setEnabled(false);
@@ -700,7 +541,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->enterQueryManuallyInfoText->setEnabled(false);
         ui->clearAllQueriesInfoText->setEnabled(false);
         ui->clearSelectedQueriesInfoText->setEnabled(false);
-        ui->blastHitsTableWidget->setEnabled(false);
+        ui->blastHitsTableView->setEnabled(false);
         ui->blastSearchWidget->setEnabled(false);
         ui->blastHitsTableInfoText->setEnabled(false);
         break;
@@ -711,7 +552,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->step2Label->setEnabled(false);
         ui->loadQueriesFromFastaButton->setEnabled(false);
         ui->enterQueryManuallyButton->setEnabled(false);
-        ui->blastQueriesTableWidget->setEnabled(false);
+        ui->blastQueriesTableView->setEnabled(false);
         ui->blastQueriesTableInfoText->setEnabled(false);
         ui->step3Label->setEnabled(false);
         ui->parametersLabel->setEnabled(false);
@@ -728,7 +569,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->enterQueryManuallyInfoText->setEnabled(false);
         ui->clearAllQueriesInfoText->setEnabled(false);
         ui->clearSelectedQueriesInfoText->setEnabled(false);
-        ui->blastHitsTableWidget->setEnabled(false);
+        ui->blastHitsTableView->setEnabled(false);
         ui->blastSearchWidget->setEnabled(false);
         ui->blastHitsTableInfoText->setEnabled(false);
         break;
@@ -739,7 +580,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->step2Label->setEnabled(true);
         ui->loadQueriesFromFastaButton->setEnabled(true);
         ui->enterQueryManuallyButton->setEnabled(true);
-        ui->blastQueriesTableWidget->setEnabled(true);
+        ui->blastQueriesTableView->setEnabled(true);
         ui->blastQueriesTableInfoText->setEnabled(true);
         ui->step3Label->setEnabled(false);
         ui->parametersLabel->setEnabled(false);
@@ -756,7 +597,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->enterQueryManuallyInfoText->setEnabled(true);
         ui->clearSelectedQueriesInfoText->setEnabled(false);
         ui->clearSelectedQueriesInfoText->setEnabled(false);
-        ui->blastHitsTableWidget->setEnabled(false);
+        ui->blastHitsTableView->setEnabled(false);
         ui->blastSearchWidget->setEnabled(false);
         ui->blastHitsTableInfoText->setEnabled(false);
         break;
@@ -767,7 +608,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->step2Label->setEnabled(true);
         ui->loadQueriesFromFastaButton->setEnabled(true);
         ui->enterQueryManuallyButton->setEnabled(true);
-        ui->blastQueriesTableWidget->setEnabled(true);
+        ui->blastQueriesTableView->setEnabled(true);
         ui->blastQueriesTableInfoText->setEnabled(true);
         ui->step3Label->setEnabled(true);
         ui->parametersLabel->setEnabled(true);
@@ -784,7 +625,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->enterQueryManuallyInfoText->setEnabled(true);
         ui->clearAllQueriesInfoText->setEnabled(true);
         ui->clearSelectedQueriesInfoText->setEnabled(true);
-        ui->blastHitsTableWidget->setEnabled(false);
+        ui->blastHitsTableView->setEnabled(false);
         ui->blastSearchWidget->setEnabled(true);
         ui->blastHitsTableInfoText->setEnabled(false);
         break;
@@ -795,7 +636,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->step2Label->setEnabled(true);
         ui->loadQueriesFromFastaButton->setEnabled(true);
         ui->enterQueryManuallyButton->setEnabled(true);
-        ui->blastQueriesTableWidget->setEnabled(true);
+        ui->blastQueriesTableView->setEnabled(true);
         ui->blastQueriesTableInfoText->setEnabled(true);
         ui->step3Label->setEnabled(true);
         ui->parametersLabel->setEnabled(true);
@@ -812,7 +653,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->enterQueryManuallyInfoText->setEnabled(true);
         ui->clearAllQueriesInfoText->setEnabled(true);
         ui->clearSelectedQueriesInfoText->setEnabled(true);
-        ui->blastHitsTableWidget->setEnabled(false);
+        ui->blastHitsTableView->setEnabled(false);
         ui->blastSearchWidget->setEnabled(true);
         ui->blastHitsTableInfoText->setEnabled(false);
         break;
@@ -823,7 +664,7 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->step2Label->setEnabled(true);
         ui->loadQueriesFromFastaButton->setEnabled(true);
         ui->enterQueryManuallyButton->setEnabled(true);
-        ui->blastQueriesTableWidget->setEnabled(true);
+        ui->blastQueriesTableView->setEnabled(true);
         ui->blastQueriesTableInfoText->setEnabled(true);
         ui->step3Label->setEnabled(true);
         ui->parametersLabel->setEnabled(true);
@@ -840,11 +681,43 @@ void BlastSearchDialog::setUiStep(BlastUiState blastUiState)
         ui->enterQueryManuallyInfoText->setEnabled(true);
         ui->clearAllQueriesInfoText->setEnabled(true);
         ui->clearSelectedQueriesInfoText->setEnabled(true);
-        ui->blastHitsTableWidget->setEnabled(true);
+        ui->blastHitsTableView->setEnabled(true);
         ui->blastSearchWidget->setEnabled(true);
         ui->blastHitsTableInfoText->setEnabled(true);
         break;
     }
+
+    //The built-in aligner has no database to build and doesn't take BLAST's
+    //parameters.
+    if (usingBuiltInAligner())
+    {
+        ui->buildBlastDatabaseButton->setEnabled(false);
+        ui->parametersLabel->setEnabled(false);
+        ui->parametersLineEdit->setEnabled(false);
+    }
+}
+
+
+bool BlastSearchDialog::usingBuiltInAligner() const
+{
+    return g_settings->blastAligner == BUILT_IN_ALIGNER;
+}
+
+
+//When the aligner changes, the dialog goes back to the first step which
+//the new aligner still needs done.
+void BlastSearchDialog::alignerChanged()
+{
+    g_settings->blastAligner = (ui->alignerComboBox->currentIndex() == 1) ? BUILT_IN_ALIGNER : BLAST_PROGRAMS;
+
+    if (g_blastSearch->m_blastDatabase == "" && !usingBuiltInAligner())
+        setUiStep(BLAST_DB_NOT_YET_BUILT);
+    else if (g_blastSearch->m_blastQueries.m_queries.size() == 0)
+        setUiStep(BLAST_DB_BUILT_BUT_NO_QUERIES);
+    else if (g_blastSearch->m_allHits.size() == 0)
+        setUiStep(READY_FOR_BLAST_SEARCH);
+    else
+        setUiStep(BLAST_SEARCH_COMPLETE);
 }
 
 
@@ -859,7 +732,15 @@ void BlastSearchDialog::setInfoTexts()
     ui->buildBlastDatabaseInfoText->setInfoText("This step runs makeblastdb on the contig sequences, "
                                                 "preparing them for a BLAST search.<br><br>"
                                                 "The database files generated are temporary and will "
-                                                "be deleted when Bandage is closed.");
+                                                "be deleted when Bandage is closed.<br><br>"
+                                                "If the built-in aligner is chosen instead of BLAST, "
+                                                "this step isn't needed. The built-in aligner finds "
+                                                "seeds in an index of the node sequences, chains them "
+                                                "and extends them into alignments, and the alignments "
+                                                "which meet over edges give the query paths directly. "
+                                                "Protein queries are aligned to a six-frame "
+                                                "translation of the nodes, which is made the first "
+                                                "time it is needed and kept with the graph.");
 
     ui->loadQueriesFromFastaInfoText->setInfoText("Click this button to load a FASTA file. Each "
                                                   "sequence in the FASTA file will be a separate "
@@ -908,8 +789,8 @@ void BlastSearchDialog::setInfoTexts()
                                                "the second half in a different part, this value would be 100%. This value "
                                                "is equivalent to the 'qcovs' output option in BLAST.<br><br>"
                                                "<b>Paths</b>: These are the number of possible paths through the graph which "
-                                               "represent the entire query.  If there is at least one path, you can click on "
-                                               "this button to view a table of the paths' properties.");
+                                               "represent the entire query.  If there is at least one path, you can click in "
+                                               "this cell to view a table of the paths' properties.");
 
     ui->blastHitsTableInfoText->setInfoText("The BLAST hits are displayed in this table after a BLAST search is run.<br><br>"
                                             "<b>Query name</b>: This is the name of the BLAST query for the hit.<br><br>"
@@ -939,78 +820,6 @@ void BlastSearchDialog::setInfoTexts()
 
 
 
-//This function is called whenever a user changed the 'Show' tick box for a
-//query.  It does three things:
-// 1) Updates the 'shown' status of the TableWidgetItem so the table can be
-//    sorted by that column.
-// 2) Colours the QTableWidgetItems in the query table to match the query's
-//    'shown' status.
-// 3) Colours the QTableWidgetItems in the hits table to match the hit's query's
-//    'shown' status.
-void BlastSearchDialog::queryShownChanged()
-{
-    ui->blastQueriesTableWidget->blockSignals(true);
-
-    QTableWidgetItem tempItem;
-    QColor shownColour = tempItem.foreground().color();
-    QColor hiddenColour = QColor(150, 150, 150);
-
-    for (int i = 0; i < ui->blastQueriesTableWidget->rowCount(); ++i)
-    {
-        QString queryName = ui->blastQueriesTableWidget->item(i, 2)->text();
-        BlastQuery * query = g_blastSearch->m_blastQueries.getQueryFromName(queryName);
-        if (query == 0)
-            continue;
-        
-        QTableWidgetItem * item = ui->blastQueriesTableWidget->item(i, 1);
-        TableWidgetItemShown * shownItem = dynamic_cast<TableWidgetItemShown *>(item);
-
-        if (shownItem == 0)
-            continue;
-        shownItem->m_shown = query->isShown();
-
-        QColor colour = shownColour;
-        if (query->isHidden())
-            colour = hiddenColour;
-        ui->blastQueriesTableWidget->item(i, 2)->setForeground(colour);
-        ui->blastQueriesTableWidget->item(i, 3)->setForeground(colour);
-        ui->blastQueriesTableWidget->item(i, 4)->setForeground(colour);
-        ui->blastQueriesTableWidget->item(i, 5)->setForeground(colour);
-        ui->blastQueriesTableWidget->item(i, 6)->setForeground(colour);
-        ui->blastQueriesTableWidget->item(i, 7)->setForeground(colour);
-    }
-
-    for (int i = 0; i < ui->blastHitsTableWidget->rowCount(); ++i)
-    {
-        QString queryName = ui->blastHitsTableWidget->item(i, 1)->text();
-        BlastQuery * query = g_blastSearch->m_blastQueries.getQueryFromName(queryName);
-        if (query == 0)
-            continue;
-
-        QColor colour = shownColour;
-        if (query->isHidden())
-            colour = hiddenColour;
-
-        ui->blastHitsTableWidget->item(i, 1)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 2)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 3)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 4)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 5)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 6)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 7)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 8)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 9)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 10)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 11)->setForeground(colour);
-        ui->blastHitsTableWidget->item(i, 12)->setForeground(colour);
-    }
-
-    ui->blastQueriesTableWidget->blockSignals(false);
-    emit blastChanged();
-}
-
-
-
 void BlastSearchDialog::showPathsDialog(BlastQuery * query)
 {
     deleteQueryPathsDialog();
@@ -1044,6 +853,19 @@ void BlastSearchDialog::openFiltersDialog()
     {
         filtersDialog.setSettingsFromWidgets();
         setFilterText();
+
+        //If a search has been done, its hits are filtered again with the new
+        //settings, without searching again.
+        if (g_blastSearch->m_allHits.getUnfilteredCount() > 0)
+        {
+            QApplication::setOverrideCursor(Qt::WaitCursor);
+            deleteQueryPathsDialog();
+            g_blastSearch->applyHitFilters();
+            fillQueriesTable();
+            fillHitsTable();
+            QApplication::restoreOverrideCursor();
+            emit blastChanged();
+        }
     }
 }
 
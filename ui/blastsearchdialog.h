@@ -28,6 +28,8 @@
 class DeBruijnNode;
 class BlastQuery;
 class QueryPathsDialog;
+class BlastHitsTableModel;
+class BlastQueriesTableModel;
 
 namespace Ui {
 class BlastSearchDialog;
@@ -50,6 +52,8 @@ private:
     QThread * m_buildBlastDatabaseThread;
     QThread * m_blastSearchThread;
     QueryPathsDialog * m_queryPathsDialog;
+    BlastHitsTableModel * m_hitsModel;
+    BlastQueriesTableModel * m_queriesModel;
 
     void setUiStep(BlastUiState blastUiState);
     void clearBlastHits();
@@ -57,9 +61,9 @@ private:
     void loadBlastQueriesFromFastaFile(QString fullFileName);
     void buildBlastDatabase(bool separateThread);
     void runBlastSearches(bool separateThread);
-    void makeQueryRow(int row);
     void deleteQueryPathsDialog();
     void setFilterText();
+    bool usingBuiltInAligner() const;
 
 private slots:
     void afterWindowShow();
@@ -76,12 +80,13 @@ private slots:
     void runBlastSearchFinished(QString error);
     void buildBlastDatabaseCancelled();
     void runBlastSearchCancelled();
-    void queryCellChanged(int row, int column);
+    void queryEdited();
+    void queryTableClicked(const QModelIndex & index);
     void queryTableSelectionChanged();
-    void queryShownChanged();
     void showPathsDialog(BlastQuery * query);
     void queryPathSelectionChangedSlot();
     void openFiltersDialog();
+    void alignerChanged();
 
 signals:
     void blastChanged();
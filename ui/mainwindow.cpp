@@ -54,6 +54,7 @@
 #include "../graph/debruijnedge.h"
 #include "../graph/graphicsitemnode.h"
 #include "../graph/graphicsitemedge.h"
+#include "../graph/graphcoarsener.h"
 #include "myprogressdialog.h"
 #include <limits>
 #include <QDesktopServices>
@@ -70,7 +71,8 @@ MainWindow::MainWindow(QString fileToLoadOnStartup, bool drawGraphAfterLoad) :
     QMainWindow(0),
     ui(new Ui::MainWindow), m_layoutThread(0), m_imageFilter("PNG (*.png)"),
     m_fileToLoadOnStartup(fileToLoadOnStartup), m_drawGraphAfterLoad(drawGraphAfterLoad),
-    m_uiState(NO_GRAPH_LOADED), m_blastSearchDialog(0), m_alreadyShown(false)
+    m_uiState(NO_GRAPH_LOADED), m_blastSearchDialog(0), m_alreadyShown(false),
+    m_graphCoarsener(0)
 {
     ui->setupUi(this);
 
@@ -164,6 +166,8 @@ MainWindow::MainWindow(QString fileToLoadOnStartup, bool drawGraphAfterLoad) :
     connect(ui->actionBring_selected_nodes_to_front, SIGNAL(triggered()), this, SLOT(bringSelectedNodesToFront()));
     connect(ui->actionSelect_nodes_with_BLAST_hits, SIGNAL(triggered()), this, SLOT(selectNodesWithBlastHits()));
     connect(ui->actionSelect_nodes_with_dead_ends, SIGNAL(triggered()), this, SLOT(selectNodesWithDeadEnds()));
+    connect(ui->actionSelect_nodes_in_bubbles, SIGNAL(triggered()), this, SLOT(selectNodesInBubbles()));
+    connect(ui->actionSelect_nodes_containing_sequence, SIGNAL(triggered()), this, SLOT(selectNodesContainingSequence()));
     connect(ui->actionSelect_all, SIGNAL(triggered()), this, SLOT(selectAll()));
     connect(ui->actionSelect_none, SIGNAL(triggered()), this, SLOT(selectNone()));
     connect(ui->actionInvert_selection, SIGNAL(triggered()), this, SLOT(invertSelection()));
@@ -192,6 +196,9 @@ MainWindow::MainWindow(QString fileToLoadOnStartup, bool drawGraphAfterLoad) :
     connect(ui->actionMerge_all_possible_nodes, SIGNAL(triggered(bool)), this, SLOT(mergeAllPossible()));
     connect(ui->actionChange_node_name, SIGNAL(triggered(bool)), this, SLOT(changeNodeName()));
     connect(ui->actionChange_node_depth, SIGNAL(triggered(bool)), this, SLOT(changeNodeDepth()));
+    connect(ui->actionUndo, SIGNAL(triggered(bool)), this, SLOT(undoEdit()));
+    connect(ui->actionRedo, SIGNAL(triggered(bool)), this, SLOT(redoEdit()));
+    connect(ui->actionExpand_selected_super_nodes, SIGNAL(triggered(bool)), this, SLOT(expandSelectedSuperNodes()));
     connect(ui->moreInfoButton, SIGNAL(clicked(bool)), this, SLOT(openGraphInfoDialog()));
 
     connect(this, SIGNAL(windowLoaded()), this, SLOT(afterMainWindowShow()), Qt::ConnectionType(Qt::QueuedConnection | Qt::UniqueConnection));
@@ -244,6 +251,7 @@ void MainWindow::cleanUp()
     ui->blastQueryComboBox->clear();
     ui->blastQueryComboBox->addItem("none");
 
+    leaveLevelOfDetail();
     g_blastSearch->cleanUp();
     g_assemblyGraph->cleanUp();
     setWindowTitle("Bandage");
@@ -261,6 +269,8 @@ void MainWindow::cleanUp()
     ui->csvComboBox->clear();
     ui->csvComboBox->setEnabled(false);
     g_settings->displayNodeCsvDataCol = 0;
+
+    updateUndoRedoActions();
 }
 
 void MainWindow::loadCSV(QString fullFileName)
@@ -607,8 +617,11 @@ void MainWindow::graphScopeChanged()
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleInfoText, 1, 0, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleLabel, 1, 1, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleWidget, 1, 2, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 2, 0, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 2, 1, 1, 2);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailInfoText, 2, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailLabel, 2, 1, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailSpinBox, 2, 2, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 3, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 3, 1, 1, 2);
 
         break;
 
@@ -637,8 +650,11 @@ void MainWindow::graphScopeChanged()
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleInfoText, 4, 0, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleLabel, 4, 1, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleWidget, 4, 2, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 5, 0, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 5, 1, 1, 2);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailInfoText, 5, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailLabel, 5, 1, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailSpinBox, 5, 2, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 6, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 6, 1, 1, 2);
 
         break;
 
@@ -661,8 +677,11 @@ void MainWindow::graphScopeChanged()
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleInfoText, 2, 0, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleLabel, 2, 1, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleWidget, 2, 2, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 3, 0, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 3, 1, 1, 2);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailInfoText, 3, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailLabel, 3, 1, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailSpinBox, 3, 2, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 4, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 4, 1, 1, 2);
 
         break;
 
@@ -682,8 +701,29 @@ void MainWindow::graphScopeChanged()
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleInfoText, 3, 0, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleLabel, 3, 1, 1, 1);
         ui->graphDrawingGridLayout->addWidget(ui->nodeStyleWidget, 3, 2, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 4, 0, 1, 1);
-        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 4, 1, 1, 2);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailInfoText, 4, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailLabel, 4, 1, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailSpinBox, 4, 2, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 5, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 5, 1, 1, 2);
+
+        break;
+
+    case 4:
+        g_settings->graphScope = BUBBLES;
+
+        setStartingNodesWidgetVisibility(false);
+        setNodeDistanceWidgetVisibility(false);
+        setDepthRangeWidgetVisibility(false);
+
+        ui->graphDrawingGridLayout->addWidget(ui->nodeStyleInfoText, 1, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->nodeStyleLabel, 1, 1, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->nodeStyleWidget, 1, 2, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailInfoText, 2, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailLabel, 2, 1, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->levelOfDetailSpinBox, 2, 2, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphInfoText, 3, 0, 1, 1);
+        ui->graphDrawingGridLayout->addWidget(ui->drawGraphButton, 3, 1, 1, 2);
 
         break;
     }
@@ -717,7 +757,19 @@ void MainWindow::setDepthRangeWidgetVisibility(bool visible)
 }
 
 
+//This function sets the level of detail from its spin box and then draws the
+//graph at that level.
 void MainWindow::drawGraph()
+{
+    if (!setLevelOfDetail(ui->levelOfDetailSpinBox->value()))
+        return;
+    drawGraphAtCurrentLevel();
+}
+
+
+//This function draws whichever graph is in place (the full graph or the
+//coarsened copy of the current level) around the chosen starting nodes.
+void MainWindow::drawGraphAtCurrentLevel()
 {
     QString errorTitle;
     QString errorMessage;
@@ -732,12 +784,122 @@ void MainWindow::drawGraph()
         return;
     }
 
+    if (g_settings->graphScope == BUBBLES)
+        showBubbleSearchStatus(g_assemblyGraph->getTruncatedBubbleSearchCount());
+
     resetScene();
     g_assemblyGraph->buildOgdfGraphFromNodesAndEdges(startingNodes, g_settings->nodeDistance);
     layoutGraph();
 }
 
 
+//Above level 0, a coarsened copy of the graph is drawn in place of the
+//graph, which is kept aside until level 0 is drawn again.  The copy can't be
+//edited or searched with BLAST.
+bool MainWindow::setLevelOfDetail(int level)
+{
+    if (level == 0)
+    {
+        if (m_graphCoarsener != 0)
+        {
+            resetScene();
+            leaveLevelOfDetail();
+        }
+        setFullGraphActionsEnabled(true);
+        return true;
+    }
+
+    if (g_settings->graphScope == AROUND_BLAST_HITS)
+    {
+        QMessageBox::information(this, "Level of detail",
+                                 "BLAST hits can only be drawn at level 0, where the graph is not coarsened.");
+        return false;
+    }
+
+    if (m_graphCoarsener == 0)
+    {
+        resetScene();
+        g_assemblyGraph->clearOgdfGraphAndResetNodes();
+        m_fullGraph = g_assemblyGraph;
+        m_graphCoarsener = new GraphCoarsener(m_fullGraph.data());
+    }
+    m_graphCoarsener->setLevel(level);
+    if (m_graphCoarsener->getLevel() < level)
+        ui->levelOfDetailSpinBox->setValue(m_graphCoarsener->getLevel());
+
+    showLevelGraph();
+    setFullGraphActionsEnabled(false);
+    return true;
+}
+
+
+//This function replaces the drawn graph with a newly built copy of the
+//current level.
+void MainWindow::showLevelGraph()
+{
+    resetScene();
+    AssemblyGraph * levelGraph = new AssemblyGraph();
+    m_graphCoarsener->buildLevelGraph(levelGraph);
+    if (g_assemblyGraph != m_fullGraph)
+        g_assemblyGraph->cleanUp();
+    g_assemblyGraph.reset(levelGraph);
+}
+
+
+//This function puts the full graph back in place of a coarsened copy.  The
+//caller must first reset the scene if it holds the copy's nodes.
+void MainWindow::leaveLevelOfDetail()
+{
+    if (m_graphCoarsener == 0)
+        return;
+
+    g_assemblyGraph->cleanUp();
+    g_assemblyGraph = m_fullGraph;
+    m_fullGraph.clear();
+    delete m_graphCoarsener;
+    m_graphCoarsener = 0;
+
+    //The coarsened copy changed the automatic node length to suit itself.
+    g_assemblyGraph->updateGraphInfo();
+}
+
+
+//This function gives the full graph, which is set aside while a coarsened
+//copy is drawn in its place.
+AssemblyGraph * MainWindow::getFullGraph() const
+{
+    if (m_fullGraph.isNull())
+        return g_assemblyGraph.data();
+    return m_fullGraph.data();
+}
+
+
+//These actions edit the graph or save parts of it, so they are turned off
+//while a coarsened copy is drawn: its super-nodes have no sequences, and
+//edits to it would be lost.  Saving the entire graph uses the full graph
+//instead, and images are still saved of what is drawn.
+void MainWindow::setFullGraphActionsEnabled(bool enabled)
+{
+    ui->actionRemove_selection_from_graph->setEnabled(enabled);
+    ui->actionDuplicate_selected_nodes->setEnabled(enabled);
+    ui->actionMerge_selected_nodes->setEnabled(enabled);
+    ui->actionMerge_all_possible_nodes->setEnabled(enabled);
+    ui->actionChange_node_name->setEnabled(enabled);
+    ui->actionChange_node_depth->setEnabled(enabled);
+    ui->blastSearchWidget->setEnabled(enabled && m_uiState != NO_GRAPH_LOADED);
+    ui->actionSelect_nodes_containing_sequence->setEnabled(enabled);
+    ui->actionCopy_selected_node_sequences_to_clipboard->setEnabled(enabled);
+    ui->actionSave_selected_node_sequences_to_FASTA->setEnabled(enabled);
+    ui->actionCopy_selected_node_path_to_clipboard->setEnabled(enabled);
+    ui->actionSave_selected_node_path_to_FASTA->setEnabled(enabled);
+    ui->actionSpecify_exact_path_for_copy_save->setEnabled(enabled);
+    ui->actionSave_visible_graph_to_GFA->setEnabled(enabled);
+    ui->actionLoad_CSV->setEnabled(enabled && m_uiState != NO_GRAPH_LOADED);
+    ui->actionExpand_selected_super_nodes->setEnabled(!enabled);
+    updateUndoRedoActions();
+}
+
+
 void MainWindow::graphLayoutFinished()
 {
     delete m_fmmm;
@@ -748,6 +910,7 @@ void MainWindow::graphLayoutFinished()
     selectionChanged();
 
     setUiState(GRAPH_DRAWN);
+    setFullGraphActionsEnabled(m_graphCoarsener == 0);
 
     //Move the focus to the view so the user can use keyboard controls to navigate.
     g_graphicsView->setFocus();
@@ -769,6 +932,9 @@ void MainWindow::resetScene()
     g_assemblyGraph->resetEdges();
     g_assemblyGraph->m_contiguitySearchDone = false;
 
+    //The edit history can't keep graphics items from the old scene.
+    g_assemblyGraph->clearEditHistoryGraphicsItems();
+
     g_graphicsView->setScene(0);
     delete m_scene;
     m_scene = new MyGraphicsScene(this);
@@ -1651,7 +1817,10 @@ void MainWindow::setInfoTexts()
                                         "limit the drawing to a smaller region of the graph.</li>"
                                         "<li>'Around BLAST hits': if you have conducted a BLAST search "
                                         "on this graph, this option will draw the region(s) of the graph "
-                                        "around nodes that contain hits.</li></ul>");
+                                        "around nodes that contain hits.</li>"
+                                        "<li>'Bubbles': only the nodes in bubbles (regions of the graph "
+                                        "which split from one node and rejoin at another, such as "
+                                        "heterozygous variants or sequencing errors) will be drawn.</li></ul>");
     ui->startingNodesInfoText->setInfoText("Enter a comma-delimited list of node names here. This will "
                                            "define which regions of the graph will be drawn.<br><br>"
                                            "When in double mode, you can include '+' or '-' at the end "
@@ -1671,6 +1840,17 @@ void MainWindow::setInfoTexts()
                                        "'Double' mode will draw both nodes and their complement nodes. The nodes "
                                        "will show directionality with an arrow head. They will initially be "
                                        "drawn on top of each other, but can be manually moved to separate them.");
+    ui->levelOfDetailInfoText->setInfoText("This controls how much the graph is simplified before it is drawn, "
+                                           "which allows an overview of very large graphs:<ul>"
+                                           "<li>0: the graph is drawn as it is.</li>"
+                                           "<li>1: each chain of nodes without branches is drawn as one node.</li>"
+                                           "<li>2: simple bubbles are also drawn as one node.</li>"
+                                           "<li>3 and above: neighbouring nodes are joined into clusters, roughly "
+                                           "halving the number of nodes at each level.</li></ul>"
+                                           "Joined nodes (super-nodes) have the total length and the mean depth "
+                                           "of their nodes. Selected super-nodes can be expanded using the "
+                                           "View menu.<br><br>"
+                                           "Above level 0, the graph cannot be edited or searched with BLAST.");
     ui->drawGraphInfoText->setInfoText("Clicking this button will conduct the graph layout and draw the graph to "
                                        "the screen. This process is fast for small graphs but can be "
                                        "resource-intensive for large graphs.<br><br>"
@@ -1944,6 +2124,131 @@ void MainWindow::selectNodesWithDeadEnds()
 }
 
 
+void MainWindow::selectNodesInBubbles()
+{
+    int truncatedSearchCount = 0;
+    std::vector<DeBruijnNode *> nodesInBubbles = g_assemblyGraph->getNodesInSuperbubbles(&truncatedSearchCount);
+    showBubbleSearchStatus(truncatedSearchCount);
+
+    m_scene->blockSignals(true);
+    m_scene->clearSelection();
+
+    bool atLeastOneNodeSelected = false;
+    for (size_t i = 0; i < nodesInBubbles.size(); ++i)
+    {
+        GraphicsItemNode * graphicsItemNode = nodesInBubbles[i]->getGraphicsItemNode();
+        if (graphicsItemNode == 0)
+            continue;
+
+        graphicsItemNode->setSelected(true);
+        atLeastOneNodeSelected = true;
+    }
+    m_scene->blockSignals(false);
+    g_graphicsView->viewport()->update();
+    selectionChanged();
+
+    if (nodesInBubbles.size() == 0)
+    {
+        QMessageBox::information(this, "No bubbles", "Nothing was selected because this graph has no bubbles.");
+        return;
+    }
+
+    if (!atLeastOneNodeSelected)
+        QMessageBox::information(this, "No bubbles in visible nodes",
+                                       "Nothing was selected because no nodes in bubbles are currently visible. "
+                                       "Adjust the graph scope to make the nodes in bubbles visible.");
+    else
+        zoomToSelection();
+}
+
+
+//Bubbles larger than the maximum bubble size aren't found, so the status bar
+//says when any bubble search stopped there.
+void MainWindow::showBubbleSearchStatus(int truncatedSearchCount)
+{
+    if (truncatedSearchCount == 0)
+    {
+        ui->statusBar->clearMessage();
+        return;
+    }
+    ui->statusBar->showMessage(formatIntForDisplay(truncatedSearchCount) +
+                               (truncatedSearchCount == 1 ? " bubble search" : " bubble searches") +
+                               " stopped at the maximum bubble size of " +
+                               formatIntForDisplay(int(g_settings->maxBubbleNodes)) +
+                               " nodes, so any larger bubbles are not shown.");
+}
+
+
+//This function selects the nodes which a sequence passes through, found with
+//the graph's sequence index.  The index is built the first time this is used,
+//so later searches are quick.
+void MainWindow::selectNodesContainingSequence()
+{
+    bool ok;
+    QString sequence = QInputDialog::getText(this, "Select nodes containing sequence", "Sequence:",
+                                             QLineEdit::Normal, "", &ok);
+    sequence = sequence.simplified().remove(' ');
+    if (!ok || sequence.isEmpty())
+        return;
+
+    if (sequence.length() < g_settings->sequenceIndexKmerSize)
+    {
+        QMessageBox::information(this, "Sequence too short",
+                                 "The sequence must be at least " + QString::number(g_settings->sequenceIndexKmerSize) +
+                                 " bases long.");
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    std::vector<SequenceHit> hits = g_assemblyGraph->findSequence(sequence.toLatin1(), g_settings->findMaxMismatches);
+    QApplication::restoreOverrideCursor();
+
+    //In single mode, a node is selected if the sequence is in it or its
+    //reverse complement.
+    QSet<DeBruijnNode *> nodesInHits;
+    for (size_t i = 0; i < hits.size(); ++i)
+    {
+        for (size_t j = 0; j < hits[i].nodes.size(); ++j)
+        {
+            nodesInHits.insert(hits[i].nodes[j]);
+            if (!g_settings->doubleMode)
+                nodesInHits.insert(hits[i].nodes[j]->getReverseComplement());
+        }
+    }
+
+    m_scene->blockSignals(true);
+    m_scene->clearSelection();
+
+    bool atLeastOneNodeSelected = false;
+    QSetIterator<DeBruijnNode *> i(nodesInHits);
+    while (i.hasNext())
+    {
+        GraphicsItemNode * graphicsItemNode = i.next()->getGraphicsItemNode();
+        if (graphicsItemNode == 0)
+            continue;
+
+        graphicsItemNode->setSelected(true);
+        atLeastOneNodeSelected = true;
+    }
+    m_scene->blockSignals(false);
+    g_graphicsView->viewport()->update();
+    selectionChanged();
+
+    if (hits.empty())
+    {
+        QMessageBox::information(this, "Sequence not found", "Nothing was selected because the sequence is not in the graph.");
+        return;
+    }
+
+    if (!atLeastOneNodeSelected)
+        QMessageBox::information(this, "Sequence not in visible nodes",
+                                       "Nothing was selected because no nodes containing the sequence are currently visible. "
+                                       "Adjust the graph scope to make these nodes visible.");
+    else
+        zoomToSelection();
+}
+
+
 void MainWindow::selectAll()
 {
     m_scene->blockSignals(true);
@@ -2142,6 +2447,7 @@ void MainWindow::setGraphScopeComboBox(GraphScope graphScope)
     case AROUND_NODE: ui->graphScopeComboBox->setCurrentIndex(1); break;
     case AROUND_BLAST_HITS: ui->graphScopeComboBox->setCurrentIndex(2); break;
     case DEPTH_RANGE: ui->graphScopeComboBox->setCurrentIndex(3); break;
+    case BUBBLES: ui->graphScopeComboBox->setCurrentIndex(4); break;
     }
 }
 
@@ -2236,7 +2542,7 @@ void MainWindow::saveEntireGraphToFasta()
     if (fullFileName != "") //User did not hit cancel
     {
         g_memory->rememberedPath = QFileInfo(fullFileName).absolutePath();
-        g_assemblyGraph->saveEntireGraphToFasta(fullFileName);
+        getFullGraph()->saveEntireGraphToFasta(fullFileName);
     }
 }
 
@@ -2248,7 +2554,7 @@ void MainWindow::saveEntireGraphToFastaOnlyPositiveNodes()
     if (fullFileName != "") //User did not hit cancel
     {
         g_memory->rememberedPath = QFileInfo(fullFileName).absolutePath();
-        g_assemblyGraph->saveEntireGraphToFastaOnlyPositiveNodes(fullFileName);
+        getFullGraph()->saveEntireGraphToFastaOnlyPositiveNodes(fullFileName);
     }
 }
 
@@ -2261,7 +2567,7 @@ void MainWindow::saveEntireGraphToGfa()
     if (fullFileName != "") //User did not hit cancel
     {
         g_memory->rememberedPath = QFileInfo(fullFileName).absolutePath();
-        bool success = g_assemblyGraph->saveEntireGraphToGfa(fullFileName);
+        bool success = getFullGraph()->saveEntireGraphToGfa(fullFileName);
         if (!success)
             QMessageBox::warning(this, "Error saving file", "Bandage was unable to save the graph file.");
     }
@@ -2340,7 +2646,10 @@ QByteArray MainWindow::makeStringUrlSafe(QByteArray s)
 void MainWindow::hideNodes()
 {
     std::vector<DeBruijnNode *> selectedNodes = m_scene->getSelectedNodes();
+    g_assemblyGraph->beginEdit("Hide nodes");
     g_assemblyGraph->removeGraphicsItemNodes(&selectedNodes, !g_settings->doubleMode, m_scene);
+    g_assemblyGraph->endEdit();
+    updateUndoRedoActions();
 }
 
 
@@ -2350,13 +2659,13 @@ void MainWindow::removeSelection()
     std::vector<DeBruijnEdge *> selectedEdges = m_scene->getSelectedEdges();
     std::vector<DeBruijnNode *> selectedNodes = m_scene->getSelectedNodes();
 
-    g_assemblyGraph->removeGraphicsItemEdges(&selectedEdges, true, m_scene);
-    g_assemblyGraph->removeGraphicsItemNodes(&selectedNodes, true, m_scene);
-
-    g_assemblyGraph->deleteEdges(&selectedEdges);
-    g_assemblyGraph->deleteNodes(&selectedNodes);
+    g_assemblyGraph->beginEdit("Remove selection");
+    g_assemblyGraph->removeGraphicsItemNodesAndEdges(&selectedNodes, &selectedEdges, true, m_scene);
+    g_assemblyGraph->deleteNodesAndEdges(&selectedNodes, &selectedEdges);
+    g_assemblyGraph->endEdit();
+    updateUndoRedoActions();
 
-    g_assemblyGraph->determineGraphInfo();
+    g_assemblyGraph->updateGraphInfo();
     displayGraphDetails();
 
     //Now that the graph has changed, we have to reset BLAST and contiguity
@@ -2388,10 +2697,13 @@ void MainWindow::duplicateSelectedNodes()
             nodesToDuplicate.push_back(node);
     }
 
+    g_assemblyGraph->beginEdit("Duplicate nodes");
     for (int i = 0; i < nodesToDuplicate.size(); ++i)
         g_assemblyGraph->duplicateNodePair(nodesToDuplicate[i], m_scene);
+    g_assemblyGraph->endEdit();
+    updateUndoRedoActions();
 
-    g_assemblyGraph->determineGraphInfo();
+    g_assemblyGraph->updateGraphInfo();
     displayGraphDetails();
 
     //Now that the graph has changed, we have to reset BLAST and contiguity
@@ -2428,7 +2740,10 @@ void MainWindow::mergeSelectedNodes()
         return;
     }
 
+    g_assemblyGraph->beginEdit("Merge nodes");
     bool success = g_assemblyGraph->mergeNodes(nodesToMerge, m_scene, true);
+    g_assemblyGraph->endEdit();
+    updateUndoRedoActions();
 
     if (!success)
     {
@@ -2436,7 +2751,7 @@ void MainWindow::mergeSelectedNodes()
         return;
     }
 
-    g_assemblyGraph->determineGraphInfo();
+    g_assemblyGraph->updateGraphInfo();
     displayGraphDetails();
 
     //Now that the graph has changed, we have to reset BLAST and contiguity
@@ -2462,13 +2777,16 @@ void MainWindow::mergeAllPossible()
 
 
         g_graphicsView->viewport()->setUpdatesEnabled(false);
+        g_assemblyGraph->beginEdit("Merge all possible nodes");
         merges = g_assemblyGraph->mergeAllPossible(m_scene, &progress);
+        g_assemblyGraph->endEdit();
         g_graphicsView->viewport()->setUpdatesEnabled(true);
+        updateUndoRedoActions();
     }
 
     if (merges > 0)
     {
-        g_assemblyGraph->determineGraphInfo();
+        g_assemblyGraph->updateGraphInfo();
         displayGraphDetails();
 
         //Now that the graph has changed, we have to reset BLAST and contiguity
@@ -2510,7 +2828,10 @@ void MainWindow::changeNodeName()
 
     if (changeNodeNameDialog.exec()) //The user clicked OK
     {
+        g_assemblyGraph->beginEdit("Change node name");
         g_assemblyGraph->changeNodeName(oldName, changeNodeNameDialog.getNewName());
+        g_assemblyGraph->endEdit();
+        updateUndoRedoActions();
         selectionChanged();
         cleanUpAllBlast();
     }
@@ -2531,8 +2852,11 @@ void MainWindow::changeNodeDepth()
 
     if (changeNodeDepthDialog.exec()) //The user clicked OK
     {
+        g_assemblyGraph->beginEdit("Change node depth");
         g_assemblyGraph->changeNodeDepth(&selectedNodes,
                                              changeNodeDepthDialog.getNewDepth());
+        g_assemblyGraph->endEdit();
+        updateUndoRedoActions();
         selectionChanged();
         g_assemblyGraph->recalculateAllDepthsRelativeToDrawnMean();
         g_assemblyGraph->recalculateAllNodeWidths();
@@ -2542,6 +2866,83 @@ void MainWindow::changeNodeDepth()
 
 
 
+void MainWindow::undoEdit()
+{
+    if (g_assemblyGraph->undoEdit(m_scene))
+        graphEditUndoneOrRedone();
+}
+
+void MainWindow::redoEdit()
+{
+    if (g_assemblyGraph->redoEdit(m_scene))
+        graphEditUndoneOrRedone();
+}
+
+
+//After an undo or redo, the graph has changed in the same ways as after an
+//edit, so the same things need to be refreshed.
+void MainWindow::graphEditUndoneOrRedone()
+{
+    updateUndoRedoActions();
+
+    g_assemblyGraph->updateGraphInfo();
+    displayGraphDetails();
+    g_assemblyGraph->recalculateAllDepthsRelativeToDrawnMean();
+    g_assemblyGraph->recalculateAllNodeWidths();
+
+    cleanUpAllBlast();
+    g_assemblyGraph->resetNodeContiguityStatus();
+    selectionChanged();
+    g_graphicsView->viewport()->update();
+}
+
+
+void MainWindow::updateUndoRedoActions()
+{
+    const GraphEditJournal * editJournal = g_assemblyGraph->getEditJournal();
+
+    ui->actionUndo->setEnabled(editJournal->canUndo());
+    if (editJournal->canUndo())
+        ui->actionUndo->setText("Undo " + editJournal->getUndoDescription().toLower());
+    else
+        ui->actionUndo->setText("Undo");
+
+    ui->actionRedo->setEnabled(editJournal->canRedo());
+    if (editJournal->canRedo())
+        ui->actionRedo->setText("Redo " + editJournal->getRedoDescription().toLower());
+    else
+        ui->actionRedo->setText("Redo");
+}
+
+
+
+//This function shows the selected super-nodes as the nodes they were made
+//from and draws the graph again.
+void MainWindow::expandSelectedSuperNodes()
+{
+    if (m_graphCoarsener == 0)
+        return;
+
+    std::vector<DeBruijnNode *> selectedNodes = m_scene->getSelectedNodes();
+    bool expanded = false;
+    for (size_t i = 0; i < selectedNodes.size(); ++i)
+    {
+        if (m_graphCoarsener->expandNode(selectedNodes[i]->getNameWithoutSign()))
+            expanded = true;
+    }
+
+    if (!expanded)
+    {
+        QMessageBox::information(this, "No super-nodes selected",
+                                 "Select one or more super-nodes (e.g. chain_12 or cluster_40) to expand them.");
+        return;
+    }
+
+    showLevelGraph();
+    drawGraphAtCurrentLevel();
+}
+
+
 void MainWindow::openGraphInfoDialog()
 {
     GraphInfoDialog graphInfoDialog(this);
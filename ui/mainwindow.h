@@ -28,6 +28,7 @@
 #include <QRectF>
 #include "../program/globals.h"
 #include <QThread>
+#include <QSharedPointer>
 #include "../ogdf/energybased/FMMMLayout.h"
 
 class GraphicsViewZoom;
@@ -35,6 +36,8 @@ class MyGraphicsScene;
 class DeBruijnNode;
 class DeBruijnEdge;
 class BlastSearchDialog;
+class AssemblyGraph;
+class GraphCoarsener;
 
 namespace Ui {
 class MainWindow;
@@ -62,6 +65,8 @@ private:
     UiState m_uiState;
     BlastSearchDialog * m_blastSearchDialog;
     bool m_alreadyShown;
+    QSharedPointer<AssemblyGraph> m_fullGraph;
+    GraphCoarsener * m_graphCoarsener;
 
     void cleanUp();
     void displayGraphDetails();
@@ -97,6 +102,15 @@ private:
     void removeGraphicsItemEdges(const std::vector<DeBruijnEdge *> * edges, bool reverseComplement);
     void removeAllGraphicsEdgesFromNode(DeBruijnNode * node, bool reverseComplement);
     std::vector<DeBruijnNode *> addComplementaryNodes(std::vector<DeBruijnNode *> nodes);
+    void graphEditUndoneOrRedone();
+    void updateUndoRedoActions();
+    void drawGraphAtCurrentLevel();
+    bool setLevelOfDetail(int level);
+    void showLevelGraph();
+    void leaveLevelOfDetail();
+    AssemblyGraph * getFullGraph() const;
+    void setFullGraphActionsEnabled(bool enabled);
+    void showBubbleSearchStatus(int truncatedSearchCount);
 
 private slots:
     void loadGraph(QString fullFileName = "");
@@ -133,6 +147,8 @@ private slots:
     void bringSelectedNodesToFront();
     void selectNodesWithBlastHits();
     void selectNodesWithDeadEnds();
+    void selectNodesInBubbles();
+    void selectNodesContainingSequence();
     void selectAll();
     void selectNone();
     void invertSelection();
@@ -159,6 +175,9 @@ private slots:
     void cleanUpAllBlast();
     void changeNodeName();
     void changeNodeDepth();
+    void undoEdit();
+    void redoEdit();
+    void expandSelectedSuperNodes();
     void openGraphInfoDialog();
 
 protected:
@@ -71,3 +71,11 @@ void MyProgressDialog::setValue(int value)
 {
     ui->progressBar->setValue(value);
 }
+
+//The message isn't changed once the user has cancelled, so the cancel
+//message stays.
+void MyProgressDialog::setMessage(QString message)
+{
+    if (!m_cancelled)
+        ui->messageLabel->setText(message);
+}
@@ -42,6 +42,7 @@ public:
 public slots:
     void setMaxValue(int max);
     void setValue(int value);
+    void setMessage(QString message);
 
 private:
     Ui::MyProgressDialog *ui;
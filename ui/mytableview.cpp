@@ -0,0 +1,152 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "mytableview.h"
+
+#include <vector>
+#include <algorithm>
+#include <QHeaderView>
+#include <QKeyEvent>
+#include <QApplication>
+#include <QClipboard>
+
+MyTableView::MyTableView(QWidget * parent) :
+    QTableView(parent), m_smallFirstColumn(false), m_smallSecondColumn(false)
+{
+    verticalHeader()->hide();
+    horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    horizontalHeader()->setDefaultAlignment(Qt::AlignLeft);
+}
+
+
+void MyTableView::resizeColumns()
+{
+    if (model() == 0)
+        return;
+
+    //If the sort indicator is shown, the columns are given way too much
+    //space.  It is hidden for the resize, instead of turning sorting off, as
+    //turning sorting back on would sort the whole model again.
+    horizontalHeader()->setSortIndicatorShown(false);
+    resizeColumnsToContents();
+    horizontalHeader()->setSortIndicatorShown(true);
+
+    spreadColumnsToTableWidth(horizontalHeader(), viewport()->width(),
+                              m_smallFirstColumn, m_smallSecondColumn);
+}
+
+
+void MyTableView::showEvent(QShowEvent * event)
+{
+    QTableView::showEvent(event);
+    resizeColumns();
+}
+
+
+void MyTableView::keyPressEvent(QKeyEvent* event)
+{
+    //If Ctrl-C typed (Command-C on Mac)
+    if (event->key() == Qt::Key_C && (event->modifiers() & Qt::ControlModifier))
+    {
+        copyCellsToClipboard(selectedIndexes());
+        return;
+    }
+
+    QTableView::keyPressEvent(event);
+}
+
+
+
+//This function is used after the columns are sized to their contents.  For
+//some tables, the first column is set to a minimum size, as it will hold the
+//colour for both queries and hits.
+void spreadColumnsToTableWidth(QHeaderView * header, int tableWidth,
+                               bool smallFirstColumn, bool smallSecondColumn)
+{
+    int minColumnWidth = header->minimumSectionSize();
+    if (smallFirstColumn)
+        header->resizeSection(0, minColumnWidth);
+
+    int columnCount = header->count();
+    std::vector<int> columnWidths;
+    int oldTotalColumnWidth = 0;
+    for (int i = 0; i < columnCount; ++i)
+    {
+        int columnWidth = header->sectionSize(i);
+        columnWidths.push_back(columnWidth);
+        oldTotalColumnWidth += columnWidth;
+    }
+
+    //If the total column width exceeds the size of the table, just leave things alone.
+    if (oldTotalColumnWidth > tableWidth)
+        return;
+
+    //If the code got here, then there is width to spare in the table.  Resize each column
+    //(except for the first) to take up the whole width, keeping their relative size.
+
+    int newTotalColumnWidth = 0.0;
+    int startingColumn = 0;
+    if (smallFirstColumn)
+    {
+        startingColumn = 1;
+        newTotalColumnWidth += header->sectionSize(0);
+    }
+    if (smallSecondColumn)
+    {
+        startingColumn = 2;
+        newTotalColumnWidth += header->sectionSize(1);
+    }
+
+    for (int i = startingColumn; i < columnCount - 1; ++i)
+    {
+        int oldColumnWidth = columnWidths[i];
+        double fraction = double(oldColumnWidth) / oldTotalColumnWidth;
+        int newColumnWidth = fraction * tableWidth;
+        newTotalColumnWidth += newColumnWidth;
+        header->resizeSection(i, newColumnWidth);
+    }
+    int lastColumnWidth = tableWidth - newTotalColumnWidth;
+    header->resizeSection(columnCount - 1, lastColumnWidth);
+}
+
+
+//This function puts the cells' text on the clipboard, with tabs between the
+//cells of a row and newlines between rows.
+//http://stackoverflow.com/questions/3135737/copying-part-of-qtableview
+void copyCellsToClipboard(QModelIndexList cells)
+{
+    std::sort(cells.begin(), cells.end()); // Necessary, otherwise they are in column order
+
+    QString text;
+    int currentRow = 0; // To determine when to insert newlines
+    foreach (const QModelIndex& cell, cells) {
+        if (text.length() == 0) {
+            // First item
+        } else if (cell.row() != currentRow) {
+            // New row
+            text += '\n';
+        } else {
+            // Next cell
+            text += '\t';
+        }
+        currentRow = cell.row();
+        text += cell.data().toString();
+    }
+
+    QApplication::clipboard()->setText(text);
+}
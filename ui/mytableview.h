@@ -0,0 +1,50 @@
+//Copyright 2017 Ryan Wick
+
+//This file is part of Bandage
+
+//Bandage is free software: you can redistribute it and/or modify
+//it under the terms of the GNU General Public License as published by
+//the Free Software Foundation, either version 3 of the License, or
+//(at your option) any later version.
+
+//Bandage is distributed in the hope that it will be useful,
+//but WITHOUT ANY WARRANTY; without even the implied warranty of
+//MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//GNU General Public License for more details.
+
+//You should have received a copy of the GNU General Public License
+//along with Bandage.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef MYTABLEVIEW_H
+#define MYTABLEVIEW_H
+
+#include <QTableView>
+
+class QHeaderView;
+
+
+//This is the view counterpart of MyTableWidget, for tables whose rows come
+//from a model rather than from one item per cell.
+class MyTableView : public QTableView
+{
+    Q_OBJECT
+public:
+    explicit MyTableView(QWidget *parent = 0);
+
+    void resizeColumns();
+    bool m_smallFirstColumn;
+    bool m_smallSecondColumn;
+
+protected:
+    void showEvent(QShowEvent * event);
+    void keyPressEvent(QKeyEvent* event);
+
+};
+
+//These functions are shared by MyTableView and MyTableWidget.
+void spreadColumnsToTableWidth(QHeaderView * header, int tableWidth,
+                               bool smallFirstColumn, bool smallSecondColumn);
+void copyCellsToClipboard(QModelIndexList cells);
+
+#endif // MYTABLEVIEW_H
@@ -21,10 +21,13 @@
 #include "../program/globals.h"
 #include "../program/settings.h"
 #include "../graph/assemblygraph.h"
+#include "../graph/shortestpathfinder.h"
 #include <QClipboard>
 #include <QTextStream>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QMessageBox>
+#include <QRegularExpression>
 #include "mygraphicsview.h"
 #include "../program/memory.h"
 
@@ -51,6 +54,7 @@ PathSpecifyDialog::PathSpecifyDialog(QWidget *parent) :
     connect(ui->circularPathCheckBox, SIGNAL(toggled(bool)), g_graphicsView->viewport(), SLOT(update()));
     connect(ui->copyButton, SIGNAL(clicked(bool)), this, SLOT(copyPathToClipboard()));
     connect(ui->saveButton, SIGNAL(clicked(bool)), this, SLOT(savePathToFile()));
+    connect(ui->shortestPathButton, SIGNAL(clicked(bool)), this, SLOT(fillInShortestPath()));
     connect(this, SIGNAL(rejected()), this, SLOT(deleteLater()));
 }
 
@@ -176,3 +180,47 @@ void PathSpecifyDialog::addNodeName(DeBruijnNode * node)
 
     ui->pathTextEdit->setPlainText(pathText);
 }
+
+
+//This function replaces the path text with the shortest path from the first
+//node in the text to the last node in the text.  Any start/end positions are
+//ignored.
+void PathSpecifyDialog::fillInShortestPath()
+{
+    QString pathText = ui->pathTextEdit->toPlainText();
+    pathText.remove(QRegularExpression("\\([^)]*\\)"));
+    QStringList nodeNames = pathText.simplified().split(",");
+    for (int i = nodeNames.size() - 1; i >= 0; --i)
+    {
+        nodeNames[i] = nodeNames[i].simplified();
+        if (nodeNames[i] == "")
+            nodeNames.removeAt(i);
+    }
+
+    if (nodeNames.size() < 2)
+    {
+        QMessageBox::information(this, "Not enough nodes", "To find a shortest path, enter the first and last nodes of the path (with their directionality), separated by a comma.");
+        return;
+    }
+
+    QString firstNodeName = nodeNames.front();
+    QString lastNodeName = nodeNames.back();
+    if (!g_assemblyGraph->m_deBruijnGraphNodes.contains(firstNodeName) ||
+            !g_assemblyGraph->m_deBruijnGraphNodes.contains(lastNodeName))
+    {
+        QMessageBox::information(this, "Node not found", "The first and last nodes must be exact node names in the graph, including their directionality (+ or -).");
+        return;
+    }
+
+    ShortestPathFinder shortestPathFinder(g_assemblyGraph->m_deBruijnGraphNodes[firstNodeName],
+                                          g_assemblyGraph->m_deBruijnGraphNodes[lastNodeName]);
+    Path shortestPath = shortestPathFinder.getShortestPath();
+    if (shortestPath.isEmpty())
+    {
+        QMessageBox::information(this, "No path found", "There is no path from " + firstNodeName + " to " + lastNodeName + ".");
+        return;
+    }
+
+    ui->circularPathCheckBox->setChecked(false);
+    ui->pathTextEdit->setPlainText(shortestPath.getString(true));
+}